@@ -4257,6 +4257,8 @@ public:
   unsigned getNumAttributes() const { return VertexAttributes.size(); }
   unsigned getNumSamplers() const { return Samplers.size(); }
   unsigned getNumSamplerBindings() const { return SamplerBindings.size(); }
+  unsigned getNumUniforms() const { return UniformRecords.size(); }
+  unsigned getNumTextures() const { return Textures.size(); }
   ArrayRef<VertexBinding> getBindings() const { return VertexBindings; }
   ArrayRef<VertexAttribute> getAttributes() const { return VertexAttributes; }
   ArrayRef<SamplerRecord> getSamplers() const { return Samplers; }
@@ -6006,12 +6008,16 @@ class GenerateConsumer : public ASTConsumer {
   std::unique_ptr<raw_pwrite_stream> OS;
   llvm::DenseSet<uint64_t> SeenHashes;
   llvm::DenseSet<uint64_t> SeenSamplerHashes;
+  llvm::DenseSet<uint64_t> SeenPipelineHashes;
+  llvm::DenseSet<uint64_t> SeenStateHashes;
   std::string AnonNSString;
   raw_string_ostream AnonOS{AnonNSString};
   std::string CoordinatorSpecString;
   raw_string_ostream CoordinatorSpecOS{CoordinatorSpecString};
   std::string HighCoordinatorSpecString;
   raw_string_ostream HighCoordinatorSpecOS{HighCoordinatorSpecString};
+  std::string PipelineGroupString;
+  raw_string_ostream PipelineGroupOS{PipelineGroupString};
   Optional<std::pair<SourceLocation, std::string>> HeadInclude;
   struct HshExpansion {
     SourceRange Range;
@@ -6048,6 +6054,23 @@ class GenerateConsumer : public ASTConsumer {
     T.print(HighCoordinatorSpecOS, HostPolicy);
   }
 
+  /*
+   * Specializations of one pipeline template that share a coordinator form
+   * a group; the first becomes the base pipeline that the others are
+   * created as derivatives of.
+   */
+  void addPipelineGroup(ArrayRef<QualType> Members) {
+    if (Members.size() < 2)
+      return;
+    for (auto Member : Members) {
+      PipelineGroupOS << "template <> struct hsh::detail::PipelineGroup<\n";
+      Member.print(PipelineGroupOS, HostPolicy);
+      PipelineGroupOS << "> {\n  using Base = ";
+      Members.front().print(PipelineGroupOS, HostPolicy);
+      PipelineGroupOS << ";\n};\n";
+    }
+  }
+
   class LocationNamespaceSearch
       : public RecursiveASTVisitor<LocationNamespaceSearch> {
     ASTContext &Context;
@@ -6163,6 +6186,7 @@ public:
     if (Context.getDiagnostics().hasErrorOccurred())
       return false;
 
+    std::array<SmallVector<QualType, 8>, 2> GroupMembers;
     auto ProcessSpecialization = [&](CXXRecordDecl *Specialization) {
       QualType T{Specialization->getTypeForDecl(), 0};
 
@@ -6212,10 +6236,12 @@ public:
           PipelineAttributes.getInShaderPipelineArgs(Context, PipelineSpec);
       bool IsDirectRender = PipelineAttributes.isDirectRender(PipelineSpec);
 
-      if (PipelineAttributes.isHighPriority(PipelineSpec))
+      bool HighPriority = PipelineAttributes.isHighPriority(PipelineSpec);
+      if (HighPriority)
         addHighCoordinatorType(T);
       else
         addCoordinatorType(T);
+      GroupMembers[HighPriority].push_back(T);
 
       StagesBuilder Builder(Context, Builtins, Specialization,
                             ColorAttachmentArgs.size() +
@@ -6346,13 +6372,24 @@ public:
       SmallVector<uint64_t, 8> SamplerHashes;
       DenseMap<HshTarget, StageBinaries> BinaryMap;
       BinaryMap.reserve(Targets.size());
+      DenseMap<HshTarget, uint64_t> PipelineHashes;
+      PipelineHashes.reserve(Targets.size());
 
       // Emit shader record while interjecting with data initializers
-      HostPolicy.setVarInitPrint([&](VarDecl *D, raw_ostream &InitOS) {
+      HostPolicy.setVarInitPrint([&](VarDecl *D, raw_ostream &OutOS) {
         if (D->InitHshTarget == -1)
           return false;
         auto Target = HshTarget(D->InitHshTarget);
 
+        /*
+         * The initializer spells out the pipeline state (shader hashes,
+         * vertex state and the hash of the blend and depth state) so its
+         * hash, together with the sampler hashes, identifies the pipeline
+         * across translation units.
+         */
+        std::string InitString;
+        raw_string_ostream InitOS(InitString);
+
         auto Policy =
             MakePrintingPolicy(Builtins, Target, InShaderPipelineArgs);
         auto Sources = Builder.printResults(*Policy);
@@ -6480,46 +6517,90 @@ public:
           }
         }
 
-        InitOS << "    },\n    {\n";
+        InitOS << "    },\n";
+
+        /*
+         * Blend, depth and rasterization state is emitted once per distinct
+         * state and target as a constant table that every pipeline with the
+         * same state refers to.
+         */
+        std::string StateString;
+        raw_string_ostream StateOS(StateString);
 
         auto PrintArguments = [&](const auto &Args) {
-          CommaArgPrinter ArgPrinter(InitOS);
+          CommaArgPrinter ArgPrinter(StateOS);
           for (const auto &Arg : Args) {
             ArgPrinter.addArg();
             if (Arg.getKind() == TemplateArgument::Integral &&
                 Builtins.identifyBuiltinType(Arg.getIntegralType()) ==
                     HBT_ColorComponentFlags) {
-              InitOS << "hsh::ColorComponentFlags(";
+              StateOS << "hsh::ColorComponentFlags(";
               Builtins.printColorComponentFlagExpr(
-                  InitOS, HostPolicy,
+                  StateOS, HostPolicy,
                   ColorComponentFlags(Arg.getAsIntegral().getZExtValue()));
-              InitOS << ")";
+              StateOS << ")";
             } else {
-              Arg.print(HostPolicy, InitOS);
+              Arg.print(HostPolicy, StateOS);
             }
           }
         };
 
+        StateOS << "hsh::detail::PipelineState<";
+        Builtins.printTargetEnumString(StateOS, HostPolicy, Target);
+        StateOS << ", " << ColorAttachmentArgs.size() << "> ";
+        auto StateDeclLength = StateOS.str().size();
+        StateOS << "{\n  {\n";
+
         for (const auto &Attachment : ColorAttachmentArgs) {
-          InitOS << "      hsh::detail::ColorAttachment{";
+          StateOS << "    hsh::detail::ColorAttachment{";
           PrintArguments(Attachment);
-          InitOS << "},\n";
+          StateOS << "},\n";
         }
 
-        InitOS << "    },\n";
+        StateOS << "  },\n";
 
-        InitOS << "    hsh::detail::PipelineInfo{";
+        StateOS << "  hsh::detail::PipelineInfo{";
         PrintArguments(PipelineArgs);
-        InitOS << ", " << (IsDirectRender ? "true" : "false");
-        InitOS << "}\n";
+        StateOS << ", " << (IsDirectRender ? "true" : "false");
+        StateOS << ", " << Builder.getNumUniforms() << ", "
+                << Builder.getNumTextures() << ", "
+                << Builder.getNumSamplerBindings();
+        StateOS << "}\n}";
+
+        auto StateHash = xxHash64(StateOS.str());
+        auto StateHashStr = MakeHashString(StateHash);
+        if (SeenStateHashes.insert(StateHash).second) {
+          StringRef State = StateOS.str();
+          *OS << "inline constexpr " << State.substr(0, StateDeclLength)
+              << "_hshst_" << StateHashStr << State.substr(StateDeclLength)
+              << ";\n\n";
+        }
+
+        InitOS << "    _hshst_" << StateHashStr << "\n";
 
         InitOS << "  }";
+        // Samplers are only spelled out for the first target
+        std::string PipelineState = InitOS.str();
+        for (auto SamplerHash : SamplerHashes)
+          PipelineState += MakeHashString(SamplerHash);
+        PipelineHashes[Target] = xxHash64(PipelineState);
+        OutOS << InitOS.str();
         return true;
       });
       Specialization->print(AnonOS, HostPolicy);
       HostPolicy.resetVarInitPrint();
       AnonOS << ";\n";
 
+      // Emit pipeline objects shared by identical pipelines
+      for (auto Target : Targets) {
+        auto PipelineHash = PipelineHashes[Target];
+        if (!SeenPipelineHashes.insert(PipelineHash).second)
+          continue;
+        *OS << "inline hsh::detail::PipelineObject<";
+        Builtins.printTargetEnumString(*OS, HostPolicy, Target);
+        *OS << "> _hshp_" << MakeHashString(PipelineHash) << ";\n";
+      }
+
       // Emit shader data
       for (auto Target : Targets) {
         AnonOS << "hsh::detail::ShaderData<";
@@ -6542,7 +6623,8 @@ public:
         for (auto SamplerHash : SamplerHashes)
           AnonOS << "    _hshsamp_" << MakeHashString(SamplerHash) << ",\n";
 
-        AnonOS << "  }\n};\n";
+        AnonOS << "  },\n  _hshp_" << MakeHashString(PipelineHashes[Target])
+               << "\n};\n";
       }
 
       for (auto SamplerHash : SamplerHashes) {
@@ -6560,6 +6642,8 @@ public:
     if (BindingCTD) {
       for (auto *Specialization : BindingCTD->specializations())
         ProcessSpecialization(Specialization);
+      for (const auto &Members : GroupMembers)
+        addPipelineGroup(Members);
     } else {
       ProcessSpecialization(BindingCD);
     }
@@ -6857,6 +6941,10 @@ public:
 
       *OS << AnonOS.str();
 
+      /* Groups must be known before the coordinators instantiate creation */
+      if (!PipelineGroupOS.str().empty())
+        *OS << PipelineGroupOS.str() << "\n";
+
       if (NeedsCoordinatorComma) {
         *OS << "template <> hsh::detail::PipelineCoordinatorNode<false,\n"
             << CoordinatorSpecOS.str() << ">::Impl>\n"
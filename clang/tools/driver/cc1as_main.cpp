@@ -232,6 +232,7 @@ bool AssemblerInvocation::CreateFromArgs(AssemblerInvocation &Opts,
               .Case("none", llvm::DebugCompressionType::None)
               .Case("zlib", llvm::DebugCompressionType::Z)
               .Case("zlib-gnu", llvm::DebugCompressionType::GNU)
+              .Case("zstd", llvm::DebugCompressionType::Zstd)
               .Default(llvm::DebugCompressionType::None);
     }
   }
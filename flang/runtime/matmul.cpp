@@ -0,0 +1,215 @@
+//===-- runtime/matmul.cpp ------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// Implements MATMUL for all combinations of ranks of its arguments.
+//
+// Every case is treated as an (n x m) matrix X times an (m x p) matrix Y
+// giving an (n x p) result R; a vector argument is a matrix with one row
+// (for X) or one column (for Y).  When both arguments are contiguous,
+// R is built up one column at a time as a sum of columns of X scaled by
+// elements of Y, so that the innermost loop runs with unit stride through
+// both X and R, and the loops are blocked so that a block of X stays in
+// cache while it is applied to every column of Y.  Otherwise, each element
+// of R is computed as a dot product through the descriptors' byte strides.
+
+#include "matmul.h"
+#include "terminator.h"
+#include <algorithm>
+#include <cinttypes>
+#include <complex>
+
+namespace Fortran::runtime {
+
+// Rows of X and R, and columns of X (rows of Y), in a cache block.
+static constexpr SubscriptValue rowsPerBlock{256};
+static constexpr SubscriptValue innerPerBlock{64};
+
+template <typename T> static inline T MultiplyAdd(T sum, T x, T y) {
+  return sum + x * y;
+}
+
+// Written out to avoid the NaN and infinity recovery in the library's
+// complex multiplication, which would keep the loops from vectorizing.
+template <typename R>
+static inline std::complex<R> MultiplyAdd(
+    std::complex<R> sum, std::complex<R> x, std::complex<R> y) {
+  return {sum.real() + x.real() * y.real() - x.imag() * y.imag(),
+      sum.imag() + x.real() * y.imag() + x.imag() * y.real()};
+}
+
+template <typename T>
+static void MatmulContiguous(T *r, const T *x, const T *y, SubscriptValue n,
+    SubscriptValue m, SubscriptValue p) {
+  if (n == 1) {
+    // Vector times matrix: each element of the result is a dot product
+    // with a column of Y.
+    for (SubscriptValue j{0}; j < p; ++j) {
+      const T *yColumn{y + j * m};
+      T sum{0};
+      for (SubscriptValue k{0}; k < m; ++k) {
+        sum = MultiplyAdd(sum, x[k], yColumn[k]);
+      }
+      r[j] = sum;
+    }
+    return;
+  }
+  std::fill(r, r + n * p, T{0});
+  for (SubscriptValue kb{0}; kb < m; kb += innerPerBlock) {
+    SubscriptValue kEnd{std::min(kb + innerPerBlock, m)};
+    for (SubscriptValue ib{0}; ib < n; ib += rowsPerBlock) {
+      SubscriptValue iEnd{std::min(ib + rowsPerBlock, n)};
+      for (SubscriptValue j{0}; j < p; ++j) {
+        T *rColumn{r + j * n};
+        const T *yColumn{y + j * m};
+        SubscriptValue k{kb};
+        // Four columns of X at a time, so that each element of R is loaded
+        // and stored once per four multiplications.
+        for (; k + 4 <= kEnd; k += 4) {
+          T s0{yColumn[k]}, s1{yColumn[k + 1]};
+          T s2{yColumn[k + 2]}, s3{yColumn[k + 3]};
+          const T *x0{x + k * n};
+          const T *x1{x0 + n}, *x2{x1 + n}, *x3{x2 + n};
+          for (SubscriptValue i{ib}; i < iEnd; ++i) {
+            rColumn[i] = MultiplyAdd(
+                MultiplyAdd(MultiplyAdd(MultiplyAdd(rColumn[i], x0[i], s0),
+                                x1[i], s1),
+                    x2[i], s2),
+                x3[i], s3);
+          }
+        }
+        for (; k < kEnd; ++k) {
+          T scale{yColumn[k]};
+          const T *xColumn{x + k * n};
+          for (SubscriptValue i{ib}; i < iEnd; ++i) {
+            rColumn[i] = MultiplyAdd(rColumn[i], xColumn[i], scale);
+          }
+        }
+      }
+    }
+  }
+}
+
+// Byte strides of the rows and columns of X and Y; zero for the missing
+// dimension of a vector.
+template <typename T>
+static void MatmulStrided(T *r, const char *x, const char *y, SubscriptValue n,
+    SubscriptValue m, SubscriptValue p, SubscriptValue xRowStride,
+    SubscriptValue xColumnStride, SubscriptValue yRowStride,
+    SubscriptValue yColumnStride) {
+  for (SubscriptValue j{0}; j < p; ++j) {
+    for (SubscriptValue i{0}; i < n; ++i) {
+      const char *xp{x + i * xRowStride};
+      const char *yp{y + j * yColumnStride};
+      T sum{0};
+      for (SubscriptValue k{0}; k < m; ++k) {
+        sum = MultiplyAdd(sum, *reinterpret_cast<const T *>(xp),
+            *reinterpret_cast<const T *>(yp));
+        xp += xColumnStride;
+        yp += yRowStride;
+      }
+      r[i + j * n] = sum;
+    }
+  }
+}
+
+template <typename T>
+static void DoMatmul(Descriptor &result, const Descriptor &x,
+    const Descriptor &y, SubscriptValue n, SubscriptValue m, SubscriptValue p) {
+  T *r{result.OffsetElement<T>(0)};
+  if (x.IsContiguous() && y.IsContiguous()) {
+    MatmulContiguous(r, x.OffsetElement<const T>(0),
+        y.OffsetElement<const T>(0), n, m, p);
+  } else {
+    const Dimension &xLast{x.GetDimension(x.rank() - 1)};
+    const Dimension &yFirst{y.GetDimension(0)};
+    MatmulStrided(r, x.OffsetElement<const char>(0),
+        y.OffsetElement<const char>(0), n, m, p,
+        x.rank() == 2 ? x.GetDimension(0).ByteStride() : 0,
+        xLast.ByteStride(), yFirst.ByteStride(),
+        y.rank() == 2 ? y.GetDimension(1).ByteStride() : 0);
+  }
+}
+
+extern "C" {
+void RTNAME(Matmul)(Descriptor &result, const Descriptor &x,
+    const Descriptor &y, const char *sourceFile, int line) {
+  Terminator terminator{sourceFile, line};
+  int xRank{x.rank()}, yRank{y.rank()};
+  RUNTIME_CHECK(terminator, xRank >= 1 && xRank <= 2);
+  RUNTIME_CHECK(terminator, yRank >= 1 && yRank <= 2);
+  RUNTIME_CHECK(terminator, xRank == 2 || yRank == 2);
+  SubscriptValue n{xRank == 2 ? x.GetDimension(0).Extent() : 1};
+  SubscriptValue m{x.GetDimension(xRank - 1).Extent()};
+  SubscriptValue p{yRank == 2 ? y.GetDimension(1).Extent() : 1};
+  if (y.GetDimension(0).Extent() != m) {
+    terminator.Crash("MATMUL: arguments have inner extents %" PRId64
+                     " and %" PRId64,
+        static_cast<std::int64_t>(m),
+        static_cast<std::int64_t>(y.GetDimension(0).Extent()));
+  }
+  TypeCategory category{x.type().Categorize()};
+  std::size_t elementBytes{x.ElementBytes()};
+  if (y.type().Categorize() != category || y.ElementBytes() != elementBytes) {
+    terminator.Crash("MATMUL: arguments have type codes %d and %d",
+        x.type().raw(), y.type().raw());
+  }
+
+  // Establish and allocate the result.
+  int resultRank{xRank + yRank - 2};
+  SubscriptValue lowerBound[2]{1, 1};
+  SubscriptValue extent[2];
+  if (resultRank == 2) {
+    extent[0] = n;
+    extent[1] = p;
+  } else {
+    extent[0] = xRank == 2 ? n : p;
+  }
+  result.Establish(x.type(), elementBytes, nullptr, resultRank, extent,
+      CFI_attribute_allocatable);
+  int status{result.Allocate(lowerBound, extent)};
+  if (status != CFI_SUCCESS) {
+    terminator.Crash("MATMUL: Allocate failed (error %d)", status);
+  }
+
+  switch (category) {
+  case TypeCategory::Integer:
+    switch (elementBytes) {
+    case 1:
+      return DoMatmul<std::int8_t>(result, x, y, n, m, p);
+    case 2:
+      return DoMatmul<std::int16_t>(result, x, y, n, m, p);
+    case 4:
+      return DoMatmul<std::int32_t>(result, x, y, n, m, p);
+    case 8:
+      return DoMatmul<std::int64_t>(result, x, y, n, m, p);
+    }
+    break;
+  case TypeCategory::Real:
+    switch (elementBytes) {
+    case 4:
+      return DoMatmul<float>(result, x, y, n, m, p);
+    case 8:
+      return DoMatmul<double>(result, x, y, n, m, p);
+    }
+    break;
+  case TypeCategory::Complex:
+    switch (elementBytes) {
+    case 8:
+      return DoMatmul<std::complex<float>>(result, x, y, n, m, p);
+    case 16:
+      return DoMatmul<std::complex<double>>(result, x, y, n, m, p);
+    }
+    break;
+  default:
+    break;
+  }
+  terminator.Crash("MATMUL: no case for type code %d, %zd bytes per element",
+      x.type().raw(), elementBytes);
+}
+} // extern "C"
+} // namespace Fortran::runtime
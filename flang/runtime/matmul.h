@@ -0,0 +1,29 @@
+//===-- runtime/matmul.h ----------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// Defines the API for the MATMUL transformational intrinsic function.
+
+#ifndef FORTRAN_RUNTIME_MATMUL_H_
+#define FORTRAN_RUNTIME_MATMUL_H_
+
+#include "descriptor.h"
+#include "entry-names.h"
+
+namespace Fortran::runtime {
+extern "C" {
+
+// MATMUL (F2018 16.9.124) of a matrix by a matrix, a vector by a matrix,
+// or a matrix by a vector.  The arguments must have the same intrinsic
+// numeric type and kind.  The result descriptor, which must have room for
+// the dimensions of the result, is established here as an allocatable
+// array with lower bounds of 1 and then allocated; the caller deallocates it.
+void RTNAME(Matmul)(Descriptor &result, const Descriptor &x,
+    const Descriptor &y, const char *sourceFile = nullptr, int line = 0);
+}
+} // namespace Fortran::runtime
+#endif // FORTRAN_RUNTIME_MATMUL_H_
@@ -0,0 +1,557 @@
+//===-- runtime/reduction.cpp ---------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// Implements SUM, PRODUCT, MAXVAL, MINVAL, and DOT_PRODUCT over whole arrays.
+//
+// Each reduction is an accumulator class with two ways to consume elements:
+// Contiguous() takes a unit-stride run of elements and keeps several
+// independent partial results so that the loop can be vectorized (the
+// order in which elements are combined is processor dependent in Fortran),
+// while Accumulate() takes one element at a time for arrays that must be
+// traversed through their descriptors.
+
+#include "reduction.h"
+#include "terminator.h"
+#include <cinttypes>
+#include <limits>
+
+namespace Fortran::runtime {
+
+// Number of independent partial results kept by the contiguous loops;
+// enough to cover the latency of a floating-point add or multiply.
+static constexpr std::size_t partials{4};
+
+static bool IsTrue(const Descriptor &mask, const SubscriptValue *at) {
+  const char *p{mask.Element<char>(at)};
+  switch (mask.ElementBytes()) {
+  case 1:
+    return *reinterpret_cast<const std::int8_t *>(p) != 0;
+  case 2:
+    return *reinterpret_cast<const std::int16_t *>(p) != 0;
+  case 4:
+    return *reinterpret_cast<const std::int32_t *>(p) != 0;
+  case 8:
+    return *reinterpret_cast<const std::int64_t *>(p) != 0;
+  default:
+    Terminator terminator{__FILE__, __LINE__};
+    terminator.Crash("no case for %zd-byte LOGICAL", mask.ElementBytes());
+  }
+}
+
+static void CheckType(const Descriptor &x, TypeCategory category, int kind,
+    const char *intrinsic, Terminator &terminator) {
+  if (x.type().Categorize() != category ||
+      x.ElementBytes() !=
+          static_cast<std::size_t>(
+              category == TypeCategory::Complex ? 2 * kind : kind)) {
+    terminator.Crash("%s: bad argument type code %d, %zd bytes per element",
+        intrinsic, x.type().raw(), x.ElementBytes());
+  }
+}
+
+static void CheckConformable(const Descriptor &x, const Descriptor &y,
+    const char *intrinsic, Terminator &terminator) {
+  int rank{x.rank()};
+  if (y.rank() != rank) {
+    terminator.Crash(
+        "%s: arguments have ranks %d and %d", intrinsic, rank, y.rank());
+  }
+  for (int j{0}; j < rank; ++j) {
+    auto xExtent{x.GetDimension(j).Extent()};
+    auto yExtent{y.GetDimension(j).Extent()};
+    if (xExtent != yExtent) {
+      terminator.Crash("%s: dimension %d of arguments have extents %" PRId64
+                       " and %" PRId64,
+          intrinsic, j + 1, static_cast<std::int64_t>(xExtent),
+          static_cast<std::int64_t>(yExtent));
+    }
+  }
+}
+
+template <typename T, typename ACCUMULATOR>
+static void DoReduction(const Descriptor &x, const Descriptor *mask,
+    ACCUMULATOR &accumulator, const char *intrinsic, Terminator &terminator) {
+  std::size_t elements{x.Elements()};
+  if (elements == 0) {
+    return;
+  }
+  if (mask && mask->rank() == 0) {
+    // A scalar MASK= applies to every element.
+    if (!IsTrue(*mask, nullptr)) {
+      return;
+    }
+    mask = nullptr;
+  }
+  if (!mask && x.IsContiguous()) {
+    accumulator.Contiguous(x.OffsetElement<T>(0), elements);
+    return;
+  }
+  SubscriptValue at[maxRank], maskAt[maxRank];
+  x.GetLowerBounds(at);
+  if (mask) {
+    CheckConformable(x, *mask, intrinsic, terminator);
+    mask->GetLowerBounds(maskAt);
+    for (; elements-- > 0; x.IncrementSubscripts(at)) {
+      if (IsTrue(*mask, maskAt)) {
+        accumulator.Accumulate(*x.Element<T>(at));
+      }
+      mask->IncrementSubscripts(maskAt);
+    }
+    return;
+  }
+  // Step through each column with its byte stride, and through the
+  // subscripts only from one column to the next.
+  const Dimension &dim0{x.GetDimension(0)};
+  SubscriptValue columnExtent{dim0.Extent()};
+  SubscriptValue stride{dim0.ByteStride()};
+  for (std::size_t columns{elements / columnExtent}; columns-- > 0;) {
+    const char *p{x.Element<char>(at)};
+    for (SubscriptValue j{0}; j < columnExtent; ++j, p += stride) {
+      accumulator.Accumulate(*reinterpret_cast<const T *>(p));
+    }
+    at[0] = dim0.UpperBound();
+    x.IncrementSubscripts(at);
+  }
+}
+
+template <typename T> class SumAccumulator {
+public:
+  void Contiguous(const T *p, std::size_t n) {
+    T partial[partials]{};
+    std::size_t j{0};
+    for (; j + partials <= n; j += partials) {
+      for (std::size_t k{0}; k < partials; ++k) {
+        partial[k] += p[j + k];
+      }
+    }
+    for (; j < n; ++j) {
+      sum_ += p[j];
+    }
+    for (std::size_t k{0}; k < partials; ++k) {
+      sum_ += partial[k];
+    }
+  }
+  void Accumulate(const T &x) { sum_ += x; }
+  T result() const { return sum_; }
+
+private:
+  T sum_{0};
+};
+
+template <typename T> class ProductAccumulator {
+public:
+  void Contiguous(const T *p, std::size_t n) {
+    T partial[partials];
+    for (std::size_t k{0}; k < partials; ++k) {
+      partial[k] = T{1};
+    }
+    std::size_t j{0};
+    for (; j + partials <= n; j += partials) {
+      for (std::size_t k{0}; k < partials; ++k) {
+        partial[k] *= p[j + k];
+      }
+    }
+    for (; j < n; ++j) {
+      product_ *= p[j];
+    }
+    for (std::size_t k{0}; k < partials; ++k) {
+      product_ *= partial[k];
+    }
+  }
+  void Accumulate(const T &x) { product_ *= x; }
+  T result() const { return product_; }
+
+private:
+  T product_{1};
+};
+
+// For MAXVAL (IS_MAX) and MINVAL.  The comparisons are false for NaN,
+// so NaN elements never replace the accumulated value.
+template <typename T, bool IS_MAX> class ExtremumAccumulator {
+public:
+  void Contiguous(const T *p, std::size_t n) {
+    any_ |= n > 0;
+    T partial[partials];
+    for (std::size_t k{0}; k < partials; ++k) {
+      partial[k] = extremum_;
+    }
+    std::size_t j{0};
+    for (; j + partials <= n; j += partials) {
+      for (std::size_t k{0}; k < partials; ++k) {
+        partial[k] = Pick(partial[k], p[j + k]);
+      }
+    }
+    for (; j < n; ++j) {
+      extremum_ = Pick(extremum_, p[j]);
+    }
+    for (std::size_t k{0}; k < partials; ++k) {
+      extremum_ = Pick(extremum_, partial[k]);
+    }
+  }
+  void Accumulate(const T &x) {
+    any_ = true;
+    extremum_ = Pick(extremum_, x);
+  }
+  T result() const { return any_ ? extremum_ : Empty(); }
+
+private:
+  static T Pick(T a, T b) {
+    if constexpr (IS_MAX) {
+      return b > a ? b : a;
+    } else {
+      return b < a ? b : a;
+    }
+  }
+  // The result when no element is selected: -HUGE for MAXVAL and HUGE for
+  // MINVAL, or an infinity of that sign where the type has one.
+  static constexpr T Empty() {
+    using Limits = std::numeric_limits<T>;
+    if constexpr (Limits::has_infinity) {
+      return IS_MAX ? -Limits::infinity() : Limits::infinity();
+    } else {
+      return IS_MAX ? -Limits::max() : Limits::max();
+    }
+  }
+  // INTEGER MAXVAL starts from the least value of the type, which lies below
+  // -HUGE(), so that an element with that value is still found.
+  static constexpr T Start() {
+    if constexpr (std::numeric_limits<T>::has_infinity) {
+      return Empty();
+    } else {
+      return IS_MAX ? std::numeric_limits<T>::lowest()
+                    : std::numeric_limits<T>::max();
+    }
+  }
+  T extremum_{Start()};
+  bool any_{false};
+};
+
+template <typename T, typename ACCUMULATOR>
+static T Reduce(const Descriptor &x, const char *source, int line,
+    const Descriptor *mask, TypeCategory category, int kind,
+    const char *intrinsic) {
+  Terminator terminator{source, line};
+  CheckType(x, category, kind, intrinsic, terminator);
+  ACCUMULATOR accumulator;
+  DoReduction<T>(x, mask, accumulator, intrinsic, terminator);
+  return accumulator.result();
+}
+
+// COMPLEX products are done one element at a time, so only their sums
+// have split real and imaginary accumulators.
+template <typename T> class ComplexSumAccumulator {
+public:
+  void Contiguous(const std::complex<T> *p, std::size_t n) {
+    // A COMPLEX array is also a unit-stride array of 2*n reals.
+    const T *r{reinterpret_cast<const T *>(p)};
+    T partial[2 * partials]{};
+    std::size_t j{0};
+    for (; j + partials <= n; j += partials) {
+      for (std::size_t k{0}; k < 2 * partials; ++k) {
+        partial[k] += r[2 * j + k];
+      }
+    }
+    for (; j < n; ++j) {
+      sum_ += p[j];
+    }
+    for (std::size_t k{0}; k < 2 * partials; k += 2) {
+      sum_ += std::complex<T>{partial[k], partial[k + 1]};
+    }
+  }
+  void Accumulate(const std::complex<T> &x) { sum_ += x; }
+  std::complex<T> result() const { return sum_; }
+
+private:
+  std::complex<T> sum_{0, 0};
+};
+
+template <typename T> class ComplexProductAccumulator {
+public:
+  void Contiguous(const std::complex<T> *p, std::size_t n) {
+    for (std::size_t j{0}; j < n; ++j) {
+      Accumulate(p[j]);
+    }
+  }
+  void Accumulate(const std::complex<T> &x) { product_ *= x; }
+  std::complex<T> result() const { return product_; }
+
+private:
+  std::complex<T> product_{1, 0};
+};
+
+// DOT_PRODUCT
+template <typename T>
+static T DotProduct(const Descriptor &x, const Descriptor &y,
+    const char *source, int line, TypeCategory category, int kind) {
+  Terminator terminator{source, line};
+  CheckType(x, category, kind, "DOT_PRODUCT", terminator);
+  CheckType(y, category, kind, "DOT_PRODUCT", terminator);
+  RUNTIME_CHECK(terminator, x.rank() == 1 && y.rank() == 1);
+  CheckConformable(x, y, "DOT_PRODUCT", terminator);
+  SubscriptValue n{x.GetDimension(0).Extent()};
+  if (x.IsContiguous() && y.IsContiguous()) {
+    const T *xp{x.OffsetElement<T>(0)};
+    const T *yp{y.OffsetElement<T>(0)};
+    T partial[partials]{};
+    SubscriptValue j{0};
+    for (; j + static_cast<SubscriptValue>(partials) <= n; j += partials) {
+      for (std::size_t k{0}; k < partials; ++k) {
+        partial[k] += xp[j + k] * yp[j + k];
+      }
+    }
+    T result{0};
+    for (; j < n; ++j) {
+      result += xp[j] * yp[j];
+    }
+    for (std::size_t k{0}; k < partials; ++k) {
+      result += partial[k];
+    }
+    return result;
+  }
+  T result{0};
+  SubscriptValue xAt{x.GetDimension(0).LowerBound()};
+  SubscriptValue yAt{y.GetDimension(0).LowerBound()};
+  for (SubscriptValue j{0}; j < n; ++j, ++xAt, ++yAt) {
+    result += *x.Element<T>(&xAt) * *y.Element<T>(&yAt);
+  }
+  return result;
+}
+
+template <typename T>
+static std::complex<T> ComplexDotProduct(const Descriptor &x,
+    const Descriptor &y, const char *source, int line, int kind) {
+  Terminator terminator{source, line};
+  CheckType(x, TypeCategory::Complex, kind, "DOT_PRODUCT", terminator);
+  CheckType(y, TypeCategory::Complex, kind, "DOT_PRODUCT", terminator);
+  RUNTIME_CHECK(terminator, x.rank() == 1 && y.rank() == 1);
+  CheckConformable(x, y, "DOT_PRODUCT", terminator);
+  SubscriptValue n{x.GetDimension(0).Extent()};
+  // Accumulate CONJG(x)*y with the real and imaginary parts written out,
+  // which avoids the NaN recovery of the library's complex multiplication.
+  T re{0}, im{0};
+  if (x.IsContiguous() && y.IsContiguous()) {
+    const T *xp{x.OffsetElement<T>(0)};
+    const T *yp{y.OffsetElement<T>(0)};
+    for (SubscriptValue j{0}; j < 2 * n; j += 2) {
+      re += xp[j] * yp[j] + xp[j + 1] * yp[j + 1];
+      im += xp[j] * yp[j + 1] - xp[j + 1] * yp[j];
+    }
+  } else {
+    SubscriptValue xAt{x.GetDimension(0).LowerBound()};
+    SubscriptValue yAt{y.GetDimension(0).LowerBound()};
+    for (SubscriptValue j{0}; j < n; ++j, ++xAt, ++yAt) {
+      const T *xp{x.Element<T>(&xAt)};
+      const T *yp{y.Element<T>(&yAt)};
+      re += xp[0] * yp[0] + xp[1] * yp[1];
+      im += xp[0] * yp[1] - xp[1] * yp[0];
+    }
+  }
+  return {re, im};
+}
+
+extern "C" {
+std::int8_t RTNAME(SumInteger1)(const Descriptor &x, const char *source,
+    int line, const Descriptor *mask) {
+  return Reduce<std::int8_t, SumAccumulator<std::int8_t>>(
+      x, source, line, mask, TypeCategory::Integer, 1, "SUM");
+}
+std::int16_t RTNAME(SumInteger2)(const Descriptor &x, const char *source,
+    int line, const Descriptor *mask) {
+  return Reduce<std::int16_t, SumAccumulator<std::int16_t>>(
+      x, source, line, mask, TypeCategory::Integer, 2, "SUM");
+}
+std::int32_t RTNAME(SumInteger4)(const Descriptor &x, const char *source,
+    int line, const Descriptor *mask) {
+  return Reduce<std::int32_t, SumAccumulator<std::int32_t>>(
+      x, source, line, mask, TypeCategory::Integer, 4, "SUM");
+}
+std::int64_t RTNAME(SumInteger8)(const Descriptor &x, const char *source,
+    int line, const Descriptor *mask) {
+  return Reduce<std::int64_t, SumAccumulator<std::int64_t>>(
+      x, source, line, mask, TypeCategory::Integer, 8, "SUM");
+}
+float RTNAME(SumReal4)(const Descriptor &x, const char *source, int line,
+    const Descriptor *mask) {
+  return Reduce<float, SumAccumulator<float>>(
+      x, source, line, mask, TypeCategory::Real, 4, "SUM");
+}
+double RTNAME(SumReal8)(const Descriptor &x, const char *source, int line,
+    const Descriptor *mask) {
+  return Reduce<double, SumAccumulator<double>>(
+      x, source, line, mask, TypeCategory::Real, 8, "SUM");
+}
+void RTNAME(CppSumComplex4)(std::complex<float> &result, const Descriptor &x,
+    const char *source, int line, const Descriptor *mask) {
+  result = Reduce<std::complex<float>, ComplexSumAccumulator<float>>(
+      x, source, line, mask, TypeCategory::Complex, 4, "SUM");
+}
+void RTNAME(CppSumComplex8)(std::complex<double> &result, const Descriptor &x,
+    const char *source, int line, const Descriptor *mask) {
+  result = Reduce<std::complex<double>, ComplexSumAccumulator<double>>(
+      x, source, line, mask, TypeCategory::Complex, 8, "SUM");
+}
+
+std::int8_t RTNAME(ProductInteger1)(const Descriptor &x, const char *source,
+    int line, const Descriptor *mask) {
+  return Reduce<std::int8_t, ProductAccumulator<std::int8_t>>(
+      x, source, line, mask, TypeCategory::Integer, 1, "PRODUCT");
+}
+std::int16_t RTNAME(ProductInteger2)(const Descriptor &x, const char *source,
+    int line, const Descriptor *mask) {
+  return Reduce<std::int16_t, ProductAccumulator<std::int16_t>>(
+      x, source, line, mask, TypeCategory::Integer, 2, "PRODUCT");
+}
+std::int32_t RTNAME(ProductInteger4)(const Descriptor &x, const char *source,
+    int line, const Descriptor *mask) {
+  return Reduce<std::int32_t, ProductAccumulator<std::int32_t>>(
+      x, source, line, mask, TypeCategory::Integer, 4, "PRODUCT");
+}
+std::int64_t RTNAME(ProductInteger8)(const Descriptor &x, const char *source,
+    int line, const Descriptor *mask) {
+  return Reduce<std::int64_t, ProductAccumulator<std::int64_t>>(
+      x, source, line, mask, TypeCategory::Integer, 8, "PRODUCT");
+}
+float RTNAME(ProductReal4)(const Descriptor &x, const char *source, int line,
+    const Descriptor *mask) {
+  return Reduce<float, ProductAccumulator<float>>(
+      x, source, line, mask, TypeCategory::Real, 4, "PRODUCT");
+}
+double RTNAME(ProductReal8)(const Descriptor &x, const char *source, int line,
+    const Descriptor *mask) {
+  return Reduce<double, ProductAccumulator<double>>(
+      x, source, line, mask, TypeCategory::Real, 8, "PRODUCT");
+}
+void RTNAME(CppProductComplex4)(std::complex<float> &result,
+    const Descriptor &x, const char *source, int line,
+    const Descriptor *mask) {
+  result = Reduce<std::complex<float>, ComplexProductAccumulator<float>>(
+      x, source, line, mask, TypeCategory::Complex, 4, "PRODUCT");
+}
+void RTNAME(CppProductComplex8)(std::complex<double> &result,
+    const Descriptor &x, const char *source, int line,
+    const Descriptor *mask) {
+  result = Reduce<std::complex<double>, ComplexProductAccumulator<double>>(
+      x, source, line, mask, TypeCategory::Complex, 8, "PRODUCT");
+}
+
+std::int8_t RTNAME(MaxvalInteger1)(const Descriptor &x, const char *source,
+    int line, const Descriptor *mask) {
+  return Reduce<std::int8_t, ExtremumAccumulator<std::int8_t, true>>(
+      x, source, line, mask, TypeCategory::Integer, 1, "MAXVAL");
+}
+std::int16_t RTNAME(MaxvalInteger2)(const Descriptor &x, const char *source,
+    int line, const Descriptor *mask) {
+  return Reduce<std::int16_t, ExtremumAccumulator<std::int16_t, true>>(
+      x, source, line, mask, TypeCategory::Integer, 2, "MAXVAL");
+}
+std::int32_t RTNAME(MaxvalInteger4)(const Descriptor &x, const char *source,
+    int line, const Descriptor *mask) {
+  return Reduce<std::int32_t, ExtremumAccumulator<std::int32_t, true>>(
+      x, source, line, mask, TypeCategory::Integer, 4, "MAXVAL");
+}
+std::int64_t RTNAME(MaxvalInteger8)(const Descriptor &x, const char *source,
+    int line, const Descriptor *mask) {
+  return Reduce<std::int64_t, ExtremumAccumulator<std::int64_t, true>>(
+      x, source, line, mask, TypeCategory::Integer, 8, "MAXVAL");
+}
+float RTNAME(MaxvalReal4)(const Descriptor &x, const char *source, int line,
+    const Descriptor *mask) {
+  return Reduce<float, ExtremumAccumulator<float, true>>(
+      x, source, line, mask, TypeCategory::Real, 4, "MAXVAL");
+}
+double RTNAME(MaxvalReal8)(const Descriptor &x, const char *source, int line,
+    const Descriptor *mask) {
+  return Reduce<double, ExtremumAccumulator<double, true>>(
+      x, source, line, mask, TypeCategory::Real, 8, "MAXVAL");
+}
+
+std::int8_t RTNAME(MinvalInteger1)(const Descriptor &x, const char *source,
+    int line, const Descriptor *mask) {
+  return Reduce<std::int8_t, ExtremumAccumulator<std::int8_t, false>>(
+      x, source, line, mask, TypeCategory::Integer, 1, "MINVAL");
+}
+std::int16_t RTNAME(MinvalInteger2)(const Descriptor &x, const char *source,
+    int line, const Descriptor *mask) {
+  return Reduce<std::int16_t, ExtremumAccumulator<std::int16_t, false>>(
+      x, source, line, mask, TypeCategory::Integer, 2, "MINVAL");
+}
+std::int32_t RTNAME(MinvalInteger4)(const Descriptor &x, const char *source,
+    int line, const Descriptor *mask) {
+  return Reduce<std::int32_t, ExtremumAccumulator<std::int32_t, false>>(
+      x, source, line, mask, TypeCategory::Integer, 4, "MINVAL");
+}
+std::int64_t RTNAME(MinvalInteger8)(const Descriptor &x, const char *source,
+    int line, const Descriptor *mask) {
+  return Reduce<std::int64_t, ExtremumAccumulator<std::int64_t, false>>(
+      x, source, line, mask, TypeCategory::Integer, 8, "MINVAL");
+}
+float RTNAME(MinvalReal4)(const Descriptor &x, const char *source, int line,
+    const Descriptor *mask) {
+  return Reduce<float, ExtremumAccumulator<float, false>>(
+      x, source, line, mask, TypeCategory::Real, 4, "MINVAL");
+}
+double RTNAME(MinvalReal8)(const Descriptor &x, const char *source, int line,
+    const Descriptor *mask) {
+  return Reduce<double, ExtremumAccumulator<double, false>>(
+      x, source, line, mask, TypeCategory::Real, 8, "MINVAL");
+}
+
+std::int8_t RTNAME(DotProductInteger1)(
+    const Descriptor &x, const Descriptor &y, const char *source, int line) {
+  return DotProduct<std::int8_t>(x, y, source, line, TypeCategory::Integer, 1);
+}
+std::int16_t RTNAME(DotProductInteger2)(
+    const Descriptor &x, const Descriptor &y, const char *source, int line) {
+  return DotProduct<std::int16_t>(
+      x, y, source, line, TypeCategory::Integer, 2);
+}
+std::int32_t RTNAME(DotProductInteger4)(
+    const Descriptor &x, const Descriptor &y, const char *source, int line) {
+  return DotProduct<std::int32_t>(
+      x, y, source, line, TypeCategory::Integer, 4);
+}
+std::int64_t RTNAME(DotProductInteger8)(
+    const Descriptor &x, const Descriptor &y, const char *source, int line) {
+  return DotProduct<std::int64_t>(
+      x, y, source, line, TypeCategory::Integer, 8);
+}
+float RTNAME(DotProductReal4)(
+    const Descriptor &x, const Descriptor &y, const char *source, int line) {
+  return DotProduct<float>(x, y, source, line, TypeCategory::Real, 4);
+}
+double RTNAME(DotProductReal8)(
+    const Descriptor &x, const Descriptor &y, const char *source, int line) {
+  return DotProduct<double>(x, y, source, line, TypeCategory::Real, 8);
+}
+void RTNAME(CppDotProductComplex4)(std::complex<float> &result,
+    const Descriptor &x, const Descriptor &y, const char *source, int line) {
+  result = ComplexDotProduct<float>(x, y, source, line, 4);
+}
+void RTNAME(CppDotProductComplex8)(std::complex<double> &result,
+    const Descriptor &x, const Descriptor &y, const char *source, int line) {
+  result = ComplexDotProduct<double>(x, y, source, line, 8);
+}
+bool RTNAME(DotProductLogical)(
+    const Descriptor &x, const Descriptor &y, const char *source, int line) {
+  Terminator terminator{source, line};
+  RUNTIME_CHECK(terminator, x.type().IsLogical());
+  RUNTIME_CHECK(terminator, y.type().IsLogical());
+  RUNTIME_CHECK(terminator, x.rank() == 1 && y.rank() == 1);
+  CheckConformable(x, y, "DOT_PRODUCT", terminator);
+  SubscriptValue n{x.GetDimension(0).Extent()};
+  SubscriptValue xAt{x.GetDimension(0).LowerBound()};
+  SubscriptValue yAt{y.GetDimension(0).LowerBound()};
+  for (SubscriptValue j{0}; j < n; ++j, ++xAt, ++yAt) {
+    if (IsTrue(x, &xAt) && IsTrue(y, &yAt)) {
+      return true;
+    }
+  }
+  return false;
+}
+} // extern "C"
+} // namespace Fortran::runtime
@@ -0,0 +1,141 @@
+// Times the runtime's MATMUL, DOT_PRODUCT, SUM, and MAXVAL against the
+// textbook loops that they replace.  Not run as a test; invoke it with an
+// optional size scale factor (default 1).
+
+#include "../../runtime/descriptor.h"
+#include "../../runtime/matmul.h"
+#include "../../runtime/reduction.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace Fortran::runtime;
+using Fortran::common::TypeCategory;
+
+static volatile double sink;
+
+template <typename F> static double Seconds(int repetitions, F &&f) {
+  auto start{std::chrono::steady_clock::now()};
+  for (int j{0}; j < repetitions; ++j) {
+    f();
+  }
+  std::chrono::duration<double> elapsed{
+      std::chrono::steady_clock::now() - start};
+  return elapsed.count() / repetitions;
+}
+
+static void Report(const char *what, double naive, double runtime) {
+  std::printf("%-28s naive %10.3f us  runtime %10.3f us  speedup %5.2fx\n",
+      what, naive * 1e6, runtime * 1e6, naive / runtime);
+}
+
+static void BenchMatmul(SubscriptValue n, int repetitions) {
+  std::vector<double> x(n * n), y(n * n), r(n * n);
+  for (SubscriptValue j{0}; j < n * n; ++j) {
+    x[j] = j % 13;
+    y[j] = j % 7;
+  }
+  SubscriptValue extent[]{n, n};
+  StaticDescriptor<2> staticDescriptor[3];
+  Descriptor &xd{staticDescriptor[0].descriptor()};
+  Descriptor &yd{staticDescriptor[1].descriptor()};
+  Descriptor &result{staticDescriptor[2].descriptor()};
+  xd.Establish(TypeCategory::Real, 8, x.data(), 2, extent);
+  yd.Establish(TypeCategory::Real, 8, y.data(), 2, extent);
+  double naive{Seconds(repetitions, [&]() {
+    for (SubscriptValue i{0}; i < n; ++i) {
+      for (SubscriptValue j{0}; j < n; ++j) {
+        double sum{0};
+        for (SubscriptValue k{0}; k < n; ++k) {
+          sum += x[i + k * n] * y[k + j * n];
+        }
+        r[i + j * n] = sum;
+      }
+    }
+    sink = r[n * n - 1];
+  })};
+  double runtime{Seconds(repetitions, [&]() {
+    RTNAME(Matmul)(result, xd, yd);
+    sink = result.OffsetElement<double>(0)[n * n - 1];
+    result.Deallocate();
+  })};
+  char what[64];
+  std::snprintf(what, sizeof what, "MATMUL real(8) %ldx%ld",
+      static_cast<long>(n), static_cast<long>(n));
+  Report(what, naive, runtime);
+}
+
+static void BenchReductions(SubscriptValue n, int repetitions) {
+  std::vector<double> x(n), y(n);
+  for (SubscriptValue j{0}; j < n; ++j) {
+    x[j] = (j % 17) * 0.25;
+    y[j] = (j % 11) * 0.5;
+  }
+  SubscriptValue extent[]{n};
+  StaticDescriptor<1> staticDescriptor[2];
+  Descriptor &xd{staticDescriptor[0].descriptor()};
+  Descriptor &yd{staticDescriptor[1].descriptor()};
+  xd.Establish(TypeCategory::Real, 8, x.data(), 1, extent);
+  yd.Establish(TypeCategory::Real, 8, y.data(), 1, extent);
+
+  double naive{Seconds(repetitions, [&]() {
+    double sum{0};
+    for (SubscriptValue j{0}; j < n; ++j) {
+      sum += x[j] * y[j];
+    }
+    sink = sum;
+  })};
+  double runtime{Seconds(
+      repetitions, [&]() { sink = RTNAME(DotProductReal8)(xd, yd); })};
+  Report("DOT_PRODUCT real(8)", naive, runtime);
+
+  naive = Seconds(repetitions, [&]() {
+    double sum{0};
+    for (SubscriptValue j{0}; j < n; ++j) {
+      sum += x[j];
+    }
+    sink = sum;
+  });
+  runtime = Seconds(repetitions,
+      [&]() { sink = RTNAME(SumReal8)(xd, __FILE__, __LINE__); });
+  Report("SUM real(8)", naive, runtime);
+
+  naive = Seconds(repetitions, [&]() {
+    double maxval{x[0]};
+    for (SubscriptValue j{1}; j < n; ++j) {
+      if (x[j] > maxval) {
+        maxval = x[j];
+      }
+    }
+    sink = maxval;
+  });
+  runtime = Seconds(repetitions,
+      [&]() { sink = RTNAME(MaxvalReal8)(xd, __FILE__, __LINE__); });
+  Report("MAXVAL real(8)", naive, runtime);
+
+  // Every other element, through the descriptor
+  xd.raw().dim[0].sm *= 2;
+  xd.raw().dim[0].extent = n / 2;
+  naive = Seconds(repetitions, [&]() {
+    double sum{0};
+    for (SubscriptValue j{0}; j < n; j += 2) {
+      sum += x[j];
+    }
+    sink = sum;
+  });
+  runtime = Seconds(repetitions,
+      [&]() { sink = RTNAME(SumReal8)(xd, __FILE__, __LINE__); });
+  Report("SUM real(8) stride 2", naive, runtime);
+}
+
+int main(int argc, const char *argv[]) {
+  int scale{argc > 1 ? std::atoi(argv[1]) : 1};
+  if (scale < 1) {
+    scale = 1;
+  }
+  BenchMatmul(64 * scale, 20);
+  BenchMatmul(256 * scale, 2);
+  BenchReductions(1 << 20, 20 * scale);
+  return 0;
+}
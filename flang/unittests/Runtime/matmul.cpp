@@ -0,0 +1,146 @@
+// Tests of MATMUL for each combination of argument ranks, with contiguous
+// and strided arguments
+
+#include "testing.h"
+#include "../../runtime/descriptor.h"
+#include "../../runtime/matmul.h"
+#include "llvm/Support/raw_ostream.h"
+#include <complex>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace Fortran::runtime;
+using Fortran::common::TypeCategory;
+
+// Computes the reference result with the textbook loops.
+template <typename T>
+static void NaiveMatmul(T *r, const T *x, const T *y, SubscriptValue n,
+    SubscriptValue m, SubscriptValue p) {
+  for (SubscriptValue i{0}; i < n; ++i) {
+    for (SubscriptValue j{0}; j < p; ++j) {
+      T sum{0};
+      for (SubscriptValue k{0}; k < m; ++k) {
+        sum += x[i + k * n] * y[k + j * m];
+      }
+      r[i + j * n] = sum;
+    }
+  }
+}
+
+template <typename T>
+static void CheckResult(const char *what, const Descriptor &result, int rank,
+    const SubscriptValue *extent, const T *expect) {
+  if (result.rank() != rank) {
+    Fail() << what << ": result rank " << result.rank() << ", expected "
+           << rank << '\n';
+    return;
+  }
+  for (int j{0}; j < rank; ++j) {
+    const Dimension &dim{result.GetDimension(j)};
+    if (dim.LowerBound() != 1 || dim.Extent() != extent[j]) {
+      Fail() << what << ": result dimension " << j << " is "
+             << dim.LowerBound() << ':' << dim.UpperBound() << '\n';
+      return;
+    }
+  }
+  std::size_t elements{result.Elements()};
+  const T *got{result.OffsetElement<const T>(0)};
+  for (std::size_t j{0}; j < elements; ++j) {
+    if (got[j] != expect[j]) {
+      Fail() << what << ": element " << j << " is wrong\n";
+      return;
+    }
+  }
+}
+
+static void testRanks() {
+  // [[1,2,3],[4,5,6]] (2x3) times [[1,2],[3,4],[5,6]] (3x2)
+  double x[]{1, 4, 2, 5, 3, 6};
+  double y[]{1, 3, 5, 2, 4, 6};
+  double v[]{1, -1};
+  double w[]{2, 0, -1};
+  SubscriptValue xExtent[]{2, 3}, yExtent[]{3, 2}, vExtent[]{2}, wExtent[]{3};
+  StaticDescriptor<2> staticDescriptor[5];
+  Descriptor &xd{staticDescriptor[0].descriptor()};
+  Descriptor &yd{staticDescriptor[1].descriptor()};
+  Descriptor &vd{staticDescriptor[2].descriptor()};
+  Descriptor &wd{staticDescriptor[3].descriptor()};
+  Descriptor &result{staticDescriptor[4].descriptor()};
+  xd.Establish(TypeCategory::Real, 8, x, 2, xExtent);
+  yd.Establish(TypeCategory::Real, 8, y, 2, yExtent);
+  vd.Establish(TypeCategory::Real, 8, v, 1, vExtent);
+  wd.Establish(TypeCategory::Real, 8, w, 1, wExtent);
+
+  RTNAME(Matmul)(result, xd, yd, __FILE__, __LINE__);
+  SubscriptValue matrixExtent[]{2, 2};
+  double matrix[]{22, 49, 28, 64};
+  CheckResult("MATMUL(x,y)", result, 2, matrixExtent, matrix);
+  result.Deallocate();
+
+  RTNAME(Matmul)(result, vd, xd, __FILE__, __LINE__);
+  SubscriptValue vectorTimesExtent[]{3};
+  double vectorTimes[]{-3, -3, -3};
+  CheckResult("MATMUL(v,x)", result, 1, vectorTimesExtent, vectorTimes);
+  result.Deallocate();
+
+  RTNAME(Matmul)(result, xd, wd, __FILE__, __LINE__);
+  SubscriptValue timesVectorExtent[]{2};
+  double timesVector[]{-1, 2};
+  CheckResult("MATMUL(x,w)", result, 1, timesVectorExtent, timesVector);
+  result.Deallocate();
+
+  // The sections x(:,1:3:2) and y(1:3:2,:) exercise the strided path.
+  xd.raw().dim[1].sm *= 2;
+  xd.raw().dim[1].extent = 2;
+  yd.raw().dim[0].sm *= 2;
+  yd.raw().dim[0].extent = 2;
+  RTNAME(Matmul)(result, xd, yd, __FILE__, __LINE__);
+  double strided[]{16, 34, 20, 44};
+  CheckResult("MATMUL(x(:,1:3:2),y(1:3:2,:))", result, 2, matrixExtent,
+      strided);
+  result.Deallocate();
+
+  // Nonconformable arguments
+  try {
+    RTNAME(Matmul)(result, xd, wd, __FILE__, __LINE__);
+    Fail() << "MATMUL of nonconformable arguments did not crash\n";
+  } catch (const std::string &) {
+  }
+}
+
+template <typename T>
+static void testLarge(const char *what, TypeCategory category, int kind,
+    SubscriptValue n, SubscriptValue m, SubscriptValue p) {
+  std::vector<T> x(n * m), y(m * p), expect(n * p);
+  for (SubscriptValue j{0}; j < n * m; ++j) {
+    x[j] = static_cast<T>(j % 7 - 3);
+  }
+  for (SubscriptValue j{0}; j < m * p; ++j) {
+    y[j] = static_cast<T>(j % 5 - 2);
+  }
+  NaiveMatmul(expect.data(), x.data(), y.data(), n, m, p);
+  SubscriptValue xExtent[]{n, m}, yExtent[]{m, p}, rExtent[]{n, p};
+  StaticDescriptor<2> staticDescriptor[3];
+  Descriptor &xd{staticDescriptor[0].descriptor()};
+  Descriptor &yd{staticDescriptor[1].descriptor()};
+  Descriptor &result{staticDescriptor[2].descriptor()};
+  xd.Establish(category, kind, x.data(), 2, xExtent);
+  yd.Establish(category, kind, y.data(), 2, yExtent);
+  RTNAME(Matmul)(result, xd, yd, __FILE__, __LINE__);
+  CheckResult(what, result, 2, rExtent, expect.data());
+  result.Deallocate();
+}
+
+int main() {
+  StartTests();
+  testRanks();
+  // Sizes that are not multiples of the cache blocks; the elements are
+  // small integers, so that every sum is exact.
+  testLarge<std::int32_t>("INTEGER(4)", TypeCategory::Integer, 4, 300, 70, 9);
+  testLarge<float>("REAL(4)", TypeCategory::Real, 4, 257, 65, 3);
+  testLarge<double>("REAL(8)", TypeCategory::Real, 8, 513, 130, 5);
+  testLarge<std::complex<double>>(
+      "COMPLEX(8)", TypeCategory::Complex, 8, 260, 66, 4);
+  return EndTests();
+}
@@ -0,0 +1,285 @@
+// Tests of SUM, PRODUCT, MAXVAL, MINVAL, and DOT_PRODUCT over whole arrays
+
+#include "testing.h"
+#include "../../runtime/descriptor.h"
+#include "../../runtime/reduction.h"
+#include "llvm/Support/raw_ostream.h"
+#include <cinttypes>
+#include <limits>
+#include <string>
+
+using namespace Fortran::runtime;
+using Fortran::common::TypeCategory;
+
+// Views every other element of a contiguous vector of 2*n elements.
+static void MakeStrided(Descriptor &d, TypeCategory category, int kind,
+    void *data, SubscriptValue n) {
+  SubscriptValue extent[]{n};
+  d.Establish(category, kind, data, 1, extent);
+  d.raw().dim[0].sm *= 2;
+}
+
+template <typename T>
+static void Check(const char *what, T got, T expect) {
+  if (got != expect) {
+    Fail() << what << ": got " << static_cast<double>(got) << ", expected "
+           << static_cast<double>(expect) << '\n';
+  }
+}
+
+static void Check(const char *what, std::complex<double> got,
+    std::complex<double> expect) {
+  if (got != expect) {
+    Fail() << what << ": got (" << got.real() << ',' << got.imag()
+           << "), expected (" << expect.real() << ',' << expect.imag()
+           << ")\n";
+  }
+}
+
+static void integerReductions() {
+  std::int32_t data[2][3]{{1, 2, 3}, {-4, 5, 6}}; // [[1,-4],[2,5],[3,6]]
+  SubscriptValue extent[]{3, 2};
+  StaticDescriptor<2> staticDescriptor;
+  Descriptor &array{staticDescriptor.descriptor()};
+  array.Establish(TypeCategory::Integer, 4, data, 2, extent);
+  Check("SUM", RTNAME(SumInteger4)(array, __FILE__, __LINE__), 13);
+  Check("PRODUCT", RTNAME(ProductInteger4)(array, __FILE__, __LINE__), -720);
+  Check("MAXVAL", RTNAME(MaxvalInteger4)(array, __FILE__, __LINE__), 6);
+  Check("MINVAL", RTNAME(MinvalInteger4)(array, __FILE__, __LINE__), -4);
+
+  bool maskData[2][3]{{true, false, true}, {false, true, false}};
+  StaticDescriptor<2> maskStaticDescriptor;
+  Descriptor &mask{maskStaticDescriptor.descriptor()};
+  mask.Establish(TypeCategory::Logical, 1, maskData, 2, extent);
+  Check("SUM(MASK=)",
+      RTNAME(SumInteger4)(array, __FILE__, __LINE__, &mask), 9);
+  Check("PRODUCT(MASK=)",
+      RTNAME(ProductInteger4)(array, __FILE__, __LINE__, &mask), 15);
+  Check("MAXVAL(MASK=)",
+      RTNAME(MaxvalInteger4)(array, __FILE__, __LINE__, &mask), 5);
+  Check("MINVAL(MASK=)",
+      RTNAME(MinvalInteger4)(array, __FILE__, __LINE__, &mask), 1);
+
+  // A scalar MASK= selects all of the elements or none of them.
+  bool scalarMaskData{true};
+  StaticDescriptor<0> scalarMaskStaticDescriptor;
+  Descriptor &scalarMask{scalarMaskStaticDescriptor.descriptor()};
+  scalarMask.Establish(TypeCategory::Logical, 1, &scalarMaskData, 0);
+  Check("SUM(MASK=.TRUE.)",
+      RTNAME(SumInteger4)(array, __FILE__, __LINE__, &scalarMask), 13);
+  scalarMaskData = false;
+  Check("SUM(MASK=.FALSE.)",
+      RTNAME(SumInteger4)(array, __FILE__, __LINE__, &scalarMask), 0);
+  Check("MAXVAL(MASK=.FALSE.)",
+      RTNAME(MaxvalInteger4)(array, __FILE__, __LINE__, &scalarMask),
+      -std::numeric_limits<std::int32_t>::max());
+
+  // A mask that selects no element
+  bool noneData[2][3]{};
+  mask.Establish(TypeCategory::Logical, 1, noneData, 2, extent);
+  Check("PRODUCT(MASK=none)",
+      RTNAME(ProductInteger4)(array, __FILE__, __LINE__, &mask), 1);
+  Check("MAXVAL(MASK=none)",
+      RTNAME(MaxvalInteger4)(array, __FILE__, __LINE__, &mask),
+      -std::numeric_limits<std::int32_t>::max());
+  Check("MINVAL(MASK=none)",
+      RTNAME(MinvalInteger4)(array, __FILE__, __LINE__, &mask),
+      std::numeric_limits<std::int32_t>::max());
+
+  // The section array(1:3:2,:)
+  array.raw().dim[0].sm *= 2;
+  array.raw().dim[0].extent = 2;
+  Check("SUM section", RTNAME(SumInteger4)(array, __FILE__, __LINE__), 6);
+  Check("MAXVAL section", RTNAME(MaxvalInteger4)(array, __FILE__, __LINE__), 6);
+
+  // Long enough to exercise the partial results of the contiguous loops,
+  // and viewed both whole and with a stride of two.
+  std::int64_t longData[21];
+  for (int j{0}; j < 21; ++j) {
+    longData[j] = j % 2 ? -j : j;
+  }
+  SubscriptValue longExtent[]{21};
+  StaticDescriptor<1> longStaticDescriptor;
+  Descriptor &longArray{longStaticDescriptor.descriptor()};
+  longArray.Establish(TypeCategory::Integer, 8, longData, 1, longExtent);
+  Check("SUM long", RTNAME(SumInteger8)(longArray, __FILE__, __LINE__),
+      std::int64_t{10});
+  Check("MAXVAL long", RTNAME(MaxvalInteger8)(longArray, __FILE__, __LINE__),
+      std::int64_t{20});
+  Check("MINVAL long", RTNAME(MinvalInteger8)(longArray, __FILE__, __LINE__),
+      std::int64_t{-19});
+  MakeStrided(longArray, TypeCategory::Integer, 8, longData, 11);
+  Check("SUM strided", RTNAME(SumInteger8)(longArray, __FILE__, __LINE__),
+      std::int64_t{110});
+  Check("MINVAL strided",
+      RTNAME(MinvalInteger8)(longArray, __FILE__, __LINE__), std::int64_t{0});
+
+  // Zero-sized arrays
+  SubscriptValue zero[]{0};
+  longArray.Establish(TypeCategory::Integer, 8, longData, 1, zero);
+  Check("SUM empty", RTNAME(SumInteger8)(longArray, __FILE__, __LINE__),
+      std::int64_t{0});
+  Check("PRODUCT empty",
+      RTNAME(ProductInteger8)(longArray, __FILE__, __LINE__), std::int64_t{1});
+  Check("MAXVAL empty", RTNAME(MaxvalInteger8)(longArray, __FILE__, __LINE__),
+      -std::numeric_limits<std::int64_t>::max());
+  Check("MINVAL empty", RTNAME(MinvalInteger8)(longArray, __FILE__, __LINE__),
+      std::numeric_limits<std::int64_t>::max());
+
+  // The least value of the type is below -HUGE() but can still be the result.
+  longData[0] = std::numeric_limits<std::int64_t>::lowest();
+  longArray.Establish(TypeCategory::Integer, 8, longData, 1, longExtent);
+  longArray.raw().dim[0].extent = 1;
+  Check("MAXVAL of the least value",
+      RTNAME(MaxvalInteger8)(longArray, __FILE__, __LINE__),
+      std::numeric_limits<std::int64_t>::lowest());
+}
+
+static void realReductions() {
+  double data[10];
+  for (int j{0}; j < 10; ++j) {
+    data[j] = 0.5 * (j + 1);
+  }
+  SubscriptValue extent[]{10};
+  StaticDescriptor<1> staticDescriptor;
+  Descriptor &array{staticDescriptor.descriptor()};
+  array.Establish(TypeCategory::Real, 8, data, 1, extent);
+  Check("SUM real", RTNAME(SumReal8)(array, __FILE__, __LINE__), 27.5);
+  Check("MAXVAL real", RTNAME(MaxvalReal8)(array, __FILE__, __LINE__), 5.0);
+  data[3] = std::numeric_limits<double>::quiet_NaN();
+  Check("MINVAL real with NaN", RTNAME(MinvalReal8)(array, __FILE__, __LINE__),
+      0.5);
+  MakeStrided(array, TypeCategory::Real, 8, data, 5);
+  Check("PRODUCT strided real",
+      RTNAME(ProductReal8)(array, __FILE__, __LINE__),
+      0.5 * 1.5 * 2.5 * 3.5 * 4.5);
+
+  float single[3]{1.5f, -2.0f, 4.0f};
+  array.Establish(TypeCategory::Real, 4, single, 1, extent);
+  array.raw().dim[0].extent = 3;
+  Check("SUM real(4)", RTNAME(SumReal4)(array, __FILE__, __LINE__), 3.5f);
+  Check("MINVAL real(4)", RTNAME(MinvalReal4)(array, __FILE__, __LINE__),
+      -2.0f);
+
+  // Zero-sized and masked-out arrays
+  bool maskData[3]{};
+  StaticDescriptor<1> maskStaticDescriptor;
+  Descriptor &mask{maskStaticDescriptor.descriptor()};
+  mask.Establish(TypeCategory::Logical, 1, maskData, 1, extent);
+  mask.raw().dim[0].extent = 3;
+  Check("MAXVAL(MASK=none) real(4)",
+      RTNAME(MaxvalReal4)(array, __FILE__, __LINE__, &mask),
+      -std::numeric_limits<float>::infinity());
+  Check("MINVAL(MASK=none) real(4)",
+      RTNAME(MinvalReal4)(array, __FILE__, __LINE__, &mask),
+      std::numeric_limits<float>::infinity());
+  array.raw().dim[0].extent = 0;
+  Check("MAXVAL empty real(4)", RTNAME(MaxvalReal4)(array, __FILE__, __LINE__),
+      -std::numeric_limits<float>::infinity());
+  array.Establish(TypeCategory::Real, 8, data, 1, extent);
+  array.raw().dim[0].extent = 0;
+  Check("MAXVAL empty real", RTNAME(MaxvalReal8)(array, __FILE__, __LINE__),
+      -std::numeric_limits<double>::infinity());
+  Check("MINVAL empty real", RTNAME(MinvalReal8)(array, __FILE__, __LINE__),
+      std::numeric_limits<double>::infinity());
+  Check("SUM empty real", RTNAME(SumReal8)(array, __FILE__, __LINE__), 0.0);
+}
+
+static void complexReductions() {
+  std::complex<double> data[6];
+  for (int j{0}; j < 6; ++j) {
+    data[j] = {1.0 * j, 1.0 - j};
+  }
+  SubscriptValue extent[]{6};
+  StaticDescriptor<1> staticDescriptor;
+  Descriptor &array{staticDescriptor.descriptor()};
+  array.Establish(TypeCategory::Complex, 8, data, 1, extent);
+  std::complex<double> result;
+  RTNAME(CppSumComplex8)(result, array, __FILE__, __LINE__);
+  Check("SUM complex", result, {15.0, -9.0});
+  MakeStrided(array, TypeCategory::Complex, 8, data, 3);
+  RTNAME(CppProductComplex8)(result, array, __FILE__, __LINE__);
+  Check("PRODUCT strided complex", result, data[0] * data[2] * data[4]);
+}
+
+static void dotProducts() {
+  std::int16_t x[9], y[9];
+  for (int j{0}; j < 9; ++j) {
+    x[j] = j + 1;
+    y[j] = 2 - j;
+  }
+  SubscriptValue extent[]{9};
+  StaticDescriptor<1> staticDescriptor[2];
+  Descriptor &xd{staticDescriptor[0].descriptor()};
+  Descriptor &yd{staticDescriptor[1].descriptor()};
+  xd.Establish(TypeCategory::Integer, 2, x, 1, extent);
+  yd.Establish(TypeCategory::Integer, 2, y, 1, extent);
+  Check("DOT_PRODUCT integer", RTNAME(DotProductInteger2)(xd, yd),
+      std::int16_t{-150});
+  MakeStrided(xd, TypeCategory::Integer, 2, x, 4);
+  MakeStrided(yd, TypeCategory::Integer, 2, y + 1, 4);
+  Check("DOT_PRODUCT strided integer", RTNAME(DotProductInteger2)(xd, yd),
+      std::int16_t{-52});
+
+  std::complex<double> cx[2]{{1.0, 2.0}, {3.0, -1.0}};
+  std::complex<double> cy[2]{{0.0, 1.0}, {2.0, 2.0}};
+  extent[0] = 2;
+  xd.Establish(TypeCategory::Complex, 8, cx, 1, extent);
+  yd.Establish(TypeCategory::Complex, 8, cy, 1, extent);
+  std::complex<double> result;
+  RTNAME(CppDotProductComplex8)(result, xd, yd);
+  Check("DOT_PRODUCT complex", result,
+      std::conj(cx[0]) * cy[0] + std::conj(cx[1]) * cy[1]);
+
+  bool lx[3]{true, false, true}, ly[3]{false, true, false};
+  extent[0] = 3;
+  xd.Establish(TypeCategory::Logical, 1, lx, 1, extent);
+  yd.Establish(TypeCategory::Logical, 1, ly, 1, extent);
+  if (RTNAME(DotProductLogical)(xd, yd)) {
+    Fail() << "DOT_PRODUCT logical: got .TRUE.\n";
+  }
+  ly[2] = true;
+  if (!RTNAME(DotProductLogical)(xd, yd)) {
+    Fail() << "DOT_PRODUCT logical: got .FALSE.\n";
+  }
+}
+
+static void badArguments() {
+  double x[2]{1.0, 2.0};
+  float y[3]{1.0f, 2.0f, 3.0f};
+  SubscriptValue xExtent[]{2}, yExtent[]{3};
+  StaticDescriptor<1> staticDescriptor[2];
+  Descriptor &xd{staticDescriptor[0].descriptor()};
+  Descriptor &yd{staticDescriptor[1].descriptor()};
+  xd.Establish(TypeCategory::Real, 8, x, 1, xExtent);
+  yd.Establish(TypeCategory::Real, 4, y, 1, yExtent);
+  try {
+    RTNAME(SumReal4)(xd, __FILE__, __LINE__);
+    Fail() << "SUM with wrong kind did not crash\n";
+  } catch (const std::string &) {
+  }
+  try {
+    RTNAME(DotProductReal8)(xd, yd);
+    Fail() << "DOT_PRODUCT of different kinds did not crash\n";
+  } catch (const std::string &) {
+  }
+  std::int32_t ix[2]{1, 0};
+  bool lx[2]{true, true};
+  xd.Establish(TypeCategory::Integer, 4, ix, 1, xExtent);
+  yd.Establish(TypeCategory::Logical, 1, lx, 1, xExtent);
+  try {
+    RTNAME(DotProductLogical)(xd, yd);
+    Fail() << "LOGICAL DOT_PRODUCT of an INTEGER vector did not crash\n";
+  } catch (const std::string &) {
+  }
+}
+
+int main() {
+  StartTests();
+  integerReductions();
+  realReductions();
+  complexReductions();
+  dotProducts();
+  badArguments();
+  return EndTests();
+}
@@ -0,0 +1,89 @@
+#include <cstddef>
+
+#include "benchmark/benchmark.h"
+#include "test_macros.h"
+
+// A chain of classes, each deriving from the previous one and from a mixin,
+// so that every level is a __vmi_class_type_info.
+template <std::size_t Depth>
+struct Mixin {
+  virtual ~Mixin() {}
+};
+
+template <std::size_t Depth>
+struct Chain : Chain<Depth - 1>, Mixin<Depth> {};
+
+template <>
+struct Chain<0> {
+  virtual ~Chain() {}
+};
+
+template <std::size_t Depth>
+struct VChain : virtual VChain<Depth - 1>, virtual Mixin<Depth> {};
+
+template <>
+struct VChain<0> {
+  virtual ~VChain() {}
+};
+
+// Downcast from the root to the dynamic type of the object.
+template <std::size_t Depth>
+static void BM_DynamicCastToDynamicType(benchmark::State &state) {
+  Chain<Depth> obj;
+  Chain<0> *volatile base = &obj;
+  for (auto _ : state)
+    benchmark::DoNotOptimize(dynamic_cast<Chain<Depth> *>(base));
+}
+BENCHMARK_TEMPLATE(BM_DynamicCastToDynamicType, 1);
+BENCHMARK_TEMPLATE(BM_DynamicCastToDynamicType, 8);
+BENCHMARK_TEMPLATE(BM_DynamicCastToDynamicType, 32);
+
+// Downcast from the root to a class in the middle of the chain.
+template <std::size_t Depth>
+static void BM_DynamicCastToIntermediate(benchmark::State &state) {
+  Chain<Depth> obj;
+  Chain<0> *volatile base = &obj;
+  for (auto _ : state)
+    benchmark::DoNotOptimize(dynamic_cast<Chain<Depth / 2> *>(base));
+}
+BENCHMARK_TEMPLATE(BM_DynamicCastToIntermediate, 2);
+BENCHMARK_TEMPLATE(BM_DynamicCastToIntermediate, 8);
+BENCHMARK_TEMPLATE(BM_DynamicCastToIntermediate, 32);
+
+// Cross cast between two unrelated bases of the object.
+template <std::size_t Depth>
+static void BM_DynamicCastCross(benchmark::State &state) {
+  Chain<Depth> obj;
+  Mixin<1> *volatile base = &obj;
+  for (auto _ : state)
+    benchmark::DoNotOptimize(dynamic_cast<Mixin<Depth> *>(base));
+}
+BENCHMARK_TEMPLATE(BM_DynamicCastCross, 2);
+BENCHMARK_TEMPLATE(BM_DynamicCastCross, 8);
+BENCHMARK_TEMPLATE(BM_DynamicCastCross, 32);
+
+// Downcast that fails because the object is not of the destination type.
+template <std::size_t Depth>
+static void BM_DynamicCastFail(benchmark::State &state) {
+  Chain<Depth> obj;
+  Chain<0> *volatile base = &obj;
+  for (auto _ : state)
+    benchmark::DoNotOptimize(dynamic_cast<Chain<Depth + 1> *>(base));
+}
+BENCHMARK_TEMPLATE(BM_DynamicCastFail, 1);
+BENCHMARK_TEMPLATE(BM_DynamicCastFail, 8);
+BENCHMARK_TEMPLATE(BM_DynamicCastFail, 32);
+
+// Downcast through virtual bases.
+template <std::size_t Depth>
+static void BM_DynamicCastVirtual(benchmark::State &state) {
+  VChain<Depth> obj;
+  VChain<0> *volatile base = &obj;
+  for (auto _ : state)
+    benchmark::DoNotOptimize(dynamic_cast<VChain<Depth / 2> *>(base));
+}
+BENCHMARK_TEMPLATE(BM_DynamicCastVirtual, 2);
+BENCHMARK_TEMPLATE(BM_DynamicCastVirtual, 8);
+BENCHMARK_TEMPLATE(BM_DynamicCastVirtual, 32);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,69 @@
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "test_macros.h"
+
+static const char* kFileName = "fstream.bench.dat";
+
+// Writes a file of `Lines` lines of `LineLen` characters each.
+static void makeFile(std::size_t Lines, std::size_t LineLen) {
+  std::ofstream out(kFileName, std::ios_base::trunc);
+  std::string line(LineLen, 'x');
+  for (std::size_t i = 0; i < Lines; ++i)
+    out << line << '\n';
+}
+
+static void BM_IfstreamGetline(benchmark::State &state) {
+  makeFile(1 << 14, state.range(0));
+  std::string line;
+  for (auto _ : state) {
+    std::ifstream in(kFileName);
+    std::size_t n = 0;
+    while (std::getline(in, line))
+      n += line.size();
+    benchmark::DoNotOptimize(n);
+  }
+  std::remove(kFileName);
+}
+BENCHMARK(BM_IfstreamGetline)->Range(8, 1024);
+
+static void BM_IfstreamIgnoreLine(benchmark::State &state) {
+  makeFile(1 << 14, state.range(0));
+  for (auto _ : state) {
+    std::ifstream in(kFileName);
+    while (in.ignore(1 << 20, '\n'))
+      ;
+    benchmark::DoNotOptimize(in.gcount());
+  }
+  std::remove(kFileName);
+}
+BENCHMARK(BM_IfstreamIgnoreLine)->Range(8, 1024);
+
+static void BM_IfstreamRead(benchmark::State &state) {
+  makeFile(1 << 12, 255);
+  std::vector<char> buf(state.range(0));
+  for (auto _ : state) {
+    std::ifstream in(kFileName, std::ios_base::binary);
+    while (in.read(buf.data(), buf.size()))
+      ;
+    benchmark::DoNotOptimize(buf.data());
+  }
+  std::remove(kFileName);
+}
+BENCHMARK(BM_IfstreamRead)->Range(64, 1 << 16);
+
+static void BM_OfstreamWrite(benchmark::State &state) {
+  std::vector<char> buf(state.range(0), 'x');
+  for (auto _ : state) {
+    std::ofstream out(kFileName, std::ios_base::binary | std::ios_base::trunc);
+    for (std::size_t written = 0; written < (1 << 20); written += buf.size())
+      out.write(buf.data(), buf.size());
+  }
+  std::remove(kFileName);
+}
+BENCHMARK(BM_OfstreamWrite)->Range(64, 1 << 16);
+
+BENCHMARK_MAIN();
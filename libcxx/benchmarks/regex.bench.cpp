@@ -0,0 +1,36 @@
+#include <regex>
+#include <string>
+
+#include "benchmark/benchmark.h"
+#include "test_macros.h"
+
+// A log-like subject where the match only occurs at the very end.
+static std::string makeLog(std::size_t Lines) {
+  std::string s;
+  for (std::size_t i = 0; i < Lines; ++i)
+    s += "INFO request served in 12 ms by worker thread\n";
+  s += "ERROR 4242 connection reset\n";
+  return s;
+}
+
+// Patterns with a literal prefix can skip to its occurrences.
+static void BM_RegexSearchLiteralPrefix(benchmark::State &state) {
+  std::string s = makeLog(state.range(0));
+  std::regex re("ERROR [0-9]+");
+  std::smatch m;
+  for (auto _ : state)
+    benchmark::DoNotOptimize(std::regex_search(s, m, re));
+}
+BENCHMARK(BM_RegexSearchLiteralPrefix)->Range(8, 8 << 6);
+
+// Patterns without one have to be tried at every position.
+static void BM_RegexSearchNoPrefix(benchmark::State &state) {
+  std::string s = makeLog(state.range(0));
+  std::regex re("[A-Z]+ [0-9]{4}");
+  std::smatch m;
+  for (auto _ : state)
+    benchmark::DoNotOptimize(std::regex_search(s, m, re));
+}
+BENCHMARK(BM_RegexSearchNoPrefix)->Range(8, 8 << 6);
+
+BENCHMARK_MAIN();
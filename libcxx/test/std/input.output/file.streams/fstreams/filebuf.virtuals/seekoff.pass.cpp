@@ -23,7 +23,7 @@
 int main(int, char**)
 {
     {
-        char buf[10];
+        char buf[10] = {};
         typedef std::filebuf::pos_type pos_type;
         std::filebuf f;
         f.pubsetbuf(buf, sizeof(buf));
@@ -31,7 +31,8 @@ int main(int, char**)
                                                        | std::ios_base::trunc) != 0);
         assert(f.is_open());
         f.sputn("abcdefghijklmnopqrstuvwxyz", 26);
-        LIBCPP_ASSERT(buf[0] == 'v');
+        // Writes that do not fit into the buffer go straight to the file.
+        LIBCPP_ASSERT(buf[0] == '\0');
         pos_type p = f.pubseekoff(-15, std::ios_base::cur);
         assert(p == 11);
         assert(f.sgetc() == 'l');
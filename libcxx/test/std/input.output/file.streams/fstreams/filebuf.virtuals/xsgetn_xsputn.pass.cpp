@@ -0,0 +1,68 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// <fstream>
+
+// streamsize xsgetn(char_type* s, streamsize n);
+// streamsize xsputn(const char_type* s, streamsize n);
+
+#include <fstream>
+#include <cassert>
+#include <cstdio>
+#include <string>
+
+#include "test_macros.h"
+
+int main(int, char**)
+{
+    std::string data;
+    for (int i = 0; i < 1000; ++i)
+        data += static_cast<char>('a' + i % 26);
+    {
+        char buf[16];
+        std::filebuf f;
+        f.pubsetbuf(buf, sizeof(buf));
+        assert(f.open("xsgetn_xsputn.dat", std::ios_base::out
+                                         | std::ios_base::trunc) != 0);
+        // Mix writes that fit into the buffer with ones that do not.
+        assert(f.sputn(data.data(), 3) == 3);
+        assert(f.sputn(data.data() + 3, 500) == 500);
+        assert(f.sputn(data.data() + 503, 7) == 7);
+        assert(f.sputn(data.data() + 510, 490) == 490);
+        assert(f.close() != 0);
+    }
+    {
+        char buf[16];
+        std::filebuf f;
+        f.pubsetbuf(buf, sizeof(buf));
+        assert(f.open("xsgetn_xsputn.dat", std::ios_base::in) != 0);
+        std::string s(1000, ' ');
+        assert(f.sgetn(&s[0], 5) == 5);
+        assert(f.sgetn(&s[5], 600) == 600);
+        // The characters read last can still be put back.
+        assert(f.sungetc() == data[604]);
+        assert(f.sungetc() == data[603]);
+        assert(f.sungetc() == data[602]);
+        assert(f.sungetc() == data[601]);
+        // libc++ keeps four of them, and nothing older from the buffer.
+        std::filebuf::int_type c = f.sungetc();
+        LIBCPP_ASSERT(c == std::char_traits<char>::eof());
+        if (c != std::char_traits<char>::eof())
+            assert(f.sbumpc() == data[600]);
+        assert(f.sbumpc() == data[601]);
+        assert(f.sbumpc() == data[602]);
+        assert(f.sbumpc() == data[603]);
+        assert(f.sbumpc() == data[604]);
+        assert(f.sgetn(&s[605], 1000) == 395);
+        assert(s == data);
+        assert(f.sgetc() == std::char_traits<char>::eof());
+    }
+    std::remove("xsgetn_xsputn.dat");
+
+  return 0;
+}
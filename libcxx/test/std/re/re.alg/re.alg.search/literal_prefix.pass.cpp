@@ -0,0 +1,95 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// <regex>
+
+// template <class BidirectionalIterator, class Allocator, class charT, class traits>
+//     bool
+//     regex_search(BidirectionalIterator first, BidirectionalIterator last,
+//                  match_results<BidirectionalIterator, Allocator>& m,
+//                  const basic_regex<charT, traits>& e,
+//                  regex_constants::match_flag_type flags = regex_constants::match_default);
+
+// Searches for patterns that begin with plain characters, which are found by
+// looking for those characters first.
+
+#include <regex>
+#include <string>
+#include <cassert>
+#include "test_macros.h"
+
+static bool search(const std::string& s, const std::regex& re,
+                   std::string::size_type pos, const std::string& str)
+{
+    std::smatch m;
+    if (!std::regex_search(s, m, re))
+        return false;
+    return static_cast<std::string::size_type>(m.position(0)) == pos &&
+           m.str(0) == str;
+}
+
+int main(int, char**)
+{
+    // A prefix found after the first position.
+    assert(search("xxabcxx", std::regex("abc"), 2, "abc"));
+    assert(search("ab abd abc", std::regex("abc"), 7, "abc"));
+    assert(search("xxaabbb", std::regex("ab+"), 3, "abbb"));
+    assert(!std::regex_search("xxabxx", std::regex("abc")));
+
+    // Case-insensitive patterns match the prefix in any case.
+    assert(search("xxABCxx", std::regex("abc", std::regex::icase), 2, "ABC"));
+    assert(search("xxaBcxx", std::regex("AbC", std::regex::icase), 2, "aBc"));
+
+    // ^ only matches at the start of the subject, even after a newline.
+    assert(!std::regex_search("x\nabc", std::regex("^abc")));
+    assert(search("abc\nabc", std::regex("^abc"), 0, "abc"));
+    assert(!std::regex_search("xabc", std::regex("^abc")));
+    {
+        std::smatch m;
+        std::string s("abc abc");
+        assert(!std::regex_search(s, m, std::regex("^abc"),
+                                  std::regex_constants::match_not_bol));
+    }
+
+    // An alternation at the start has no common prefix.
+    assert(search("xxcdxx", std::regex("ab|cd"), 2, "cd"));
+    assert(search("xxabxx", std::regex("ab|cd"), 2, "ab"));
+    assert(search("xxabdxx", std::regex("abc|abd"), 2, "abd"));
+    assert(search("xxcdxx", std::regex("(?:ab|cd)"), 2, "cd"));
+    assert(search("xxcd", std::regex("ab*|cd"), 2, "cd"));
+    assert(search("xxcdxx", std::regex("ab\ncd", std::regex::egrep), 2, "cd"));
+    assert(search("xxcdxx", std::regex("ab\ncd", std::regex::grep), 2, "cd"));
+
+    // Loops over the first characters.
+    assert(search("xxbbc", std::regex("a*bc"), 3, "bc"));
+    assert(search("xxaabc", std::regex("a*bc"), 2, "aabc"));
+    assert(search("xxcc", std::regex("(ab)*cc"), 2, "cc"));
+    assert(search("xxcc", std::regex("(?:ab)*cc"), 2, "cc"));
+    assert(search("xxcc", std::regex("(ab)*cc", std::regex::nosubs), 2, "cc"));
+    assert(search("xxac", std::regex("ab?c"), 2, "ac"));
+
+    // A prefix longer than the subject, or than what is left of it.
+    assert(!std::regex_search("abc", std::regex("abcdef")));
+    assert(!std::regex_search("xabcde", std::regex("abcdef")));
+    assert(!std::regex_search("", std::regex("abcdef")));
+    assert(search("xabcdef", std::regex("abcdef"), 1, "abcdef"));
+    assert(search("xxabcdefghijklmnopqrstuvwxyz",
+                  std::regex("abcdefghijklmnopqrstuvwxyz"), 2,
+                  "abcdefghijklmnopqrstuvwxyz"));
+
+    // Embedded NULs in the pattern and in the subject.
+    {
+        std::string s("x\0ya\0b", 6);
+        std::string p("a\0b", 3);
+        assert(search(s, std::regex(p), 3, p));
+        assert(!std::regex_search(std::string("xa\0c", 4), std::regex(p)));
+        assert(search(std::string("ab\0a\0b", 6), std::regex(p), 3, p));
+    }
+
+  return 0;
+}
@@ -0,0 +1,90 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// <string>
+
+// template<class charT, class traits, class Allocator>
+//   basic_istream<charT,traits>&
+//   getline(basic_istream<charT,traits>& is,
+//           basic_string<charT,traits,Allocator>& str);
+
+// Lines that span several refills of a small stream buffer.
+
+#include <string>
+#include <streambuf>
+#include <istream>
+#include <cassert>
+
+#include "test_macros.h"
+
+// Hands out the characters of a string a few at a time.
+struct chunked_buf
+    : public std::streambuf
+{
+    std::string data_;
+    std::size_t pos_;
+    std::size_t chunk_;
+    char buf_[8];
+
+    chunked_buf(const std::string& data, std::size_t chunk)
+        : data_(data), pos_(0), chunk_(chunk) {}
+
+    int_type underflow()
+    {
+        if (pos_ == data_.size())
+            return traits_type::eof();
+        std::size_t n = data_.copy(buf_, chunk_, pos_);
+        pos_ += n;
+        setg(buf_, buf_, buf_ + n);
+        return traits_type::to_int_type(*gptr());
+    }
+};
+
+int main(int, char**)
+{
+    std::string a(20, 'a');
+    std::string b(3, 'b');
+    std::string text = a + "\n" + b + "\n\n" + a + b;
+    for (std::size_t chunk = 1; chunk <= 8; ++chunk)
+    {
+        chunked_buf sb(text, chunk);
+        std::istream in(&sb);
+        std::string s("initial text");
+        getline(in, s);
+        assert(in.good());
+        assert(s == a);
+        getline(in, s);
+        assert(in.good());
+        assert(s == b);
+        getline(in, s);
+        assert(in.good());
+        assert(s == "");
+        getline(in, s);
+        assert(in.eof() && !in.fail());
+        assert(s == a + b);
+        getline(in, s);
+        assert(in.eof() && in.fail());
+    }
+    {
+        chunked_buf sb(text, 5);
+        std::istream in(&sb);
+        in.ignore(21, '\n');
+        assert(in.gcount() == 21);
+        in.ignore(2);
+        assert(in.gcount() == 2);
+        in.ignore(100, '\n');
+        assert(in.gcount() == 2);
+        in.ignore(100, 'b');
+        assert(in.gcount() == 22);
+        in.ignore(100);
+        assert(in.gcount() == 2);
+        assert(in.eof());
+    }
+
+  return 0;
+}
@@ -48,6 +48,23 @@
 #include <sys/syslog.h>
 #endif
 
+// When LIBCXXABI_DYNAMIC_CAST_CACHE is defined, __dynamic_cast remembers the
+// results of recent searches in a small lock-free table keyed by the vtable
+// of the source subobject and the source and destination types. A vtable
+// determines the layout of the complete object around the subobject (this
+// includes construction vtables), so the adjustment found by one search is
+// valid for every later cast with the same key.
+//
+// The table is never flushed. If a library is unloaded and another one later
+// places different classes at the same vtable and type_info addresses, stale
+// entries would give wrong answers, so the cache is off by default and only
+// meant for programs that do not dlclose code with polymorphic types.
+
+#ifdef LIBCXXABI_DYNAMIC_CAST_CACHE
+#include "include/atomic_support.h"
+#include <stdint.h>
+#endif
+
 static inline
 bool
 is_equal(const std::type_info* x, const std::type_info* y, bool use_strcmp)
@@ -607,18 +624,119 @@ bool __pointer_to_member_type_info::can_catch_nested(
 //    (static_ptr, static_type), then return dynamic_ptr.
 // Else return nullptr.
 
+#ifdef LIBCXXABI_DYNAMIC_CAST_CACHE
+
+namespace
+{
+
+// One slot of the dynamic_cast cache. The slot is a seqlock: writers make
+// seq odd while they update the other fields, and readers discard what they
+// read unless seq was even and unchanged around their reads.
+struct dynamic_cast_cache_entry
+{
+    uintptr_t seq;
+    const void* vtable;
+    const __class_type_info* static_type;
+    const __class_type_info* dst_type;
+    // dst_ptr - static_ptr, or dynamic_cast_fails.
+    ptrdiff_t offset;
+};
+
+const ptrdiff_t dynamic_cast_fails = PTRDIFF_MIN;
+const size_t dynamic_cast_cache_size = 256;
+
+dynamic_cast_cache_entry dynamic_cast_cache[dynamic_cast_cache_size];
+
+dynamic_cast_cache_entry&
+get_dynamic_cast_cache_entry(const void* vtable,
+                             const __class_type_info* static_type,
+                             const __class_type_info* dst_type)
+{
+    uintptr_t h = reinterpret_cast<uintptr_t>(vtable) ^
+                  (reinterpret_cast<uintptr_t>(static_type) >> 3) ^
+                  (reinterpret_cast<uintptr_t>(dst_type) >> 6);
+    h *= static_cast<uintptr_t>(0x9E3779B97F4A7C15ull);
+    return dynamic_cast_cache[(h >> (sizeof(uintptr_t) * 8 - 8)) %
+                              dynamic_cast_cache_size];
+}
+
+bool
+lookup_dynamic_cast_cache(const void* vtable,
+                          const __class_type_info* static_type,
+                          const __class_type_info* dst_type,
+                          ptrdiff_t& offset)
+{
+    using namespace std;
+    dynamic_cast_cache_entry& e =
+        get_dynamic_cast_cache_entry(vtable, static_type, dst_type);
+    uintptr_t seq = __libcpp_atomic_load(&e.seq, _AO_Acquire);
+    if (seq & 1)
+        return false;
+    // The acquire loads keep the second load of seq after them, and pair
+    // with the release stores of a writer that overlapped with this read.
+    bool hit = __libcpp_atomic_load(&e.vtable, _AO_Acquire) == vtable &&
+               __libcpp_atomic_load(&e.static_type, _AO_Acquire) == static_type &&
+               __libcpp_atomic_load(&e.dst_type, _AO_Acquire) == dst_type;
+    offset = __libcpp_atomic_load(&e.offset, _AO_Acquire);
+    return hit && __libcpp_atomic_load(&e.seq, _AO_Relaxed) == seq;
+}
+
+void
+update_dynamic_cast_cache(const void* vtable,
+                          const __class_type_info* static_type,
+                          const __class_type_info* dst_type,
+                          ptrdiff_t offset)
+{
+    using namespace std;
+    dynamic_cast_cache_entry& e =
+        get_dynamic_cast_cache_entry(vtable, static_type, dst_type);
+    uintptr_t seq = __libcpp_atomic_load(&e.seq, _AO_Relaxed);
+    // If another thread is writing the slot, leave it to that thread.
+    if ((seq & 1) ||
+        !__libcpp_atomic_compare_exchange(&e.seq, &seq, seq + 1,
+                                          _AO_Acquire, _AO_Relaxed))
+        return;
+    __libcpp_atomic_store(&e.vtable, vtable, _AO_Release);
+    __libcpp_atomic_store(&e.static_type, static_type, _AO_Release);
+    __libcpp_atomic_store(&e.dst_type, dst_type, _AO_Release);
+    __libcpp_atomic_store(&e.offset, offset, _AO_Release);
+    __libcpp_atomic_store(&e.seq, seq + 2, _AO_Release);
+}
+
+}  // unnamed namespace
+
+#endif  // LIBCXXABI_DYNAMIC_CAST_CACHE
+
 extern "C" _LIBCXXABI_FUNC_VIS void *
 __dynamic_cast(const void *static_ptr, const __class_type_info *static_type,
                const __class_type_info *dst_type,
                std::ptrdiff_t src2dst_offset) {
-    // Possible future optimization:  Take advantage of src2dst_offset
-
     // Get (dynamic_ptr, dynamic_type) from static_ptr
     void **vtable = *static_cast<void ** const *>(static_ptr);
     ptrdiff_t offset_to_derived = reinterpret_cast<ptrdiff_t>(vtable[-2]);
     const void* dynamic_ptr = static_cast<const char*>(static_ptr) + offset_to_derived;
     const __class_type_info* dynamic_type = static_cast<const __class_type_info*>(vtable[-1]);
 
+    // A non-negative src2dst_offset means that static_type is a unique public
+    // non-virtual base of dst_type at that offset. When the object is exactly
+    // a dst_type, the cast then succeeds iff static_ptr is that base, which
+    // can be checked without walking the hierarchy.
+    if (src2dst_offset >= 0 && is_equal(dynamic_type, dst_type, false) &&
+        static_cast<const char*>(static_ptr) - src2dst_offset ==
+            static_cast<const char*>(dynamic_ptr))
+        return const_cast<void*>(dynamic_ptr);
+
+#ifdef LIBCXXABI_DYNAMIC_CAST_CACHE
+    ptrdiff_t cached_offset;
+    if (lookup_dynamic_cast_cache(vtable, static_type, dst_type, cached_offset))
+    {
+        if (cached_offset == dynamic_cast_fails)
+            return nullptr;
+        return const_cast<char*>(static_cast<const char*>(static_ptr)) +
+               cached_offset;
+    }
+#endif  // LIBCXXABI_DYNAMIC_CAST_CACHE
+
     // Initialize answer to nullptr.  This will be changed from the search
     //    results if a non-null answer is found.  Regardless, this is what will
     //    be returned.
@@ -694,6 +812,12 @@ __dynamic_cast(const void *static_ptr, const __class_type_info *static_type,
             break;
         }
     }
+#ifdef LIBCXXABI_DYNAMIC_CAST_CACHE
+    update_dynamic_cast_cache(vtable, static_type, dst_type,
+                              dst_ptr == 0 ? dynamic_cast_fails :
+                              static_cast<const char*>(dst_ptr) -
+                                  static_cast<const char*>(static_ptr));
+#endif  // LIBCXXABI_DYNAMIC_CAST_CACHE
     return const_cast<void*>(dst_ptr);
 }
 
@@ -0,0 +1,103 @@
+//===----------------------- dynamic_cast_repeat.pass.cpp -----------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// Repeats the same casts so that a dynamic_cast that remembers earlier
+// results (see LIBCXXABI_DYNAMIC_CAST_CACHE) has to give the same answers
+// again, including for casts made while an object is being constructed.
+
+#include <cassert>
+
+namespace t1
+{
+
+struct V { virtual ~V() {} int v; };
+struct A : virtual V { int a; };
+struct B : virtual V { int b; };
+struct C : A, B { int c; };
+struct D : C { int d; };
+
+// Casts the same (vtable, static type, destination type) combinations many
+// times over objects with different complete types.
+void test()
+{
+    D d;
+    C c;
+    A a;
+    for (int i = 0; i < 100; ++i)
+    {
+        V* vd = static_cast<V*>(&d);
+        assert(dynamic_cast<D*>(vd) == &d);
+        assert(dynamic_cast<C*>(vd) == static_cast<C*>(&d));
+        assert(dynamic_cast<B*>(vd) == static_cast<B*>(&d));
+        A* ad = static_cast<A*>(&d);
+        assert(dynamic_cast<B*>(ad) == static_cast<B*>(&d));
+        assert(dynamic_cast<D*>(ad) == &d);
+
+        V* vc = static_cast<V*>(&c);
+        assert(dynamic_cast<D*>(vc) == 0);
+        assert(dynamic_cast<B*>(vc) == static_cast<B*>(&c));
+
+        V* va = static_cast<V*>(&a);
+        assert(dynamic_cast<A*>(va) == &a);
+        assert(dynamic_cast<B*>(va) == 0);
+        assert(dynamic_cast<C*>(va) == 0);
+    }
+}
+
+}  // t1
+
+namespace t2
+{
+
+// While an E is constructed its B subobject is briefly a complete B, but
+// laid out as part of an E. The same static and destination types must then
+// give different answers than for a real B.
+
+struct V { virtual ~V() {} char v[16]; };
+struct B : virtual V
+{
+    B();
+    char b[32];
+};
+struct X { virtual ~X() {} char x[8]; };
+struct E : X, B { char e[4]; };
+
+B* seen_b = 0;
+
+// Keeps the compiler from folding the cast below: within the constructor it
+// knows what the V is part of.
+V* volatile opaque_v = 0;
+
+B::B()
+{
+    opaque_v = this;
+    seen_b = dynamic_cast<B*>(opaque_v);
+}
+
+void test()
+{
+    for (int i = 0; i < 100; ++i)
+    {
+        B b;
+        assert(seen_b == &b);
+        E e;
+        assert(seen_b == static_cast<B*>(&e));
+        V* v = static_cast<V*>(&e);
+        assert(dynamic_cast<B*>(v) == static_cast<B*>(&e));
+        assert(dynamic_cast<E*>(v) == &e);
+        assert(dynamic_cast<X*>(v) == static_cast<X*>(&e));
+    }
+}
+
+}  // t2
+
+int main()
+{
+    t1::test();
+    t2::test();
+}
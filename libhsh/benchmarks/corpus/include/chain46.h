@@ -0,0 +1,17 @@
+/* Generated by gen-corpus.py; do not edit. */
+#pragma once
+#include "chain45.h"
+
+namespace Corpus {
+struct Vertex46 {
+  hsh::float3 position;
+  hsh::float3 normal;
+};
+
+struct Uniforms46 {
+  hsh::float4x4 xf;
+  hsh::float4 tint;
+  hsh::float3 lightDir;
+  float level;
+};
+} // namespace Corpus
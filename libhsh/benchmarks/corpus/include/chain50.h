@@ -0,0 +1,17 @@
+/* Generated by gen-corpus.py; do not edit. */
+#pragma once
+#include "chain49.h"
+
+namespace Corpus {
+struct Vertex50 {
+  hsh::float3 position;
+  hsh::float3 normal;
+};
+
+struct Uniforms50 {
+  hsh::float4x4 xf;
+  hsh::float4 tint;
+  hsh::float3 lightDir;
+  float level;
+};
+} // namespace Corpus
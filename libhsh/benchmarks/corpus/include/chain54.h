@@ -0,0 +1,17 @@
+/* Generated by gen-corpus.py; do not edit. */
+#pragma once
+#include "chain53.h"
+
+namespace Corpus {
+struct Vertex54 {
+  hsh::float3 position;
+  hsh::float3 normal;
+};
+
+struct Uniforms54 {
+  hsh::float4x4 xf;
+  hsh::float4 tint;
+  hsh::float3 lightDir;
+  float level;
+};
+} // namespace Corpus
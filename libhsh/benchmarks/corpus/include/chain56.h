@@ -0,0 +1,17 @@
+/* Generated by gen-corpus.py; do not edit. */
+#pragma once
+#include "chain55.h"
+
+namespace Corpus {
+struct Vertex56 {
+  hsh::float3 position;
+  hsh::float3 normal;
+};
+
+struct Uniforms56 {
+  hsh::float4x4 xf;
+  hsh::float4 tint;
+  hsh::float3 lightDir;
+  float level;
+};
+} // namespace Corpus
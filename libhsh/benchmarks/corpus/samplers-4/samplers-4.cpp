@@ -0,0 +1,207 @@
+/* Generated by gen-corpus.py; do not edit. */
+#include "chain0.h"
+#include "samplers-4.cpp.hshhead"
+
+namespace Corpus {
+using namespace hsh::pipeline;
+using Vertex = Vertex0;
+using Uniforms = Uniforms0;
+
+constexpr hsh::sampler Sampler0(hsh::Nearest, hsh::Nearest, hsh::Nearest);
+constexpr hsh::sampler Sampler1(hsh::Linear, hsh::Nearest, hsh::Nearest);
+constexpr hsh::sampler Sampler2(hsh::Nearest, hsh::Linear, hsh::Nearest);
+constexpr hsh::sampler Sampler3(hsh::Linear, hsh::Linear, hsh::Nearest);
+
+struct Pipeline0 : pipeline<color_attachment<>> {
+  Pipeline0(hsh::uniform_buffer<Uniforms> u, hsh::vertex_buffer<Vertex> v, hsh::texture2d tex0, hsh::texture2d tex1, hsh::texture2d tex2, hsh::texture2d tex3) {
+    position = u->xf * hsh::float4{v->position, 1.f};
+    hsh::float4 c = u->tint;
+    c = c * u->tint + hsh::float4{v->normal, 0.f};
+    c = hsh::float4{c.xyz() * hsh::dot(v->normal, u->lightDir), 1.f};
+    c = u->xf * c;
+    c = c - u->tint * 3.f;
+    c = c * u->tint + hsh::float4{v->normal, 4.f};
+    c = hsh::float4{c.xyz() * hsh::dot(v->normal, u->lightDir), 1.f};
+    c = u->xf * c;
+    c = c - u->tint * 7.f;
+    c = c + tex0.sample<float>({0.f, 0.f}, Sampler0);
+    c = c + tex1.sample<float>({0.f, 0.f}, Sampler1);
+    c = c + tex2.sample<float>({0.f, 0.f}, Sampler2);
+    c = c + tex3.sample<float>({0.f, 0.f}, Sampler3);
+    color_out[0] = c;
+  }
+};
+
+void BindPipeline0(hsh::binding &b, hsh::uniform_buffer_typeless u, hsh::vertex_buffer_typeless v, hsh::texture2d tex0, hsh::texture2d tex1, hsh::texture2d tex2, hsh::texture2d tex3) {
+  b.hsh_Pipeline0(Pipeline0(u, v, tex0, tex1, tex2, tex3));
+}
+
+struct Pipeline1 : pipeline<color_attachment<>> {
+  Pipeline1(hsh::uniform_buffer<Uniforms> u, hsh::vertex_buffer<Vertex> v, hsh::texture2d tex0, hsh::texture2d tex1, hsh::texture2d tex2, hsh::texture2d tex3) {
+    position = u->xf * hsh::float4{v->position, 1.f};
+    hsh::float4 c = u->tint;
+    c = c * u->tint + hsh::float4{v->normal, 0.f};
+    c = hsh::float4{c.xyz() * hsh::dot(v->normal, u->lightDir), 1.f};
+    c = u->xf * c;
+    c = c - u->tint * 3.f;
+    c = c * u->tint + hsh::float4{v->normal, 4.f};
+    c = hsh::float4{c.xyz() * hsh::dot(v->normal, u->lightDir), 1.f};
+    c = u->xf * c;
+    c = c - u->tint * 7.f;
+    c = c + tex0.sample<float>({0.f, 0.f}, Sampler0);
+    c = c + tex1.sample<float>({0.f, 0.f}, Sampler1);
+    c = c + tex2.sample<float>({0.f, 0.f}, Sampler2);
+    c = c + tex3.sample<float>({0.f, 0.f}, Sampler3);
+    color_out[0] = c;
+  }
+};
+
+void BindPipeline1(hsh::binding &b, hsh::uniform_buffer_typeless u, hsh::vertex_buffer_typeless v, hsh::texture2d tex0, hsh::texture2d tex1, hsh::texture2d tex2, hsh::texture2d tex3) {
+  b.hsh_Pipeline1(Pipeline1(u, v, tex0, tex1, tex2, tex3));
+}
+
+struct Pipeline2 : pipeline<color_attachment<>> {
+  Pipeline2(hsh::uniform_buffer<Uniforms> u, hsh::vertex_buffer<Vertex> v, hsh::texture2d tex0, hsh::texture2d tex1, hsh::texture2d tex2, hsh::texture2d tex3) {
+    position = u->xf * hsh::float4{v->position, 1.f};
+    hsh::float4 c = u->tint;
+    c = c * u->tint + hsh::float4{v->normal, 0.f};
+    c = hsh::float4{c.xyz() * hsh::dot(v->normal, u->lightDir), 1.f};
+    c = u->xf * c;
+    c = c - u->tint * 3.f;
+    c = c * u->tint + hsh::float4{v->normal, 4.f};
+    c = hsh::float4{c.xyz() * hsh::dot(v->normal, u->lightDir), 1.f};
+    c = u->xf * c;
+    c = c - u->tint * 7.f;
+    c = c + tex0.sample<float>({0.f, 0.f}, Sampler0);
+    c = c + tex1.sample<float>({0.f, 0.f}, Sampler1);
+    c = c + tex2.sample<float>({0.f, 0.f}, Sampler2);
+    c = c + tex3.sample<float>({0.f, 0.f}, Sampler3);
+    color_out[0] = c;
+  }
+};
+
+void BindPipeline2(hsh::binding &b, hsh::uniform_buffer_typeless u, hsh::vertex_buffer_typeless v, hsh::texture2d tex0, hsh::texture2d tex1, hsh::texture2d tex2, hsh::texture2d tex3) {
+  b.hsh_Pipeline2(Pipeline2(u, v, tex0, tex1, tex2, tex3));
+}
+
+struct Pipeline3 : pipeline<color_attachment<>> {
+  Pipeline3(hsh::uniform_buffer<Uniforms> u, hsh::vertex_buffer<Vertex> v, hsh::texture2d tex0, hsh::texture2d tex1, hsh::texture2d tex2, hsh::texture2d tex3) {
+    position = u->xf * hsh::float4{v->position, 1.f};
+    hsh::float4 c = u->tint;
+    c = c * u->tint + hsh::float4{v->normal, 0.f};
+    c = hsh::float4{c.xyz() * hsh::dot(v->normal, u->lightDir), 1.f};
+    c = u->xf * c;
+    c = c - u->tint * 3.f;
+    c = c * u->tint + hsh::float4{v->normal, 4.f};
+    c = hsh::float4{c.xyz() * hsh::dot(v->normal, u->lightDir), 1.f};
+    c = u->xf * c;
+    c = c - u->tint * 7.f;
+    c = c + tex0.sample<float>({0.f, 0.f}, Sampler0);
+    c = c + tex1.sample<float>({0.f, 0.f}, Sampler1);
+    c = c + tex2.sample<float>({0.f, 0.f}, Sampler2);
+    c = c + tex3.sample<float>({0.f, 0.f}, Sampler3);
+    color_out[0] = c;
+  }
+};
+
+void BindPipeline3(hsh::binding &b, hsh::uniform_buffer_typeless u, hsh::vertex_buffer_typeless v, hsh::texture2d tex0, hsh::texture2d tex1, hsh::texture2d tex2, hsh::texture2d tex3) {
+  b.hsh_Pipeline3(Pipeline3(u, v, tex0, tex1, tex2, tex3));
+}
+
+struct Pipeline4 : pipeline<color_attachment<>> {
+  Pipeline4(hsh::uniform_buffer<Uniforms> u, hsh::vertex_buffer<Vertex> v, hsh::texture2d tex0, hsh::texture2d tex1, hsh::texture2d tex2, hsh::texture2d tex3) {
+    position = u->xf * hsh::float4{v->position, 1.f};
+    hsh::float4 c = u->tint;
+    c = c * u->tint + hsh::float4{v->normal, 0.f};
+    c = hsh::float4{c.xyz() * hsh::dot(v->normal, u->lightDir), 1.f};
+    c = u->xf * c;
+    c = c - u->tint * 3.f;
+    c = c * u->tint + hsh::float4{v->normal, 4.f};
+    c = hsh::float4{c.xyz() * hsh::dot(v->normal, u->lightDir), 1.f};
+    c = u->xf * c;
+    c = c - u->tint * 7.f;
+    c = c + tex0.sample<float>({0.f, 0.f}, Sampler0);
+    c = c + tex1.sample<float>({0.f, 0.f}, Sampler1);
+    c = c + tex2.sample<float>({0.f, 0.f}, Sampler2);
+    c = c + tex3.sample<float>({0.f, 0.f}, Sampler3);
+    color_out[0] = c;
+  }
+};
+
+void BindPipeline4(hsh::binding &b, hsh::uniform_buffer_typeless u, hsh::vertex_buffer_typeless v, hsh::texture2d tex0, hsh::texture2d tex1, hsh::texture2d tex2, hsh::texture2d tex3) {
+  b.hsh_Pipeline4(Pipeline4(u, v, tex0, tex1, tex2, tex3));
+}
+
+struct Pipeline5 : pipeline<color_attachment<>> {
+  Pipeline5(hsh::uniform_buffer<Uniforms> u, hsh::vertex_buffer<Vertex> v, hsh::texture2d tex0, hsh::texture2d tex1, hsh::texture2d tex2, hsh::texture2d tex3) {
+    position = u->xf * hsh::float4{v->position, 1.f};
+    hsh::float4 c = u->tint;
+    c = c * u->tint + hsh::float4{v->normal, 0.f};
+    c = hsh::float4{c.xyz() * hsh::dot(v->normal, u->lightDir), 1.f};
+    c = u->xf * c;
+    c = c - u->tint * 3.f;
+    c = c * u->tint + hsh::float4{v->normal, 4.f};
+    c = hsh::float4{c.xyz() * hsh::dot(v->normal, u->lightDir), 1.f};
+    c = u->xf * c;
+    c = c - u->tint * 7.f;
+    c = c + tex0.sample<float>({0.f, 0.f}, Sampler0);
+    c = c + tex1.sample<float>({0.f, 0.f}, Sampler1);
+    c = c + tex2.sample<float>({0.f, 0.f}, Sampler2);
+    c = c + tex3.sample<float>({0.f, 0.f}, Sampler3);
+    color_out[0] = c;
+  }
+};
+
+void BindPipeline5(hsh::binding &b, hsh::uniform_buffer_typeless u, hsh::vertex_buffer_typeless v, hsh::texture2d tex0, hsh::texture2d tex1, hsh::texture2d tex2, hsh::texture2d tex3) {
+  b.hsh_Pipeline5(Pipeline5(u, v, tex0, tex1, tex2, tex3));
+}
+
+struct Pipeline6 : pipeline<color_attachment<>> {
+  Pipeline6(hsh::uniform_buffer<Uniforms> u, hsh::vertex_buffer<Vertex> v, hsh::texture2d tex0, hsh::texture2d tex1, hsh::texture2d tex2, hsh::texture2d tex3) {
+    position = u->xf * hsh::float4{v->position, 1.f};
+    hsh::float4 c = u->tint;
+    c = c * u->tint + hsh::float4{v->normal, 0.f};
+    c = hsh::float4{c.xyz() * hsh::dot(v->normal, u->lightDir), 1.f};
+    c = u->xf * c;
+    c = c - u->tint * 3.f;
+    c = c * u->tint + hsh::float4{v->normal, 4.f};
+    c = hsh::float4{c.xyz() * hsh::dot(v->normal, u->lightDir), 1.f};
+    c = u->xf * c;
+    c = c - u->tint * 7.f;
+    c = c + tex0.sample<float>({0.f, 0.f}, Sampler0);
+    c = c + tex1.sample<float>({0.f, 0.f}, Sampler1);
+    c = c + tex2.sample<float>({0.f, 0.f}, Sampler2);
+    c = c + tex3.sample<float>({0.f, 0.f}, Sampler3);
+    color_out[0] = c;
+  }
+};
+
+void BindPipeline6(hsh::binding &b, hsh::uniform_buffer_typeless u, hsh::vertex_buffer_typeless v, hsh::texture2d tex0, hsh::texture2d tex1, hsh::texture2d tex2, hsh::texture2d tex3) {
+  b.hsh_Pipeline6(Pipeline6(u, v, tex0, tex1, tex2, tex3));
+}
+
+struct Pipeline7 : pipeline<color_attachment<>> {
+  Pipeline7(hsh::uniform_buffer<Uniforms> u, hsh::vertex_buffer<Vertex> v, hsh::texture2d tex0, hsh::texture2d tex1, hsh::texture2d tex2, hsh::texture2d tex3) {
+    position = u->xf * hsh::float4{v->position, 1.f};
+    hsh::float4 c = u->tint;
+    c = c * u->tint + hsh::float4{v->normal, 0.f};
+    c = hsh::float4{c.xyz() * hsh::dot(v->normal, u->lightDir), 1.f};
+    c = u->xf * c;
+    c = c - u->tint * 3.f;
+    c = c * u->tint + hsh::float4{v->normal, 4.f};
+    c = hsh::float4{c.xyz() * hsh::dot(v->normal, u->lightDir), 1.f};
+    c = u->xf * c;
+    c = c - u->tint * 7.f;
+    c = c + tex0.sample<float>({0.f, 0.f}, Sampler0);
+    c = c + tex1.sample<float>({0.f, 0.f}, Sampler1);
+    c = c + tex2.sample<float>({0.f, 0.f}, Sampler2);
+    c = c + tex3.sample<float>({0.f, 0.f}, Sampler3);
+    color_out[0] = c;
+  }
+};
+
+void BindPipeline7(hsh::binding &b, hsh::uniform_buffer_typeless u, hsh::vertex_buffer_typeless v, hsh::texture2d tex0, hsh::texture2d tex1, hsh::texture2d tex2, hsh::texture2d tex3) {
+  b.hsh_Pipeline7(Pipeline7(u, v, tex0, tex1, tex2, tex3));
+}
+
+} // namespace Corpus
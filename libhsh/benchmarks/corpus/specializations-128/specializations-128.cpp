@@ -0,0 +1,462 @@
+/* Generated by gen-corpus.py; do not edit. */
+#include "chain0.h"
+#include "specializations-128.cpp.hshhead"
+
+namespace Corpus {
+using namespace hsh::pipeline;
+using Vertex = Vertex0;
+using Uniforms = Uniforms0;
+
+constexpr hsh::sampler Sampler0(hsh::Nearest, hsh::Nearest, hsh::Nearest);
+
+struct Pipeline0 : pipeline<color_attachment<>> {
+  Pipeline0(hsh::uniform_buffer<Uniforms> u, hsh::vertex_buffer<Vertex> v, hsh::texture2d tex0) {
+    position = u->xf * hsh::float4{v->position, 1.f};
+    hsh::float4 c = u->tint;
+    c = c * u->tint + hsh::float4{v->normal, 0.f};
+    c = hsh::float4{c.xyz() * hsh::dot(v->normal, u->lightDir), 1.f};
+    c = u->xf * c;
+    c = c - u->tint * 3.f;
+    c = c * u->tint + hsh::float4{v->normal, 4.f};
+    c = hsh::float4{c.xyz() * hsh::dot(v->normal, u->lightDir), 1.f};
+    c = u->xf * c;
+    c = c - u->tint * 7.f;
+    c = c + tex0.sample<float>({0.f, 0.f}, Sampler0);
+    color_out[0] = c;
+  }
+};
+
+void BindPipeline0(hsh::binding &b, hsh::uniform_buffer_typeless u, hsh::vertex_buffer_typeless v, hsh::texture2d tex0) {
+  b.hsh_Pipeline0(Pipeline0(u, v, tex0));
+}
+
+struct Pipeline1 : pipeline<color_attachment<>> {
+  Pipeline1(hsh::uniform_buffer<Uniforms> u, hsh::vertex_buffer<Vertex> v, hsh::texture2d tex0) {
+    position = u->xf * hsh::float4{v->position, 1.f};
+    hsh::float4 c = u->tint;
+    c = c * u->tint + hsh::float4{v->normal, 0.f};
+    c = hsh::float4{c.xyz() * hsh::dot(v->normal, u->lightDir), 1.f};
+    c = u->xf * c;
+    c = c - u->tint * 3.f;
+    c = c * u->tint + hsh::float4{v->normal, 4.f};
+    c = hsh::float4{c.xyz() * hsh::dot(v->normal, u->lightDir), 1.f};
+    c = u->xf * c;
+    c = c - u->tint * 7.f;
+    c = c + tex0.sample<float>({0.f, 0.f}, Sampler0);
+    color_out[0] = c;
+  }
+};
+
+void BindPipeline1(hsh::binding &b, hsh::uniform_buffer_typeless u, hsh::vertex_buffer_typeless v, hsh::texture2d tex0) {
+  b.hsh_Pipeline1(Pipeline1(u, v, tex0));
+}
+
+struct Pipeline2 : pipeline<color_attachment<>> {
+  Pipeline2(hsh::uniform_buffer<Uniforms> u, hsh::vertex_buffer<Vertex> v, hsh::texture2d tex0) {
+    position = u->xf * hsh::float4{v->position, 1.f};
+    hsh::float4 c = u->tint;
+    c = c * u->tint + hsh::float4{v->normal, 0.f};
+    c = hsh::float4{c.xyz() * hsh::dot(v->normal, u->lightDir), 1.f};
+    c = u->xf * c;
+    c = c - u->tint * 3.f;
+    c = c * u->tint + hsh::float4{v->normal, 4.f};
+    c = hsh::float4{c.xyz() * hsh::dot(v->normal, u->lightDir), 1.f};
+    c = u->xf * c;
+    c = c - u->tint * 7.f;
+    c = c + tex0.sample<float>({0.f, 0.f}, Sampler0);
+    color_out[0] = c;
+  }
+};
+
+void BindPipeline2(hsh::binding &b, hsh::uniform_buffer_typeless u, hsh::vertex_buffer_typeless v, hsh::texture2d tex0) {
+  b.hsh_Pipeline2(Pipeline2(u, v, tex0));
+}
+
+struct Pipeline3 : pipeline<color_attachment<>> {
+  Pipeline3(hsh::uniform_buffer<Uniforms> u, hsh::vertex_buffer<Vertex> v, hsh::texture2d tex0) {
+    position = u->xf * hsh::float4{v->position, 1.f};
+    hsh::float4 c = u->tint;
+    c = c * u->tint + hsh::float4{v->normal, 0.f};
+    c = hsh::float4{c.xyz() * hsh::dot(v->normal, u->lightDir), 1.f};
+    c = u->xf * c;
+    c = c - u->tint * 3.f;
+    c = c * u->tint + hsh::float4{v->normal, 4.f};
+    c = hsh::float4{c.xyz() * hsh::dot(v->normal, u->lightDir), 1.f};
+    c = u->xf * c;
+    c = c - u->tint * 7.f;
+    c = c + tex0.sample<float>({0.f, 0.f}, Sampler0);
+    color_out[0] = c;
+  }
+};
+
+void BindPipeline3(hsh::binding &b, hsh::uniform_buffer_typeless u, hsh::vertex_buffer_typeless v, hsh::texture2d tex0) {
+  b.hsh_Pipeline3(Pipeline3(u, v, tex0));
+}
+
+struct Pipeline4 : pipeline<color_attachment<>> {
+  Pipeline4(hsh::uniform_buffer<Uniforms> u, hsh::vertex_buffer<Vertex> v, hsh::texture2d tex0) {
+    position = u->xf * hsh::float4{v->position, 1.f};
+    hsh::float4 c = u->tint;
+    c = c * u->tint + hsh::float4{v->normal, 0.f};
+    c = hsh::float4{c.xyz() * hsh::dot(v->normal, u->lightDir), 1.f};
+    c = u->xf * c;
+    c = c - u->tint * 3.f;
+    c = c * u->tint + hsh::float4{v->normal, 4.f};
+    c = hsh::float4{c.xyz() * hsh::dot(v->normal, u->lightDir), 1.f};
+    c = u->xf * c;
+    c = c - u->tint * 7.f;
+    c = c + tex0.sample<float>({0.f, 0.f}, Sampler0);
+    color_out[0] = c;
+  }
+};
+
+void BindPipeline4(hsh::binding &b, hsh::uniform_buffer_typeless u, hsh::vertex_buffer_typeless v, hsh::texture2d tex0) {
+  b.hsh_Pipeline4(Pipeline4(u, v, tex0));
+}
+
+struct Pipeline5 : pipeline<color_attachment<>> {
+  Pipeline5(hsh::uniform_buffer<Uniforms> u, hsh::vertex_buffer<Vertex> v, hsh::texture2d tex0) {
+    position = u->xf * hsh::float4{v->position, 1.f};
+    hsh::float4 c = u->tint;
+    c = c * u->tint + hsh::float4{v->normal, 0.f};
+    c = hsh::float4{c.xyz() * hsh::dot(v->normal, u->lightDir), 1.f};
+    c = u->xf * c;
+    c = c - u->tint * 3.f;
+    c = c * u->tint + hsh::float4{v->normal, 4.f};
+    c = hsh::float4{c.xyz() * hsh::dot(v->normal, u->lightDir), 1.f};
+    c = u->xf * c;
+    c = c - u->tint * 7.f;
+    c = c + tex0.sample<float>({0.f, 0.f}, Sampler0);
+    color_out[0] = c;
+  }
+};
+
+void BindPipeline5(hsh::binding &b, hsh::uniform_buffer_typeless u, hsh::vertex_buffer_typeless v, hsh::texture2d tex0) {
+  b.hsh_Pipeline5(Pipeline5(u, v, tex0));
+}
+
+struct Pipeline6 : pipeline<color_attachment<>> {
+  Pipeline6(hsh::uniform_buffer<Uniforms> u, hsh::vertex_buffer<Vertex> v, hsh::texture2d tex0) {
+    position = u->xf * hsh::float4{v->position, 1.f};
+    hsh::float4 c = u->tint;
+    c = c * u->tint + hsh::float4{v->normal, 0.f};
+    c = hsh::float4{c.xyz() * hsh::dot(v->normal, u->lightDir), 1.f};
+    c = u->xf * c;
+    c = c - u->tint * 3.f;
+    c = c * u->tint + hsh::float4{v->normal, 4.f};
+    c = hsh::float4{c.xyz() * hsh::dot(v->normal, u->lightDir), 1.f};
+    c = u->xf * c;
+    c = c - u->tint * 7.f;
+    c = c + tex0.sample<float>({0.f, 0.f}, Sampler0);
+    color_out[0] = c;
+  }
+};
+
+void BindPipeline6(hsh::binding &b, hsh::uniform_buffer_typeless u, hsh::vertex_buffer_typeless v, hsh::texture2d tex0) {
+  b.hsh_Pipeline6(Pipeline6(u, v, tex0));
+}
+
+struct Pipeline7 : pipeline<color_attachment<>> {
+  Pipeline7(hsh::uniform_buffer<Uniforms> u, hsh::vertex_buffer<Vertex> v, hsh::texture2d tex0) {
+    position = u->xf * hsh::float4{v->position, 1.f};
+    hsh::float4 c = u->tint;
+    c = c * u->tint + hsh::float4{v->normal, 0.f};
+    c = hsh::float4{c.xyz() * hsh::dot(v->normal, u->lightDir), 1.f};
+    c = u->xf * c;
+    c = c - u->tint * 3.f;
+    c = c * u->tint + hsh::float4{v->normal, 4.f};
+    c = hsh::float4{c.xyz() * hsh::dot(v->normal, u->lightDir), 1.f};
+    c = u->xf * c;
+    c = c - u->tint * 7.f;
+    c = c + tex0.sample<float>({0.f, 0.f}, Sampler0);
+    color_out[0] = c;
+  }
+};
+
+void BindPipeline7(hsh::binding &b, hsh::uniform_buffer_typeless u, hsh::vertex_buffer_typeless v, hsh::texture2d tex0) {
+  b.hsh_Pipeline7(Pipeline7(u, v, tex0));
+}
+
+enum Variant {
+  Variant0,
+  Variant1,
+  Variant2,
+  Variant3,
+  Variant4,
+  Variant5,
+  Variant6,
+  Variant7,
+  Variant8,
+  Variant9,
+  Variant10,
+  Variant11,
+  Variant12,
+  Variant13,
+  Variant14,
+  Variant15,
+  Variant16,
+  Variant17,
+  Variant18,
+  Variant19,
+  Variant20,
+  Variant21,
+  Variant22,
+  Variant23,
+  Variant24,
+  Variant25,
+  Variant26,
+  Variant27,
+  Variant28,
+  Variant29,
+  Variant30,
+  Variant31,
+  Variant32,
+  Variant33,
+  Variant34,
+  Variant35,
+  Variant36,
+  Variant37,
+  Variant38,
+  Variant39,
+  Variant40,
+  Variant41,
+  Variant42,
+  Variant43,
+  Variant44,
+  Variant45,
+  Variant46,
+  Variant47,
+  Variant48,
+  Variant49,
+  Variant50,
+  Variant51,
+  Variant52,
+  Variant53,
+  Variant54,
+  Variant55,
+  Variant56,
+  Variant57,
+  Variant58,
+  Variant59,
+  Variant60,
+  Variant61,
+  Variant62,
+  Variant63,
+  Variant64,
+  Variant65,
+  Variant66,
+  Variant67,
+  Variant68,
+  Variant69,
+  Variant70,
+  Variant71,
+  Variant72,
+  Variant73,
+  Variant74,
+  Variant75,
+  Variant76,
+  Variant77,
+  Variant78,
+  Variant79,
+  Variant80,
+  Variant81,
+  Variant82,
+  Variant83,
+  Variant84,
+  Variant85,
+  Variant86,
+  Variant87,
+  Variant88,
+  Variant89,
+  Variant90,
+  Variant91,
+  Variant92,
+  Variant93,
+  Variant94,
+  Variant95,
+  Variant96,
+  Variant97,
+  Variant98,
+  Variant99,
+  Variant100,
+  Variant101,
+  Variant102,
+  Variant103,
+  Variant104,
+  Variant105,
+  Variant106,
+  Variant107,
+  Variant108,
+  Variant109,
+  Variant110,
+  Variant111,
+  Variant112,
+  Variant113,
+  Variant114,
+  Variant115,
+  Variant116,
+  Variant117,
+  Variant118,
+  Variant119,
+  Variant120,
+  Variant121,
+  Variant122,
+  Variant123,
+  Variant124,
+  Variant125,
+  Variant126,
+  Variant127,
+};
+
+template <Variant V>
+struct Specialized : pipeline<color_attachment<>> {
+  Specialized(hsh::uniform_buffer<Uniforms> u, hsh::vertex_buffer<Vertex> v, hsh::texture2d tex0) {
+    position = u->xf * hsh::float4{v->position, 1.f};
+    hsh::float4 c = u->tint;
+    c = c * u->tint + hsh::float4{v->normal, 0.f};
+    c = hsh::float4{c.xyz() * hsh::dot(v->normal, u->lightDir), 1.f};
+    c = u->xf * c;
+    c = c - u->tint * 3.f;
+    c = c * u->tint + hsh::float4{v->normal, 4.f};
+    c = hsh::float4{c.xyz() * hsh::dot(v->normal, u->lightDir), 1.f};
+    c = u->xf * c;
+    c = c - u->tint * 7.f;
+    c = c + tex0.sample<float>({0.f, 0.f}, Sampler0);
+    color_out[0] = c;
+    color_out[0] = c * float(int(V) + 1);
+  }
+};
+template struct Specialized<Variant0>;
+template struct Specialized<Variant1>;
+template struct Specialized<Variant2>;
+template struct Specialized<Variant3>;
+template struct Specialized<Variant4>;
+template struct Specialized<Variant5>;
+template struct Specialized<Variant6>;
+template struct Specialized<Variant7>;
+template struct Specialized<Variant8>;
+template struct Specialized<Variant9>;
+template struct Specialized<Variant10>;
+template struct Specialized<Variant11>;
+template struct Specialized<Variant12>;
+template struct Specialized<Variant13>;
+template struct Specialized<Variant14>;
+template struct Specialized<Variant15>;
+template struct Specialized<Variant16>;
+template struct Specialized<Variant17>;
+template struct Specialized<Variant18>;
+template struct Specialized<Variant19>;
+template struct Specialized<Variant20>;
+template struct Specialized<Variant21>;
+template struct Specialized<Variant22>;
+template struct Specialized<Variant23>;
+template struct Specialized<Variant24>;
+template struct Specialized<Variant25>;
+template struct Specialized<Variant26>;
+template struct Specialized<Variant27>;
+template struct Specialized<Variant28>;
+template struct Specialized<Variant29>;
+template struct Specialized<Variant30>;
+template struct Specialized<Variant31>;
+template struct Specialized<Variant32>;
+template struct Specialized<Variant33>;
+template struct Specialized<Variant34>;
+template struct Specialized<Variant35>;
+template struct Specialized<Variant36>;
+template struct Specialized<Variant37>;
+template struct Specialized<Variant38>;
+template struct Specialized<Variant39>;
+template struct Specialized<Variant40>;
+template struct Specialized<Variant41>;
+template struct Specialized<Variant42>;
+template struct Specialized<Variant43>;
+template struct Specialized<Variant44>;
+template struct Specialized<Variant45>;
+template struct Specialized<Variant46>;
+template struct Specialized<Variant47>;
+template struct Specialized<Variant48>;
+template struct Specialized<Variant49>;
+template struct Specialized<Variant50>;
+template struct Specialized<Variant51>;
+template struct Specialized<Variant52>;
+template struct Specialized<Variant53>;
+template struct Specialized<Variant54>;
+template struct Specialized<Variant55>;
+template struct Specialized<Variant56>;
+template struct Specialized<Variant57>;
+template struct Specialized<Variant58>;
+template struct Specialized<Variant59>;
+template struct Specialized<Variant60>;
+template struct Specialized<Variant61>;
+template struct Specialized<Variant62>;
+template struct Specialized<Variant63>;
+template struct Specialized<Variant64>;
+template struct Specialized<Variant65>;
+template struct Specialized<Variant66>;
+template struct Specialized<Variant67>;
+template struct Specialized<Variant68>;
+template struct Specialized<Variant69>;
+template struct Specialized<Variant70>;
+template struct Specialized<Variant71>;
+template struct Specialized<Variant72>;
+template struct Specialized<Variant73>;
+template struct Specialized<Variant74>;
+template struct Specialized<Variant75>;
+template struct Specialized<Variant76>;
+template struct Specialized<Variant77>;
+template struct Specialized<Variant78>;
+template struct Specialized<Variant79>;
+template struct Specialized<Variant80>;
+template struct Specialized<Variant81>;
+template struct Specialized<Variant82>;
+template struct Specialized<Variant83>;
+template struct Specialized<Variant84>;
+template struct Specialized<Variant85>;
+template struct Specialized<Variant86>;
+template struct Specialized<Variant87>;
+template struct Specialized<Variant88>;
+template struct Specialized<Variant89>;
+template struct Specialized<Variant90>;
+template struct Specialized<Variant91>;
+template struct Specialized<Variant92>;
+template struct Specialized<Variant93>;
+template struct Specialized<Variant94>;
+template struct Specialized<Variant95>;
+template struct Specialized<Variant96>;
+template struct Specialized<Variant97>;
+template struct Specialized<Variant98>;
+template struct Specialized<Variant99>;
+template struct Specialized<Variant100>;
+template struct Specialized<Variant101>;
+template struct Specialized<Variant102>;
+template struct Specialized<Variant103>;
+template struct Specialized<Variant104>;
+template struct Specialized<Variant105>;
+template struct Specialized<Variant106>;
+template struct Specialized<Variant107>;
+template struct Specialized<Variant108>;
+template struct Specialized<Variant109>;
+template struct Specialized<Variant110>;
+template struct Specialized<Variant111>;
+template struct Specialized<Variant112>;
+template struct Specialized<Variant113>;
+template struct Specialized<Variant114>;
+template struct Specialized<Variant115>;
+template struct Specialized<Variant116>;
+template struct Specialized<Variant117>;
+template struct Specialized<Variant118>;
+template struct Specialized<Variant119>;
+template struct Specialized<Variant120>;
+template struct Specialized<Variant121>;
+template struct Specialized<Variant122>;
+template struct Specialized<Variant123>;
+template struct Specialized<Variant124>;
+template struct Specialized<Variant125>;
+template struct Specialized<Variant126>;
+template struct Specialized<Variant127>;
+
+void BindSpecialized(hsh::binding &b, hsh::uniform_buffer_typeless u, hsh::vertex_buffer_typeless v, hsh::texture2d tex0, Variant V) {
+  b.hsh_Specialized(Specialized<V>(u, v, tex0));
+}
+
+} // namespace Corpus
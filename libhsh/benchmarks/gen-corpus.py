@@ -0,0 +1,209 @@
+#!/usr/bin/env python3
+"""Generates the synthetic hshgen benchmark corpus.
+
+Every scenario starts from a common baseline and scales one dimension of
+the input:
+
+  pipelines        number of plain pipeline structs bound in the file
+  specializations  explicit instantiations of one templated pipeline
+  statements       statements in each pipeline constructor
+  samplers         sampled textures and distinct samplers per pipeline
+  include-depth    length of the header chain included before the shaders
+
+Each scenario is written to <output>/<dimension>-<size>/ as a single
+source file that includes its own .hshhead output, like any other hsh
+user. The header chain is shared by all scenarios and lives in
+<output>/include.
+
+The checked-in corpus was produced by running this script with no
+arguments; rerun it after changing the parameters below.
+"""
+
+import argparse
+import os
+import shutil
+
+BASELINE = {
+    'pipelines': 8,
+    'specializations': 0,
+    'statements': 8,
+    'samplers': 1,
+    'include-depth': 1,
+}
+
+# Sampler counts stay within the HSH_MAX_SAMPLERS that run-benchmarks.py
+# passes to hshgen.
+SCENARIOS = {
+    'pipelines': [16, 64, 256],
+    'specializations': [8, 32, 128],
+    'statements': [16, 64, 256],
+    'samplers': [2, 4, 8],
+    'include-depth': [4, 16, 64],
+}
+
+HEADER = '/* Generated by gen-corpus.py; do not edit. */\n'
+
+
+def header_name(level):
+    return 'chain%d.h' % level
+
+
+def write_header_chain(include_dir, depth):
+    """Each header adds a vertex format and a uniform block on top of the
+    previous one. The deepest header's types are the ones the shaders use."""
+    os.makedirs(include_dir, exist_ok=True)
+    for level in range(depth):
+        lines = [HEADER, '#pragma once\n']
+        if level == 0:
+            lines.append('#include <hsh/hsh.h>\n')
+        else:
+            lines.append('#include "%s"\n' % header_name(level - 1))
+        lines.append('''
+namespace Corpus {
+struct Vertex%(l)d {
+  hsh::float3 position;
+  hsh::float3 normal;
+};
+
+struct Uniforms%(l)d {
+  hsh::float4x4 xf;
+  hsh::float4 tint;
+  hsh::float3 lightDir;
+  float level;
+};
+} // namespace Corpus
+''' % {'l': level})
+        with open(os.path.join(include_dir, header_name(level)), 'w') as f:
+            f.write(''.join(lines))
+
+
+def statement(k):
+    """One of a few statement forms that each lower to distinct code."""
+    form = k % 4
+    if form == 0:
+        return 'c = c * u->tint + hsh::float4{v->normal, %d.f};' % k
+    if form == 1:
+        return ('c = hsh::float4{c.xyz() * hsh::dot(v->normal, u->lightDir), '
+                '1.f};')
+    if form == 2:
+        return 'c = u->xf * c;'
+    return 'c = c - u->tint * %d.f;' % k
+
+
+def pipeline_body(params, indent):
+    pad = ' ' * indent
+    lines = [pad + 'position = u->xf * hsh::float4{v->position, 1.f};',
+             pad + 'hsh::float4 c = u->tint;']
+    for k in range(params['statements']):
+        lines.append(pad + statement(k))
+    for s in range(params['samplers']):
+        lines.append(pad + 'c = c + tex%d.sample<float>({0.f, 0.f}, '
+                     'Sampler%d);' % (s, s))
+    lines.append(pad + 'color_out[0] = c;')
+    return '\n'.join(lines) + '\n'
+
+
+def parameter_list(params):
+    decls = ['hsh::uniform_buffer<Uniforms> u', 'hsh::vertex_buffer<Vertex> v']
+    decls += ['hsh::texture2d tex%d' % s for s in range(params['samplers'])]
+    return decls
+
+
+def binding_parameter_list(params):
+    decls = ['hsh::binding &b', 'hsh::uniform_buffer_typeless u',
+             'hsh::vertex_buffer_typeless v']
+    decls += ['hsh::texture2d tex%d' % s for s in range(params['samplers'])]
+    return decls
+
+
+def argument_list(params):
+    return ', '.join(['u', 'v'] +
+                     ['tex%d' % s for s in range(params['samplers'])])
+
+
+def write_scenario(output_dir, name, params):
+    scenario_dir = os.path.join(output_dir, name)
+    os.makedirs(scenario_dir, exist_ok=True)
+    deepest = params['include-depth'] - 1
+    out = [HEADER,
+           '#include "%s"\n' % header_name(deepest),
+           '#include "%s.cpp.hshhead"\n' % name,
+           '\nnamespace Corpus {\n',
+           'using namespace hsh::pipeline;\n',
+           'using Vertex = Vertex%d;\n' % deepest,
+           'using Uniforms = Uniforms%d;\n\n' % deepest]
+    for s in range(params['samplers']):
+        filters = ['hsh::Nearest', 'hsh::Linear']
+        out.append('constexpr hsh::sampler Sampler%d(%s, %s, %s);\n' %
+                   (s, filters[s % 2], filters[(s >> 1) % 2],
+                    filters[(s >> 2) % 2]))
+    params_decl = ', '.join(parameter_list(params))
+    binding_decl = ', '.join(binding_parameter_list(params))
+    args = argument_list(params)
+
+    for i in range(params['pipelines']):
+        out.append('''
+struct Pipeline%(i)d : pipeline<color_attachment<>> {
+  Pipeline%(i)d(%(params)s) {
+%(body)s  }
+};
+
+void BindPipeline%(i)d(%(binding)s) {
+  b.hsh_Pipeline%(i)d(Pipeline%(i)d(%(args)s));
+}
+''' % {'i': i, 'params': params_decl, 'binding': binding_decl,
+            'args': args, 'body': pipeline_body(params, 4)})
+
+    num_variants = params['specializations']
+    if num_variants:
+        out.append('\nenum Variant {\n')
+        out.extend('  Variant%d,\n' % j for j in range(num_variants))
+        out.append('};\n')
+        out.append('''
+template <Variant V>
+struct Specialized : pipeline<color_attachment<>> {
+  Specialized(%(params)s) {
+%(body)s    color_out[0] = c * float(int(V) + 1);
+  }
+};
+''' % {'params': params_decl, 'body': pipeline_body(params, 4)})
+        out.extend('template struct Specialized<Variant%d>;\n' % j
+                   for j in range(num_variants))
+        out.append('''
+void BindSpecialized(%(binding)s, Variant V) {
+  b.hsh_Specialized(Specialized<V>(%(args)s));
+}
+''' % {'binding': binding_decl, 'args': args})
+
+    out.append('\n} // namespace Corpus\n')
+    with open(os.path.join(scenario_dir, name + '.cpp'), 'w') as f:
+        f.write(''.join(out))
+
+
+def scenarios():
+    for dimension, sizes in SCENARIOS.items():
+        for size in sizes:
+            params = dict(BASELINE)
+            params[dimension] = size
+            yield '%s-%d' % (dimension, size), params
+    yield 'baseline', dict(BASELINE)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('output', nargs='?',
+                        default=os.path.join(os.path.dirname(
+                            os.path.abspath(__file__)), 'corpus'),
+                        help='directory to write the corpus to')
+    args = parser.parse_args()
+
+    if os.path.isdir(args.output):
+        shutil.rmtree(args.output)
+    max_depth = max(SCENARIOS['include-depth'] + [BASELINE['include-depth']])
+    write_header_chain(os.path.join(args.output, 'include'), max_depth)
+    for name, params in scenarios():
+        write_scenario(args.output, name, params)
+
+
+if __name__ == '__main__':
+    main()
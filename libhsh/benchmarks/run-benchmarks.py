@@ -0,0 +1,177 @@
+#!/usr/bin/env python3
+"""Runs hshgen over the benchmark corpus and records its cost.
+
+Each scenario in the corpus is generated for the GLSL and HLSL source
+targets, which need no external shader compiler. For every scenario the
+minimum wall time over the repetitions, the peak resident set size of the
+hshgen process and the size of the generated header are recorded.
+
+Results are printed as a table and optionally written as JSON. Given the
+JSON of an earlier run with --baseline, the change of each measurement is
+shown and the run fails when wall time or peak RSS grew by more than
+--max-regression percent.
+"""
+
+import argparse
+import json
+import os
+import re
+import subprocess
+import sys
+import tempfile
+import time
+
+# Limits that the hsh headers require to be defined. The corpus stays
+# within them.
+DEFINES = [
+    'HSH_MAX_UNIFORMS=8',
+    'HSH_MAX_IMAGES=8',
+    'HSH_MAX_SAMPLERS=8',
+    'HSH_MAX_VERTEX_BUFFERS=8',
+    'HSH_MAX_RENDER_TEXTURE_BINDINGS=4',
+    'HSH_DESCRIPTOR_POOL_SIZE=8192',
+]
+
+TARGETS = ['-glsl', '-hlsl']
+
+
+def scenario_key(name):
+    """Orders scenarios by dimension, then numerically by size."""
+    match = re.match(r'(.*)-(\d+)$', name)
+    if not match:
+        return (name, 0)
+    return (match.group(1), int(match.group(2)))
+
+
+def find_scenarios(corpus, pattern):
+    names = [name for name in os.listdir(corpus)
+             if name != 'include' and
+             os.path.isfile(os.path.join(corpus, name, name + '.cpp'))]
+    if pattern:
+        names = [name for name in names if re.search(pattern, name)]
+    return sorted(names, key=scenario_key)
+
+
+def run_once(args, name, output):
+    """Runs hshgen once and returns its wall time in seconds and peak RSS
+    in KiB, or None if it failed."""
+    source = os.path.join(args.corpus, name, name + '.cpp')
+    cmd = [args.hshgen, '-I', args.include, '-I',
+           os.path.join(args.corpus, 'include')]
+    cmd += ['-D' + define for define in DEFINES]
+    cmd += TARGETS + [source, output]
+    with tempfile.TemporaryFile() as stderr:
+        start = time.perf_counter()
+        proc = subprocess.Popen(cmd, stdout=subprocess.DEVNULL, stderr=stderr)
+        # wait4 reports the usage of this child alone, unlike
+        # getrusage(RUSAGE_CHILDREN) which keeps the maximum over all of them.
+        _, status, usage = os.wait4(proc.pid, 0)
+        wall = time.perf_counter() - start
+        proc.returncode = status
+        if status != 0:
+            stderr.seek(0)
+            sys.stderr.write('error: hshgen failed on %s:\n' % name)
+            sys.stderr.write(' '.join(cmd) + '\n')
+            sys.stderr.write(stderr.read().decode(errors='replace'))
+            return None
+    peak_rss = usage.ru_maxrss
+    if sys.platform == 'darwin':
+        peak_rss //= 1024
+    return wall, peak_rss
+
+
+def run_scenario(args, name):
+    output_dir = os.path.join(args.work_dir, name)
+    os.makedirs(output_dir, exist_ok=True)
+    # hshgen checks that the source includes a header named like its output.
+    output = os.path.join(output_dir, name + '.cpp.hshhead')
+    walls = []
+    peak_rss = 0
+    for _ in range(args.repeat):
+        result = run_once(args, name, output)
+        if result is None:
+            return None
+        walls.append(result[0])
+        peak_rss = max(peak_rss, result[1])
+    return {
+        'scenario': name,
+        'wall_s': min(walls),
+        'peak_rss_kib': peak_rss,
+        'output_bytes': os.path.getsize(output),
+    }
+
+
+def percent_change(old, new):
+    if not old:
+        return 0.0
+    return 100.0 * (new - old) / old
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description=__doc__.splitlines()[0])
+    parser.add_argument('--hshgen', required=True, help='hshgen executable')
+    parser.add_argument('--include', required=True,
+                        help='libhsh include directory')
+    parser.add_argument('--corpus',
+                        default=os.path.join(os.path.dirname(
+                            os.path.abspath(__file__)), 'corpus'),
+                        help='corpus produced by gen-corpus.py')
+    parser.add_argument('--work-dir', required=True,
+                        help='directory for the generated headers')
+    parser.add_argument('--output', help='write results as JSON to this file')
+    parser.add_argument('--baseline',
+                        help='JSON results of an earlier run to compare to')
+    parser.add_argument('--max-regression', type=float, default=10.0,
+                        help='percent growth of wall time or peak RSS over '
+                        'the baseline that fails the run')
+    parser.add_argument('--repeat', type=int, default=3,
+                        help='runs per scenario; the fastest is kept')
+    parser.add_argument('--filter', help='only run scenarios matching regex')
+    args = parser.parse_args()
+
+    baseline = {}
+    if args.baseline:
+        with open(args.baseline) as f:
+            baseline = {r['scenario']: r for r in json.load(f)['results']}
+
+    results = []
+    failed = False
+    regressed = []
+    print('%-24s %10s %12s %12s' %
+          ('scenario', 'wall (s)', 'RSS (KiB)', 'output (B)'))
+    for name in find_scenarios(args.corpus, args.filter):
+        result = run_scenario(args, name)
+        if result is None:
+            failed = True
+            continue
+        results.append(result)
+        line = '%-24s %10.3f %12d %12d' % (name, result['wall_s'],
+                                           result['peak_rss_kib'],
+                                           result['output_bytes'])
+        old = baseline.get(name)
+        if old:
+            wall_change = percent_change(old['wall_s'], result['wall_s'])
+            rss_change = percent_change(old['peak_rss_kib'],
+                                        result['peak_rss_kib'])
+            line += '   wall %+6.1f%%  RSS %+6.1f%%' % (wall_change,
+                                                         rss_change)
+            if max(wall_change, rss_change) > args.max_regression:
+                regressed.append(name)
+        print(line)
+        sys.stdout.flush()
+
+    if args.output:
+        with open(args.output, 'w') as f:
+            json.dump({'hshgen': args.hshgen, 'repeat': args.repeat,
+                       'results': results}, f, indent=2)
+            f.write('\n')
+
+    if regressed:
+        sys.stderr.write('error: regressed by more than %g%%: %s\n' %
+                         (args.max_regression, ', '.join(regressed)))
+    return 1 if failed or regressed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
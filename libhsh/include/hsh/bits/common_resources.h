@@ -381,6 +381,10 @@ template <hsh::Target T> struct ShaderObject {};
 /* Holds sampler object as loaded into graphics API */
 template <hsh::Target T> struct SamplerObject {};
 
+/* Holds pipeline object as loaded into graphics API; shared by every
+ * binding with identical pipeline state */
+template <hsh::Target T> struct PipelineObject {};
+
 /* Associates texture with sampler object index in shader data. */
 struct SamplerBinding {
   texture_typeless Tex; /* Reference to actual texture being sampled. */
@@ -529,13 +533,35 @@ struct PipelineInfo {
   enum Compare DepthCompare = Always;
   bool DepthWrite = true;
   bool DirectRenderPass = false;
+  /* Descriptors actually bound by the pipeline; backends size descriptor
+   * layouts from these instead of the global maximums. */
+  uint32_t NumUniforms = MaxUniforms;
+  uint32_t NumImages = MaxImages;
+  uint32_t NumSamplers = MaxSamplers;
   constexpr PipelineInfo() noexcept = default;
   constexpr PipelineInfo(enum Topology Topology, unsigned PatchControlPoints,
                          enum CullMode CullMode, enum Compare DepthCompare,
-                         bool DepthWrite, bool DirectRenderPass) noexcept
+                         bool DepthWrite, bool DirectRenderPass,
+                         uint32_t NumUniforms = MaxUniforms,
+                         uint32_t NumImages = MaxImages,
+                         uint32_t NumSamplers = MaxSamplers) noexcept
       : Topology(Topology), PatchControlPoints(PatchControlPoints),
         CullMode(CullMode), DepthCompare(DepthCompare), DepthWrite(DepthWrite),
-        DirectRenderPass(DirectRenderPass) {}
+        DirectRenderPass(DirectRenderPass), NumUniforms(NumUniforms),
+        NumImages(NumImages), NumSamplers(NumSamplers) {}
+};
+
+/* Blend, depth, rasterization and topology state of a pipeline. hshgen emits
+ * one constant table per distinct state and target, which every pipeline
+ * spelling the same state refers to. Backends specialize this to hold their
+ * own state structures so they are built once at compile time. */
+template <Target T, std::uint32_t NAttachments> struct PipelineState {
+  std::array<ColorAttachment, NAttachments> Attachments;
+  struct PipelineInfo PipelineInfo;
+
+  constexpr PipelineState(std::array<ColorAttachment, NAttachments> Atts,
+                          struct PipelineInfo PipelineInfo) noexcept
+      : Attachments(Atts), PipelineInfo(PipelineInfo) {}
 };
 
 template <Target T, std::uint32_t NStages, std::uint32_t NBindings,
@@ -557,6 +583,15 @@ struct ShaderConstData {
                             struct PipelineInfo PipelineInfo) noexcept
       : StageCodes(S), Bindings(B), Attributes(A), Samplers(Samps),
         Attachments(Atts), PipelineInfo(PipelineInfo) {}
+
+  constexpr ShaderConstData(
+      std::array<ShaderCode<T>, NStages> S,
+      std::array<VertexBinding, NBindings> B,
+      std::array<VertexAttribute, NAttributes> A,
+      std::array<sampler, NSamplers> Samps,
+      const PipelineState<T, NAttachments> &State) noexcept
+      : ShaderConstData(S, B, A, Samps, State.Attachments,
+                        State.PipelineInfo) {}
 };
 
 template <Target T, std::uint32_t NStages, std::uint32_t NSamplers>
@@ -565,11 +600,21 @@ struct ShaderData {
   std::array<ObjectRef, NStages> ShaderObjects;
   using SamplerRef = std::reference_wrapper<SamplerObject<T>>;
   std::array<SamplerRef, NSamplers> SamplerObjects;
+  using PipelineRef = std::reference_wrapper<PipelineObject<T>>;
+  PipelineRef SharedPipeline;
   constexpr ShaderData(std::array<ObjectRef, NStages> S,
-                       std::array<SamplerRef, NSamplers> Samps) noexcept
-      : ShaderObjects(S), SamplerObjects(Samps) {}
+                       std::array<SamplerRef, NSamplers> Samps,
+                       PipelineRef Pipeline) noexcept
+      : ShaderObjects(S), SamplerObjects(Samps), SharedPipeline(Pipeline) {}
 };
 
+/*
+ * hshgen specializes this for every specialization of a pipeline template
+ * that is created alongside others of the same template. Base names the
+ * first of them, which the rest may be created as derivatives of.
+ */
+template <typename B> struct PipelineGroup { using Base = void; };
+
 template <hsh::Target T> struct PipelineBuilder {
   template <typename... B> static void CreatePipelines() noexcept {
     assert(false && "unimplemented pipeline builder");
@@ -641,6 +641,16 @@ struct ShaderConstData<Target::DEKO3D, NStages, NBindings, NAttributes,
                         std::make_index_sequence<NAttributes>(),
                         std::make_index_sequence<NSamplers>(),
                         std::make_index_sequence<NAttachments>()) {}
+
+  constexpr ShaderConstData(
+      std::array<ShaderCode<Target::DEKO3D>, NStages> S,
+      std::array<VertexBinding, NBindings> B,
+      std::array<VertexAttribute, NAttributes> A,
+      std::array<sampler, NSamplers> Samps,
+      const PipelineState<Target::DEKO3D, NAttachments> &State,
+      const SourceLocation &Location = SourceLocation::current()) noexcept
+      : ShaderConstData(S, B, A, Samps, State.Attachments, State.PipelineInfo,
+                        Location) {}
 };
 
 template <std::uint32_t NStages, std::uint32_t NSamplers>
@@ -649,6 +659,9 @@ struct ShaderData<Target::DEKO3D, NStages, NSamplers> {
   std::array<ObjectRef, NStages> ShaderObjects;
   using SamplerRef = std::reference_wrapper<SamplerObject<Target::DEKO3D>>;
   TargetTraits<Target::DEKO3D>::Pipeline Pipeline;
+  /* deko3d binds pipeline state piecemeal, so there is no shared pipeline
+   * object to hold. */
+  using PipelineRef = std::reference_wrapper<PipelineObject<Target::DEKO3D>>;
   template <std::size_t... StSeq>
   constexpr ShaderData(std::array<ObjectRef, NStages> S,
                        std::array<SamplerRef, NSamplers> Samps,
@@ -656,7 +669,8 @@ struct ShaderData<Target::DEKO3D, NStages, NSamplers> {
       : ShaderObjects(S), Pipeline{NStages,
                                    {&std::get<StSeq>(S).get().Shader...}} {}
   constexpr ShaderData(std::array<ObjectRef, NStages> S,
-                       std::array<SamplerRef, NSamplers> Samps) noexcept
+                       std::array<SamplerRef, NSamplers> Samps,
+                       PipelineRef) noexcept
       : ShaderData(S, Samps, std::make_index_sequence<NStages>()) {}
   template <std::size_t... StSeq>
   void InitializeShaders(const std::array<StageCode, NStages> &StageCodes,
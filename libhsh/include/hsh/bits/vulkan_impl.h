@@ -44,35 +44,53 @@ protected:
 } // namespace VULKAN_HPP_NAMESPACE
 
 namespace hsh::detail::vulkan {
+/*
+ * Buffer handles live in a heap record that stays put for the buffer's
+ * lifetime, so bindings follow a static buffer when defragmentation moves
+ * it to new memory.
+ */
+struct BufferRecord {
+  vk::Buffer Buffer;
+  VmaAllocation Allocation = VK_NULL_HANDLE;
+  vk::DeviceSize Size = 0;
+  vk::BufferUsageFlags Usage;
+  /* Static buffers whose contents are uploaded may be defragmented */
+  bool Movable = false;
+  BufferRecord *Prev = nullptr, *Next = nullptr;
+};
+
 class BufferAllocation {
   friend class DeletedBufferAllocation;
   friend BufferAllocation
   AllocateStaticBuffer(const SourceLocation &location, vk::DeviceSize size,
                        vk::BufferUsageFlags usage) noexcept;
+  friend BufferAllocation AllocateHostBuffer(const SourceLocation &location,
+                                             vk::DeviceSize size) noexcept;
 
 protected:
-  vk::Buffer Buffer;
-  VmaAllocation Allocation = VK_NULL_HANDLE;
-  BufferAllocation(vk::Buffer Buffer, VmaAllocation Allocation) noexcept
-      : Buffer(Buffer), Allocation(Allocation) {}
+  BufferRecord *Record = nullptr;
+  BufferAllocation(vk::Buffer Buffer, VmaAllocation Allocation,
+                   vk::DeviceSize Size, vk::BufferUsageFlags Usage) noexcept
+      : Record(new BufferRecord{Buffer, Allocation, Size, Usage}) {}
 
 public:
   BufferAllocation() noexcept = default;
   BufferAllocation(const BufferAllocation &other) = delete;
   BufferAllocation &operator=(const BufferAllocation &other) = delete;
   BufferAllocation(BufferAllocation &&other) noexcept {
-    std::swap(Buffer, other.Buffer);
-    std::swap(Allocation, other.Allocation);
+    std::swap(Record, other.Record);
   }
   BufferAllocation &operator=(BufferAllocation &&other) noexcept {
-    std::swap(Buffer, other.Buffer);
-    std::swap(Allocation, other.Allocation);
+    std::swap(Record, other.Record);
     return *this;
   }
   inline ~BufferAllocation() noexcept;
-  vk::Buffer GetBuffer() const noexcept { return Buffer; }
+  vk::Buffer GetBuffer() const noexcept {
+    return Record ? Record->Buffer : vk::Buffer{};
+  }
+  BufferRecord *GetRecord() const noexcept { return Record; }
   operator vk::Buffer() const noexcept { return GetBuffer(); }
-  bool IsValid() const noexcept { return Buffer.operator bool(); }
+  bool IsValid() const noexcept { return Record != nullptr; }
 };
 
 class UploadBufferAllocation : public BufferAllocation {
@@ -81,8 +99,10 @@ class UploadBufferAllocation : public BufferAllocation {
                        vk::DeviceSize size) noexcept;
   void *MappedData;
   UploadBufferAllocation(vk::Buffer BufferIn, VmaAllocation AllocationIn,
-                         void *MappedData) noexcept
-      : BufferAllocation(BufferIn, AllocationIn), MappedData(MappedData) {}
+                         vk::DeviceSize Size, void *MappedData) noexcept
+      : BufferAllocation(BufferIn, AllocationIn, Size,
+                         vk::BufferUsageFlagBits::eTransferSrc),
+        MappedData(MappedData) {}
 
 public:
   UploadBufferAllocation() noexcept = default;
@@ -91,15 +111,14 @@ public:
 
 class DynamicBufferAllocation : public BufferAllocation {
   UploadBufferAllocation UploadBuffer;
-  vk::DeviceSize Size;
   friend DynamicBufferAllocation
   AllocateDynamicBuffer(const SourceLocation &location, vk::DeviceSize size,
                         vk::BufferUsageFlags usage) noexcept;
   DynamicBufferAllocation(vk::Buffer BufferIn, VmaAllocation AllocationIn,
-                          vk::DeviceSize Size,
+                          vk::DeviceSize Size, vk::BufferUsageFlags Usage,
                           UploadBufferAllocation UploadBuffer) noexcept
-      : BufferAllocation(BufferIn, AllocationIn),
-        UploadBuffer(std::move(UploadBuffer)), Size(Size) {}
+      : BufferAllocation(BufferIn, AllocationIn, Size, Usage),
+        UploadBuffer(std::move(UploadBuffer)) {}
 
 public:
   DynamicBufferAllocation() noexcept = default;
@@ -113,6 +132,9 @@ struct TextureAllocation {
   AllocateTexture(const SourceLocation &location,
                   const vk::ImageCreateInfo &CreateInfo,
                   bool Dedicated) noexcept;
+  friend TextureAllocation
+  AllocateTransientTexture(const SourceLocation &location,
+                           const vk::ImageCreateInfo &CreateInfo) noexcept;
 
 protected:
   vk::Image Image;
@@ -137,6 +159,51 @@ public:
   vk::Image GetImage() const noexcept { return Image; }
 };
 
+/*
+ * Static textures own their image through a heap record so the residency
+ * manager can swap in a copy without the largest mips, and later put them
+ * back. Bindings read the current view through the record.
+ */
+struct ResidentTexture {
+  TextureAllocation Allocation;
+  vk::UniqueImageView ImageView;
+  /* The full mip chain and its upload layout */
+  vk::ImageCreateInfo CreateInfo;
+  vk::ImageViewType ViewType;
+  vk::ComponentMapping Components;
+  std::array<vk::BufferImageCopy, MaxMipCount> Copies;
+  vk::DeviceSize ChainSize;
+  SourceLocation Location;
+  /* Host copy of the evicted mips, laid out like the upload buffer */
+  BufferAllocation EvictedMips;
+  uint32_t FirstMip = 0;
+  uint64_t LastUsedFrame = 0;
+  bool Tracked = false;
+  ResidentTexture *Prev = nullptr, *Next = nullptr;
+
+  ResidentTexture(const vk::ImageCreateInfo &CreateInfo,
+                  vk::ImageViewType ViewType, vk::ComponentMapping Components,
+                  const std::array<vk::BufferImageCopy, MaxMipCount> &Copies,
+                  vk::DeviceSize ChainSize,
+                  const SourceLocation &Location) noexcept
+      : CreateInfo(CreateInfo), ViewType(ViewType), Components(Components),
+        Copies(Copies), ChainSize(ChainSize), Location(Location) {}
+
+  vk::Extent3D MipExtent(uint32_t Mip) const noexcept {
+    return {std::max(CreateInfo.extent.width >> Mip, 1u),
+            std::max(CreateInfo.extent.height >> Mip, 1u),
+            std::max(CreateInfo.extent.depth >> Mip, 1u)};
+  }
+  vk::DeviceSize MipSize(uint32_t Mip) const noexcept {
+    auto End = Mip + 1 < CreateInfo.mipLevels ? Copies[Mip + 1].bufferOffset
+                                               : ChainSize;
+    return End - Copies[Mip].bufferOffset;
+  }
+  uint32_t NumResidentMips() const noexcept {
+    return CreateInfo.mipLevels - FirstMip;
+  }
+};
+
 struct RenderPassBeginInfo : vk::RenderPassBeginInfo {
   std::array<vk::ClearValue, 2> ClearValues;
   RenderPassBeginInfo() = default;
@@ -151,6 +218,20 @@ struct RenderPassBeginInfo : vk::RenderPassBeginInfo {
   }
 };
 
+/*
+ * Render passes that differ only in load and store ops are compatible with
+ * the pipelines and framebuffers created against Globals.RenderPass, so one
+ * variant exists for each combination the render textures may pick.
+ */
+constexpr std::size_t NumRenderPassVariants = 3 * 3 * 2;
+constexpr std::size_t
+RenderPassVariantIndex(vk::AttachmentLoadOp ColorLoad,
+                       vk::AttachmentLoadOp DepthLoad,
+                       vk::AttachmentStoreOp DepthStore) noexcept {
+  return std::size_t(ColorLoad) * 6 + std::size_t(DepthLoad) * 2 +
+         std::size_t(DepthStore);
+}
+
 class SurfaceAllocation {
   friend class DeletedSurfaceAllocation;
   friend class RenderTextureAllocation;
@@ -160,7 +241,8 @@ class SurfaceAllocation {
   SourceLocation Location;
   vk::UniqueSurfaceKHR Surface;
   vk::UniqueSwapchainKHR Swapchain;
-  vk::UniqueRenderPass OwnedRenderPass, OwnedDirectRenderPass;
+  std::array<vk::UniqueRenderPass, NumRenderPassVariants> OwnedRenderPasses;
+  vk::UniqueRenderPass OwnedDirectRenderPass;
   struct SwapchainImage {
     vk::Image Image;
     vk::UniqueImageView ColorView;
@@ -243,7 +325,26 @@ class RenderTextureAllocation {
   std::array<Binding, MaxRenderTextureBindings> ColorBindings;
   std::array<Binding, MaxRenderTextureBindings> DepthBindings;
   bool FirstAttach = false;
+  /* Load ops of the pass begun at the next draw or clear */
+  vk::AttachmentLoadOp ColorLoadOp = vk::AttachmentLoadOp::eLoad;
+  vk::AttachmentLoadOp DepthLoadOp = vk::AttachmentLoadOp::eLoad;
+  /*
+   * Depth of a render texture without depth bindings moves to a transient
+   * attachment that is never stored once a frame has used the texture
+   * without loading depth. The frame that first attaches it doesn't count,
+   * as fresh attachments are never loaded. A pass that loads depth after
+   * all moves it back to a stored attachment for good.
+   */
+  bool TransientDepth = false;
+  bool DepthLoaded = false;
+  bool RenderedThisFrame = false;
+  bool AttachedFreshThisFrame = false;
+  bool DepthNeedsBarrier = false;
+  inline void Link() noexcept;
   inline void Prepare() noexcept;
+  inline void PrepareDepth() noexcept;
+  inline void ReplaceDepth() noexcept;
+  inline void BarrierDepth() noexcept;
   static inline void _Resolve(vk::Image SrcImage, vk::Image DstImage,
                               vk::ImageAspectFlagBits Aspect,
                               vk::Offset3D SrcOffset, vk::Offset3D DstOffset,
@@ -269,6 +370,7 @@ public:
   RenderTextureAllocation &
   operator=(RenderTextureAllocation &&other) noexcept = delete;
   void PreRender() noexcept {
+    bool NeedsPrepare = false;
     if (Surface) {
       auto &SurfAlloc = *Surface;
       auto SurfContentExtent = SurfAlloc.ContentExtent();
@@ -276,11 +378,27 @@ public:
           SurfAlloc.GetColorFormat() != ColorFormat) {
         Extent = SurfContentExtent;
         ColorFormat = SurfAlloc.GetColorFormat();
-        Prepare();
+        NeedsPrepare = true;
       }
     }
+    if (NeedsPrepare) {
+      Prepare();
+    } else if (RenderedThisFrame && !AttachedFreshThisFrame && !DepthLoaded &&
+               !TransientDepth && NumDepthBindings == 0) {
+      TransientDepth = true;
+      ReplaceDepth();
+      DepthNeedsBarrier = true;
+    }
+    RenderedThisFrame = AttachedFreshThisFrame = false;
   }
   inline void BeginRenderPass() noexcept;
+  inline void EndRenderPass() noexcept;
+  void ClearOnLoad(bool Color, bool Depth) noexcept {
+    if (Color)
+      ColorLoadOp = vk::AttachmentLoadOp::eClear;
+    if (Depth)
+      DepthLoadOp = vk::AttachmentLoadOp::eClear;
+  }
   inline void ResolveSurface(SurfaceAllocation *Surface,
                              bool Reattach) noexcept;
   inline void ResolveColorBinding(uint32_t Idx, rect2d Region,
@@ -305,29 +423,24 @@ public:
 };
 
 class DeletedBufferAllocation {
-  vk::Buffer Buffer;
-  VmaAllocation Allocation = VK_NULL_HANDLE;
+  BufferRecord *Record = nullptr;
 
 public:
   explicit DeletedBufferAllocation(BufferAllocation &&Obj) noexcept {
-    std::swap(Buffer, Obj.Buffer);
-    std::swap(Allocation, Obj.Allocation);
+    std::swap(Record, Obj.Record);
   }
   DeletedBufferAllocation &operator=(BufferAllocation &&Obj) noexcept {
-    std::swap(Buffer, Obj.Buffer);
-    std::swap(Allocation, Obj.Allocation);
+    std::swap(Record, Obj.Record);
     return *this;
   }
   DeletedBufferAllocation(const DeletedBufferAllocation &other) = delete;
   DeletedBufferAllocation &
   operator=(const DeletedBufferAllocation &other) = delete;
   DeletedBufferAllocation(DeletedBufferAllocation &&other) noexcept {
-    std::swap(Buffer, other.Buffer);
-    std::swap(Allocation, other.Allocation);
+    std::swap(Record, other.Record);
   }
   DeletedBufferAllocation &operator=(DeletedBufferAllocation &&other) noexcept {
-    std::swap(Buffer, other.Buffer);
-    std::swap(Allocation, other.Allocation);
+    std::swap(Record, other.Record);
     return *this;
   }
   inline ~DeletedBufferAllocation() noexcept;
@@ -361,17 +474,18 @@ public:
 class DeletedSurfaceAllocation {
   vk::UniqueSurfaceKHR Surface;
   vk::UniqueSwapchainKHR Swapchain;
-  vk::UniqueRenderPass OwnedRenderPass;
+  std::array<vk::UniqueRenderPass, NumRenderPassVariants> OwnedRenderPasses;
   std::function<void()> DeleterLambda;
 
 public:
   explicit DeletedSurfaceAllocation(SurfaceAllocation &&Obj) noexcept
       : Surface(std::move(Obj.Surface)), Swapchain(std::move(Obj.Swapchain)),
-        OwnedRenderPass(std::move(Obj.OwnedRenderPass)),
+        OwnedRenderPasses(std::move(Obj.OwnedRenderPasses)),
         DeleterLambda(std::move(Obj.DeleterLambda)) {}
 
   ~DeletedSurfaceAllocation() noexcept {
-    OwnedRenderPass.reset();
+    for (auto &RenderPass : OwnedRenderPasses)
+      RenderPass.reset();
     Swapchain.reset();
     Surface.reset();
     if (DeleterLambda)
@@ -451,41 +565,160 @@ public:
   operator=(DeletedRenderTextureAllocation &&other) noexcept = default;
 };
 
+class DeletedResidentTexture {
+  ResidentTexture *Record = nullptr;
+
+public:
+  explicit DeletedResidentTexture(ResidentTexture *Record) noexcept
+      : Record(Record) {}
+  DeletedResidentTexture(const DeletedResidentTexture &other) = delete;
+  DeletedResidentTexture &
+  operator=(const DeletedResidentTexture &other) = delete;
+  DeletedResidentTexture(DeletedResidentTexture &&other) noexcept {
+    std::swap(Record, other.Record);
+  }
+  DeletedResidentTexture &operator=(DeletedResidentTexture &&other) noexcept {
+    std::swap(Record, other.Record);
+    return *this;
+  }
+  inline ~DeletedResidentTexture() noexcept;
+};
+
+/* Resources may be released from any thread; the render thread purges. */
 class DeletedResources {
+  std::mutex Lock;
   std::vector<DeletedBufferAllocation> Buffers;
   std::vector<DeletedTextureAllocation> Textures;
+  std::vector<DeletedResidentTexture> ResidentTextures;
   std::vector<DeletedSurfaceAllocation> Surfaces;
   std::vector<DeletedSurfaceSwapchainImage> SwapchainImages;
   std::vector<DeletedRenderTextureAllocation> RenderTextures;
+  std::vector<vk::UniqueImageView> ImageViews;
+  std::vector<vk::UniqueFramebuffer> Framebuffers;
 
 public:
   void DeleteLater(BufferAllocation &&Obj) noexcept {
+    std::lock_guard<std::mutex> Guard(Lock);
     Buffers.emplace_back(std::move(Obj));
   }
   void DeleteLater(TextureAllocation &&Obj) noexcept {
+    std::lock_guard<std::mutex> Guard(Lock);
     Textures.emplace_back(std::move(Obj));
   }
+  void DeleteLater(ResidentTexture *Obj) noexcept {
+    std::lock_guard<std::mutex> Guard(Lock);
+    ResidentTextures.emplace_back(Obj);
+  }
   void DeleteLater(SurfaceAllocation &&Obj) noexcept {
+    std::lock_guard<std::mutex> Guard(Lock);
     Surfaces.emplace_back(std::move(Obj));
   }
   void DeleteLater(SurfaceAllocation::SwapchainImage &&Obj) noexcept {
+    std::lock_guard<std::mutex> Guard(Lock);
     SwapchainImages.emplace_back(std::move(Obj));
   }
   void DeleteLater(RenderTextureAllocation &&Obj) noexcept {
+    std::lock_guard<std::mutex> Guard(Lock);
     RenderTextures.emplace_back(std::move(Obj));
   }
+  void DeleteLater(vk::UniqueImageView &&Obj) noexcept {
+    std::lock_guard<std::mutex> Guard(Lock);
+    ImageViews.emplace_back(std::move(Obj));
+  }
+  void DeleteLater(vk::UniqueFramebuffer &&Obj) noexcept {
+    std::lock_guard<std::mutex> Guard(Lock);
+    Framebuffers.emplace_back(std::move(Obj));
+  }
   void Purge() noexcept {
-    Buffers.clear();
-    Textures.clear();
-    Surfaces.clear();
-    SwapchainImages.clear();
-    RenderTextures.clear();
+    /* Destroy outside the lock so destructors may release more resources */
+    decltype(Buffers) OldBuffers;
+    decltype(Textures) OldTextures;
+    decltype(ResidentTextures) OldResidentTextures;
+    decltype(Surfaces) OldSurfaces;
+    decltype(SwapchainImages) OldSwapchainImages;
+    decltype(RenderTextures) OldRenderTextures;
+    decltype(ImageViews) OldImageViews;
+    decltype(Framebuffers) OldFramebuffers;
+    std::lock_guard<std::mutex> Guard(Lock);
+    OldBuffers.swap(Buffers);
+    OldTextures.swap(Textures);
+    OldResidentTextures.swap(ResidentTextures);
+    OldSurfaces.swap(Surfaces);
+    OldSwapchainImages.swap(SwapchainImages);
+    OldRenderTextures.swap(RenderTextures);
+    OldImageViews.swap(ImageViews);
+    OldFramebuffers.swap(Framebuffers);
   }
   DeletedResources() noexcept = default;
   DeletedResources(const DeletedResources &) = delete;
   DeletedResources &operator=(const DeletedResources &) = delete;
 };
 
+/*
+ * Backing store for the variable-sized part of pipeline bindings. Slots are
+ * carved from large blocks and recycled through one free list per size
+ * class, so a binding only occupies what its pipeline uses.
+ */
+class BindingArena {
+public:
+  static constexpr std::size_t Granularity = 16;
+  static constexpr std::size_t BlockSize = 64 * 1024;
+
+private:
+  struct FreeSlot {
+    FreeSlot *Next;
+  };
+  std::mutex Lock;
+  std::vector<FreeSlot *> FreeLists;
+  std::vector<std::unique_ptr<unsigned char[]>> Blocks;
+  std::size_t BlockOffset = BlockSize;
+  std::size_t LiveBytes = 0;
+
+  static std::size_t SizeClass(std::size_t Size) noexcept {
+    return (Size + Granularity - 1) / Granularity;
+  }
+
+public:
+  void *Allocate(std::size_t Size) noexcept {
+    auto Class = SizeClass(Size);
+    auto Bytes = Class * Granularity;
+    assert(Bytes <= BlockSize && "binding resources too large");
+    std::lock_guard<std::mutex> Guard(Lock);
+    LiveBytes += Bytes;
+    if (Class < FreeLists.size() && FreeLists[Class]) {
+      auto *Slot = FreeLists[Class];
+      FreeLists[Class] = Slot->Next;
+      return Slot;
+    }
+    if (BlockOffset + Bytes > BlockSize) {
+      Blocks.emplace_back(new unsigned char[BlockSize]);
+      BlockOffset = 0;
+    }
+    void *Ret = Blocks.back().get() + BlockOffset;
+    BlockOffset += Bytes;
+    return Ret;
+  }
+
+  void Deallocate(void *Ptr, std::size_t Size) noexcept {
+    auto Class = SizeClass(Size);
+    std::lock_guard<std::mutex> Guard(Lock);
+    LiveBytes -= Class * Granularity;
+    if (Class >= FreeLists.size())
+      FreeLists.resize(Class + 1);
+    FreeLists[Class] = new (Ptr) FreeSlot{FreeLists[Class]};
+  }
+
+  std::size_t GetLiveBytes() noexcept {
+    std::lock_guard<std::mutex> Guard(Lock);
+    return LiveBytes;
+  }
+
+  std::size_t GetReservedBytes() noexcept {
+    std::lock_guard<std::mutex> Guard(Lock);
+    return Blocks.size() * BlockSize;
+  }
+};
+
 struct VulkanGlobals {
   vk::Instance Instance;
   vk::PhysicalDevice PhysDevice;
@@ -494,9 +727,12 @@ struct VulkanGlobals {
   vk::VmaPool UploadPool;
   uint8_t PipelineCacheUUID[VK_UUID_SIZE];
   vk::PipelineCache PipelineCache;
-  std::array<vk::DescriptorSetLayout, 64> DescriptorSetLayout;
-  vk::PipelineLayout PipelineLayout;
-  struct DescriptorPoolChain *DescriptorPoolChain = nullptr;
+  /* Totals over all createGraphicsPipelines calls */
+  uint64_t PipelineCreateCalls = 0;
+  uint64_t PipelinesCreated = 0;
+  uint64_t PipelineDerivativesCreated = 0;
+  std::chrono::nanoseconds PipelineCreateTime{};
+  struct DescriptorLayoutCache *DescriptorLayouts = nullptr;
   vk::Semaphore ImageAcquireSem;
   vk::Semaphore RenderCompleteSem;
   uint32_t QueueFamilyIdx = 0;
@@ -504,6 +740,8 @@ struct VulkanGlobals {
   vk::PipelineMultisampleStateCreateInfo MultisampleState{
       {}, vk::SampleCountFlagBits::e1};
   vk::RenderPass RenderPass, DirectRenderPass;
+  std::array<vk::RenderPass, NumRenderPassVariants> RenderPassVariants{};
+  bool RenderPassActive = false;
   float Anisotropy = 0.f;
   std::array<vk::CommandBuffer, 2> CommandBuffers;
   std::array<vk::Fence, 2> CommandFences;
@@ -511,6 +749,14 @@ struct VulkanGlobals {
   vk::Fence CmdFence;
   vk::CommandBuffer CopyCmd;
   vk::Fence CopyFence;
+  vk::CommandBuffer MaintenanceCmd;
+  vk::Fence MaintenanceFence;
+  class TransferQueue *Transfers = nullptr;
+  class BufferDefragmenter *Defragmenter = nullptr;
+  class MemoryBudget *Budget = nullptr;
+  class TextureResidency *Residency = nullptr;
+  BindingArena *BindingResources = nullptr;
+  std::atomic<std::thread::id> RenderThread;
   vk::Pipeline BoundPipeline;
   vk::DescriptorSet BoundDescriptorSet;
   RenderTextureAllocation *AttachedRenderTexture = nullptr;
@@ -518,8 +764,10 @@ struct VulkanGlobals {
   bool AcquiredImage = false;
 
   std::array<DeletedResources, 2> *DeletedResourcesArr;
-  DeletedResources *DeletedResources = nullptr;
+  std::atomic<class DeletedResources *> DeletedResources{nullptr};
   SurfaceAllocation *SurfaceHead = nullptr;
+  /* Render textures may be created and destroyed on any thread */
+  std::mutex RenderTextureLock;
   RenderTextureAllocation *RenderTextureHead = nullptr;
 
   void PreRender() noexcept {
@@ -527,13 +775,18 @@ struct VulkanGlobals {
     Cmd = CommandBuffers[CurBufferIdx];
     CmdFence = CommandFences[CurBufferIdx];
     Device.waitForFences(CmdFence, VK_TRUE, 500000000);
-    DeletedResources = &(*DeletedResourcesArr)[CurBufferIdx];
-    DeletedResources->Purge();
+    RenderThread.store(std::this_thread::get_id(), std::memory_order_relaxed);
+    auto *CurDeletedResources = &(*DeletedResourcesArr)[CurBufferIdx];
+    DeletedResources.store(CurDeletedResources);
+    CurDeletedResources->Purge();
 
     for (auto *Surf = SurfaceHead; Surf; Surf = Surf->GetNext())
       Surf->PreRender();
-    for (auto *RT = RenderTextureHead; RT; RT = RT->GetNext())
-      RT->PreRender();
+    {
+      std::lock_guard<std::mutex> Guard(RenderTextureLock);
+      for (auto *RT = RenderTextureHead; RT; RT = RT->GetNext())
+        RT->PreRender();
+    }
 
     CopyCmd.begin(vk::CommandBufferBeginInfo(
         vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
@@ -543,8 +796,8 @@ struct VulkanGlobals {
 
   void PostRender() noexcept {
     if (AttachedRenderTexture) {
+      AttachedRenderTexture->EndRenderPass();
       AttachedRenderTexture = nullptr;
-      Cmd.endRenderPass();
     }
     BoundPipeline = vk::Pipeline{};
     BoundDescriptorSet = vk::DescriptorSet{};
@@ -554,7 +807,9 @@ struct VulkanGlobals {
     vk::PipelineStageFlags pipeStageFlags =
         vk::PipelineStageFlagBits::eColorAttachmentOutput;
     Device.resetFences({CopyFence, CmdFence});
-    Queue.submit(vk::SubmitInfo(0, {}, &pipeStageFlags, 1, &CopyCmd),
+    const auto &CopyCmds = CollectTransfers();
+    Queue.submit(vk::SubmitInfo(0, {}, &pipeStageFlags, CopyCmds.size(),
+                                CopyCmds.data()),
                  CopyFence);
     Queue.submit(vk::SubmitInfo(AcquiredImage ? 1 : 0, &ImageAcquireSem,
                                 &pipeStageFlags, 1, &Cmd, AcquiredImage ? 1 : 0,
@@ -564,11 +819,32 @@ struct VulkanGlobals {
       Surf->PostRender();
     AcquiredImage = false;
     Device.waitForFences(CopyFence, VK_TRUE, 500000000);
+    RetireTransfers();
+    Defragment();
+    ManageResidency();
     ++Frame;
   }
 
-  void SetDescriptorSetLayout(vk::DescriptorSetLayout Layout) noexcept {
-    std::fill(DescriptorSetLayout.begin(), DescriptorSetLayout.end(), Layout);
+  inline const std::vector<vk::CommandBuffer> &CollectTransfers() noexcept;
+  inline void RetireTransfers() noexcept;
+  inline void Defragment() noexcept;
+  inline void ManageResidency() noexcept;
+
+  /* Runs MaintenanceCmd to completion after all earlier submissions */
+  void SubmitMaintenance() noexcept {
+    Device.resetFences(MaintenanceFence);
+    Queue.submit(vk::SubmitInfo(0, nullptr, nullptr, 1, &MaintenanceCmd),
+                 MaintenanceFence);
+    Device.waitForFences(MaintenanceFence, VK_TRUE, UINT64_MAX);
+  }
+
+  bool IsRenderThread() const noexcept {
+    return RenderThread.load(std::memory_order_relaxed) ==
+           std::this_thread::get_id();
+  }
+
+  template <typename T> void DeleteLater(T &&Obj) noexcept {
+    DeletedResources.load()->DeleteLater(std::move(Obj));
   }
 
   vk::RenderPass GetRenderPass() const noexcept {
@@ -576,6 +852,14 @@ struct VulkanGlobals {
     return RenderPass;
   }
 
+  vk::RenderPass
+  GetRenderPass(vk::AttachmentLoadOp ColorLoad, vk::AttachmentLoadOp DepthLoad,
+                vk::AttachmentStoreOp DepthStore) const noexcept {
+    assert(RenderPass && "No surfaces created yet");
+    return RenderPassVariants[RenderPassVariantIndex(ColorLoad, DepthLoad,
+                                                     DepthStore)];
+  }
+
   vk::RenderPass GetDirectRenderPass() const noexcept {
     assert(DirectRenderPass && "No surfaces created yet");
     return DirectRenderPass;
@@ -632,6 +916,542 @@ template <typename Mgr> inline void WritePipelineCache(Mgr &M) noexcept {
       Globals.PipelineCacheUUID);
 }
 
+/*
+ * Compacts device memory over long sessions. At the end of a frame VMA moves
+ * at most the configured number of bytes of static buffers with GPU copies;
+ * the moved buffers are then recreated over their new memory and bindings
+ * pick up the handles from their buffer records, rewriting descriptors the
+ * next time they are bound.
+ *
+ * VMA keeps its block vectors locked until vmaDefragmentationEnd, and the
+ * copies must not overtake earlier frames still reading the old memory, so
+ * each pass waits for its submission. Passes therefore only start when a
+ * periodic measurement finds fragmented memory, and continue on the
+ * following frames for as long as they make progress.
+ */
+class BufferDefragmenter {
+  /* Render thread only */
+  BufferRecord *Head = nullptr;
+  vk::DeviceSize BytesPerFrame = 0;
+  bool Continue = false;
+  uint32_t Epoch = 0;
+  std::vector<BufferRecord *> Records;
+  std::vector<VmaAllocation> Allocations;
+  std::vector<VkBool32> Changed;
+  uint64_t Passes = 0;
+  uint64_t BytesMoved = 0;
+  uint64_t AllocationsMoved = 0;
+  uint64_t BlocksFreed = 0;
+
+  static bool IsFragmented() noexcept {
+    VmaStats Stats;
+    vmaCalculateStats(Globals.Allocator, &Stats);
+    return Stats.total.unusedRangeCount > Stats.total.blockCount;
+  }
+
+  static void Relocate(BufferRecord *Record) noexcept {
+    Globals.Device.destroyBuffer(Record->Buffer);
+    Record->Buffer = Globals.Device
+                         .createBuffer(vk::BufferCreateInfo({}, Record->Size,
+                                                            Record->Usage))
+                         .value;
+    auto Result = vmaBindBufferMemory(Globals.Allocator, Record->Allocation,
+                                      Record->Buffer);
+    HSH_ASSERT_VK_SUCCESS(vk::Result(Result));
+    VmaAllocationInfo AllocInfo;
+    vmaGetAllocationInfo(Globals.Allocator, Record->Allocation, &AllocInfo);
+    Globals.SetDebugObjectName(static_cast<const char *>(AllocInfo.pUserData),
+                               Record->Buffer);
+  }
+
+public:
+  static constexpr uint64_t MeasureInterval = 64;
+
+  BufferDefragmenter() noexcept = default;
+  ~BufferDefragmenter() noexcept { Globals.Defragmenter = nullptr; }
+  BufferDefragmenter(const BufferDefragmenter &) = delete;
+  BufferDefragmenter &operator=(const BufferDefragmenter &) = delete;
+
+  void Link(BufferRecord *Record) noexcept {
+    assert(!Record->Movable);
+    Record->Movable = true;
+    Record->Prev = nullptr;
+    Record->Next = Head;
+    if (Head)
+      Head->Prev = Record;
+    Head = Record;
+  }
+
+  void Unlink(BufferRecord *Record) noexcept {
+    if (Record->Prev)
+      Record->Prev->Next = Record->Next;
+    else
+      Head = Record->Next;
+    if (Record->Next)
+      Record->Next->Prev = Record->Prev;
+    Record->Prev = Record->Next = nullptr;
+    Record->Movable = false;
+  }
+
+  void SetBudget(vk::DeviceSize Bytes) noexcept {
+    BytesPerFrame = Bytes;
+    Continue = false;
+  }
+
+  /* Advances whenever buffers move so bindings know to refresh */
+  uint32_t GetEpoch() const noexcept { return Epoch; }
+  uint64_t GetPasses() const noexcept { return Passes; }
+  uint64_t GetBytesMoved() const noexcept { return BytesMoved; }
+  uint64_t GetAllocationsMoved() const noexcept { return AllocationsMoved; }
+  uint64_t GetBlocksFreed() const noexcept { return BlocksFreed; }
+
+  void Step() noexcept {
+    if (!BytesPerFrame || !Head)
+      return;
+    if (!Continue &&
+        (Globals.Frame % MeasureInterval != 0 || !IsFragmented()))
+      return;
+
+    Records.clear();
+    Allocations.clear();
+    for (auto *Record = Head; Record; Record = Record->Next) {
+      Records.push_back(Record);
+      Allocations.push_back(Record->Allocation);
+    }
+    Changed.assign(Records.size(), VK_FALSE);
+
+    auto Cmd = Globals.MaintenanceCmd;
+    Cmd.begin(vk::CommandBufferBeginInfo(
+        vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+    Cmd.pipelineBarrier(
+        vk::PipelineStageFlagBits::eAllCommands,
+        vk::PipelineStageFlagBits::eTransfer, {},
+        vk::MemoryBarrier(vk::AccessFlagBits::eMemoryWrite,
+                          vk::AccessFlagBits::eTransferRead |
+                              vk::AccessFlagBits::eTransferWrite),
+        {}, {});
+
+    VmaDefragmentationInfo2 Info{};
+    Info.allocationCount = uint32_t(Allocations.size());
+    Info.pAllocations = Allocations.data();
+    Info.pAllocationsChanged = Changed.data();
+    /* CPU moves could overwrite memory that earlier frames still read */
+    Info.maxCpuBytesToMove = 0;
+    Info.maxCpuAllocationsToMove = 0;
+    Info.maxGpuBytesToMove = BytesPerFrame;
+    Info.maxGpuAllocationsToMove = UINT32_MAX;
+    Info.commandBuffer = Cmd;
+    VmaDefragmentationStats Stats{};
+    VmaDefragmentationContext Context = VK_NULL_HANDLE;
+    vmaDefragmentationBegin(Globals.Allocator, &Info, &Stats, &Context);
+
+    Cmd.pipelineBarrier(
+        vk::PipelineStageFlagBits::eTransfer,
+        vk::PipelineStageFlagBits::eAllCommands, {},
+        vk::MemoryBarrier(vk::AccessFlagBits::eTransferWrite,
+                          vk::AccessFlagBits::eMemoryRead |
+                              vk::AccessFlagBits::eMemoryWrite),
+        {}, {});
+    Cmd.end();
+    if (Context) {
+      Globals.SubmitMaintenance();
+      vmaDefragmentationEnd(Globals.Allocator, Context);
+    }
+
+    for (std::size_t i = 0; i < Records.size(); ++i)
+      if (Changed[i])
+        Relocate(Records[i]);
+
+    ++Passes;
+    BytesMoved += Stats.bytesMoved;
+    AllocationsMoved += Stats.allocationsMoved;
+    BlocksFreed += Stats.deviceMemoryBlocksFreed;
+    if (Stats.allocationsMoved)
+      ++Epoch;
+    Continue = Stats.allocationsMoved != 0;
+  }
+};
+
+/*
+ * Device-local usage and budget summed over VMA's per-heap figures. With
+ * VK_EXT_memory_budget these come from the driver and include other
+ * processes; otherwise VMA estimates them from the heap sizes.
+ */
+class MemoryBudget {
+  vk::DeviceSize Usage = 0;
+  vk::DeviceSize Budget = 0;
+
+public:
+  MemoryBudget() noexcept = default;
+  ~MemoryBudget() noexcept { Globals.Budget = nullptr; }
+  MemoryBudget(const MemoryBudget &) = delete;
+  MemoryBudget &operator=(const MemoryBudget &) = delete;
+
+  void Update() noexcept {
+    vmaSetCurrentFrameIndex(Globals.Allocator, uint32_t(Globals.Frame));
+    const VkPhysicalDeviceMemoryProperties *Props;
+    vmaGetMemoryProperties(Globals.Allocator, &Props);
+    std::array<VmaBudget, VK_MAX_MEMORY_HEAPS> Budgets;
+    vmaGetBudget(Globals.Allocator, Budgets.data());
+    Usage = Budget = 0;
+    for (uint32_t i = 0; i < Props->memoryHeapCount; ++i) {
+      if (Props->memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) {
+        Usage += Budgets[i].usage;
+        Budget += Budgets[i].budget;
+      }
+    }
+  }
+
+  vk::DeviceSize GetUsage() const noexcept { return Usage; }
+  vk::DeviceSize GetBudget() const noexcept { return Budget; }
+};
+
+/*
+ * Tracks when each static texture was last bound for drawing. While
+ * device-local usage is above the eviction threshold, textures that have
+ * gone cold lose their largest resident mip to a host copy; once usage
+ * falls below the restore threshold, evicted textures that are drawn with
+ * again get their mips uploaded back. Replacement images are created and
+ * filled by a maintenance submission that completes before the frame ends,
+ * and bindings rewrite their descriptors on the next bind.
+ */
+class TextureResidency {
+  /* Render thread only */
+  ResidentTexture *Head = nullptr;
+  float EvictFraction = 0.9f;
+  float RestoreFraction = 0.8f;
+  uint64_t ColdFrames = 300;
+  uint32_t NumEvicted = 0;
+  vk::DeviceSize EvictedBytes = 0;
+  uint64_t Evictions = 0;
+  uint64_t Restorations = 0;
+  std::vector<ResidentTexture *> Evict;
+  std::vector<ResidentTexture *> Restore;
+  std::vector<TextureAllocation> Replacements;
+  std::vector<vk::ImageMemoryBarrier> Barriers;
+
+  inline void Replace() noexcept;
+
+public:
+  /* Bounds the work and the stall of a single frame */
+  static constexpr std::size_t MaxTexturesPerFrame = 16;
+
+  TextureResidency() noexcept = default;
+  ~TextureResidency() noexcept { Globals.Residency = nullptr; }
+  TextureResidency(const TextureResidency &) = delete;
+  TextureResidency &operator=(const TextureResidency &) = delete;
+
+  void Link(ResidentTexture *Record) noexcept {
+    assert(!Record->Tracked);
+    Record->Tracked = true;
+    Record->LastUsedFrame = Globals.Frame;
+    Record->Prev = nullptr;
+    Record->Next = Head;
+    if (Head)
+      Head->Prev = Record;
+    Head = Record;
+  }
+
+  void Unlink(ResidentTexture *Record) noexcept {
+    if (Record->Prev)
+      Record->Prev->Next = Record->Next;
+    else
+      Head = Record->Next;
+    if (Record->Next)
+      Record->Next->Prev = Record->Prev;
+    Record->Prev = Record->Next = nullptr;
+    Record->Tracked = false;
+    if (Record->FirstMip) {
+      --NumEvicted;
+      for (uint32_t i = 0; i < Record->FirstMip; ++i)
+        EvictedBytes -= Record->MipSize(i);
+    }
+  }
+
+  void SetLimits(float Evict, float Restore, uint64_t Cold) noexcept {
+    EvictFraction = Evict;
+    RestoreFraction = Restore;
+    ColdFrames = Cold;
+  }
+
+  uint32_t GetNumEvicted() const noexcept { return NumEvicted; }
+  vk::DeviceSize GetEvictedBytes() const noexcept { return EvictedBytes; }
+  uint64_t GetEvictions() const noexcept { return Evictions; }
+  uint64_t GetRestorations() const noexcept { return Restorations; }
+
+  void Step() noexcept {
+    auto Usage = Globals.Budget->GetUsage();
+    auto Budget = Globals.Budget->GetBudget();
+    if (!Head || !Budget)
+      return;
+    Evict.clear();
+    Restore.clear();
+    auto Frame = Globals.Frame;
+    auto EvictAbove = vk::DeviceSize(double(Budget) * EvictFraction);
+    auto RestoreBelow = vk::DeviceSize(double(Budget) * RestoreFraction);
+    if (Usage > EvictAbove) {
+      for (auto *R = Head; R; R = R->Next)
+        if (R->LastUsedFrame + ColdFrames < Frame && R->NumResidentMips() > 1)
+          Evict.push_back(R);
+      std::sort(Evict.begin(), Evict.end(), [](auto *A, auto *B) {
+        return A->LastUsedFrame < B->LastUsedFrame;
+      });
+      vk::DeviceSize Freed = 0;
+      std::size_t Count = 0;
+      while (Count < Evict.size() && Count < MaxTexturesPerFrame &&
+             Freed + EvictAbove < Usage) {
+        auto *R = Evict[Count++];
+        Freed += R->MipSize(R->FirstMip);
+      }
+      Evict.resize(Count);
+    } else if (NumEvicted && Usage < RestoreBelow) {
+      auto Headroom = RestoreBelow - Usage;
+      for (auto *R = Head; R && Restore.size() < MaxTexturesPerFrame;
+           R = R->Next) {
+        if (!R->FirstMip || R->LastUsedFrame != Frame)
+          continue;
+        vk::DeviceSize Needed = 0;
+        for (uint32_t i = 0; i < R->FirstMip; ++i)
+          Needed += R->MipSize(i);
+        if (Needed > Headroom)
+          continue;
+        Headroom -= Needed;
+        Restore.push_back(R);
+      }
+    }
+    if (!Evict.empty() || !Restore.empty())
+      Replace();
+  }
+};
+
+/*
+ * Resources created off the render thread record their upload copies into
+ * command buffers from a pool owned by the creating thread. Finished
+ * recordings are pushed onto a lock-free queue that the render thread
+ * submits with its own copy commands; once that submission completes, the
+ * upload buffers are released and the command buffers returned to the pool.
+ */
+template <typename T> class AtomicStack {
+  std::atomic<T *> Head{nullptr};
+
+public:
+  void Push(T *Node) noexcept {
+    T *OldHead = Head.load(std::memory_order_relaxed);
+    do
+      Node->Next = OldHead;
+    while (!Head.compare_exchange_weak(OldHead, Node,
+                                       std::memory_order_release,
+                                       std::memory_order_relaxed));
+  }
+  /* Only whole-stack removal is supported, which avoids the ABA problem. */
+  T *TakeAll() noexcept {
+    return Head.exchange(nullptr, std::memory_order_acquire);
+  }
+};
+
+/* What an upload fills; handed to its manager once the copy has executed */
+struct UploadTarget {
+  BufferRecord *Buffer = nullptr;
+  ResidentTexture *Texture = nullptr;
+  void Track() noexcept {
+    if (Buffer)
+      Globals.Defragmenter->Link(Buffer);
+    if (Texture)
+      Globals.Residency->Link(Texture);
+  }
+};
+
+struct TransferContext;
+
+struct PendingTransfer {
+  PendingTransfer *Next = nullptr;
+  TransferContext *Context;
+  vk::CommandBuffer Cmd;
+  UploadBufferAllocation UploadBuffer;
+  UploadTarget Target;
+  explicit PendingTransfer(TransferContext *Context,
+                           vk::CommandBuffer Cmd) noexcept
+      : Context(Context), Cmd(Cmd) {}
+};
+
+struct TransferContext {
+  vk::UniqueCommandPool CommandPool;
+  /* Only touched by the thread currently owning the context */
+  std::vector<std::unique_ptr<PendingTransfer>> Transfers;
+  std::vector<PendingTransfer *> FreeTransfers;
+  /* Handed back by the render thread */
+  AtomicStack<PendingTransfer> Retired;
+
+  TransferContext() noexcept
+      : CommandPool(Globals.Device
+                        .createCommandPoolUnique(vk::CommandPoolCreateInfo(
+                            vk::CommandPoolCreateFlagBits::eTransient |
+                                vk::CommandPoolCreateFlagBits::
+                                    eResetCommandBuffer,
+                            Globals.QueueFamilyIdx))
+                        .value) {}
+
+  inline PendingTransfer *Begin() noexcept;
+  inline void End(PendingTransfer *Transfer,
+                  UploadBufferAllocation &&UploadBuffer,
+                  UploadTarget Target) noexcept;
+};
+
+class TransferQueue {
+  /* Tells the contexts cached by threads apart from those of a queue that
+     was destroyed when the device was recreated. */
+  static inline std::atomic<uint64_t> NextGeneration{1};
+  const uint64_t Generation = NextGeneration.fetch_add(1);
+
+  AtomicStack<PendingTransfer> Submitted;
+  /* Render thread only */
+  PendingTransfer *InFlight = nullptr;
+  std::vector<vk::CommandBuffer> CommandBuffers;
+
+  std::mutex ContextLock;
+  std::vector<std::unique_ptr<TransferContext>> Contexts;
+  std::vector<TransferContext *> IdleContexts;
+
+public:
+  TransferQueue() noexcept = default;
+  ~TransferQueue() noexcept { Globals.Transfers = nullptr; }
+  TransferQueue(const TransferQueue &) = delete;
+  TransferQueue &operator=(const TransferQueue &) = delete;
+
+  uint64_t GetGeneration() const noexcept { return Generation; }
+
+  TransferContext *AcquireContext() noexcept {
+    std::lock_guard<std::mutex> Guard(ContextLock);
+    if (!IdleContexts.empty()) {
+      auto *Ret = IdleContexts.back();
+      IdleContexts.pop_back();
+      return Ret;
+    }
+    return Contexts.emplace_back(std::make_unique<TransferContext>()).get();
+  }
+
+  void ReleaseContext(TransferContext *Context) noexcept {
+    std::lock_guard<std::mutex> Guard(ContextLock);
+    IdleContexts.push_back(Context);
+  }
+
+  void Submit(PendingTransfer *Transfer) noexcept { Submitted.Push(Transfer); }
+
+  const std::vector<vk::CommandBuffer> &
+  Collect(vk::CommandBuffer CopyCmd) noexcept {
+    assert(!InFlight && "previous transfers not retired");
+    CommandBuffers.clear();
+    InFlight = Submitted.TakeAll();
+    for (auto *T = InFlight; T; T = T->Next)
+      CommandBuffers.push_back(T->Cmd);
+    CommandBuffers.push_back(CopyCmd);
+    return CommandBuffers;
+  }
+
+  void Retire() noexcept {
+    for (auto *T = InFlight; T;) {
+      auto *Next = T->Next;
+      T->UploadBuffer = UploadBufferAllocation{};
+      T->Target.Track();
+      T->Target = UploadTarget{};
+      T->Context->Retired.Push(T);
+      T = Next;
+    }
+    InFlight = nullptr;
+  }
+};
+
+PendingTransfer *TransferContext::Begin() noexcept {
+  for (auto *T = Retired.TakeAll(); T; T = T->Next)
+    FreeTransfers.push_back(T);
+  if (FreeTransfers.empty()) {
+    vk::CommandBufferAllocateInfo AllocateInfo(
+        CommandPool.get(), vk::CommandBufferLevel::ePrimary, 1);
+    vk::CommandBuffer Cmd;
+    HSH_ASSERT_VK_SUCCESS(
+        Globals.Device.allocateCommandBuffers(&AllocateInfo, &Cmd));
+    FreeTransfers.push_back(
+        Transfers.emplace_back(std::make_unique<PendingTransfer>(this, Cmd))
+            .get());
+  }
+  auto *Transfer = FreeTransfers.back();
+  FreeTransfers.pop_back();
+  Transfer->Cmd.begin(vk::CommandBufferBeginInfo(
+      vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+  return Transfer;
+}
+
+void TransferContext::End(PendingTransfer *Transfer,
+                          UploadBufferAllocation &&UploadBuffer,
+                          UploadTarget Target) noexcept {
+  Transfer->Cmd.end();
+  Transfer->UploadBuffer = std::move(UploadBuffer);
+  Transfer->Target = Target;
+  Globals.Transfers->Submit(Transfer);
+}
+
+/*
+ * Returns the calling thread's context to the idle list when it exits. The
+ * context belongs to the TransferQueue of the generation it was acquired
+ * from; once that queue is destroyed along with its device, the context is
+ * gone and the thread acquires a new one from the current queue.
+ */
+struct ThreadTransferContext {
+  TransferContext *Context = nullptr;
+  uint64_t Generation = 0;
+  bool IsCurrent() const noexcept {
+    return Context && Globals.Transfers &&
+           Globals.Transfers->GetGeneration() == Generation;
+  }
+  ~ThreadTransferContext() noexcept {
+    if (IsCurrent())
+      Globals.Transfers->ReleaseContext(Context);
+  }
+};
+
+inline TransferContext &GetThreadTransferContext() noexcept {
+  thread_local ThreadTransferContext ThreadContext;
+  if (!ThreadContext.IsCurrent()) {
+    ThreadContext.Context = Globals.Transfers->AcquireContext();
+    ThreadContext.Generation = Globals.Transfers->GetGeneration();
+  }
+  return *ThreadContext.Context;
+}
+
+/*
+ * Records upload copies with F(CommandBuffer, vk::Buffer Upload). The render
+ * thread records straight into the frame's copy command buffer. The Target
+ * is handed to the defragmenter and residency manager once nothing pending
+ * refers to its current handles.
+ */
+template <typename Func>
+inline void RecordUpload(UploadBufferAllocation &&UploadBuffer, Func F,
+                         UploadTarget Target = {}) noexcept {
+  if (Globals.IsRenderThread()) {
+    F(Globals.CopyCmd, UploadBuffer.GetBuffer());
+    Target.Track();
+    return;
+  }
+  auto &Context = GetThreadTransferContext();
+  auto *Transfer = Context.Begin();
+  F(Transfer->Cmd, UploadBuffer.GetBuffer());
+  Context.End(Transfer, std::move(UploadBuffer), Target);
+}
+
+const std::vector<vk::CommandBuffer> &
+VulkanGlobals::CollectTransfers() noexcept {
+  return Transfers->Collect(CopyCmd);
+}
+
+void VulkanGlobals::RetireTransfers() noexcept { Transfers->Retire(); }
+
+void VulkanGlobals::Defragment() noexcept { Defragmenter->Step(); }
+
+void VulkanGlobals::ManageResidency() noexcept {
+  Budget->Update();
+  Residency->Step();
+}
+
 inline vk::Viewport
 SurfaceAllocation::ProcessMargins(vk::Viewport vp) noexcept {
   vp.x += MarginL;
@@ -805,7 +1625,9 @@ void SurfaceAllocation::DrawDecorations() noexcept {
     Globals.Cmd.setViewport(
         0, vk::Viewport(0.f, 0.f, Extent.width, Extent.height, 0.f, 1.f));
     Globals.Cmd.setScissor(0, vk::Rect2D({}, {Extent.width, Extent.height}));
+    Globals.RenderPassActive = true;
     DecorationLambda();
+    Globals.RenderPassActive = false;
     Globals.Cmd.endRenderPass();
     Globals.Cmd.pipelineBarrier(
         vk::PipelineStageFlagBits::eColorAttachmentOutput,
@@ -838,44 +1660,59 @@ void SurfaceAllocation::DrawDecorations() noexcept {
 }
 
 BufferAllocation::~BufferAllocation() noexcept {
-  if (Buffer)
-    Globals.DeletedResources->DeleteLater(std::move(*this));
+  if (Record)
+    Globals.DeleteLater(std::move(*this));
 }
 
 DeletedBufferAllocation::~DeletedBufferAllocation() noexcept {
-  vmaDestroyBuffer(Globals.Allocator, Buffer, Allocation);
+  if (!Record)
+    return;
+  if (Record->Movable)
+    Globals.Defragmenter->Unlink(Record);
+  vmaDestroyBuffer(Globals.Allocator, Record->Buffer, Record->Allocation);
+  delete Record;
 }
 
 TextureAllocation::~TextureAllocation() noexcept {
   if (Image)
-    Globals.DeletedResources->DeleteLater(std::move(*this));
+    Globals.DeleteLater(std::move(*this));
 }
 
 DeletedTextureAllocation::~DeletedTextureAllocation() noexcept {
   vmaDestroyImage(Globals.Allocator, Image, Allocation);
 }
 
+DeletedResidentTexture::~DeletedResidentTexture() noexcept {
+  if (!Record)
+    return;
+  if (Record->Tracked)
+    Globals.Residency->Unlink(Record);
+  delete Record;
+}
+
 SurfaceAllocation::~SurfaceAllocation() noexcept {
-  if (OwnedRenderPass) {
+  if (OwnedRenderPasses[0]) {
     if (Prev)
-      Prev->OwnedRenderPass = std::move(OwnedRenderPass);
+      Prev->OwnedRenderPasses = std::move(OwnedRenderPasses);
     else if (Next)
-      Next->OwnedRenderPass = std::move(OwnedRenderPass);
+      Next->OwnedRenderPasses = std::move(OwnedRenderPasses);
   }
   if (Prev) {
     Prev->Next = Next;
   } else {
     Globals.SurfaceHead = Next;
-    if (!Globals.SurfaceHead)
+    if (!Globals.SurfaceHead) {
       Globals.RenderPass = vk::RenderPass{};
+      Globals.RenderPassVariants = {};
+    }
   }
   if (Next)
     Next->Prev = Prev;
-  Globals.DeletedResources->DeleteLater(std::move(*this));
+  Globals.DeleteLater(std::move(*this));
 }
 
 SurfaceAllocation::SwapchainImage::~SwapchainImage() noexcept {
-  Globals.DeletedResources->DeleteLater(std::move(*this));
+  Globals.DeleteLater(std::move(*this));
 }
 
 SurfaceAllocation::SurfaceAllocation(
@@ -912,8 +1749,10 @@ SurfaceAllocation::SurfaceAllocation(
           0, vk::ImageLayout::eColorAttachmentOptimal};
       vk::AttachmentReference DepthRef{
           1, vk::ImageLayout::eDepthStencilAttachmentOptimal};
-      constexpr RenderPassCreateInfo(vk::Format colorFormat,
-                                     vk::SampleCountFlagBits samples) noexcept
+      constexpr RenderPassCreateInfo(
+          vk::Format colorFormat, vk::SampleCountFlagBits samples,
+          vk::AttachmentLoadOp colorLoad, vk::AttachmentLoadOp depthLoad,
+          vk::AttachmentStoreOp depthStore) noexcept
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wuninitialized"
           : vk::RenderPassCreateInfo({}, Attachments.size(), Attachments.data(),
@@ -921,15 +1760,14 @@ SurfaceAllocation::SurfaceAllocation(
 #pragma GCC diagnostic pop
             Attachments{
                 vk::AttachmentDescription(
-                    {}, colorFormat, samples, vk::AttachmentLoadOp::eLoad,
+                    {}, colorFormat, samples, colorLoad,
                     vk::AttachmentStoreOp::eStore,
                     vk::AttachmentLoadOp::eDontCare,
                     vk::AttachmentStoreOp::eDontCare,
                     vk::ImageLayout::eColorAttachmentOptimal,
                     vk::ImageLayout::eColorAttachmentOptimal),
                 vk::AttachmentDescription(
-                    {}, vk::Format::eD32Sfloat, samples,
-                    vk::AttachmentLoadOp::eLoad, vk::AttachmentStoreOp::eStore,
+                    {}, vk::Format::eD32Sfloat, samples, depthLoad, depthStore,
                     vk::AttachmentLoadOp::eDontCare,
                     vk::AttachmentStoreOp::eDontCare,
                     vk::ImageLayout::eDepthStencilAttachmentOptimal,
@@ -939,14 +1777,32 @@ SurfaceAllocation::SurfaceAllocation(
                                        {}, 1, &ColorRef, {}, &DepthRef)} {
       }
     };
-    OwnedRenderPass = Globals.Device
-                          .createRenderPassUnique(RenderPassCreateInfo(
-                              GetColorFormat(),
-                              Globals.MultisampleState.rasterizationSamples))
-                          .value;
-    Globals.SetDebugObjectName(location.with_field("OwnedRenderPass"),
-                               OwnedRenderPass.get());
-    Globals.RenderPass = OwnedRenderPass.get();
+    constexpr vk::AttachmentLoadOp LoadOps[] = {
+        vk::AttachmentLoadOp::eLoad, vk::AttachmentLoadOp::eClear,
+        vk::AttachmentLoadOp::eDontCare};
+    constexpr vk::AttachmentStoreOp StoreOps[] = {
+        vk::AttachmentStoreOp::eStore, vk::AttachmentStoreOp::eDontCare};
+    for (auto ColorLoad : LoadOps) {
+      for (auto DepthLoad : LoadOps) {
+        for (auto DepthStore : StoreOps) {
+          auto Idx = RenderPassVariantIndex(ColorLoad, DepthLoad, DepthStore);
+          OwnedRenderPasses[Idx] =
+              Globals.Device
+                  .createRenderPassUnique(RenderPassCreateInfo(
+                      GetColorFormat(),
+                      Globals.MultisampleState.rasterizationSamples, ColorLoad,
+                      DepthLoad, DepthStore))
+                  .value;
+          Globals.SetDebugObjectName(
+              location.with_field("OwnedRenderPasses", Idx),
+              OwnedRenderPasses[Idx].get());
+          Globals.RenderPassVariants[Idx] = OwnedRenderPasses[Idx].get();
+        }
+      }
+    }
+    Globals.RenderPass = Globals.RenderPassVariants[RenderPassVariantIndex(
+        vk::AttachmentLoadOp::eLoad, vk::AttachmentLoadOp::eLoad,
+        vk::AttachmentStoreOp::eStore)];
 
     struct DirectRenderPassCreateInfo : vk::RenderPassCreateInfo {
       std::array<vk::AttachmentDescription, 1> Attachments;
@@ -984,45 +1840,52 @@ SurfaceAllocation::SurfaceAllocation(
 }
 
 RenderTextureAllocation::~RenderTextureAllocation() noexcept {
-  if (Prev)
-    Prev->Next = Next;
-  else
-    Globals.RenderTextureHead = Next;
+  {
+    std::lock_guard<std::mutex> Guard(Globals.RenderTextureLock);
+    if (Prev)
+      Prev->Next = Next;
+    else
+      Globals.RenderTextureHead = Next;
+    if (Next)
+      Next->Prev = Prev;
+  }
+  Globals.DeleteLater(std::move(*this));
+}
+
+void RenderTextureAllocation::Link() noexcept {
+  std::lock_guard<std::mutex> Guard(Globals.RenderTextureLock);
+  Next = Globals.RenderTextureHead;
+  Globals.RenderTextureHead = this;
   if (Next)
-    Next->Prev = Prev;
-  Globals.DeletedResources->DeleteLater(std::move(*this));
+    Next->Prev = this;
 }
 
 RenderTextureAllocation::RenderTextureAllocation(
     const SourceLocation &location, SurfaceAllocation *Surface,
     uint32_t NumColorBindings, uint32_t NumDepthBindings) noexcept
-    : Next(Globals.RenderTextureHead), Location(location), Surface(Surface),
-      NumColorBindings(NumColorBindings), NumDepthBindings(NumDepthBindings) {
-  Globals.RenderTextureHead = this;
-  if (Next)
-    Next->Prev = this;
+    : Location(location), Surface(Surface), NumColorBindings(NumColorBindings),
+      NumDepthBindings(NumDepthBindings) {
   assert(Surface);
   assert(NumColorBindings <= MaxRenderTextureBindings);
   assert(NumDepthBindings <= MaxRenderTextureBindings);
+  Link();
 }
 
 RenderTextureAllocation::RenderTextureAllocation(
     const SourceLocation &location, extent2d extent, vk::Format colorFormat,
     uint32_t NumColorBindings, uint32_t NumDepthBindings) noexcept
-    : Next(Globals.RenderTextureHead), Location(location), Extent(extent),
-      ColorFormat(colorFormat), NumColorBindings(NumColorBindings),
-      NumDepthBindings(NumDepthBindings) {
-  Globals.RenderTextureHead = this;
-  if (Next)
-    Next->Prev = this;
+    : Location(location), Extent(extent), ColorFormat(colorFormat),
+      NumColorBindings(NumColorBindings), NumDepthBindings(NumDepthBindings) {
   assert(NumColorBindings <= MaxRenderTextureBindings);
   assert(NumDepthBindings <= MaxRenderTextureBindings);
   Prepare();
+  /* Only linked once prepared, as PreRender may look at it right away */
+  Link();
 }
 
 void DynamicBufferAllocation::Unmap() noexcept {
   Globals.CopyCmd.copyBuffer(UploadBuffer.GetBuffer(), GetBuffer(),
-                             vk::BufferCopy{0, 0, Size});
+                             vk::BufferCopy{0, 0, Record->Size});
 }
 } // namespace hsh::detail::vulkan
 
@@ -1069,37 +1932,73 @@ void ObjectDestroy<VmaAllocator, VULKAN_HPP_DEFAULT_DISPATCHER_TYPE>::destroy(
 
 namespace hsh::detail::vulkan {
 
+/* Counts of each descriptor type bound by a pipeline. Pipelines with equal
+ * signatures share one descriptor set layout, pipeline layout and pool chain.
+ * Binding numbers stay at the offsets the shaders are compiled with
+ * (uniforms, then MaxUniforms + images, then MaxUniforms + MaxImages +
+ * samplers); the layout simply omits the unused ones. */
+struct DescriptorSignature {
+  uint32_t NumUniforms = 0;
+  uint32_t NumImages = 0;
+  uint32_t NumSamplers = 0;
+  constexpr DescriptorSignature() noexcept = default;
+  /* Pools must reserve at least one descriptor, so a pipeline without any
+   * resources gets a single (never written) uniform binding. */
+  constexpr DescriptorSignature(uint32_t NumUniforms, uint32_t NumImages,
+                                uint32_t NumSamplers) noexcept
+      : NumUniforms((NumUniforms | NumImages | NumSamplers) ? NumUniforms
+                                                            : 1),
+        NumImages(NumImages), NumSamplers(NumSamplers) {
+    assert(NumUniforms <= MaxUniforms && "too many uniforms");
+    assert(NumImages <= MaxImages && "too many images");
+    assert(NumSamplers <= MaxSamplers && "too many samplers");
+  }
+  constexpr uint32_t NumDescriptors() const noexcept {
+    return NumUniforms + NumImages + NumSamplers;
+  }
+  constexpr bool operator==(const DescriptorSignature &Other) const noexcept {
+    return NumUniforms == Other.NumUniforms && NumImages == Other.NumImages &&
+           NumSamplers == Other.NumSamplers;
+  }
+};
+
 struct DescriptorPoolCreateInfo : vk::DescriptorPoolCreateInfo {
-  std::array<vk::DescriptorPoolSize, 3> PoolSizes{
-      vk::DescriptorPoolSize{vk::DescriptorType::eUniformBufferDynamic,
-                             MaxUniforms *MaxDescriptorPoolSets},
-      vk::DescriptorPoolSize{vk::DescriptorType::eSampledImage,
-                             MaxImages *MaxDescriptorPoolSets},
-      vk::DescriptorPoolSize{vk::DescriptorType::eSampler,
-                             MaxSamplers *MaxDescriptorPoolSets}};
-  constexpr DescriptorPoolCreateInfo() noexcept
+  std::array<vk::DescriptorPoolSize, 3> PoolSizes;
+  explicit DescriptorPoolCreateInfo(DescriptorSignature Signature) noexcept
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wuninitialized"
-      : vk::DescriptorPoolCreateInfo({}, MaxDescriptorPoolSets,
-                                     PoolSizes.size(), PoolSizes.data()) {
-  }
+      : vk::DescriptorPoolCreateInfo({}, MaxDescriptorPoolSets, 0,
+                                     PoolSizes.data()) {
 #pragma GCC diagnostic pop
+    auto AddSize = [&](vk::DescriptorType Type, uint32_t Count) {
+      if (Count)
+        PoolSizes[poolSizeCount++] =
+            vk::DescriptorPoolSize{Type, Count * MaxDescriptorPoolSets};
+    };
+    AddSize(vk::DescriptorType::eUniformBuffer, Signature.NumUniforms);
+    AddSize(vk::DescriptorType::eSampledImage, Signature.NumImages);
+    AddSize(vk::DescriptorType::eSampler, Signature.NumSamplers);
+  }
 };
 struct UniqueDescriptorSet {
   vk::DescriptorSet Set;
   std::uint64_t Index = UINT64_MAX;
+  struct DescriptorPoolChain *Chain = nullptr;
   UniqueDescriptorSet() noexcept = default;
-  UniqueDescriptorSet(vk::DescriptorSet Set, std::size_t Index) noexcept
-      : Set(Set), Index(Index) {}
+  UniqueDescriptorSet(vk::DescriptorSet Set, std::size_t Index,
+                      struct DescriptorPoolChain *Chain) noexcept
+      : Set(Set), Index(Index), Chain(Chain) {}
   UniqueDescriptorSet(const UniqueDescriptorSet &) = delete;
   UniqueDescriptorSet &operator=(const UniqueDescriptorSet &) = delete;
   UniqueDescriptorSet(UniqueDescriptorSet &&Other) noexcept {
     Set = Other.Set;
     std::swap(Index, Other.Index);
+    std::swap(Chain, Other.Chain);
   }
   UniqueDescriptorSet &operator=(UniqueDescriptorSet &&Other) noexcept {
     Set = Other.Set;
     std::swap(Index, Other.Index);
+    std::swap(Chain, Other.Chain);
     return *this;
   }
   operator vk::DescriptorSet() const noexcept { return Set; }
@@ -1107,51 +2006,66 @@ struct UniqueDescriptorSet {
   inline ~UniqueDescriptorSet() noexcept;
 };
 
+/* Pools of descriptor sets of a single layout. */
 struct DescriptorPoolChain {
+  DescriptorSignature Signature;
+  /* Layout replicated for allocating whole buckets at once */
+  std::array<vk::DescriptorSetLayout, 64> SetLayouts;
+  DescriptorPoolChain(DescriptorSignature Signature,
+                      vk::DescriptorSetLayout Layout) noexcept
+      : Signature(Signature) {
+    SetLayouts.fill(Layout);
+  }
+  DescriptorPoolChain(const DescriptorPoolChain &) = delete;
+  DescriptorPoolChain &operator=(const DescriptorPoolChain &) = delete;
+
   struct DescriptorPool {
     vk::UniqueDescriptorPool Pool;
     std::size_t AllocatedSets = 0;
     static_assert(MaxDescriptorPoolSets % 64 == 0);
     std::array<uint64_t, MaxDescriptorPoolSets / 64> Bitmap{};
-    DescriptorPool() noexcept {
-      Pool =
-          Globals.Device.createDescriptorPoolUnique(DescriptorPoolCreateInfo())
-              .value;
+    explicit DescriptorPool(DescriptorSignature Signature) noexcept {
+      Pool = Globals.Device
+                 .createDescriptorPoolUnique(
+                     DescriptorPoolCreateInfo(Signature))
+                 .value;
     }
     struct DescriptorBucket {
       std::array<vk::DescriptorSet, 64> DescriptorSets;
-      UniqueDescriptorSet Allocate(struct DescriptorPool &pool, uint64_t &bmp,
+      UniqueDescriptorSet Allocate(struct DescriptorPoolChain &chain,
+                                   struct DescriptorPool &pool, uint64_t &bmp,
                                    std::size_t Index) noexcept {
         assert(bmp != UINT64_MAX && "descriptor bucket full");
         if (!DescriptorSets[0]) {
           struct DescriptorSetAllocateInfo
               : public vk::DescriptorSetAllocateInfo {
             explicit constexpr DescriptorSetAllocateInfo(
-                vk::DescriptorPool pool) noexcept
-                : vk::DescriptorSetAllocateInfo(
-                      pool, 64, Globals.DescriptorSetLayout.data()) {}
-          } AllocateInfo(pool.Pool.get());
+                vk::DescriptorPool pool,
+                const vk::DescriptorSetLayout *Layouts) noexcept
+                : vk::DescriptorSetAllocateInfo(pool, 64, Layouts) {}
+          } AllocateInfo(pool.Pool.get(), chain.SetLayouts.data());
           auto Result = Globals.Device.allocateDescriptorSets(
               &AllocateInfo, DescriptorSets.data());
           HSH_ASSERT_VK_SUCCESS(Result);
         }
         for (unsigned i = 0; i < 64; ++i) {
-          if ((bmp & (1u << i)) == 0) {
-            bmp |= (1u << i);
-            return UniqueDescriptorSet(DescriptorSets[i], Index + i);
+          if ((bmp & (1ull << i)) == 0) {
+            bmp |= (1ull << i);
+            return UniqueDescriptorSet(DescriptorSets[i], Index + i, &chain);
           }
         }
         return {};
       }
     };
     std::array<DescriptorBucket, MaxDescriptorPoolSets / 64> Buckets;
-    UniqueDescriptorSet Allocate(std::size_t Index) noexcept {
+    UniqueDescriptorSet Allocate(struct DescriptorPoolChain &chain,
+                                 std::size_t Index) noexcept {
       assert(AllocatedSets < MaxDescriptorPoolSets && "descriptor pool full");
       auto BucketsIt = Buckets.begin();
       for (uint64_t &bmp : Bitmap) {
         if (bmp != UINT64_MAX) {
           ++AllocatedSets;
-          return BucketsIt->Allocate(*this, bmp, Index);
+          return BucketsIt->Allocate(chain, *this, bmp, Index);
         }
         Index += 64;
         ++BucketsIt;
@@ -1172,10 +2086,10 @@ struct DescriptorPoolChain {
     std::size_t Index = 0;
     for (auto &pool : Chain) {
       if (pool.AllocatedSets != MaxDescriptorPoolSets)
-        return pool.Allocate(Index);
+        return pool.Allocate(*this, Index);
       Index += MaxDescriptorPoolSets;
     }
-    return Chain.emplace_back().Allocate(Index);
+    return Chain.emplace_back(Signature).Allocate(*this, Index);
   }
   void Free(std::size_t Index) noexcept {
     auto PoolIdx = Index / MaxDescriptorPoolSets;
@@ -1184,13 +2098,47 @@ struct DescriptorPoolChain {
     std::advance(PoolIt, PoolIdx);
     PoolIt->Free(PoolRem);
   }
+  /* Descriptors reserved by the pools created so far */
+  std::size_t ReservedDescriptors() const noexcept {
+    return Chain.size() * MaxDescriptorPoolSets * Signature.NumDescriptors();
+  }
 };
 
 UniqueDescriptorSet::~UniqueDescriptorSet() noexcept {
   if (Index != UINT64_MAX)
-    Globals.DescriptorPoolChain->Free(Index);
+    Chain->Free(Index);
 }
 
+/* Layout objects and descriptor pools for one descriptor signature. */
+struct DescriptorLayout {
+  vk::UniqueDescriptorSetLayout SetLayout;
+  vk::UniquePipelineLayout PipelineLayout;
+  DescriptorPoolChain PoolChain;
+  DescriptorLayout(DescriptorSignature Signature,
+                   vk::UniqueDescriptorSetLayout SetLayout,
+                   vk::UniquePipelineLayout PipelineLayout) noexcept
+      : SetLayout(std::move(SetLayout)),
+        PipelineLayout(std::move(PipelineLayout)),
+        PoolChain(Signature, this->SetLayout.get()) {}
+  DescriptorSignature GetSignature() const noexcept {
+    return PoolChain.Signature;
+  }
+};
+
+/* Deduplicates descriptor layouts by signature as pipelines are built. The
+ * list keeps addresses stable for pipelines and descriptor sets referencing
+ * their layout. */
+struct DescriptorLayoutCache {
+  std::list<DescriptorLayout> Layouts;
+  inline DescriptorLayout &Get(DescriptorSignature Signature) noexcept;
+  std::size_t ReservedDescriptors() const noexcept {
+    std::size_t Ret = 0;
+    for (const auto &Layout : Layouts)
+      Ret += Layout.PoolChain.ReservedDescriptors();
+    return Ret;
+  }
+};
+
 inline VkResult vmaCreateAllocator(const VmaAllocatorCreateInfo &pCreateInfo,
                                    VmaAllocator *pAllocator) noexcept {
   return ::vmaCreateAllocator(
@@ -1300,7 +2248,8 @@ AllocateUploadBuffer(const SourceLocation &location,
       CreateInfo, &Buffer, &Allocation, &AllocInfo);
   HSH_ASSERT_VK_SUCCESS(vk::Result(Result));
   Globals.SetDebugObjectName(LocationStr, vk::Buffer(Buffer));
-  return UploadBufferAllocation(Buffer, Allocation, AllocInfo.pMappedData);
+  return UploadBufferAllocation(Buffer, Allocation, size,
+                                AllocInfo.pMappedData);
 }
 
 inline BufferAllocation
@@ -1324,7 +2273,7 @@ AllocateStaticBuffer(const SourceLocation &location, vk::DeviceSize size,
                                 CreateInfo, &Buffer, &Allocation, nullptr);
   HSH_ASSERT_VK_SUCCESS(vk::Result(Result));
   Globals.SetDebugObjectName(LocationStr, vk::Buffer(Buffer));
-  return BufferAllocation(Buffer, Allocation);
+  return BufferAllocation(Buffer, Allocation, size, usage);
 }
 
 inline DynamicBufferAllocation
@@ -1351,10 +2300,36 @@ AllocateDynamicBuffer(const SourceLocation &location, vk::DeviceSize size,
   HSH_ASSERT_VK_SUCCESS(vk::Result(Result));
   Globals.SetDebugObjectName(LocationStr, vk::Buffer(Buffer));
 
-  return DynamicBufferAllocation(Buffer, Allocation, size,
+  return DynamicBufferAllocation(Buffer, Allocation, size, usage,
                                  AllocateUploadBuffer(location, size));
 }
 
+/* Host memory for contents moved out of device-local memory */
+inline BufferAllocation AllocateHostBuffer(const SourceLocation &location,
+                                           vk::DeviceSize size) noexcept {
+  struct HostBufferAllocationCreateInfo : VmaAllocationCreateInfo {
+    constexpr HostBufferAllocationCreateInfo() noexcept
+        : VmaAllocationCreateInfo{0,
+                                  VMA_MEMORY_USAGE_CPU_ONLY,
+                                  0,
+                                  0,
+                                  0,
+                                  VK_NULL_HANDLE,
+                                  nullptr} {}
+  };
+  VkBuffer Buffer;
+  VmaAllocation Allocation;
+  HostBufferAllocationCreateInfo CreateInfo;
+  VmaLocationStrSetter LocationStr(CreateInfo, location, "Host");
+  auto Usage = vk::BufferUsageFlagBits::eTransferSrc |
+               vk::BufferUsageFlagBits::eTransferDst;
+  auto Result = vmaCreateBuffer(vk::BufferCreateInfo({}, size, Usage),
+                                CreateInfo, &Buffer, &Allocation, nullptr);
+  HSH_ASSERT_VK_SUCCESS(vk::Result(Result));
+  Globals.SetDebugObjectName(LocationStr, vk::Buffer(Buffer));
+  return BufferAllocation(Buffer, Allocation, size, Usage);
+}
+
 inline TextureAllocation AllocateTexture(const SourceLocation &location,
                                          const vk::ImageCreateInfo &CreateInfo,
                                          bool Dedicated = false) noexcept {
@@ -1382,6 +2357,168 @@ inline TextureAllocation AllocateTexture(const SourceLocation &location,
   return TextureAllocation(Image, Allocation);
 }
 
+/*
+ * Attachments that are never loaded or stored get lazily allocated memory
+ * where the device has it; tile-based GPUs may never back them at all.
+ */
+inline TextureAllocation
+AllocateTransientTexture(const SourceLocation &location,
+                         const vk::ImageCreateInfo &CreateInfo) noexcept {
+  struct TransientAllocationCreateInfo : VmaAllocationCreateInfo {
+    constexpr TransientAllocationCreateInfo() noexcept
+        : VmaAllocationCreateInfo{VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT,
+                                  VMA_MEMORY_USAGE_GPU_LAZILY_ALLOCATED,
+                                  0,
+                                  0,
+                                  0,
+                                  VK_NULL_HANDLE,
+                                  nullptr} {}
+  } AllocationCreateInfo;
+  VkImage Image;
+  VmaAllocation Allocation;
+  VmaLocationStrSetter LocationStr(AllocationCreateInfo, location);
+  auto Result =
+      vmaCreateImage(Globals.Allocator,
+                     reinterpret_cast<const VkImageCreateInfo *>(&CreateInfo),
+                     &AllocationCreateInfo, &Image, &Allocation, nullptr);
+  if (Result != VK_SUCCESS)
+    return AllocateTexture(location, CreateInfo, true);
+  Globals.SetDebugObjectName(LocationStr, vk::Image(Image));
+  return TextureAllocation(Image, Allocation);
+}
+
+void TextureResidency::Replace() noexcept {
+  constexpr vk::ImageSubresourceRange AllMips(vk::ImageAspectFlagBits::eColor,
+                                              0, VK_REMAINING_MIP_LEVELS, 0,
+                                              VK_REMAINING_ARRAY_LAYERS);
+  Replacements.clear();
+  Barriers.clear();
+  auto AddReplacement = [&](ResidentTexture *R, uint32_t NewFirstMip) {
+    auto Info = R->CreateInfo;
+    Info.extent = R->MipExtent(NewFirstMip);
+    Info.mipLevels = R->CreateInfo.mipLevels - NewFirstMip;
+    auto &New = Replacements.emplace_back(AllocateTexture(R->Location, Info));
+    Barriers.push_back(vk::ImageMemoryBarrier(
+        vk::AccessFlagBits::eShaderRead, vk::AccessFlagBits::eTransferRead,
+        vk::ImageLayout::eShaderReadOnlyOptimal,
+        vk::ImageLayout::eTransferSrcOptimal, VK_QUEUE_FAMILY_IGNORED,
+        VK_QUEUE_FAMILY_IGNORED, R->Allocation.GetImage(), AllMips));
+    Barriers.push_back(vk::ImageMemoryBarrier(
+        vk::AccessFlagBits(0), vk::AccessFlagBits::eTransferWrite,
+        vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal,
+        VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, New.GetImage(),
+        AllMips));
+  };
+  for (auto *R : Evict) {
+    if (!R->EvictedMips.IsValid())
+      R->EvictedMips = AllocateHostBuffer(R->Location, R->ChainSize);
+    AddReplacement(R, R->FirstMip + 1);
+  }
+  for (auto *R : Restore)
+    AddReplacement(R, 0);
+
+  auto Cmd = Globals.MaintenanceCmd;
+  Cmd.begin(vk::CommandBufferBeginInfo(
+      vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+  Cmd.pipelineBarrier(vk::PipelineStageFlagBits::eAllCommands,
+                      vk::PipelineStageFlagBits::eTransfer, {},
+                      vk::MemoryBarrier(vk::AccessFlagBits::eMemoryWrite,
+                                        vk::AccessFlagBits::eTransferRead),
+                      {}, Barriers);
+
+  /* Copies the levels both images hold, numbered from the full chain */
+  auto CopyLevels = [&](ResidentTexture *R, vk::Image Old, vk::Image New,
+                        uint32_t NewFirstMip) {
+    std::array<vk::ImageCopy, MaxMipCount> Copies;
+    uint32_t NumCopies = 0;
+    auto Layers = R->CreateInfo.arrayLayers;
+    for (uint32_t Level = std::max(R->FirstMip, NewFirstMip);
+         Level < R->CreateInfo.mipLevels; ++Level)
+      Copies[NumCopies++] = vk::ImageCopy(
+          {vk::ImageAspectFlagBits::eColor, Level - R->FirstMip, 0, Layers},
+          {}, {vk::ImageAspectFlagBits::eColor, Level - NewFirstMip, 0, Layers},
+          {}, R->MipExtent(Level));
+    Cmd.copyImage(Old, vk::ImageLayout::eTransferSrcOptimal, New,
+                  vk::ImageLayout::eTransferDstOptimal,
+                  {NumCopies, Copies.data()});
+  };
+  std::size_t i = 0;
+  for (auto *R : Evict) {
+    auto Old = R->Allocation.GetImage();
+    auto Save = R->Copies[R->FirstMip];
+    Save.imageSubresource.mipLevel = 0;
+    Save.imageExtent = R->MipExtent(R->FirstMip);
+    Cmd.copyImageToBuffer(Old, vk::ImageLayout::eTransferSrcOptimal,
+                          R->EvictedMips.GetBuffer(), Save);
+    CopyLevels(R, Old, Replacements[i++].GetImage(), R->FirstMip + 1);
+  }
+  for (auto *R : Restore) {
+    auto New = Replacements[i++].GetImage();
+    std::array<vk::BufferImageCopy, MaxMipCount> Loads;
+    for (uint32_t Level = 0; Level < R->FirstMip; ++Level) {
+      Loads[Level] = R->Copies[Level];
+      Loads[Level].imageExtent = R->MipExtent(Level);
+    }
+    Cmd.copyBufferToImage(R->EvictedMips.GetBuffer(), New,
+                          vk::ImageLayout::eTransferDstOptimal,
+                          {R->FirstMip, Loads.data()});
+    CopyLevels(R, R->Allocation.GetImage(), New, 0);
+  }
+
+  Barriers.clear();
+  for (auto &New : Replacements)
+    Barriers.push_back(vk::ImageMemoryBarrier(
+        vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eShaderRead,
+        vk::ImageLayout::eTransferDstOptimal,
+        vk::ImageLayout::eShaderReadOnlyOptimal, VK_QUEUE_FAMILY_IGNORED,
+        VK_QUEUE_FAMILY_IGNORED, New.GetImage(), AllMips));
+  Cmd.pipelineBarrier(
+      vk::PipelineStageFlagBits::eTransfer,
+      vk::PipelineStageFlagBits::eVertexShader |
+          vk::PipelineStageFlagBits::eTessellationControlShader |
+          vk::PipelineStageFlagBits::eTessellationEvaluationShader |
+          vk::PipelineStageFlagBits::eGeometryShader |
+          vk::PipelineStageFlagBits::eFragmentShader,
+      {}, {}, {}, Barriers);
+  Cmd.end();
+  Globals.SubmitMaintenance();
+
+  /* The old images and views are unused once the submission completes */
+  i = 0;
+  auto Swap = [&](ResidentTexture *R, uint32_t NewFirstMip) {
+    R->Allocation = std::move(Replacements[i++]);
+    R->ImageView =
+        Globals.Device
+            .createImageViewUnique(vk::ImageViewCreateInfo(
+                {}, R->Allocation.GetImage(), R->ViewType,
+                R->CreateInfo.format, R->Components,
+                vk::ImageSubresourceRange(
+                    vk::ImageAspectFlagBits::eColor, 0,
+                    R->CreateInfo.mipLevels - NewFirstMip, 0,
+                    R->CreateInfo.arrayLayers)))
+            .value;
+    Globals.SetDebugObjectName(R->Location, R->ImageView.get());
+  };
+  for (auto *R : Evict) {
+    Swap(R, R->FirstMip + 1);
+    if (!R->FirstMip)
+      ++NumEvicted;
+    EvictedBytes += R->MipSize(R->FirstMip);
+    ++R->FirstMip;
+    ++Evictions;
+  }
+  for (auto *R : Restore) {
+    Swap(R, 0);
+    for (uint32_t Level = 0; Level < R->FirstMip; ++Level)
+      EvictedBytes -= R->MipSize(Level);
+    R->FirstMip = 0;
+    R->EvictedMips = BufferAllocation{};
+    --NumEvicted;
+    ++Restorations;
+  }
+  Replacements.clear();
+}
+
 void RenderTextureAllocation::Prepare() noexcept {
   Globals.Device.waitIdle();
   ColorTexture = AllocateTexture(
@@ -1401,34 +2538,7 @@ void RenderTextureAllocation::Prepare() noexcept {
                                                 0, 1, 0, 1)))
                   .value;
   Globals.SetDebugObjectName(Location.with_field("ColorView"), ColorView.get());
-  DepthTexture = AllocateTexture(
-      Location.with_field("DepthTexture"),
-      vk::ImageCreateInfo({}, vk::ImageType::e2D, vk::Format::eD32Sfloat,
-                          vk::Extent3D(Extent, 1), 1, 1,
-                          vk::SampleCountFlagBits::e1,
-                          vk::ImageTiling::eOptimal,
-                          vk::ImageUsageFlagBits::eDepthStencilAttachment |
-                              vk::ImageUsageFlagBits::eTransferSrc,
-                          {}, {}, {}, vk::ImageLayout::eUndefined),
-      true);
-  DepthView = Globals.Device
-                  .createImageViewUnique(vk::ImageViewCreateInfo(
-                      {}, DepthTexture.GetImage(), vk::ImageViewType::e2D,
-                      vk::Format::eD32Sfloat, {},
-                      vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eDepth,
-                                                0, 1, 0, 1)))
-                  .value;
-  Globals.SetDebugObjectName(Location.with_field("DepthView"), DepthView.get());
-  vk::ImageView Views[] = {ColorView.get(), DepthView.get()};
-  auto RenderPass = Globals.GetRenderPass();
-  Framebuffer =
-      Globals.Device
-          .createFramebufferUnique(vk::FramebufferCreateInfo(
-              {}, RenderPass, 2, Views, Extent.width, Extent.height, 1))
-          .value;
-  Globals.SetDebugObjectName(Location.with_field("Framebuffer"),
-                             Framebuffer.get());
-  RenderPassBegin = RenderPassBeginInfo(RenderPass, Framebuffer.get(), Extent);
+  PrepareDepth();
   for (uint32_t i = 0; i < NumColorBindings; ++i) {
     ColorBindings[i].Texture = AllocateTexture(
         Location.with_field("ColorBindings", i),
@@ -1473,10 +2583,104 @@ void RenderTextureAllocation::Prepare() noexcept {
                                DepthBindings[i].ImageView.get());
   }
   FirstAttach = false;
+  DepthNeedsBarrier = false;
+}
+
+void RenderTextureAllocation::PrepareDepth() noexcept {
+  vk::ImageCreateInfo DepthCreateInfo(
+      {}, vk::ImageType::e2D, vk::Format::eD32Sfloat, vk::Extent3D(Extent, 1),
+      1, 1, vk::SampleCountFlagBits::e1, vk::ImageTiling::eOptimal,
+      vk::ImageUsageFlagBits::eDepthStencilAttachment |
+          (TransientDepth ? vk::ImageUsageFlagBits::eTransientAttachment
+                          : vk::ImageUsageFlagBits::eTransferSrc),
+      {}, {}, {}, vk::ImageLayout::eUndefined);
+  DepthTexture =
+      TransientDepth
+          ? AllocateTransientTexture(Location.with_field("DepthTexture"),
+                                     DepthCreateInfo)
+          : AllocateTexture(Location.with_field("DepthTexture"),
+                            DepthCreateInfo, true);
+  DepthView = Globals.Device
+                  .createImageViewUnique(vk::ImageViewCreateInfo(
+                      {}, DepthTexture.GetImage(), vk::ImageViewType::e2D,
+                      vk::Format::eD32Sfloat, {},
+                      vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eDepth,
+                                                0, 1, 0, 1)))
+                  .value;
+  Globals.SetDebugObjectName(Location.with_field("DepthView"), DepthView.get());
+  vk::ImageView Views[] = {ColorView.get(), DepthView.get()};
+  auto RenderPass = Globals.GetRenderPass();
+  Framebuffer =
+      Globals.Device
+          .createFramebufferUnique(vk::FramebufferCreateInfo(
+              {}, RenderPass, 2, Views, Extent.width, Extent.height, 1))
+          .value;
+  Globals.SetDebugObjectName(Location.with_field("Framebuffer"),
+                             Framebuffer.get());
+  RenderPassBegin = RenderPassBeginInfo(RenderPass, Framebuffer.get(), Extent);
+}
+
+/* The old attachment may still be in flight and is only deleted later */
+void RenderTextureAllocation::ReplaceDepth() noexcept {
+  Globals.DeleteLater(std::move(DepthView));
+  Globals.DeleteLater(std::move(Framebuffer));
+  PrepareDepth();
+}
+
+void RenderTextureAllocation::BarrierDepth() noexcept {
+  Globals.Cmd.pipelineBarrier(
+      vk::PipelineStageFlagBits::eTopOfPipe,
+      vk::PipelineStageFlagBits::eEarlyFragmentTests |
+          vk::PipelineStageFlagBits::eLateFragmentTests,
+      vk::DependencyFlagBits::eByRegion, {}, {},
+      vk::ImageMemoryBarrier(
+          vk::AccessFlagBits(0),
+          vk::AccessFlagBits::eDepthStencilAttachmentWrite,
+          vk::ImageLayout::eUndefined,
+          vk::ImageLayout::eDepthStencilAttachmentOptimal,
+          VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED,
+          DepthTexture.GetImage(),
+          vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eDepth, 0,
+                                    VK_REMAINING_MIP_LEVELS, 0,
+                                    VK_REMAINING_ARRAY_LAYERS)));
 }
 
 void RenderTextureAllocation::BeginRenderPass() noexcept {
+  RenderedThisFrame = true;
+  if (DepthLoadOp == vk::AttachmentLoadOp::eLoad) {
+    DepthLoaded = true;
+    if (TransientDepth) {
+      /*
+       * Depth is loaded across passes after all. Earlier passes did not
+       * store it, so this load is undefined once, but every later one is
+       * kept.
+       */
+      TransientDepth = false;
+      ReplaceDepth();
+      BarrierDepth();
+      DepthNeedsBarrier = false;
+    }
+  }
+  RenderPassBegin.renderPass = Globals.GetRenderPass(
+      ColorLoadOp, DepthLoadOp,
+      TransientDepth ? vk::AttachmentStoreOp::eDontCare
+                     : vk::AttachmentStoreOp::eStore);
   Globals.Cmd.beginRenderPass(RenderPassBegin, vk::SubpassContents::eInline);
+  Globals.RenderPassActive = true;
+  ColorLoadOp = DepthLoadOp = vk::AttachmentLoadOp::eLoad;
+}
+
+void RenderTextureAllocation::EndRenderPass() noexcept {
+  /* Clears still happen when nothing was drawn */
+  if (!Globals.RenderPassActive &&
+      (ColorLoadOp == vk::AttachmentLoadOp::eClear ||
+       DepthLoadOp == vk::AttachmentLoadOp::eClear))
+    BeginRenderPass();
+  if (Globals.RenderPassActive) {
+    Globals.Cmd.endRenderPass();
+    Globals.RenderPassActive = false;
+  }
+  ColorLoadOp = DepthLoadOp = vk::AttachmentLoadOp::eLoad;
 }
 
 void RenderTextureAllocation::_Resolve(vk::Image SrcImage, vk::Image DstImage,
@@ -1535,16 +2739,13 @@ void RenderTextureAllocation::Resolve(vk::Image SrcImage, vk::Image DstImage,
                                       bool Reattach) noexcept {
   bool DelimitRenderPass = this == Globals.AttachedRenderTexture;
   if (DelimitRenderPass)
-    Globals.Cmd.endRenderPass();
+    EndRenderPass();
 
   _Resolve(SrcImage, DstImage, Aspect, Offset, Offset, ExtentIn);
 
-  if (DelimitRenderPass) {
-    if (Reattach)
-      BeginRenderPass();
-    else
-      Globals.AttachedRenderTexture = nullptr;
-  }
+  /* A reattached pass begins with the next draw */
+  if (DelimitRenderPass && !Reattach)
+    Globals.AttachedRenderTexture = nullptr;
 }
 
 void RenderTextureAllocation::ResolveSurface(SurfaceAllocation *Surface,
@@ -1555,7 +2756,7 @@ void RenderTextureAllocation::ResolveSurface(SurfaceAllocation *Surface,
          "Mismatched render texture / surface extents");
   bool DelimitRenderPass = this == Globals.AttachedRenderTexture;
   if (DelimitRenderPass)
-    Globals.Cmd.endRenderPass();
+    EndRenderPass();
   auto &DstImage = Surface->SwapchainImages[Surface->NextImage];
   Globals.Cmd.pipelineBarrier(
       vk::PipelineStageFlagBits::eTransfer,
@@ -1576,12 +2777,8 @@ void RenderTextureAllocation::ResolveSurface(SurfaceAllocation *Surface,
            vk::ImageAspectFlagBits::eColor, vk::Offset3D(), DestOff,
            vk::Extent3D(Extent, 1));
   Surface->DrawDecorations();
-  if (DelimitRenderPass) {
-    if (Reattach)
-      BeginRenderPass();
-    else
-      Globals.AttachedRenderTexture = nullptr;
-  }
+  if (DelimitRenderPass && !Reattach)
+    Globals.AttachedRenderTexture = nullptr;
 }
 
 void RenderTextureAllocation::ResolveColorBinding(uint32_t Idx, rect2d region,
@@ -1605,26 +2802,14 @@ void RenderTextureAllocation::Attach(const Args &... args) noexcept {
   if (Globals.AttachedRenderTexture == this)
     return;
   if (Globals.AttachedRenderTexture)
-    Globals.Cmd.endRenderPass();
+    Globals.AttachedRenderTexture->EndRenderPass();
   Globals.AttachedRenderTexture = this;
 
   if (!FirstAttach) {
     FirstAttach = true;
-    Globals.Cmd.pipelineBarrier(
-        vk::PipelineStageFlagBits::eTopOfPipe,
-        vk::PipelineStageFlagBits::eEarlyFragmentTests |
-            vk::PipelineStageFlagBits::eLateFragmentTests,
-        vk::DependencyFlagBits::eByRegion, {}, {},
-        vk::ImageMemoryBarrier(
-            vk::AccessFlagBits(0),
-            vk::AccessFlagBits::eDepthStencilAttachmentWrite,
-            vk::ImageLayout::eUndefined,
-            vk::ImageLayout::eDepthStencilAttachmentOptimal,
-            VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED,
-            DepthTexture.GetImage(),
-            vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eDepth, 0,
-                                      VK_REMAINING_MIP_LEVELS, 0,
-                                      VK_REMAINING_ARRAY_LAYERS)));
+    AttachedFreshThisFrame = true;
+    DepthNeedsBarrier = false;
+    BarrierDepth();
     Globals.Cmd.pipelineBarrier(
         vk::PipelineStageFlagBits::eTopOfPipe,
         vk::PipelineStageFlagBits::eColorAttachmentOutput,
@@ -1637,9 +2822,15 @@ void RenderTextureAllocation::Attach(const Args &... args) noexcept {
             vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0,
                                       VK_REMAINING_MIP_LEVELS, 0,
                                       VK_REMAINING_ARRAY_LAYERS)));
+    /* Freshly allocated attachments have nothing worth loading */
+    ColorLoadOp = DepthLoadOp = vk::AttachmentLoadOp::eDontCare;
+  } else if (DepthNeedsBarrier) {
+    /* The depth attachment was replaced with a transient one */
+    DepthNeedsBarrier = false;
+    BarrierDepth();
   }
 
-  BeginRenderPass();
+  /* The pass itself begins with the first draw or clear */
   ProcessAttachArgs(args...);
 }
 
@@ -1674,12 +2865,12 @@ void RenderTextureAllocation::ProcessAttachArgs(const viewport &vp,
 namespace hsh::detail {
 template <> struct TargetTraits<Target::VULKAN_SPIRV> {
   struct BufferWrapper {
-    vk::Buffer Buffer;
+    const vulkan::BufferRecord *Record = nullptr;
     BufferWrapper() noexcept = default;
     BufferWrapper(const vulkan::BufferAllocation &Alloc) noexcept
-        : Buffer(Alloc.GetBuffer()) {}
-    bool IsValid() const noexcept { return Buffer.operator bool(); }
-    operator vk::Buffer() const noexcept { return Buffer; }
+        : Record(Alloc.GetRecord()) {}
+    bool IsValid() const noexcept { return Record != nullptr; }
+    operator vk::Buffer() const noexcept { return Record->Buffer; }
   };
   using UniformBufferOwner = vulkan::BufferAllocation;
   using UniformBufferBinding = BufferWrapper;
@@ -1692,31 +2883,56 @@ template <> struct TargetTraits<Target::VULKAN_SPIRV> {
   using DynamicIndexBufferOwner = vulkan::DynamicBufferAllocation;
   struct TextureBinding {
     vk::ImageView ImageView;
+    /* Set for static textures, whose view changes as mips are evicted */
+    vulkan::ResidentTexture *Residency;
     std::uint8_t NumMips : 7;
     std::uint8_t Integer : 1;
-    bool IsValid() const noexcept { return ImageView.operator bool(); }
+    bool IsValid() const noexcept { return ImageView || Residency; }
+    vk::ImageView GetImageView() const noexcept {
+      return Residency ? Residency->ImageView.get() : ImageView;
+    }
   };
   struct TextureOwner {
     vulkan::TextureAllocation Allocation;
     vk::UniqueImageView ImageView;
+    vulkan::ResidentTexture *Residency = nullptr;
     std::uint8_t NumMips : 7;
     std::uint8_t Integer : 1;
     TextureOwner() noexcept = default;
     TextureOwner(const TextureOwner &other) = delete;
     TextureOwner &operator=(const TextureOwner &other) = delete;
-    TextureOwner(TextureOwner &&other) noexcept = default;
-    TextureOwner &operator=(TextureOwner &&other) noexcept = default;
+    TextureOwner(TextureOwner &&other) noexcept
+        : Allocation(std::move(other.Allocation)),
+          ImageView(std::move(other.ImageView)), NumMips(other.NumMips),
+          Integer(other.Integer) {
+      std::swap(Residency, other.Residency);
+    }
+    TextureOwner &operator=(TextureOwner &&other) noexcept {
+      Allocation = std::move(other.Allocation);
+      ImageView = std::move(other.ImageView);
+      std::swap(Residency, other.Residency);
+      NumMips = other.NumMips;
+      Integer = other.Integer;
+      return *this;
+    }
+    ~TextureOwner() noexcept {
+      if (Residency)
+        vulkan::Globals.DeleteLater(Residency);
+    }
 
     TextureOwner(vulkan::TextureAllocation Allocation,
                  vk::UniqueImageView ImageView, std::uint8_t NumMips,
                  std::uint8_t Integer) noexcept
         : Allocation(std::move(Allocation)), ImageView(std::move(ImageView)),
           NumMips(NumMips), Integer(Integer) {}
+    TextureOwner(vulkan::ResidentTexture *Residency, std::uint8_t NumMips,
+                 std::uint8_t Integer) noexcept
+        : Residency(Residency), NumMips(NumMips), Integer(Integer) {}
 
-    bool IsValid() const noexcept { return ImageView.operator bool(); }
+    bool IsValid() const noexcept { return ImageView || Residency; }
 
     TextureBinding GetBinding() const noexcept {
-      return TextureBinding{ImageView.get(), NumMips, Integer};
+      return TextureBinding{ImageView.get(), Residency, NumMips, Integer};
     }
     operator TextureBinding() const noexcept { return GetBinding(); }
   };
@@ -1870,30 +3086,106 @@ template <> struct TargetTraits<Target::VULKAN_SPIRV> {
   };
   struct PipelineBinding {
     vk::Pipeline Pipeline;
+    vk::PipelineLayout PipelineLayout;
     vulkan::UniqueDescriptorSet DescriptorSet;
-    uint32_t NumVertexBuffers = 0;
-    std::array<vk::Buffer, MaxVertexBuffers> VertexBuffers{};
     static const std::array<vk::DeviceSize, MaxVertexBuffers> VertexOffsets;
-    struct BoundIndex {
-      vk::Buffer Buffer{};
-      vk::IndexType Type{};
-    } Index;
     struct BoundRenderTexture {
       RenderTextureBinding RenderTextureBinding;
       vk::ImageView KnownImageView;
       uint32_t DescriptorBindingIdx = 0;
     };
-    std::array<BoundRenderTexture, MaxImages> RenderTextures{};
+    using VertexBufferRecord = const vulkan::BufferRecord *;
+    struct BoundTexture {
+      vulkan::ResidentTexture *Residency;
+      vk::ImageView KnownImageView;
+      uint32_t DescriptorBindingIdx = 0;
+    };
+    struct BoundUniform {
+      const vulkan::BufferRecord *Record;
+      vk::Buffer KnownBuffer;
+    };
+    /*
+     * Resources that are bound outside the descriptor set or may be moved by
+     * defragmentation or eviction. The uniforms, vertex buffers, static
+     * textures and render textures used by the pipeline follow this header
+     * in the same arena slot.
+     */
+    struct BoundResources {
+      const vulkan::BufferRecord *IndexBuffer = nullptr;
+      vk::IndexType IndexType{};
+      /* Defragmentation epoch the uniform descriptors were checked at */
+      uint32_t Epoch;
+      uint16_t NumUniforms;
+      uint16_t NumVertexBuffers;
+      uint16_t NumTextures;
+      uint16_t NumRenderTextures;
+
+      BoundResources(uint16_t NumUniforms, uint16_t NumVertexBuffers,
+                     uint16_t NumTextures, uint16_t NumRenderTextures) noexcept
+          : Epoch(vulkan::Globals.Defragmenter->GetEpoch()),
+            NumUniforms(NumUniforms), NumVertexBuffers(NumVertexBuffers),
+            NumTextures(NumTextures), NumRenderTextures(NumRenderTextures) {
+        std::uninitialized_value_construct_n(Uniforms(), NumUniforms);
+        std::uninitialized_value_construct_n(VertexBuffers(),
+                                             NumVertexBuffers);
+        std::uninitialized_value_construct_n(Textures(), NumTextures);
+        std::uninitialized_value_construct_n(RenderTextures(),
+                                             NumRenderTextures);
+      }
+      ~BoundResources() noexcept {
+        std::destroy_n(RenderTextures(), NumRenderTextures);
+      }
+      BoundResources(const BoundResources &) = delete;
+      BoundResources &operator=(const BoundResources &) = delete;
+
+      static constexpr std::size_t
+      SizeFor(uint16_t NumUniforms, uint16_t NumVertexBuffers,
+              uint16_t NumTextures, uint16_t NumRenderTextures) noexcept {
+        return sizeof(BoundResources) + NumUniforms * sizeof(BoundUniform) +
+               NumVertexBuffers * sizeof(VertexBufferRecord) +
+               NumTextures * sizeof(BoundTexture) +
+               NumRenderTextures * sizeof(BoundRenderTexture);
+      }
+      std::size_t Size() const noexcept {
+        return SizeFor(NumUniforms, NumVertexBuffers, NumTextures,
+                       NumRenderTextures);
+      }
+
+      BoundUniform *Uniforms() noexcept {
+        return reinterpret_cast<BoundUniform *>(this + 1);
+      }
+      VertexBufferRecord *VertexBuffers() noexcept {
+        return reinterpret_cast<VertexBufferRecord *>(Uniforms() +
+                                                      NumUniforms);
+      }
+      BoundTexture *Textures() noexcept {
+        return reinterpret_cast<BoundTexture *>(VertexBuffers() +
+                                                NumVertexBuffers);
+      }
+      BoundRenderTexture *RenderTextures() noexcept {
+        return reinterpret_cast<BoundRenderTexture *>(Textures() +
+                                                      NumTextures);
+      }
+    };
+    static_assert(sizeof(BoundResources) % alignof(BoundUniform) == 0 &&
+                      sizeof(BoundUniform) % alignof(VertexBufferRecord) == 0 &&
+                      sizeof(VertexBufferRecord) % alignof(BoundTexture) == 0 &&
+                      sizeof(BoundTexture) % alignof(BoundRenderTexture) == 0,
+                  "trailing arrays must stay aligned");
+    BoundResources *Resources = nullptr;
+
     struct Iterators {
-      decltype(VertexBuffers)::iterator VertexBufferBegin;
-      decltype(VertexBuffers)::iterator VertexBufferIt;
-      BoundIndex &Index;
-      decltype(RenderTextures)::iterator RenderTextureIt;
+      BoundResources &Resources;
+      BoundUniform *UniformIt;
+      VertexBufferRecord *VertexBufferIt;
+      BoundTexture *TextureIt;
+      BoundRenderTexture *RenderTextureIt;
       uint32_t TextureIdx = 0;
-      constexpr explicit Iterators(PipelineBinding &Binding) noexcept
-          : VertexBufferBegin(Binding.VertexBuffers.begin()),
-            VertexBufferIt(Binding.VertexBuffers.begin()), Index(Binding.Index),
-            RenderTextureIt(Binding.RenderTextures.begin()) {}
+      explicit Iterators(BoundResources &Resources) noexcept
+          : Resources(Resources), UniformIt(Resources.Uniforms()),
+            VertexBufferIt(Resources.VertexBuffers()),
+            TextureIt(Resources.Textures()),
+            RenderTextureIt(Resources.RenderTextures()) {}
 
       inline void Add(uniform_buffer_typeless uniform) noexcept;
       inline void Add(vertex_buffer_typeless uniform) noexcept;
@@ -1906,6 +3198,46 @@ template <> struct TargetTraits<Target::VULKAN_SPIRV> {
     bool IsValid() const noexcept { return Pipeline.operator bool(); }
 
     PipelineBinding() noexcept = default;
+    PipelineBinding(const PipelineBinding &) = delete;
+    PipelineBinding &operator=(const PipelineBinding &) = delete;
+    PipelineBinding(PipelineBinding &&Other) noexcept
+        : Pipeline(Other.Pipeline), PipelineLayout(Other.PipelineLayout),
+          DescriptorSet(std::move(Other.DescriptorSet)) {
+      std::swap(Resources, Other.Resources);
+    }
+    PipelineBinding &operator=(PipelineBinding &&Other) noexcept {
+      Pipeline = Other.Pipeline;
+      PipelineLayout = Other.PipelineLayout;
+      DescriptorSet = std::move(Other.DescriptorSet);
+      std::swap(Resources, Other.Resources);
+      return *this;
+    }
+    ~PipelineBinding() noexcept { FreeResources(); }
+
+    void AllocateResources(uint16_t NumUniforms, uint16_t NumVertexBuffers,
+                           uint16_t NumTextures,
+                           uint16_t NumRenderTextures) noexcept {
+      auto Size = BoundResources::SizeFor(NumUniforms, NumVertexBuffers,
+                                          NumTextures, NumRenderTextures);
+      if (Resources && Resources->Size() == Size) {
+        Resources->~BoundResources();
+      } else {
+        FreeResources();
+        Resources = static_cast<BoundResources *>(
+            vulkan::Globals.BindingResources->Allocate(Size));
+      }
+      new (Resources) BoundResources(NumUniforms, NumVertexBuffers,
+                                     NumTextures, NumRenderTextures);
+    }
+
+    void FreeResources() noexcept {
+      if (!Resources)
+        return;
+      auto Size = Resources->Size();
+      Resources->~BoundResources();
+      vulkan::Globals.BindingResources->Deallocate(Resources, Size);
+      Resources = nullptr;
+    }
 
     template <typename Impl, typename... Args>
     void Rebind(bool UpdateDescriptors, Args... args) noexcept;
@@ -1914,9 +3246,9 @@ template <> struct TargetTraits<Target::VULKAN_SPIRV> {
       std::array<vk::DescriptorImageInfo, MaxImages> ImageInfos;
       std::array<vk::WriteDescriptorSet, MaxImages> Writes;
       uint32_t WriteCur = 0;
-      for (auto &RT : RenderTextures) {
-        if (!RT.RenderTextureBinding.Allocation)
-          break;
+      auto *RenderTextures = Resources->RenderTextures();
+      for (uint32_t i = 0; i < Resources->NumRenderTextures; ++i) {
+        auto &RT = RenderTextures[i];
         auto ImageView = RT.RenderTextureBinding.GetImageView();
         if (ImageView != RT.KnownImageView) {
           Writes[WriteCur] = vk::WriteDescriptorSet(
@@ -1924,20 +3256,84 @@ template <> struct TargetTraits<Target::VULKAN_SPIRV> {
               vk::DescriptorType::eSampledImage, &ImageInfos[WriteCur]);
           ImageInfos[WriteCur] = vk::DescriptorImageInfo(
               {}, ImageView, vk::ImageLayout::eShaderReadOnlyOptimal);
+          RT.KnownImageView = ImageView;
+          ++WriteCur;
+        }
+      }
+      vulkan::Globals.Device.updateDescriptorSets(WriteCur, Writes.data(), 0,
+                                                  nullptr);
+    }
+
+    /*
+     * Marks the static textures as used and picks up views replaced by
+     * eviction or restoration. Dynamic textures are not tracked.
+     */
+    void UpdateTextures() noexcept {
+      std::array<vk::DescriptorImageInfo, MaxImages> ImageInfos;
+      std::array<vk::WriteDescriptorSet, MaxImages> Writes;
+      uint32_t WriteCur = 0;
+      auto *Textures = Resources->Textures();
+      for (uint32_t i = 0; i < Resources->NumTextures; ++i) {
+        auto &T = Textures[i];
+        if (!T.Residency)
+          continue;
+        T.Residency->LastUsedFrame = vulkan::Globals.Frame;
+        auto ImageView = T.Residency->ImageView.get();
+        if (ImageView != T.KnownImageView) {
+          Writes[WriteCur] = vk::WriteDescriptorSet(
+              DescriptorSet.Set, T.DescriptorBindingIdx, 0, 1,
+              vk::DescriptorType::eSampledImage, &ImageInfos[WriteCur]);
+          ImageInfos[WriteCur] = vk::DescriptorImageInfo(
+              {}, ImageView, vk::ImageLayout::eShaderReadOnlyOptimal);
+          T.KnownImageView = ImageView;
           ++WriteCur;
         }
       }
+      if (WriteCur)
+        vulkan::Globals.Device.updateDescriptorSets(WriteCur, Writes.data(),
+                                                    0, nullptr);
+    }
+
+    void UpdateUniforms() noexcept {
+      std::array<vk::DescriptorBufferInfo, MaxUniforms> BufferInfos;
+      std::array<vk::WriteDescriptorSet, MaxUniforms> Writes;
+      uint32_t WriteCur = 0;
+      auto *Uniforms = Resources->Uniforms();
+      for (uint32_t i = 0; i < Resources->NumUniforms; ++i) {
+        auto &U = Uniforms[i];
+        if (U.Record->Buffer != U.KnownBuffer) {
+          Writes[WriteCur] = vk::WriteDescriptorSet(
+              DescriptorSet.Set, i, 0, 1, vk::DescriptorType::eUniformBuffer,
+              {}, &BufferInfos[WriteCur]);
+          BufferInfos[WriteCur] =
+              vk::DescriptorBufferInfo(U.Record->Buffer, 0, VK_WHOLE_SIZE);
+          U.KnownBuffer = U.Record->Buffer;
+          ++WriteCur;
+        }
+      }
+      Resources->Epoch = vulkan::Globals.Defragmenter->GetEpoch();
       vulkan::Globals.Device.updateDescriptorSets(WriteCur, Writes.data(), 0,
                                                   nullptr);
     }
 
     void Bind() noexcept {
-      for (auto &RT : RenderTextures) {
-        if (!RT.RenderTextureBinding.Allocation)
-          break;
-        if (RT.RenderTextureBinding.GetImageView() != RT.KnownImageView) {
-          UpdateRenderTextures();
-          break;
+      if (!vulkan::Globals.RenderPassActive) {
+        assert(vulkan::Globals.AttachedRenderTexture &&
+               "No render texture attached");
+        vulkan::Globals.AttachedRenderTexture->BeginRenderPass();
+      }
+      if (Resources) {
+        if (Resources->Epoch != vulkan::Globals.Defragmenter->GetEpoch())
+          UpdateUniforms();
+        if (Resources->NumTextures)
+          UpdateTextures();
+        auto *RenderTextures = Resources->RenderTextures();
+        for (uint32_t i = 0; i < Resources->NumRenderTextures; ++i) {
+          auto &RT = RenderTextures[i];
+          if (RT.RenderTextureBinding.GetImageView() != RT.KnownImageView) {
+            UpdateRenderTextures();
+            break;
+          }
         }
       }
       if (vulkan::Globals.BoundPipeline != Pipeline) {
@@ -1948,12 +3344,22 @@ template <> struct TargetTraits<Target::VULKAN_SPIRV> {
       if (vulkan::Globals.BoundDescriptorSet != DescriptorSet.Set) {
         vulkan::Globals.BoundDescriptorSet = DescriptorSet.Set;
         vulkan::Globals.Cmd.bindDescriptorSets(vk::PipelineBindPoint::eGraphics,
-                                               vulkan::Globals.PipelineLayout,
+                                               PipelineLayout,
                                                0, DescriptorSet.Set, {});
-        vulkan::Globals.Cmd.bindVertexBuffers(
-            0, NumVertexBuffers, VertexBuffers.data(), VertexOffsets.data());
-        if (Index.Buffer)
-          vulkan::Globals.Cmd.bindIndexBuffer(Index.Buffer, 0, Index.Type);
+        if (Resources) {
+          if (auto NumVertexBuffers = Resources->NumVertexBuffers) {
+            std::array<vk::Buffer, MaxVertexBuffers> VertexBuffers;
+            auto *Records = Resources->VertexBuffers();
+            for (uint32_t i = 0; i < NumVertexBuffers; ++i)
+              VertexBuffers[i] = Records[i]->Buffer;
+            vulkan::Globals.Cmd.bindVertexBuffers(
+                0, NumVertexBuffers, VertexBuffers.data(),
+                VertexOffsets.data());
+          }
+          if (Resources->IndexBuffer)
+            vulkan::Globals.Cmd.bindIndexBuffer(
+                Resources->IndexBuffer->Buffer, 0, Resources->IndexType);
+        }
       }
     }
 
@@ -1982,6 +3388,11 @@ template <> struct TargetTraits<Target::VULKAN_SPIRV> {
 
   static void ClearAttachments(bool color, bool depth) noexcept {
     assert(vulkan::Globals.AttachedRenderTexture != nullptr);
+    /* Clears before the first draw become load ops of the pass */
+    if (!vulkan::Globals.RenderPassActive) {
+      vulkan::Globals.AttachedRenderTexture->ClearOnLoad(color, depth);
+      return;
+    }
     vk::ClearRect Rect(vk::Rect2D({}, hsh::detail::vulkan::Globals
                                           .AttachedRenderTexture->GetExtent()),
                        0, 1);
@@ -257,6 +257,22 @@ HshToVkShaderStage(enum Stage Stage) noexcept {
   }
 }
 
+constexpr const char *HshToVkShaderStageName(enum Stage Stage) noexcept {
+  switch (Stage) {
+  default:
+  case Vertex:
+    return "Vertex";
+  case Control:
+    return "TessellationControl";
+  case Evaluation:
+    return "TessellationEvaluation";
+  case Geometry:
+    return "Geometry";
+  case Fragment:
+    return "Fragment";
+  }
+}
+
 constexpr vk::ColorComponentFlagBits
 HshToVkColorComponentFlags(enum ColorComponentFlags Comps) noexcept {
   return vk::ColorComponentFlagBits(
@@ -297,6 +313,22 @@ template <> struct ShaderObject<Target::VULKAN_SPIRV> {
   void Destroy() noexcept { ShaderModule.reset(); }
 };
 
+template <> struct PipelineObject<Target::VULKAN_SPIRV> {
+  vk::UniquePipeline Pipeline;
+  vulkan::DescriptorLayout *DescriptorLayout = nullptr;
+  /* Set once a coordinator has taken on creating the pipeline */
+  bool Claimed = false;
+  /* Created as the base of a pipeline group */
+  bool AllowsDerivatives = false;
+  PipelineObject() noexcept = default;
+  void Destroy() noexcept {
+    Pipeline.reset();
+    DescriptorLayout = nullptr;
+    Claimed = false;
+    AllowsDerivatives = false;
+  }
+};
+
 template <> struct SamplerObject<Target::VULKAN_SPIRV> {
   std::array<std::array<vk::UniqueSampler, MaxMipCount - 1>, 2> Samplers;
   SamplerObject() noexcept = default;
@@ -392,7 +424,7 @@ template <typename Impl> struct DescriptorPoolWrites {
       auto ImageIdx = ImageIt - ImageBegin;
       auto &Image = *ImageIt++;
       Image = vk::DescriptorImageInfo(
-          {}, texture.Binding.get_VULKAN_SPIRV().ImageView,
+          {}, texture.Binding.get_VULKAN_SPIRV().GetImageView(),
           vk::ImageLayout::eShaderReadOnlyOptimal);
       auto &Write = *WriteIt++;
       Write = vk::WriteDescriptorSet(
@@ -433,36 +465,67 @@ template <typename Impl> struct DescriptorPoolWrites {
 template <typename Impl, typename... Args>
 void TargetTraits<Target::VULKAN_SPIRV>::PipelineBinding::Rebind(
     bool UpdateDescriptors, Args... args) noexcept {
-  Pipeline = Impl::data_VULKAN_SPIRV.Pipeline.get();
+  auto &Shared = Impl::data_VULKAN_SPIRV.SharedPipeline.get();
+  Pipeline = Shared.Pipeline.get();
+  auto &Layout = *Shared.DescriptorLayout;
+  PipelineLayout = Layout.PipelineLayout.get();
+  /* A set from another pipeline's layout cannot be reused. */
+  if (DescriptorSet && DescriptorSet.Chain != &Layout.PoolChain) {
+    DescriptorSet = vulkan::UniqueDescriptorSet{};
+    UpdateDescriptors = true;
+  }
   if (UpdateDescriptors) {
     if (!DescriptorSet)
-      DescriptorSet = vulkan::Globals.DescriptorPoolChain->Allocate();
+      DescriptorSet = Layout.PoolChain.Allocate();
     vulkan::DescriptorPoolWrites<Impl> Writes(DescriptorSet, args...);
     vulkan::Globals.Device.updateDescriptorSets(
         Writes.NumWrites,
         reinterpret_cast<vk::WriteDescriptorSet *>(Writes.Writes.data()), 0,
         nullptr);
-    Iterators Its(*this);
-    (Its.Add(args), ...);
-    NumVertexBuffers = Its.VertexBufferIt - Its.VertexBufferBegin;
+    constexpr auto NumUniforms = uint16_t(
+        (0 + ... + std::is_base_of_v<uniform_buffer_typeless, Args>));
+    constexpr auto NumVertexBuffers = uint16_t(
+        (0 + ... + std::is_base_of_v<vertex_buffer_typeless, Args>));
+    constexpr auto NumTextures =
+        uint16_t((0 + ... + std::is_base_of_v<texture_typeless, Args>));
+    constexpr auto NumRenderTextures =
+        uint16_t((0 + ... + std::is_same_v<render_texture2d, Args>));
+    constexpr bool HasIndex =
+        (false || ... || std::is_base_of_v<index_buffer_typeless, Args>);
+    if constexpr (NumUniforms || NumVertexBuffers || NumTextures ||
+                  NumRenderTextures || HasIndex) {
+      AllocateResources(NumUniforms, NumVertexBuffers, NumTextures,
+                        NumRenderTextures);
+      Iterators Its(*Resources);
+      (Its.Add(args), ...);
+    } else {
+      FreeResources();
+    }
   }
 }
 
 void TargetTraits<Target::VULKAN_SPIRV>::PipelineBinding::Iterators::Add(
-    uniform_buffer_typeless) noexcept {}
+    uniform_buffer_typeless uniform) noexcept {
+  auto &U = *UniformIt++;
+  U.Record = uniform.Binding.get_VULKAN_SPIRV().Record;
+  U.KnownBuffer = U.Record->Buffer;
+}
 void TargetTraits<Target::VULKAN_SPIRV>::PipelineBinding::Iterators::Add(
     vertex_buffer_typeless vbo) noexcept {
-  *VertexBufferIt++ = vbo.Binding.get_VULKAN_SPIRV();
+  *VertexBufferIt++ = vbo.Binding.get_VULKAN_SPIRV().Record;
 }
 template <typename T>
 void TargetTraits<Target::VULKAN_SPIRV>::PipelineBinding::Iterators::Add(
     index_buffer<T> ibo) noexcept {
-  Index.Buffer = ibo.Binding.get_VULKAN_SPIRV();
-  Index.Type = vk::IndexTypeValue<T>::value;
+  Resources.IndexBuffer = ibo.Binding.get_VULKAN_SPIRV().Record;
+  Resources.IndexType = vk::IndexTypeValue<T>::value;
 }
 void TargetTraits<Target::VULKAN_SPIRV>::PipelineBinding::Iterators::Add(
-    texture_typeless) noexcept {
-  TextureIdx++;
+    texture_typeless texture) noexcept {
+  auto &T = *TextureIt++;
+  T.Residency = texture.Binding.get_VULKAN_SPIRV().Residency;
+  T.KnownImageView = texture.Binding.get_VULKAN_SPIRV().GetImageView();
+  T.DescriptorBindingIdx = MaxUniforms + TextureIdx++;
 }
 void TargetTraits<Target::VULKAN_SPIRV>::PipelineBinding::Iterators::Add(
     render_texture2d texture) noexcept {
@@ -474,52 +537,23 @@ void TargetTraits<Target::VULKAN_SPIRV>::PipelineBinding::Iterators::Add(
 void TargetTraits<Target::VULKAN_SPIRV>::PipelineBinding::Iterators::Add(
     SamplerBinding) noexcept {}
 
-template <std::uint32_t NStages, std::uint32_t NBindings,
-          std::uint32_t NAttributes, std::uint32_t NSamplers,
-          std::uint32_t NAttachments>
-struct ShaderConstData<Target::VULKAN_SPIRV, NStages, NBindings, NAttributes,
-                       NSamplers, NAttachments> {
-  std::array<vk::ShaderModuleCreateInfo, NStages> StageCodes;
-  std::array<vk::ShaderStageFlagBits, NStages> StageFlags;
-  std::array<vk::VertexInputBindingDescription, NBindings>
-      VertexBindingDescriptions;
-  std::array<vk::VertexInputAttributeDescription, NAttributes>
-      VertexAttributeDescriptions;
+template <std::uint32_t NAttachments>
+struct PipelineState<Target::VULKAN_SPIRV, NAttachments> {
   std::array<vk::PipelineColorBlendAttachmentState, NAttachments>
       TargetAttachments;
-  vk::PipelineVertexInputStateCreateInfo VertexInputState;
   vk::PipelineInputAssemblyStateCreateInfo InputAssemblyState;
   vk::PipelineTessellationStateCreateInfo TessellationState;
   vk::PipelineRasterizationStateCreateInfo RasterizationState;
   vk::PipelineDepthStencilStateCreateInfo DepthStencilState;
   vk::PipelineColorBlendStateCreateInfo ColorBlendState;
-  std::array<vk::SamplerCreateInfo, NSamplers> Samplers;
-  SourceLocation Location;
   bool DirectRenderPass;
+  vulkan::DescriptorSignature DescriptorSignature;
 
-  template <std::size_t... SSeq, std::size_t... BSeq, std::size_t... ASeq,
-            std::size_t... SampSeq, std::size_t... AttSeq>
-  constexpr ShaderConstData(
-      std::array<ShaderCode<Target::VULKAN_SPIRV>, NStages> S,
-      std::array<VertexBinding, NBindings> B,
-      std::array<VertexAttribute, NAttributes> A,
-      std::array<sampler, NSamplers> Samps,
-      std::array<ColorAttachment, NAttachments> Atts,
-      struct PipelineInfo PipelineInfo, const SourceLocation &Location,
-      std::index_sequence<SSeq...>, std::index_sequence<BSeq...>,
-      std::index_sequence<ASeq...>, std::index_sequence<SampSeq...>,
-      std::index_sequence<AttSeq...>) noexcept
-      : StageCodes{vk::ShaderModuleCreateInfo{
-            {}, std::get<SSeq>(S).Blob.Size, std::get<SSeq>(S).Blob.Data}...},
-        StageFlags{HshToVkShaderStage(std::get<SSeq>(S).Stage)...},
-        VertexBindingDescriptions{vk::VertexInputBindingDescription{
-            BSeq, std::get<BSeq>(B).Stride,
-            HshToVkInputRate(std::get<BSeq>(B).InputRate)}...},
-        VertexAttributeDescriptions{vk::VertexInputAttributeDescription{
-            ASeq, std::get<ASeq>(A).Binding,
-            HshToVkFormat(std::get<ASeq>(A).Format),
-            std::get<ASeq>(A).Offset}...},
-        TargetAttachments{vk::PipelineColorBlendAttachmentState{
+  template <std::size_t... AttSeq>
+  constexpr PipelineState(std::array<ColorAttachment, NAttachments> Atts,
+                          struct PipelineInfo PipelineInfo,
+                          std::index_sequence<AttSeq...>) noexcept
+      : TargetAttachments{vk::PipelineColorBlendAttachmentState{
             std::get<AttSeq>(Atts).blendEnabled(),
             HshToVkBlendFactor(std::get<AttSeq>(Atts).SrcColorBlendFactor),
             HshToVkBlendFactor(std::get<AttSeq>(Atts).DstColorBlendFactor),
@@ -529,11 +563,6 @@ struct ShaderConstData<Target::VULKAN_SPIRV, NStages, NBindings, NAttributes,
             HshToVkBlendOp(std::get<AttSeq>(Atts).AlphaBlendOp),
             HshToVkColorComponentFlags(
                 std::get<AttSeq>(Atts).ColorWriteComponents)}...},
-        VertexInputState{{},
-                         NBindings,
-                         VertexBindingDescriptions.data(),
-                         NAttributes,
-                         VertexAttributeDescriptions.data()},
         InputAssemblyState{{},
                            HshToVkTopology(PipelineInfo.Topology),
                            PipelineInfo.Topology == TriangleStrip},
@@ -558,6 +587,71 @@ struct ShaderConstData<Target::VULKAN_SPIRV, NStages, NBindings, NAttributes,
                         vk::LogicOp ::eClear,
                         NAttachments,
                         TargetAttachments.data()},
+        DirectRenderPass(PipelineInfo.DirectRenderPass),
+        DescriptorSignature(PipelineInfo.NumUniforms, PipelineInfo.NumImages,
+                            PipelineInfo.NumSamplers) {}
+
+  constexpr PipelineState(std::array<ColorAttachment, NAttachments> Atts,
+                          struct PipelineInfo PipelineInfo) noexcept
+      : PipelineState(Atts, PipelineInfo,
+                      std::make_index_sequence<NAttachments>()) {}
+};
+
+template <std::uint32_t NStages, std::uint32_t NBindings,
+          std::uint32_t NAttributes, std::uint32_t NSamplers,
+          std::uint32_t NAttachments>
+struct ShaderConstData<Target::VULKAN_SPIRV, NStages, NBindings, NAttributes,
+                       NSamplers, NAttachments> {
+  std::array<vk::ShaderModuleCreateInfo, NStages> StageCodes;
+  std::array<vk::ShaderStageFlagBits, NStages> StageFlags;
+  std::array<const char *, NStages> StageNames;
+  std::array<vk::VertexInputBindingDescription, NBindings>
+      VertexBindingDescriptions;
+  std::array<vk::VertexInputAttributeDescription, NAttributes>
+      VertexAttributeDescriptions;
+  vk::PipelineVertexInputStateCreateInfo VertexInputState;
+  std::array<vk::SamplerCreateInfo, NSamplers> Samplers;
+  SourceLocation Location;
+  /* Shared with every pipeline of identical fixed-function state */
+  const PipelineState<Target::VULKAN_SPIRV, NAttachments> &State;
+  /* Complete apart from the handles only known at runtime */
+  vk::GraphicsPipelineCreateInfo CreateInfo;
+
+  static constexpr std::array<vk::DynamicState, 3> Dynamics{
+      vk::DynamicState::eViewport, vk::DynamicState::eScissor,
+      vk::DynamicState::eBlendConstants};
+  static constexpr vk::PipelineDynamicStateCreateInfo DynamicState{
+      {}, Dynamics.size(), Dynamics.data()};
+  static constexpr vk::PipelineViewportStateCreateInfo ViewportState{
+      {}, 1, {}, 1, {}};
+
+  template <std::size_t... SSeq, std::size_t... BSeq, std::size_t... ASeq,
+            std::size_t... SampSeq>
+  constexpr ShaderConstData(
+      std::array<ShaderCode<Target::VULKAN_SPIRV>, NStages> S,
+      std::array<VertexBinding, NBindings> B,
+      std::array<VertexAttribute, NAttributes> A,
+      std::array<sampler, NSamplers> Samps,
+      const PipelineState<Target::VULKAN_SPIRV, NAttachments> &State,
+      const SourceLocation &Location, std::index_sequence<SSeq...>,
+      std::index_sequence<BSeq...>, std::index_sequence<ASeq...>,
+      std::index_sequence<SampSeq...>) noexcept
+      : StageCodes{vk::ShaderModuleCreateInfo{
+            {}, std::get<SSeq>(S).Blob.Size, std::get<SSeq>(S).Blob.Data}...},
+        StageFlags{HshToVkShaderStage(std::get<SSeq>(S).Stage)...},
+        StageNames{HshToVkShaderStageName(std::get<SSeq>(S).Stage)...},
+        VertexBindingDescriptions{vk::VertexInputBindingDescription{
+            BSeq, std::get<BSeq>(B).Stride,
+            HshToVkInputRate(std::get<BSeq>(B).InputRate)}...},
+        VertexAttributeDescriptions{vk::VertexInputAttributeDescription{
+            ASeq, std::get<ASeq>(A).Binding,
+            HshToVkFormat(std::get<ASeq>(A).Format),
+            std::get<ASeq>(A).Offset}...},
+        VertexInputState{{},
+                         NBindings,
+                         VertexBindingDescriptions.data(),
+                         NAttributes,
+                         VertexAttributeDescriptions.data()},
         Samplers{vk::SamplerCreateInfo{
             {},
             HshToVkFilter(std::get<SampSeq>(Samps).MagFilter),
@@ -575,65 +669,60 @@ struct ShaderConstData<Target::VULKAN_SPIRV, NStages, NBindings, NAttributes,
             0,
             HshToVkBorderColor(std::get<SampSeq>(Samps).BorderColor,
                                false)}...},
-        Location(Location), DirectRenderPass(PipelineInfo.DirectRenderPass) {}
+        Location(Location), State(State),
+        CreateInfo{{},
+                   NStages,
+                   {},
+                   &VertexInputState,
+                   &State.InputAssemblyState,
+                   &State.TessellationState,
+                   &ViewportState,
+                   &State.RasterizationState,
+                   {},
+                   &State.DepthStencilState,
+                   &State.ColorBlendState,
+                   &DynamicState} {}
 
   constexpr ShaderConstData(
       std::array<ShaderCode<Target::VULKAN_SPIRV>, NStages> S,
       std::array<VertexBinding, NBindings> B,
       std::array<VertexAttribute, NAttributes> A,
       std::array<sampler, NSamplers> Samps,
-      std::array<ColorAttachment, NAttachments> Atts,
-      struct PipelineInfo PipelineInfo,
+      const PipelineState<Target::VULKAN_SPIRV, NAttachments> &State,
       const SourceLocation &Location = SourceLocation::current()) noexcept
-      : ShaderConstData(S, B, A, Samps, Atts, PipelineInfo, Location,
+      : ShaderConstData(S, B, A, Samps, State, Location,
                         std::make_index_sequence<NStages>(),
                         std::make_index_sequence<NBindings>(),
                         std::make_index_sequence<NAttributes>(),
-                        std::make_index_sequence<NSamplers>(),
-                        std::make_index_sequence<NAttachments>()) {}
+                        std::make_index_sequence<NSamplers>()) {}
 
-  static constexpr std::array<vk::DynamicState, 3> Dynamics{
-      vk::DynamicState::eViewport, vk::DynamicState::eScissor,
-      vk::DynamicState::eBlendConstants};
-  static constexpr vk::PipelineDynamicStateCreateInfo DynamicState{
-      {}, Dynamics.size(), Dynamics.data()};
-  static constexpr vk::PipelineViewportStateCreateInfo ViewportState{
-      {}, 1, {}, 1, {}};
+  vulkan::DescriptorLayout &GetDescriptorLayout() const noexcept {
+    return vulkan::Globals.DescriptorLayouts->Get(State.DescriptorSignature);
+  }
 
+  /* Fills in the stages, multisample state, layout and render pass; all
+   * other state was assembled when the constant data was. */
   template <typename B>
   vk::GraphicsPipelineCreateInfo
-  GetPipelineInfo(VkPipelineShaderStageCreateInfo *StageInfos) const noexcept {
+  GetPipelineInfo(const vulkan::DescriptorLayout &Layout,
+                  VkPipelineShaderStageCreateInfo *StageInfos) const noexcept {
     for (std::size_t i = 0; i < NStages; ++i)
-      StageInfos[i] = vk::PipelineShaderStageCreateInfo {
-        {}, StageFlags[i],
-            B::data_VULKAN_SPIRV.ShaderObjects[i].get().Get(
-                StageCodes[i],
-#if HSH_SOURCE_LOCATION_ENABLED
-                B::cdata_VULKAN_SPIRV.Location.with_field(
-                    vk::to_string(StageFlags[i]).c_str())
-#else
-                B::cdata_VULKAN_SPIRV.Location
-#endif
-                    ),
-            "main"
-      };
-
-    return vk::GraphicsPipelineCreateInfo{
-        {},
-        NStages,
-        reinterpret_cast<vk::PipelineShaderStageCreateInfo *>(StageInfos),
-        &VertexInputState,
-        &InputAssemblyState,
-        &TessellationState,
-        &ViewportState,
-        &RasterizationState,
-        &vulkan::Globals.MultisampleState,
-        &DepthStencilState,
-        &ColorBlendState,
-        &DynamicState,
-        vulkan::Globals.PipelineLayout,
-        DirectRenderPass ? vulkan::Globals.GetDirectRenderPass()
-                         : vulkan::Globals.GetRenderPass()};
+      StageInfos[i] = vk::PipelineShaderStageCreateInfo{
+          {},
+          StageFlags[i],
+          B::data_VULKAN_SPIRV.ShaderObjects[i].get().Get(
+              StageCodes[i], Location.with_field(StageNames[i])),
+          "main"};
+
+    auto Info = CreateInfo;
+    Info.pStages =
+        reinterpret_cast<vk::PipelineShaderStageCreateInfo *>(StageInfos);
+    Info.pMultisampleState = &vulkan::Globals.MultisampleState;
+    Info.layout = Layout.PipelineLayout.get();
+    Info.renderPass = State.DirectRenderPass
+                          ? vulkan::Globals.GetDirectRenderPass()
+                          : vulkan::Globals.GetRenderPass();
+    return Info;
   }
 };
 
@@ -644,16 +733,19 @@ struct ShaderData<Target::VULKAN_SPIRV, NStages, NSamplers> {
   using SamplerRef =
       std::reference_wrapper<SamplerObject<Target::VULKAN_SPIRV>>;
   std::array<SamplerRef, NSamplers> SamplerObjects;
-  vk::UniquePipeline Pipeline;
+  using PipelineRef =
+      std::reference_wrapper<PipelineObject<Target::VULKAN_SPIRV>>;
+  PipelineRef SharedPipeline;
   constexpr ShaderData(std::array<ObjectRef, NStages> S,
-                       std::array<SamplerRef, NSamplers> Samps) noexcept
-      : ShaderObjects(S), SamplerObjects(Samps) {}
+                       std::array<SamplerRef, NSamplers> Samps,
+                       PipelineRef Pipeline) noexcept
+      : ShaderObjects(S), SamplerObjects(Samps), SharedPipeline(Pipeline) {}
   void Destroy() noexcept {
     for (auto &Obj : ShaderObjects)
       Obj.get().Destroy();
     for (auto &Obj : SamplerObjects)
       Obj.get().Destroy();
-    Pipeline.reset();
+    SharedPipeline.get().Destroy();
   }
 };
 
@@ -667,26 +759,95 @@ template <> struct PipelineBuilder<Target::VULKAN_SPIRV> {
   StageInfoStart(std::size_t BIdx, std::index_sequence<BSeq...>) noexcept {
     return (GetNumStages<B>(BSeq < BIdx) + ...);
   }
-  template <typename B> static void SetPipeline(vk::Pipeline data) noexcept {
-    vulkan::Globals.SetDebugObjectName(
-        B::cdata_VULKAN_SPIRV.Location.with_field("Pipeline"), data);
+  static void SetPipeline(PipelineObject<Target::VULKAN_SPIRV> &Object,
+                          const SourceLocation &Location,
+                          vk::Pipeline data) noexcept {
+    vulkan::Globals.SetDebugObjectName(Location.with_field("Pipeline"), data);
     vk::ObjectDestroy<vk::Device, VULKAN_HPP_DEFAULT_DISPATCHER_TYPE> deleter(
         vulkan::Globals.Device, nullptr, VULKAN_HPP_DEFAULT_DISPATCHER);
-    B::data_VULKAN_SPIRV.Pipeline = vk::UniquePipeline(data, deleter);
+    Object.Pipeline = vk::UniquePipeline(data, deleter);
+  }
+  struct PendingPipeline {
+    PipelineObject<Target::VULKAN_SPIRV> *Object;
+    const SourceLocation *Location;
+  };
+  /* Only the first binding to reach a shared pipeline object creates it;
+   * identical pipelines from other coordinators (or earlier in this one)
+   * already have. */
+  template <typename B, std::size_t N>
+  static void
+  AddPipelineInfo(std::array<vk::GraphicsPipelineCreateInfo, N> &Infos,
+                  std::array<PendingPipeline, N> &Pending,
+                  std::size_t &NumInfos,
+                  VkPipelineShaderStageCreateInfo *StageInfos) noexcept {
+    auto &Object = B::data_VULKAN_SPIRV.SharedPipeline.get();
+    if (Object.Claimed)
+      return;
+    Object.Claimed = true;
+    Object.DescriptorLayout = &B::cdata_VULKAN_SPIRV.GetDescriptorLayout();
+    auto Info = B::cdata_VULKAN_SPIRV.template GetPipelineInfo<B>(
+        *Object.DescriptorLayout, StageInfos);
+    using Base = typename PipelineGroup<B>::Base;
+    if constexpr (std::is_same_v<Base, B>) {
+      Info.flags |= vk::PipelineCreateFlagBits::eAllowDerivatives;
+      Object.AllowsDerivatives = true;
+    } else if constexpr (!std::is_void_v<Base>) {
+      SetPipelineBase(Info, Base::data_VULKAN_SPIRV.SharedPipeline.get(),
+                      Pending.data(), NumInfos);
+    }
+    Pending[NumInfos] = {&Object, &B::cdata_VULKAN_SPIRV.Location};
+    Infos[NumInfos++] = Info;
+  }
+  /* The base is either created already or earlier in the same call. A base
+   * shared with an identical pipeline outside the group may not have been
+   * created to allow derivatives. */
+  static void SetPipelineBase(vk::GraphicsPipelineCreateInfo &Info,
+                              PipelineObject<Target::VULKAN_SPIRV> &Base,
+                              const PendingPipeline *Pending,
+                              std::size_t NumPending) noexcept {
+    if (!Base.AllowsDerivatives)
+      return;
+    if (Base.Pipeline) {
+      Info.setBasePipelineHandle(Base.Pipeline.get()).setBasePipelineIndex(-1);
+    } else {
+      auto *It = std::find_if(
+          Pending, Pending + NumPending,
+          [&](const PendingPipeline &P) { return P.Object == &Base; });
+      if (It == Pending + NumPending)
+        return;
+      Info.setBasePipelineIndex(int32_t(It - Pending));
+    }
+    Info.flags |= vk::PipelineCreateFlagBits::eDerivative;
   }
   template <typename... B, std::size_t... BSeq>
   static void CreatePipelines(std::index_sequence<BSeq...> seq) noexcept {
     std::array<VkPipelineShaderStageCreateInfo, (GetNumStages<B>(true) + ...)>
         ShaderStageInfos;
-    std::array<vk::GraphicsPipelineCreateInfo, sizeof...(B)> Infos{
-        B::cdata_VULKAN_SPIRV.template GetPipelineInfo<B>(
-            ShaderStageInfos.data() + StageInfoStart<B...>(BSeq, seq))...};
+    std::array<vk::GraphicsPipelineCreateInfo, sizeof...(B)> Infos;
+    std::array<PendingPipeline, sizeof...(B)> Pending;
+    std::size_t NumInfos = 0;
+    (AddPipelineInfo<B>(Infos, Pending, NumInfos,
+                        ShaderStageInfos.data() +
+                            StageInfoStart<B...>(BSeq, seq)),
+     ...);
+    if (!NumInfos)
+      return;
     std::array<vk::Pipeline, sizeof...(B)> Pipelines;
+    auto Start = std::chrono::steady_clock::now();
     auto Result = vulkan::Globals.Device.createGraphicsPipelines(
-        vulkan::Globals.PipelineCache, Infos.size(), Infos.data(), nullptr,
+        vulkan::Globals.PipelineCache, NumInfos, Infos.data(), nullptr,
         Pipelines.data());
     HSH_ASSERT_VK_SUCCESS(Result);
-    (SetPipeline<B>(Pipelines[BSeq]), ...);
+    vulkan::Globals.PipelineCreateTime +=
+        std::chrono::steady_clock::now() - Start;
+    ++vulkan::Globals.PipelineCreateCalls;
+    vulkan::Globals.PipelinesCreated += NumInfos;
+    vulkan::Globals.PipelineDerivativesCreated += std::count_if(
+        Infos.begin(), Infos.begin() + NumInfos, [](const auto &Info) {
+          return bool(Info.flags & vk::PipelineCreateFlagBits::eDerivative);
+        });
+    for (std::size_t i = 0; i < NumInfos; ++i)
+      SetPipeline(*Pending[i].Object, *Pending[i].Location, Pipelines[i]);
   }
   template <typename... B> static void CreatePipelines() noexcept {
     CreatePipelines<B...>(std::make_index_sequence<sizeof...(B)>());
@@ -762,8 +923,12 @@ inline auto CreateBufferOwner(const SourceLocation &location,
   auto Ret = vulkan::AllocateStaticBuffer(
       location, size, bufferType | vk::BufferUsageFlagBits::eTransferDst);
 
-  vulkan::Globals.CopyCmd.copyBuffer(UploadBuffer.GetBuffer(), Ret.GetBuffer(),
-                                     vk::BufferCopy(0, 0, size));
+  vulkan::RecordUpload(
+      std::move(UploadBuffer),
+      [&](vk::CommandBuffer Cmd, vk::Buffer Upload) {
+        Cmd.copyBuffer(Upload, Ret.GetBuffer(), vk::BufferCopy(0, 0, size));
+      },
+      vulkan::UploadTarget{Ret.GetRecord()});
 
   return Ret;
 }
@@ -898,62 +1063,73 @@ inline auto CreateTextureOwner(
   auto UploadBuffer = vulkan::AllocateUploadBuffer(location, BufferSize);
   copyFunc(UploadBuffer.GetMappedData(), BufferSize);
 
-  TargetTraits<Target::VULKAN_SPIRV>::TextureOwner Ret{
-      vulkan::AllocateTexture(
-          location.with_field(Traits::Name),
-          vk::ImageCreateInfo({}, Type, TexelFormat, extent3d(extent), numMips,
-                              numLayers, vk::SampleCountFlagBits::e1,
-                              vk::ImageTiling::eOptimal,
-                              vk::ImageUsageFlagBits::eSampled |
-                                  vk::ImageUsageFlagBits::eTransferDst,
-                              {}, {}, {}, vk::ImageLayout::eUndefined)),
-      {},
-      std::uint8_t(numMips),
-      HshFormatIsInteger(format)};
-  Ret.ImageView =
+  /* The image is also a transfer source so that its mips can be evicted */
+  auto *Residency = new vulkan::ResidentTexture(
+      vk::ImageCreateInfo({}, Type, TexelFormat, extent3d(extent), numMips,
+                          numLayers, vk::SampleCountFlagBits::e1,
+                          vk::ImageTiling::eOptimal,
+                          vk::ImageUsageFlagBits::eSampled |
+                              vk::ImageUsageFlagBits::eTransferSrc |
+                              vk::ImageUsageFlagBits::eTransferDst,
+                          {}, {}, {}, vk::ImageLayout::eUndefined),
+      imageViewType,
+      vk::ComponentMapping(HshToVkComponentSwizzle(redSwizzle),
+                           HshToVkComponentSwizzle(greenSwizzle),
+                           HshToVkComponentSwizzle(blueSwizzle),
+                           HshToVkComponentSwizzle(alphaSwizzle)),
+      Copies, BufferSize, location.with_field(Traits::Name));
+  Residency->Allocation =
+      vulkan::AllocateTexture(Residency->Location, Residency->CreateInfo);
+  Residency->ImageView =
       vulkan::Globals.Device
           .createImageViewUnique(vk::ImageViewCreateInfo(
-              {}, Ret.Allocation.GetImage(), imageViewType, TexelFormat,
-              vk::ComponentMapping(HshToVkComponentSwizzle(redSwizzle),
-                                   HshToVkComponentSwizzle(greenSwizzle),
-                                   HshToVkComponentSwizzle(blueSwizzle),
-                                   HshToVkComponentSwizzle(alphaSwizzle)),
+              {}, Residency->Allocation.GetImage(), imageViewType,
+              TexelFormat, Residency->Components,
               vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0,
                                         numMips, 0, numLayers)))
           .value;
-  vulkan::Globals.SetDebugObjectName(location, Ret.ImageView.get());
+  vulkan::Globals.SetDebugObjectName(location, Residency->ImageView.get());
+  TargetTraits<Target::VULKAN_SPIRV>::TextureOwner Ret{
+      Residency, std::uint8_t(numMips), HshFormatIsInteger(format)};
+  auto Image = Residency->Allocation.GetImage();
 
-  vulkan::Globals.CopyCmd.pipelineBarrier(
-      vk::PipelineStageFlagBits::eTopOfPipe,
-      vk::PipelineStageFlagBits::eTransfer, vk::DependencyFlagBits::eByRegion,
-      {}, {},
-      vk::ImageMemoryBarrier(
-          vk::AccessFlagBits(0), vk::AccessFlagBits::eTransferWrite,
-          vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal,
-          VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED,
-          Ret.Allocation.GetImage(),
-          vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0,
-                                    VK_REMAINING_MIP_LEVELS, 0,
-                                    VK_REMAINING_ARRAY_LAYERS)));
-  vulkan::Globals.CopyCmd.copyBufferToImage(
-      UploadBuffer.GetBuffer(), Ret.Allocation.GetImage(),
-      vk::ImageLayout::eTransferDstOptimal, {numMips, Copies.data()});
-  vulkan::Globals.CopyCmd.pipelineBarrier(
-      vk::PipelineStageFlagBits::eTransfer,
-      vk::PipelineStageFlagBits::eVertexShader |
-          vk::PipelineStageFlagBits::eTessellationControlShader |
-          vk::PipelineStageFlagBits::eTessellationEvaluationShader |
-          vk::PipelineStageFlagBits::eGeometryShader |
-          vk::PipelineStageFlagBits::eFragmentShader,
-      vk::DependencyFlagBits::eByRegion, {}, {},
-      vk::ImageMemoryBarrier(
-          vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eShaderRead,
-          vk::ImageLayout::eTransferDstOptimal,
-          vk::ImageLayout::eShaderReadOnlyOptimal, VK_QUEUE_FAMILY_IGNORED,
-          VK_QUEUE_FAMILY_IGNORED, Ret.Allocation.GetImage(),
-          vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0,
-                                    VK_REMAINING_MIP_LEVELS, 0,
-                                    VK_REMAINING_ARRAY_LAYERS)));
+  vulkan::RecordUpload(
+      std::move(UploadBuffer),
+      [&](vk::CommandBuffer Cmd, vk::Buffer Upload) {
+        Cmd.pipelineBarrier(
+            vk::PipelineStageFlagBits::eTopOfPipe,
+            vk::PipelineStageFlagBits::eTransfer,
+            vk::DependencyFlagBits::eByRegion, {}, {},
+            vk::ImageMemoryBarrier(
+                vk::AccessFlagBits(0), vk::AccessFlagBits::eTransferWrite,
+                vk::ImageLayout::eUndefined,
+                vk::ImageLayout::eTransferDstOptimal, VK_QUEUE_FAMILY_IGNORED,
+                VK_QUEUE_FAMILY_IGNORED, Image,
+                vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0,
+                                          VK_REMAINING_MIP_LEVELS, 0,
+                                          VK_REMAINING_ARRAY_LAYERS)));
+        Cmd.copyBufferToImage(Upload, Image,
+                              vk::ImageLayout::eTransferDstOptimal,
+                              {numMips, Copies.data()});
+        Cmd.pipelineBarrier(
+            vk::PipelineStageFlagBits::eTransfer,
+            vk::PipelineStageFlagBits::eVertexShader |
+                vk::PipelineStageFlagBits::eTessellationControlShader |
+                vk::PipelineStageFlagBits::eTessellationEvaluationShader |
+                vk::PipelineStageFlagBits::eGeometryShader |
+                vk::PipelineStageFlagBits::eFragmentShader,
+            vk::DependencyFlagBits::eByRegion, {}, {},
+            vk::ImageMemoryBarrier(
+                vk::AccessFlagBits::eTransferWrite,
+                vk::AccessFlagBits::eShaderRead,
+                vk::ImageLayout::eTransferDstOptimal,
+                vk::ImageLayout::eShaderReadOnlyOptimal,
+                VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, Image,
+                vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0,
+                                          VK_REMAINING_MIP_LEVELS, 0,
+                                          VK_REMAINING_ARRAY_LAYERS)));
+      },
+      vulkan::UploadTarget{nullptr, Residency});
 
   return Ret;
 }
@@ -1392,31 +1568,28 @@ struct MyDescriptorSetLayoutCreateInfo : vk::DescriptorSetLayoutCreateInfo {
                                                  hsh::detail::MaxImages +
                                                  hsh::detail::MaxSamplers>
       Bindings;
-  template <std::size_t... USeq, std::size_t... ISeq, std::size_t... SSeq>
-  constexpr MyDescriptorSetLayoutCreateInfo(
-      std::index_sequence<USeq...>, std::index_sequence<ISeq...>,
-      std::index_sequence<SSeq...>) noexcept
+  explicit MyDescriptorSetLayoutCreateInfo(
+      DescriptorSignature Signature) noexcept
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wuninitialized"
-      : vk::DescriptorSetLayoutCreateInfo({}, Bindings.size(), Bindings.data()),
-        Bindings{vk::DescriptorSetLayoutBinding(
-                     USeq, vk::DescriptorType::eUniformBuffer, 1,
-                     vk::ShaderStageFlagBits::eAllGraphics)...,
-                 vk::DescriptorSetLayoutBinding(
-                     hsh::detail::MaxUniforms + ISeq,
-                     vk::DescriptorType::eSampledImage, 1,
-                     vk::ShaderStageFlagBits::eAllGraphics)...,
-                 vk::DescriptorSetLayoutBinding(
-                     hsh::detail::MaxUniforms + hsh::detail::MaxImages + SSeq,
-                     vk::DescriptorType::eSampler, 1,
-                     vk::ShaderStageFlagBits::eAllGraphics)...} {
-  }
+      : vk::DescriptorSetLayoutCreateInfo({}, Signature.NumDescriptors(),
+                                          Bindings.data()) {
 #pragma GCC diagnostic pop
-  constexpr MyDescriptorSetLayoutCreateInfo() noexcept
-      : MyDescriptorSetLayoutCreateInfo(
-            std::make_index_sequence<hsh::detail::MaxUniforms>(),
-            std::make_index_sequence<hsh::detail::MaxImages>(),
-            std::make_index_sequence<hsh::detail::MaxSamplers>()) {}
+    auto BindingIt = Bindings.begin();
+    for (uint32_t i = 0; i < Signature.NumUniforms; ++i)
+      *BindingIt++ = vk::DescriptorSetLayoutBinding(
+          i, vk::DescriptorType::eUniformBuffer, 1,
+          vk::ShaderStageFlagBits::eAllGraphics);
+    for (uint32_t i = 0; i < Signature.NumImages; ++i)
+      *BindingIt++ = vk::DescriptorSetLayoutBinding(
+          hsh::detail::MaxUniforms + i, vk::DescriptorType::eSampledImage, 1,
+          vk::ShaderStageFlagBits::eAllGraphics);
+    for (uint32_t i = 0; i < Signature.NumSamplers; ++i)
+      *BindingIt++ = vk::DescriptorSetLayoutBinding(
+          hsh::detail::MaxUniforms + hsh::detail::MaxImages + i,
+          vk::DescriptorType::eSampler, 1,
+          vk::ShaderStageFlagBits::eAllGraphics);
+  }
 };
 
 struct MyPipelineLayoutCreateInfo : vk::PipelineLayoutCreateInfo {
@@ -1429,6 +1602,24 @@ struct MyPipelineLayoutCreateInfo : vk::PipelineLayoutCreateInfo {
 #pragma GCC diagnostic pop
 };
 
+DescriptorLayout &DescriptorLayoutCache::Get(
+    DescriptorSignature Signature) noexcept {
+  for (auto &Layout : Layouts)
+    if (Layout.GetSignature() == Signature)
+      return Layout;
+  auto SetLayout = Globals.Device
+                       .createDescriptorSetLayoutUnique(
+                           MyDescriptorSetLayoutCreateInfo(Signature))
+                       .value;
+  auto PipelineLayout =
+      Globals.Device
+          .createPipelineLayoutUnique(
+              MyPipelineLayoutCreateInfo(SetLayout.get()))
+          .value;
+  return Layouts.emplace_back(Signature, std::move(SetLayout),
+                              std::move(PipelineLayout));
+}
+
 struct MyCommandPoolCreateInfo : vk::CommandPoolCreateInfo {
   constexpr MyCommandPoolCreateInfo(uint32_t qfIdx) noexcept
       : vk::CommandPoolCreateInfo(
@@ -1438,7 +1629,7 @@ struct MyCommandPoolCreateInfo : vk::CommandPoolCreateInfo {
 struct MyCommandBufferAllocateInfo : vk::CommandBufferAllocateInfo {
   constexpr MyCommandBufferAllocateInfo(vk::CommandPool cmdPool) noexcept
       : vk::CommandBufferAllocateInfo(cmdPool, vk::CommandBufferLevel::ePrimary,
-                                      3) {}
+                                      4) {}
 };
 
 struct MyVmaAllocatorCreateInfo : VmaAllocatorCreateInfo {
@@ -1447,9 +1638,8 @@ struct MyVmaAllocatorCreateInfo : VmaAllocatorCreateInfo {
                            VkDevice Device, bool HasExtMemoryBudget) noexcept
       : VmaAllocatorCreateInfo{
             VmaAllocatorCreateFlagBits(
-                VMA_ALLOCATOR_CREATE_EXTERNALLY_SYNCHRONIZED_BIT |
-                (HasExtMemoryBudget ? VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT
-                                    : 0)),
+                HasExtMemoryBudget ? VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT
+                                   : 0),
             PhysDev,
             Device,
             0,
@@ -1508,15 +1698,20 @@ class vulkan_device_owner {
     vk::UniqueVmaAllocator VmaAllocator;
     vk::UniqueVmaPool UploadPool;
     vk::UniquePipelineCache PipelineCache;
-    vk::UniqueDescriptorSetLayout DescriptorSetLayout;
-    vk::UniquePipelineLayout PipelineLayout;
-    detail::vulkan::DescriptorPoolChain DescriptorPoolChain;
+    detail::vulkan::DescriptorLayoutCache DescriptorLayouts;
     vk::UniqueCommandPool CommandPool;
     std::vector<vk::UniqueCommandBuffer> CommandBuffers;
-    std::array<vk::UniqueFence, 3> CommandFences;
+    std::array<vk::UniqueFence, 4> CommandFences;
     vk::UniqueSemaphore ImageAcquireSem;
     vk::UniqueSemaphore RenderCompleteSem;
+    /* Unlink buffers and textures as DeletedResources destroys them */
+    detail::vulkan::BufferDefragmenter Defragmenter;
+    detail::vulkan::MemoryBudget Budget;
+    detail::vulkan::TextureResidency Residency;
     std::array<detail::vulkan::DeletedResources, 2> DeletedResources;
+    /* Pending uploads release their buffers into DeletedResources */
+    detail::vulkan::TransferQueue Transfers;
+    detail::vulkan::BindingArena BindingResources;
     bool BuiltPipelines = false;
 
     ~Data() noexcept {
@@ -1658,6 +1853,87 @@ public:
   }
 
   void wait_idle() noexcept { Data->Device->waitIdle(); }
+
+  /*
+   * Lets defragmentation move up to bytes_per_frame of static buffers at the
+   * end of a frame whenever device memory is fragmented. 0 disables it.
+   */
+  void set_defragmentation_budget(std::size_t bytes_per_frame) noexcept {
+    Data->Defragmenter.SetBudget(bytes_per_frame);
+  }
+
+  struct defragmentation_stats {
+    /* Current state of all device memory blocks */
+    uint64_t used_bytes;
+    uint64_t unused_bytes;
+    uint32_t unused_ranges;
+    uint64_t largest_unused_range;
+    uint32_t blocks;
+    /* Totals over all defragmentation passes */
+    uint64_t passes;
+    uint64_t bytes_moved;
+    uint64_t allocations_moved;
+    uint64_t blocks_freed;
+  };
+
+  defragmentation_stats get_defragmentation_stats() const noexcept {
+    VmaStats Stats;
+    vmaCalculateStats(Data->VmaAllocator.get(), &Stats);
+    auto &Defrag = Data->Defragmenter;
+    return {Stats.total.usedBytes,
+            Stats.total.unusedBytes,
+            Stats.total.unusedRangeCount,
+            Stats.total.unusedRangeSizeMax,
+            Stats.total.blockCount,
+            Defrag.GetPasses(),
+            Defrag.GetBytesMoved(),
+            Defrag.GetAllocationsMoved(),
+            Defrag.GetBlocksFreed()};
+  }
+
+  /*
+   * Static textures that have not been drawn with for cold_frames frames
+   * lose their largest mips while device-local usage is above
+   * evict_fraction of the budget. They are restored when drawn with again
+   * once usage is below restore_fraction.
+   */
+  void set_texture_residency(float evict_fraction, float restore_fraction,
+                             uint32_t cold_frames) noexcept {
+    Data->Residency.SetLimits(evict_fraction, restore_fraction, cold_frames);
+  }
+
+  struct memory_stats {
+    /* Device-local heaps as of the last frame */
+    uint64_t usage;
+    uint64_t budget;
+    /* Totals over all frames */
+    uint64_t evictions;
+    uint64_t restorations;
+    /* Textures currently missing mips and the bytes held on the host */
+    uint32_t textures_evicted;
+    uint64_t evicted_bytes;
+  };
+
+  memory_stats get_memory_stats() const noexcept {
+    auto &Residency = Data->Residency;
+    return {Data->Budget.GetUsage(),   Data->Budget.GetBudget(),
+            Residency.GetEvictions(),  Residency.GetRestorations(),
+            Residency.GetNumEvicted(), Residency.GetEvictedBytes()};
+  }
+
+  struct pipeline_stats {
+    /* Totals over all pipeline coordinators built so far */
+    uint64_t create_calls;
+    uint64_t pipelines;
+    uint64_t derivatives;
+    std::chrono::nanoseconds create_time;
+  };
+
+  pipeline_stats get_pipeline_stats() const noexcept {
+    auto &Globals = detail::vulkan::Globals;
+    return {Globals.PipelineCreateCalls, Globals.PipelinesCreated,
+            Globals.PipelineDerivativesCreated, Globals.PipelineCreateTime};
+  }
 };
 
 class vulkan_instance_owner {
@@ -1773,21 +2049,14 @@ public:
 
       detail::vulkan::Globals.DeletedResourcesArr = &Data.DeletedResources;
       detail::vulkan::Globals.DeletedResources = &Data.DeletedResources[0];
-
-      Data.DescriptorSetLayout =
-          Data.Device
-              ->createDescriptorSetLayoutUnique(
-                  detail::vulkan::MyDescriptorSetLayoutCreateInfo())
-              .value;
-      detail::vulkan::Globals.SetDescriptorSetLayout(
-          Data.DescriptorSetLayout.get());
-      Data.PipelineLayout = Data.Device
-                                ->createPipelineLayoutUnique(
-                                    detail::vulkan::MyPipelineLayoutCreateInfo(
-                                        Data.DescriptorSetLayout.get()))
-                                .value;
-      detail::vulkan::Globals.PipelineLayout = Data.PipelineLayout.get();
-      detail::vulkan::Globals.DescriptorPoolChain = &Data.DescriptorPoolChain;
+      detail::vulkan::Globals.Transfers = &Data.Transfers;
+      detail::vulkan::Globals.Defragmenter = &Data.Defragmenter;
+      detail::vulkan::Globals.Budget = &Data.Budget;
+      detail::vulkan::Globals.Residency = &Data.Residency;
+      detail::vulkan::Globals.BindingResources = &Data.BindingResources;
+      detail::vulkan::Globals.RenderThread = std::this_thread::get_id();
+
+      detail::vulkan::Globals.DescriptorLayouts = &Data.DescriptorLayouts;
       detail::vulkan::Globals.Queue = Data.Device->getQueue(QFIdx, 0);
       Data.CommandPool = Data.Device
                              ->createCommandPoolUnique(
@@ -1811,11 +2080,16 @@ public:
           Data.Device
               ->createFenceUnique(vk::FenceCreateInfo(vk::FenceCreateFlags{}))
               .value,
+          Data.Device
+              ->createFenceUnique(vk::FenceCreateInfo(vk::FenceCreateFlags{}))
+              .value,
       };
       for (int i = 0; i < 2; ++i)
         detail::vulkan::Globals.CommandFences[i] = Data.CommandFences[i].get();
       detail::vulkan::Globals.CopyCmd = Data.CommandBuffers[2].get();
       detail::vulkan::Globals.CopyFence = Data.CommandFences[2].get();
+      detail::vulkan::Globals.MaintenanceCmd = Data.CommandBuffers[3].get();
+      detail::vulkan::Globals.MaintenanceFence = Data.CommandFences[3].get();
       Data.ImageAcquireSem = Data.Device->createSemaphoreUnique({}).value;
       detail::vulkan::Globals.ImageAcquireSem = Data.ImageAcquireSem.get();
       Data.RenderCompleteSem = Data.Device->createSemaphoreUnique({}).value;
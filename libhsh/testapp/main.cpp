@@ -6,6 +6,7 @@
 #include <hsh/hsh.h>
 #include <iostream>
 #include <string_view>
+#include <vector>
 using namespace std::literals;
 
 #include "test-input.h"
@@ -144,7 +145,62 @@ struct PipelineCacheFileManager {
   }
 };
 
+/*
+ * Measures the memory held by a large number of bindings of one pipeline and
+ * the time taken to bind and draw all of them in a frame.
+ */
+struct BindingBenchmark {
+  std::size_t NumBindings;
+  unsigned NumFrames = 0;
+  MyNS::Binding Resources;
+  std::vector<hsh::binding> Bindings;
+  std::chrono::steady_clock::duration DrawTime{};
+
+  explicit BindingBenchmark(std::size_t NumBindings)
+      : NumBindings(NumBindings) {}
+
+  void Setup() {
+    Resources = MyNS::BuildPipeline();
+    auto Start = std::chrono::steady_clock::now();
+    Bindings.resize(NumBindings);
+    for (auto &B : Bindings)
+      MyNS::BindDrawSomething(B, Resources.Uniform.get(), Resources.VBO.get(),
+                              Resources.Tex.get());
+    auto Elapsed = std::chrono::steady_clock::now() - Start;
+    auto ArenaBytes =
+        hsh::detail::vulkan::Globals.BindingResources->GetLiveBytes();
+    std::cerr << "Created " << NumBindings << " bindings in "
+              << std::chrono::duration<double, std::milli>(Elapsed).count()
+              << " ms\n"
+              << "sizeof(hsh::binding): " << sizeof(hsh::binding)
+              << " bytes, binding resources: " << ArenaBytes << " bytes ("
+              << double(sizeof(hsh::binding) * NumBindings + ArenaBytes) /
+                     NumBindings
+              << " bytes per binding)\n";
+  }
+
+  /* Returns false once enough frames have been measured */
+  bool Draw() {
+    auto Start = std::chrono::steady_clock::now();
+    for (auto &B : Bindings)
+      B.draw(0, 3);
+    DrawTime += std::chrono::steady_clock::now() - Start;
+    if (++NumFrames < 100)
+      return true;
+    auto Seconds = std::chrono::duration<double>(DrawTime).count();
+    std::cerr << "Bound and drew " << NumBindings * NumFrames
+              << " bindings at " << NumBindings * NumFrames / Seconds
+              << " per second\n";
+    return false;
+  }
+};
+
 int main(int argc, char **argv) {
+  std::unique_ptr<BindingBenchmark> Benchmark;
+  if (argc > 1 && argv[1] == "--bench-bindings"sv)
+    Benchmark = std::make_unique<BindingBenchmark>(
+        argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 100000);
+
   XcbConnection Connection;
   XcbWindow Window = Connection.makeWindow();
 
@@ -195,6 +251,14 @@ int main(int argc, char **argv) {
 
   PipelineCacheFileManager PCFM;
   Device.build_pipelines(PCFM);
+  auto PipelineStats = Device.get_pipeline_stats();
+  std::cerr << "Created " << PipelineStats.pipelines << " pipelines ("
+            << PipelineStats.derivatives << " derivatives) in "
+            << PipelineStats.create_calls << " calls taking "
+            << std::chrono::duration<double, std::milli>(
+                   PipelineStats.create_time)
+                   .count()
+            << " ms\n";
 
   MyNS::Binding PipelineBind{};
   MyNS::Binding PipelineTemplate1Bind{};
@@ -206,6 +270,23 @@ int main(int argc, char **argv) {
   ModelResources ModRes{};
   hsh::binding ModelBinding;
 
+  if (Benchmark) {
+    bool Running = true;
+    Connection.runloop([&]() {
+      Device.enter_draw_context([&]() {
+        if (Benchmark->Bindings.empty())
+          Benchmark->Setup();
+        Surface.acquire_next_image();
+        RenderTexture.attach();
+        hsh::clear_attachments();
+        Running = Benchmark->Draw();
+        RenderTexture.resolve_surface(Surface.get());
+      });
+      return Running;
+    });
+    return 0;
+  }
+
   Connection.runloop([&]() {
     Device.enter_draw_context([&]() {
       if (!PipelineBind.Binding) {
@@ -0,0 +1,334 @@
+#define HSH_IMPLEMENTATION
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <hsh/hsh.h>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ * Creates and destroys resources from many threads while the main thread
+ * renders frames. Half of the resources are handed to the main thread and
+ * destroyed there so that releases also cross threads. Defragmentation runs
+ * throughout to compact the memory the churn leaves behind. The other half
+ * is kept until the end of the round, when the textures are read back to
+ * check that the uploads recorded on every thread landed.
+ *
+ * Each round uses a new device with the same worker threads, so the upload
+ * contexts that the threads cached for the previous device must be replaced.
+ *
+ * Exits with 77, which the test registration treats as skipped, when there
+ * is no Vulkan device.
+ */
+
+constexpr unsigned NumThreads = 16;
+constexpr unsigned NumIterations = 256;
+constexpr unsigned NumRounds = 2;
+constexpr int SkipReturnCode = 77;
+
+struct Vertex {
+  hsh::float3 position;
+  hsh::float3 normal;
+};
+
+struct Resources {
+  hsh::owner<hsh::vertex_buffer<Vertex>> VBO;
+  hsh::owner<hsh::texture2d> Tex;
+};
+
+/* Differs between rounds for the same thread and iteration */
+static std::uint8_t FillByte(unsigned Seed) {
+  return std::uint8_t(Seed ^ (Seed >> 8));
+}
+
+static Resources CreateResources(unsigned Seed) {
+  std::array<Vertex, 3> VtxData{};
+  for (auto &V : VtxData)
+    V.position = hsh::float3{float(Seed), 0.f, 0.f};
+  return {hsh::create_vertex_buffer(VtxData),
+          hsh::create_texture2d({64, 64}, hsh::Format::RGBA8_UNORM, 4,
+                                [Seed](void *buf, std::size_t size) {
+                                  std::memset(buf, FillByte(Seed), size);
+                                })};
+}
+
+struct KeptResources {
+  unsigned Seed;
+  Resources Res;
+};
+
+/*
+ * Copies the resident mips of every texture into host memory and counts the
+ * textures with a texel that differs from the byte its upload was filled
+ * with. Vertex buffers are not transfer sources, so they are not checked.
+ */
+static unsigned VerifyTextures(const std::vector<KeptResources> &Kept) {
+  using namespace hsh::detail::vulkan;
+  struct Region {
+    unsigned Seed;
+    vk::DeviceSize Offset, Size;
+  };
+  std::vector<Region> Regions;
+  std::vector<vk::ImageMemoryBarrier> ToTransfer, ToShader;
+  std::vector<std::pair<vk::Image, vk::BufferImageCopy>> Copies;
+  vk::DeviceSize TotalSize = 0;
+  for (const auto &K : Kept) {
+    const ResidentTexture *R = K.Res.Tex.Owner.Residency;
+    auto Image = R->Allocation.GetImage();
+    vk::ImageSubresourceRange Range(vk::ImageAspectFlagBits::eColor, 0,
+                                    R->NumResidentMips(), 0, 1);
+    ToTransfer.emplace_back(vk::AccessFlagBits::eShaderRead,
+                            vk::AccessFlagBits::eTransferRead,
+                            vk::ImageLayout::eShaderReadOnlyOptimal,
+                            vk::ImageLayout::eTransferSrcOptimal,
+                            VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED,
+                            Image, Range);
+    ToShader.emplace_back(vk::AccessFlagBits::eTransferRead,
+                          vk::AccessFlagBits::eShaderRead,
+                          vk::ImageLayout::eTransferSrcOptimal,
+                          vk::ImageLayout::eShaderReadOnlyOptimal,
+                          VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED,
+                          Image, Range);
+    for (uint32_t Level = 0; Level < R->NumResidentMips(); ++Level) {
+      auto Mip = R->FirstMip + Level;
+      Copies.emplace_back(
+          Image, vk::BufferImageCopy(
+                     TotalSize, 0, 0,
+                     {vk::ImageAspectFlagBits::eColor, Level, 0, 1}, {},
+                     R->MipExtent(Mip)));
+      Regions.push_back({K.Seed, TotalSize, R->MipSize(Mip)});
+      TotalSize += R->MipSize(Mip);
+    }
+  }
+
+  VmaAllocationCreateInfo AllocCreateInfo{};
+  AllocCreateInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+  AllocCreateInfo.usage = VMA_MEMORY_USAGE_GPU_TO_CPU;
+  VkBuffer Buffer;
+  VmaAllocation Allocation;
+  VmaAllocationInfo AllocInfo;
+  auto Result = vmaCreateBuffer(
+      vk::BufferCreateInfo({}, TotalSize,
+                           vk::BufferUsageFlagBits::eTransferDst),
+      AllocCreateInfo, &Buffer, &Allocation, &AllocInfo);
+  if (Result != VK_SUCCESS) {
+    std::cerr << "Unable to allocate " << TotalSize << " readback bytes\n";
+    return unsigned(Kept.size());
+  }
+
+  auto Pool = Globals.Device
+                  .createCommandPoolUnique(vk::CommandPoolCreateInfo(
+                      vk::CommandPoolCreateFlagBits::eTransient,
+                      Globals.QueueFamilyIdx))
+                  .value;
+  auto Cmd = std::move(Globals.Device
+                           .allocateCommandBuffersUnique(
+                               vk::CommandBufferAllocateInfo(
+                                   Pool.get(),
+                                   vk::CommandBufferLevel::ePrimary, 1))
+                           .value[0]);
+  Cmd->begin(vk::CommandBufferBeginInfo(
+      vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+  Cmd->pipelineBarrier(vk::PipelineStageFlagBits::eFragmentShader,
+                       vk::PipelineStageFlagBits::eTransfer, {}, {}, {},
+                       ToTransfer);
+  for (const auto &[Image, Copy] : Copies)
+    Cmd->copyImageToBuffer(Image, vk::ImageLayout::eTransferSrcOptimal,
+                           vk::Buffer(Buffer), Copy);
+  Cmd->pipelineBarrier(
+      vk::PipelineStageFlagBits::eTransfer,
+      vk::PipelineStageFlagBits::eFragmentShader |
+          vk::PipelineStageFlagBits::eHost,
+      {}, {},
+      vk::BufferMemoryBarrier(vk::AccessFlagBits::eTransferWrite,
+                              vk::AccessFlagBits::eHostRead,
+                              VK_QUEUE_FAMILY_IGNORED,
+                              VK_QUEUE_FAMILY_IGNORED, vk::Buffer(Buffer), 0,
+                              TotalSize),
+      ToShader);
+  Cmd->end();
+  auto Fence = Globals.Device.createFenceUnique({}).value;
+  Globals.Queue.submit(vk::SubmitInfo(0, nullptr, nullptr, 1, &Cmd.get()),
+                       Fence.get());
+  Globals.Device.waitForFences(Fence.get(), VK_TRUE, UINT64_MAX);
+  vmaInvalidateAllocation(Globals.Allocator, Allocation, 0, VK_WHOLE_SIZE);
+
+  const auto *Data = static_cast<const std::uint8_t *>(AllocInfo.pMappedData);
+  /* The mips of a texture are consecutive; report each texture once */
+  unsigned Mismatches = 0;
+  unsigned BadSeed = ~0u;
+  for (const auto &R : Regions) {
+    if (R.Seed == BadSeed)
+      continue;
+    auto Expected = FillByte(R.Seed);
+    for (vk::DeviceSize i = 0; i < R.Size; ++i) {
+      if (Data[R.Offset + i] != Expected) {
+        std::cerr << "Texture " << R.Seed << " has "
+                  << unsigned(Data[R.Offset + i]) << " instead of "
+                  << unsigned(Expected) << "\n";
+        ++Mismatches;
+        BadSeed = R.Seed;
+        break;
+      }
+    }
+  }
+  vmaDestroyBuffer(Globals.Allocator, Buffer, Allocation);
+  return Mismatches;
+}
+
+class Workers {
+  std::mutex Lock;
+  std::condition_variable Start;
+  unsigned Round = 0;
+  bool Exit = false;
+  std::vector<std::thread> Threads;
+
+  void Work(unsigned t) {
+    for (unsigned Seen = 0;;) {
+      {
+        std::unique_lock<std::mutex> Guard(Lock);
+        Start.wait(Guard, [&]() { return Exit || Round != Seen; });
+        if (Exit)
+          return;
+        Seen = Round;
+      }
+      for (unsigned i = 0; i < NumIterations; ++i) {
+        unsigned Seed = ((Seen - 1) * NumThreads + t) * NumIterations + i;
+        auto Res = CreateResources(Seed);
+        ++Created;
+        if (i & 1) {
+          std::lock_guard<std::mutex> Guard(HandoffLock);
+          Handoff.push_back(std::move(Res));
+        } else {
+          Kept[t].push_back({Seed, std::move(Res)});
+        }
+      }
+      --Running;
+    }
+  }
+
+public:
+  std::mutex HandoffLock;
+  std::vector<Resources> Handoff;
+  std::array<std::vector<KeptResources>, NumThreads> Kept;
+  std::atomic<unsigned> Created{0};
+  std::atomic<unsigned> Running{0};
+
+  Workers() {
+    for (unsigned t = 0; t < NumThreads; ++t)
+      Threads.emplace_back([this, t]() { Work(t); });
+  }
+  ~Workers() {
+    {
+      std::lock_guard<std::mutex> Guard(Lock);
+      Exit = true;
+    }
+    Start.notify_all();
+    for (auto &Thread : Threads)
+      Thread.join();
+  }
+
+  void BeginRound() {
+    Created = 0;
+    Running = NumThreads;
+    {
+      std::lock_guard<std::mutex> Guard(Lock);
+      ++Round;
+    }
+    Start.notify_all();
+  }
+};
+
+static int RunRound(hsh::vulkan_instance_owner &Instance, Workers &W) {
+  auto Device = Instance.enumerate_vulkan_devices(
+      [&](const vk::PhysicalDeviceProperties &Props,
+          const vk::PhysicalDeviceDriverProperties &DriverProps) {
+        return true;
+      });
+  if (!Device) {
+    std::cerr << "No vulkan devices found\n";
+    return SkipReturnCode;
+  }
+
+  Device.set_defragmentation_budget(1024 * 1024);
+
+  W.BeginRound();
+  unsigned Frames = 0;
+  while (W.Running) {
+    Device.enter_draw_context([&]() {
+      /* Some resources are created on the render thread as well */
+      auto Res = CreateResources(Frames);
+      std::lock_guard<std::mutex> Guard(W.HandoffLock);
+      W.Handoff.clear();
+    });
+    ++Frames;
+  }
+
+  /* Flush the last submissions and deferred deletions */
+  for (int i = 0; i < 3; ++i)
+    Device.enter_draw_context([&]() {
+      std::lock_guard<std::mutex> Guard(W.HandoffLock);
+      W.Handoff.clear();
+    });
+  Device.wait_idle();
+
+  /* Destroyed before the device on every return */
+  std::vector<KeptResources> AllKept;
+  for (auto &ThreadKept : W.Kept) {
+    for (auto &K : ThreadKept)
+      AllKept.push_back(std::move(K));
+    ThreadKept.clear();
+  }
+
+  if (W.Created != NumThreads * NumIterations) {
+    std::cerr << "Created " << W.Created << " of "
+              << NumThreads * NumIterations << " resources\n";
+    return 1;
+  }
+  std::cerr << "Created " << W.Created << " resources on " << NumThreads
+            << " threads over " << Frames << " frames\n";
+
+  if (unsigned Mismatches = VerifyTextures(AllKept)) {
+    std::cerr << Mismatches << " of " << AllKept.size()
+              << " textures have wrong contents\n";
+    return 1;
+  }
+  std::cerr << "Verified the contents of " << AllKept.size()
+            << " textures\n";
+  auto Stats = Device.get_defragmentation_stats();
+  std::cerr << "Defragmentation moved " << Stats.bytes_moved << " bytes in "
+            << Stats.allocations_moved << " allocations over " << Stats.passes
+            << " passes; " << Stats.unused_bytes << " of "
+            << Stats.used_bytes + Stats.unused_bytes << " bytes in "
+            << Stats.blocks << " blocks unused across " << Stats.unused_ranges
+            << " ranges\n";
+  auto Memory = Device.get_memory_stats();
+  std::cerr << "Device-local usage " << Memory.usage << " of "
+            << Memory.budget << " bytes; " << Memory.evictions
+            << " mip evictions and " << Memory.restorations
+            << " restorations\n";
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  auto Instance = hsh::create_vulkan_instance(
+      "hsh-stress-test", 0, "test-engine", 0,
+      [](vk::DebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
+         vk::DebugUtilsMessageTypeFlagBitsEXT messageTypes,
+         const vk::DebugUtilsMessengerCallbackDataEXT &pCallbackData) {
+        std::cerr << to_string(messageSeverity) << " "
+                  << to_string(messageTypes) << " " << pCallbackData.pMessage
+                  << "\n";
+      });
+  if (!Instance)
+    return SkipReturnCode;
+
+  Workers W;
+  for (unsigned Round = 0; Round < NumRounds; ++Round)
+    if (int Ret = RunRound(Instance, W))
+      return Ret;
+  return 0;
+}
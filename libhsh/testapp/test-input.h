@@ -38,5 +38,7 @@ struct Binding {
   hsh::binding Binding;
 };
 Binding BuildPipeline();
+void BindDrawSomething(hsh::binding &b, hsh::uniform_buffer_typeless u,
+                       hsh::vertex_buffer_typeless v, hsh::texture2d tex0);
 Binding BuildPipelineTemplated(bool Something, MyNS::AlphaMode AM);
 }
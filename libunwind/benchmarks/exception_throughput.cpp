@@ -0,0 +1,142 @@
+//===----------------------- exception_throughput.cpp ---------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//
+// Measures how many exceptions per second are thrown and caught while
+// several threads throw at once through frames spread over several DSOs.
+//
+// usage: unwind-exception-throughput [--threads=1,4,...] [--dsos=1,16,...]
+//                                    [--depth=N] [--iterations=N]
+//
+// Every combination of thread and DSO count is measured. Each throw unwinds
+// --depth frames, which cycle through the first --dsos benchmark modules.
+//===----------------------------------------------------------------------===//
+
+#include <dlfcn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+// Chain points at the FrameFn of the next frame.
+typedef void (*FrameFn)(const void *Chain, unsigned Depth);
+
+static std::vector<unsigned> parseList(const char *Arg) {
+  std::vector<unsigned> Values;
+  while (*Arg) {
+    char *End;
+    unsigned long Value = strtoul(Arg, &End, 10);
+    if (End == Arg || Value == 0) {
+      fprintf(stderr, "error: invalid count list '%s'\n", Arg);
+      exit(1);
+    }
+    Values.push_back(unsigned(Value));
+    Arg = *End == ',' ? End + 1 : End;
+  }
+  return Values;
+}
+
+static FrameFn loadFrame(unsigned Index) {
+  char Path[4096];
+  snprintf(Path, sizeof(Path), "%s/unwind_benchmark_dso%u%s",
+           UNWIND_BENCHMARK_DSO_DIR, Index, UNWIND_BENCHMARK_DSO_SUFFIX);
+  void *Handle = dlopen(Path, RTLD_NOW | RTLD_LOCAL);
+  if (!Handle) {
+    fprintf(stderr, "error: %s\n", dlerror());
+    exit(1);
+  }
+  void *Sym = dlsym(Handle, "unwind_benchmark_frame");
+  if (!Sym) {
+    fprintf(stderr, "error: %s\n", dlerror());
+    exit(1);
+  }
+  return reinterpret_cast<FrameFn>(Sym);
+}
+
+/// Throws Iterations exceptions through the chain and returns how many were
+/// caught.
+static unsigned throwMany(const std::vector<FrameFn> &Chain,
+                          unsigned Iterations) {
+  unsigned Caught = 0;
+  for (unsigned I = 0; I < Iterations; ++I) {
+    try {
+      Chain[0](Chain.data() + 1, unsigned(Chain.size() - 1));
+    } catch (unsigned) {
+      ++Caught;
+    }
+  }
+  return Caught;
+}
+
+int main(int argc, char **argv) {
+  std::vector<unsigned> Threads = {1, 2, 4, 8, 16};
+  std::vector<unsigned> DSOs = {1, 8, UNWIND_BENCHMARK_DSOS};
+  unsigned Depth = 16;
+  unsigned Iterations = 2000;
+  for (int I = 1; I < argc; ++I) {
+    if (!strncmp(argv[I], "--threads=", 10))
+      Threads = parseList(argv[I] + 10);
+    else if (!strncmp(argv[I], "--dsos=", 7))
+      DSOs = parseList(argv[I] + 7);
+    else if (!strncmp(argv[I], "--depth=", 8))
+      Depth = parseList(argv[I] + 8).back();
+    else if (!strncmp(argv[I], "--iterations=", 13))
+      Iterations = parseList(argv[I] + 13).back();
+    else {
+      fprintf(stderr, "error: unknown argument '%s'\n", argv[I]);
+      return 1;
+    }
+  }
+
+  std::vector<FrameFn> Frames;
+  for (unsigned I = 0; I < UNWIND_BENCHMARK_DSOS; ++I)
+    Frames.push_back(loadFrame(I));
+
+  printf("%8s %8s %14s %14s\n", "threads", "dsos", "throws/s", "us/throw");
+  for (unsigned NumDSOs : DSOs) {
+    if (NumDSOs > Frames.size()) {
+      fprintf(stderr, "error: only %u benchmark DSOs were built\n",
+              unsigned(Frames.size()));
+      return 1;
+    }
+    // The last frame throws; every other frame calls the next.
+    std::vector<FrameFn> Chain;
+    for (unsigned I = 0; I < Depth; ++I)
+      Chain.push_back(Frames[I % NumDSOs]);
+
+    // Unwind once up front so one-time lookups aren't measured.
+    throwMany(Chain, 1);
+
+    for (unsigned NumThreads : Threads) {
+      std::vector<std::thread> Workers;
+      std::vector<unsigned> Caught(NumThreads);
+      auto Start = std::chrono::steady_clock::now();
+      for (unsigned T = 0; T < NumThreads; ++T)
+        Workers.emplace_back(
+            [&, T]() { Caught[T] = throwMany(Chain, Iterations); });
+      for (auto &Worker : Workers)
+        Worker.join();
+      std::chrono::duration<double> Elapsed =
+          std::chrono::steady_clock::now() - Start;
+
+      unsigned Total = 0;
+      for (unsigned C : Caught)
+        Total += C;
+      if (Total != NumThreads * Iterations) {
+        fprintf(stderr, "error: caught %u of %u exceptions\n", Total,
+                NumThreads * Iterations);
+        return 1;
+      }
+      printf("%8u %8u %14.0f %14.2f\n", NumThreads, NumDSOs,
+             Total / Elapsed.count(),
+             Elapsed.count() * 1e6 * NumThreads / Total);
+    }
+  }
+  return 0;
+}
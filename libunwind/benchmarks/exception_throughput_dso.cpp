@@ -0,0 +1,26 @@
+//===--------------------- exception_throughput_dso.cpp -------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//
+// One frame of the exception throughput benchmark. Every benchmark module is
+// built from this file, so each has its own copy of the frame and its unwind
+// information.
+//===----------------------------------------------------------------------===//
+
+// Chain points at the FrameFn of the next frame.
+typedef void (*FrameFn)(const void *Chain, unsigned Depth);
+
+/// Calls the next frame of the chain, or throws once Depth frames are on the
+/// stack.
+extern "C" __attribute__((visibility("default"), noinline)) void
+unwind_benchmark_frame(const void *Chain, unsigned Depth) {
+  if (Depth == 0)
+    throw Depth;
+  const FrameFn *Next = static_cast<const FrameFn *>(Chain);
+  (*Next)(Next + 1, Depth - 1);
+  // Keep this frame on the stack rather than tail calling.
+  asm volatile("" ::: "memory");
+}
@@ -14,6 +14,7 @@
 
 #include "config.h"
 #include <limits.h>
+#include <string.h>
 
 #ifdef _LIBUNWIND_DEBUG_FRAMEHEADER_CACHE
 #define _LIBUNWIND_FRAMEHEADERCACHE_TRACE0(x) _LIBUNWIND_LOG0(x)
@@ -34,31 +35,27 @@ class _LIBUNWIND_HIDDEN FrameHeaderCache {
     uintptr_t LowPC() { return Info.dso_base; };
     uintptr_t HighPC() { return Info.dso_base + Info.dwarf_section_length; };
     UnwindInfoSections Info;
-    CacheEntry *Next;
+    unsigned long LastUse;
   };
 
-  static const size_t kCacheEntryCount = 8;
+public:
+  static const size_t kCacheEntryCount = 64;
 
+private:
   // Can't depend on the C++ standard library in libunwind, so use an array to
-  // allocate the entries, and two linked lists for ordering unused and recently
-  // used entries.  FIXME: Would the the extra memory for a doubly-linked list
-  // be better than the runtime cost of traversing a very short singly-linked
-  // list on a cache miss? The entries themselves are all small and consecutive,
-  // so unlikely to cause page faults when following the pointers. The memory
-  // spent on additional pointers could also be spent on more entries.
+  // allocate the entries. It is kept sorted by LowPC so lookups are a binary
+  // search even with many dsos. Every hit stamps the entry from a use counter;
+  // adding to a full cache evicts the entry that was used least recently,
+  // which takes a linear scan, but a miss has just walked every dso anyway.
 
   CacheEntry Entries[kCacheEntryCount];
-  CacheEntry *MostRecentlyUsed;
-  CacheEntry *Unused;
+  size_t NumEntries;
+  unsigned long UseCounter;
 
   void resetCache() {
     _LIBUNWIND_FRAMEHEADERCACHE_TRACE0("FrameHeaderCache reset");
-    MostRecentlyUsed = nullptr;
-    Unused = &Entries[0];
-    for (size_t i = 0; i < kCacheEntryCount - 1; i++) {
-      Entries[i].Next = &Entries[i + 1];
-    }
-    Entries[kCacheEntryCount - 1].Next = nullptr;
+    NumEntries = 0;
+    UseCounter = 0;
   }
 
   bool cacheNeedsReset(dl_phdr_info *PInfo) {
@@ -84,35 +81,40 @@ class _LIBUNWIND_HIDDEN FrameHeaderCache {
     return false;
   }
 
+  // Returns the index of the first entry starting above Addr.
+  size_t upperBound(uintptr_t Addr) {
+    size_t Low = 0;
+    size_t High = NumEntries;
+    while (Low < High) {
+      size_t Mid = Low + (High - Low) / 2;
+      if (Entries[Mid].LowPC() <= Addr)
+        Low = Mid + 1;
+      else
+        High = Mid;
+    }
+    return Low;
+  }
+
 public:
   bool find(dl_phdr_info *PInfo, size_t, void *data) {
-    if (cacheNeedsReset(PInfo) || MostRecentlyUsed == nullptr)
+    if (cacheNeedsReset(PInfo) || NumEntries == 0)
       return false;
 
     auto *CBData = static_cast<dl_iterate_cb_data *>(data);
-    CacheEntry *Current = MostRecentlyUsed;
-    CacheEntry *Previous = nullptr;
-    while (Current != nullptr) {
+    size_t Index = upperBound(CBData->targetAddr);
+    if (Index != 0) {
+      CacheEntry *Current = &Entries[Index - 1];
       _LIBUNWIND_FRAMEHEADERCACHE_TRACE(
           "FrameHeaderCache check %lx in [%lx - %lx)", CBData->targetAddr,
           Current->LowPC(), Current->HighPC());
-      if (Current->LowPC() <= CBData->targetAddr &&
-          CBData->targetAddr < Current->HighPC()) {
+      if (CBData->targetAddr < Current->HighPC()) {
         _LIBUNWIND_FRAMEHEADERCACHE_TRACE(
             "FrameHeaderCache hit %lx in [%lx - %lx)", CBData->targetAddr,
             Current->LowPC(), Current->HighPC());
-        if (Previous) {
-          // If there is no Previous, then Current is already the
-          // MostRecentlyUsed, and no need to move it up.
-          Previous->Next = Current->Next;
-          Current->Next = MostRecentlyUsed;
-          MostRecentlyUsed = Current;
-        }
+        Current->LastUse = ++UseCounter;
         *CBData->sects = Current->Info;
         return true;
       }
-      Previous = Current;
-      Current = Current->Next;
     }
     _LIBUNWIND_FRAMEHEADERCACHE_TRACE("FrameHeaderCache miss for address %lx",
                                       CBData->targetAddr);
@@ -120,29 +122,36 @@ public:
   }
 
   void add(const UnwindInfoSections *UIS) {
-    CacheEntry *Current = nullptr;
-
-    if (Unused != nullptr) {
-      Current = Unused;
-      Unused = Unused->Next;
+    size_t Index = upperBound(UIS->dso_base);
+    if (Index != 0 && Entries[Index - 1].LowPC() == UIS->dso_base) {
+      // Already present; refresh it in place.
+      --Index;
     } else {
-      Current = MostRecentlyUsed;
-      CacheEntry *Previous = nullptr;
-      while (Current->Next != nullptr) {
-        Previous = Current;
-        Current = Current->Next;
+      if (NumEntries == kCacheEntryCount) {
+        size_t Victim = 0;
+        for (size_t i = 1; i < NumEntries; i++) {
+          if (Entries[i].LastUse < Entries[Victim].LastUse)
+            Victim = i;
+        }
+        _LIBUNWIND_FRAMEHEADERCACHE_TRACE("FrameHeaderCache evict [%lx - %lx)",
+                                          Entries[Victim].LowPC(),
+                                          Entries[Victim].HighPC());
+        memmove(&Entries[Victim], &Entries[Victim + 1],
+                (NumEntries - Victim - 1) * sizeof(CacheEntry));
+        --NumEntries;
+        if (Victim < Index)
+          --Index;
       }
-      Previous->Next = nullptr;
-      _LIBUNWIND_FRAMEHEADERCACHE_TRACE("FrameHeaderCache evict [%lx - %lx)",
-                                        Current->LowPC(), Current->HighPC());
+      memmove(&Entries[Index + 1], &Entries[Index],
+              (NumEntries - Index) * sizeof(CacheEntry));
+      ++NumEntries;
     }
 
-    Current->Info = *UIS;
-    Current->Next = MostRecentlyUsed;
-    MostRecentlyUsed = Current;
+    Entries[Index].Info = *UIS;
+    Entries[Index].LastUse = ++UseCounter;
     _LIBUNWIND_FRAMEHEADERCACHE_TRACE("FrameHeaderCache add [%lx - %lx)",
-                                      MostRecentlyUsed->LowPC(),
-                                      MostRecentlyUsed->HighPC());
+                                      Entries[Index].LowPC(),
+                                      Entries[Index].HighPC());
   }
 };
 
@@ -77,6 +77,17 @@ namespace libunwind {
 
 #if defined(_LIBUNWIND_SUPPORT_DWARF_UNWIND)
 /// Cache of recently found FDEs.
+///
+/// The entries live in immutable snapshots sorted by start address. A
+/// snapshot is either a base holding most entries, or a small tail of recent
+/// additions that points to the base it extends. Writers serialize on a lock,
+/// copy the tail (or, once the tail has grown past about the square root of
+/// the base, merge both into a new base) with their change applied, and
+/// publish the copy with an atomic pointer swap. Lookups take no lock, never
+/// allocate or free, and binary-search the tail and its base. They count
+/// themselves in one of two epochs. A replaced snapshot is retired; the next
+/// writer to find the previous epoch drained frees what was retired before
+/// the last epoch flip, and flips the epoch again.
 template <typename A>
 class _LIBUNWIND_HIDDEN DwarfFDECache {
   typedef typename A::pint_t pint_t;
@@ -97,6 +108,23 @@ private:
     pint_t fde;
   };
 
+  struct snapshot {
+    snapshot *retiredNext;
+    const snapshot *base;
+    size_t count;
+    entry entries[1];
+  };
+
+  static size_t upperBound(const snapshot *s, pint_t pc);
+  static const entry *closest(const snapshot *s, pint_t mh, pint_t pc);
+  static snapshot *allocSnapshot(size_t capacity, const snapshot *base);
+  static snapshot *merge(const snapshot *s, size_t extra, pint_t removedMh,
+                         bool remove);
+  static void retire(const snapshot *s);
+  static void publish(snapshot *s);
+  static void reclaim();
+  static void freeAll(snapshot *s);
+
   // These fields are all static to avoid needing an initializer.
   // There is only one instance of this class per process.
   static RWMutex _lock;
@@ -104,26 +132,27 @@ private:
   static void dyldUnloadHook(const struct mach_header *mh, intptr_t slide);
   static bool _registeredForDyldUnloads;
 #endif
-  static entry *_buffer;
-  static entry *_bufferUsed;
-  static entry *_bufferEnd;
-  static entry _initialBuffer[64];
+  static snapshot *_current;
+  static snapshot *_retired;
+  static snapshot *_grace;
+  static size_t _readers[2];
+  static unsigned _epoch;
 };
 
 template <typename A>
-typename DwarfFDECache<A>::entry *
-DwarfFDECache<A>::_buffer = _initialBuffer;
+typename DwarfFDECache<A>::snapshot *DwarfFDECache<A>::_current = NULL;
 
 template <typename A>
-typename DwarfFDECache<A>::entry *
-DwarfFDECache<A>::_bufferUsed = _initialBuffer;
+typename DwarfFDECache<A>::snapshot *DwarfFDECache<A>::_retired = NULL;
 
 template <typename A>
-typename DwarfFDECache<A>::entry *
-DwarfFDECache<A>::_bufferEnd = &_initialBuffer[64];
+typename DwarfFDECache<A>::snapshot *DwarfFDECache<A>::_grace = NULL;
 
 template <typename A>
-typename DwarfFDECache<A>::entry DwarfFDECache<A>::_initialBuffer[64];
+size_t DwarfFDECache<A>::_readers[2] = {0, 0};
+
+template <typename A>
+unsigned DwarfFDECache<A>::_epoch = 0;
 
 template <typename A>
 RWMutex DwarfFDECache<A>::_lock;
@@ -133,44 +162,196 @@ template <typename A>
 bool DwarfFDECache<A>::_registeredForDyldUnloads = false;
 #endif
 
+/// Returns the index of the first entry starting above pc.
+template <typename A>
+size_t DwarfFDECache<A>::upperBound(const snapshot *s, pint_t pc) {
+  size_t low = 0;
+  size_t high = s->count;
+  while (low < high) {
+    size_t mid = low + (high - low) / 2;
+    if (s->entries[mid].ip_start <= pc)
+      low = mid + 1;
+    else
+      high = mid;
+  }
+  return low;
+}
+
+/// Returns the entry of image mh (or of any image if mh is 0) that starts
+/// closest below pc, or NULL.
+template <typename A>
+const typename DwarfFDECache<A>::entry *
+DwarfFDECache<A>::closest(const snapshot *s, pint_t mh, pint_t pc) {
+  for (size_t i = upperBound(s, pc); i > 0; --i) {
+    const entry *p = &s->entries[i - 1];
+    if ((mh == p->mh) || (mh == 0))
+      return p;
+    // An image's code lies above its header.
+    if (p->ip_start < mh)
+      break;
+  }
+  return NULL;
+}
+
 template <typename A>
 typename A::pint_t DwarfFDECache<A>::findFDE(pint_t mh, pint_t pc) {
   pint_t result = 0;
-  _LIBUNWIND_LOG_IF_FALSE(_lock.lock_shared());
-  for (entry *p = _buffer; p < _bufferUsed; ++p) {
-    if ((mh == p->mh) || (mh == 0)) {
-      if ((p->ip_start <= pc) && (pc < p->ip_end)) {
-        result = p->fde;
-        break;
-      }
+  unsigned epoch = __atomic_load_n(&_epoch, __ATOMIC_SEQ_CST);
+  __atomic_fetch_add(&_readers[epoch], 1, __ATOMIC_SEQ_CST);
+  const snapshot *s = __atomic_load_n(&_current, __ATOMIC_SEQ_CST);
+  if (s != NULL) {
+    // The ranges of one image don't overlap, so only the closest entry of the
+    // image below pc can contain it.
+    const entry *p = closest(s, mh, pc);
+    if (s->base != NULL) {
+      const entry *q = closest(s->base, mh, pc);
+      if (q != NULL && (p == NULL || q->ip_start > p->ip_start))
+        p = q;
     }
+    if (p != NULL && pc < p->ip_end)
+      result = p->fde;
   }
-  _LIBUNWIND_LOG_IF_FALSE(_lock.unlock_shared());
+  __atomic_fetch_sub(&_readers[epoch], 1, __ATOMIC_RELEASE);
   return result;
 }
 
+/// Returns an empty snapshot with room for capacity entries.
+template <typename A>
+typename DwarfFDECache<A>::snapshot *
+DwarfFDECache<A>::allocSnapshot(size_t capacity, const snapshot *base) {
+  // Can't use operator new (we are below it).
+  snapshot *s =
+      (snapshot *)malloc(sizeof(snapshot) + capacity * sizeof(entry));
+  if (s != NULL) {
+    s->retiredNext = NULL;
+    s->base = base;
+    s->count = 0;
+  }
+  return s;
+}
+
+/// Returns a new base with the entries of s and its base, leaving out those
+/// of image removedMh if remove is set, and room for extra more entries.
+template <typename A>
+typename DwarfFDECache<A>::snapshot *
+DwarfFDECache<A>::merge(const snapshot *s, size_t extra, pint_t removedMh,
+                        bool remove) {
+  const entry *a = s->entries, *aEnd = &s->entries[s->count];
+  const entry *b = NULL, *bEnd = NULL;
+  if (s->base != NULL) {
+    b = s->base->entries;
+    bEnd = &s->base->entries[s->base->count];
+  }
+  size_t count = (size_t)(aEnd - a) + (size_t)(bEnd - b);
+  if (remove) {
+    for (const entry *p = a; p < aEnd; ++p)
+      count -= p->mh == removedMh;
+    for (const entry *p = b; p < bEnd; ++p)
+      count -= p->mh == removedMh;
+  }
+  snapshot *m = allocSnapshot(count + extra, NULL);
+  if (m == NULL)
+    return NULL;
+  m->count = count;
+  entry *d = m->entries;
+  while (a < aEnd || b < bEnd) {
+    const entry *p;
+    if (b == bEnd || (a < aEnd && a->ip_start <= b->ip_start))
+      p = a++;
+    else
+      p = b++;
+    if (!remove || p->mh != removedMh)
+      *d++ = *p;
+  }
+  return m;
+}
+
+/// Queues s to be freed. Must be called with _lock held.
+template <typename A>
+void DwarfFDECache<A>::retire(const snapshot *s) {
+  snapshot *r = const_cast<snapshot *>(s);
+  r->retiredNext = _retired;
+  _retired = r;
+}
+
+/// Makes s the current snapshot. Must be called with _lock held.
+template <typename A>
+void DwarfFDECache<A>::publish(snapshot *s) {
+  snapshot *old = __atomic_exchange_n(&_current, s, __ATOMIC_SEQ_CST);
+  if (old != NULL) {
+    // A base stays in use as long as a tail points to it.
+    if (old != s->base)
+      retire(old);
+    if (old->base != NULL && old->base != s->base)
+      retire(old->base);
+  }
+  reclaim();
+}
+
+/// Frees the snapshots retired before the last epoch flip if the lookups
+/// counted in the previous epoch have all left, then flips the epoch so that
+/// those retired since wait for the lookups in the current one. Must be
+/// called with _lock held.
+template <typename A>
+void DwarfFDECache<A>::reclaim() {
+  // Lookups that start after the flip count themselves in the other epoch
+  // and load a snapshot published before it, so once the lookups of the
+  // previous epoch are gone none can still be reading a snapshot retired
+  // before the flip. The flip leaves lookups in the previous epoch only for
+  // as long as a lookup takes.
+  unsigned epoch = _epoch;
+  if (__atomic_load_n(&_readers[epoch ^ 1], __ATOMIC_SEQ_CST) != 0)
+    return;
+  freeAll(_grace);
+  _grace = _retired;
+  _retired = NULL;
+  __atomic_store_n(&_epoch, epoch ^ 1, __ATOMIC_SEQ_CST);
+}
+
+template <typename A>
+void DwarfFDECache<A>::freeAll(snapshot *s) {
+  while (s != NULL) {
+    snapshot *next = s->retiredNext;
+    free(s);
+    s = next;
+  }
+}
+
 template <typename A>
 void DwarfFDECache<A>::add(pint_t mh, pint_t ip_start, pint_t ip_end,
                            pint_t fde) {
 #if !defined(_LIBUNWIND_NO_HEAP)
   _LIBUNWIND_LOG_IF_FALSE(_lock.lock());
-  if (_bufferUsed >= _bufferEnd) {
-    size_t oldSize = (size_t)(_bufferEnd - _buffer);
-    size_t newSize = oldSize * 4;
-    // Can't use operator new (we are below it).
-    entry *newBuffer = (entry *)malloc(newSize * sizeof(entry));
-    memcpy(newBuffer, _buffer, oldSize * sizeof(entry));
-    if (_buffer != _initialBuffer)
-      free(_buffer);
-    _buffer = newBuffer;
-    _bufferUsed = &newBuffer[oldSize];
-    _bufferEnd = &newBuffer[newSize];
-  }
-  _bufferUsed->mh = mh;
-  _bufferUsed->ip_start = ip_start;
-  _bufferUsed->ip_end = ip_end;
-  _bufferUsed->fde = fde;
-  ++_bufferUsed;
+  const snapshot *old = _current;
+  snapshot *s;
+  if (old == NULL) {
+    s = allocSnapshot(1, NULL);
+  } else if (old->base == NULL) {
+    // Start a tail on the current base.
+    s = allocSnapshot(1, old);
+  } else if (old->count * old->count >= old->base->count) {
+    // Merging every ~sqrt(n) additions keeps both the tail copies and the
+    // merges to O(sqrt(n)) per addition.
+    s = merge(old, 1, 0, false);
+  } else {
+    s = allocSnapshot(old->count + 1, old->base);
+    if (s != NULL) {
+      memcpy(s->entries, old->entries, old->count * sizeof(entry));
+      s->count = old->count;
+    }
+  }
+  if (s != NULL) {
+    size_t pos = upperBound(s, ip_start);
+    if (pos != s->count)
+      memmove(&s->entries[pos + 1], &s->entries[pos],
+              (s->count - pos) * sizeof(entry));
+    s->entries[pos].mh = mh;
+    s->entries[pos].ip_start = ip_start;
+    s->entries[pos].ip_end = ip_end;
+    s->entries[pos].fde = fde;
+    ++s->count;
+    publish(s);
+  }
 #ifdef __APPLE__
   if (!_registeredForDyldUnloads) {
     _dyld_register_func_for_remove_image(&dyldUnloadHook);
@@ -183,17 +364,25 @@ void DwarfFDECache<A>::add(pint_t mh, pint_t ip_start, pint_t ip_end,
 
 template <typename A>
 void DwarfFDECache<A>::removeAllIn(pint_t mh) {
+#if !defined(_LIBUNWIND_NO_HEAP)
   _LIBUNWIND_LOG_IF_FALSE(_lock.lock());
-  entry *d = _buffer;
-  for (const entry *s = _buffer; s < _bufferUsed; ++s) {
-    if (s->mh != mh) {
-      if (d != s)
-        *d = *s;
-      ++d;
+  const snapshot *old = _current;
+  bool found = false;
+  for (const snapshot *s = old; s != NULL && !found; s = s->base) {
+    for (const entry *p = s->entries; p < &s->entries[s->count]; ++p) {
+      if (p->mh == mh) {
+        found = true;
+        break;
+      }
     }
   }
-  _bufferUsed = d;
+  if (found) {
+    snapshot *s = merge(old, 0, mh, true);
+    if (s != NULL)
+      publish(s);
+  }
   _LIBUNWIND_LOG_IF_FALSE(_lock.unlock());
+#endif
 }
 
 #ifdef __APPLE__
@@ -207,8 +396,10 @@ template <typename A>
 void DwarfFDECache<A>::iterateCacheEntries(void (*func)(
     unw_word_t ip_start, unw_word_t ip_end, unw_word_t fde, unw_word_t mh)) {
   _LIBUNWIND_LOG_IF_FALSE(_lock.lock());
-  for (entry *p = _buffer; p < _bufferUsed; ++p) {
-    (*func)(p->ip_start, p->ip_end, p->fde, p->mh);
+  for (const snapshot *s = _current; s != NULL; s = s->base) {
+    for (const entry *p = s->entries; p < &s->entries[s->count]; ++p) {
+      (*func)(p->ip_start, p->ip_end, p->fde, p->mh);
+    }
   }
   _LIBUNWIND_LOG_IF_FALSE(_lock.unlock());
 }
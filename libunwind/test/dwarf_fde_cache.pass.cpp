@@ -0,0 +1,157 @@
+// -*- C++ -*-
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// Checks the DWARF FDE cache against a plain list of its entries under random
+// additions, removals and lookups, then races lookups against additions.
+
+// Like frameheadercache_test, this tests an internal interface, so it
+// includes the sources directly. Without __has_feature, config.h defines its
+// own static_assert, so the standard headers come first.
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <random>
+#include <vector>
+#ifndef _LIBUNWIND_HAS_NO_THREADS
+#include <atomic>
+#include <thread>
+#endif
+
+#include "../src/config.h"
+
+#if defined(_LIBUNWIND_SUPPORT_DWARF_UNWIND) && !defined(_LIBUNWIND_NO_HEAP)
+
+#include "../src/libunwind_ext.h"
+#include "../src/UnwindCursor.hpp"
+
+using namespace libunwind;
+
+namespace {
+
+struct TestAddressSpace {
+  typedef uintptr_t pint_t;
+};
+
+typedef DwarfFDECache<TestAddressSpace> Cache;
+
+struct Entry {
+  uintptr_t mh, ip_start, ip_end, fde;
+};
+
+std::vector<Entry> entries;
+
+// The FDE of the entry of image mh (or any image if mh is 0) that starts
+// closest below pc, if it contains pc.
+uintptr_t referenceFind(uintptr_t mh, uintptr_t pc) {
+  const Entry *best = NULL;
+  for (const Entry &e : entries)
+    if ((mh == 0 || e.mh == mh) && e.ip_start <= pc &&
+        (best == NULL || e.ip_start >= best->ip_start))
+      best = &e;
+  return best != NULL && pc < best->ip_end ? best->fde : 0;
+}
+
+// Image headers are 0x10000 apart. The code of an image lies above its header
+// but may run past the headers of the next ones, so lookups pass entries of
+// other images both above and below the header of the one they look in.
+const uintptr_t kImageSize = 0x10000;
+const uintptr_t kNumImages = 5;
+const uintptr_t kCodeSize = 3 * kImageSize;
+
+void testRandom() {
+  std::mt19937 rng(1);
+  for (int i = 0; i < 3000; ++i) {
+    unsigned op = rng() % 10;
+    if (op < 7) {
+      uintptr_t mh = (1 + rng() % kNumImages) * kImageSize;
+      uintptr_t start = mh + 0x100 + (rng() % (kCodeSize / 16 - 0x10)) * 16;
+      bool overlaps = false;
+      for (const Entry &e : entries)
+        if (e.mh == mh && start < e.ip_end && e.ip_start < start + 16)
+          overlaps = true;
+      if (overlaps)
+        continue;
+      Entry e = {mh, start, start + 16, start + 7};
+      entries.push_back(e);
+      Cache::add(e.mh, e.ip_start, e.ip_end, e.fde);
+    } else if (op == 7) {
+      uintptr_t mh = (1 + rng() % kNumImages) * kImageSize;
+      std::vector<Entry> kept;
+      for (const Entry &e : entries)
+        if (e.mh != mh)
+          kept.push_back(e);
+      entries.swap(kept);
+      Cache::removeAllIn(mh);
+    }
+    for (int j = 0; j < 20; ++j) {
+      uintptr_t mh = (rng() % (kNumImages + 1)) * kImageSize;
+      uintptr_t pc = kImageSize + rng() % (kNumImages * kImageSize + kCodeSize);
+      if (j < 5 && !entries.empty()) {
+        const Entry &e = entries[rng() % entries.size()];
+        pc = e.ip_start + rng() % 16;
+      }
+      if (Cache::findFDE(mh, pc) != referenceFind(mh, pc)) {
+        fprintf(stderr, "mismatch at step %d for mh=%#lx pc=%#lx\n", i,
+                (unsigned long)mh, (unsigned long)pc);
+        abort();
+      }
+    }
+  }
+  for (const Entry &e : entries)
+    Cache::removeAllIn(e.mh);
+  for (const Entry &e : entries)
+    if (Cache::findFDE(0, e.ip_start) != 0)
+      abort();
+  entries.clear();
+}
+
+#ifndef _LIBUNWIND_HAS_NO_THREADS
+void testConcurrent() {
+  const uintptr_t mh = 0x100000;
+  const uintptr_t kCount = 20000;
+  std::atomic<bool> stop(false);
+  std::atomic<long> wrong(0);
+  std::vector<std::thread> readers;
+  for (int t = 0; t < 4; ++t)
+    readers.emplace_back([&] {
+      while (!stop)
+        for (uintptr_t pc = mh; pc < mh + 16 * 2000; pc += 16) {
+          // Not yet added is fine, a wrong FDE is not.
+          uintptr_t fde = Cache::findFDE(mh, pc + 3);
+          if (fde != 0 && fde != pc + 7)
+            ++wrong;
+        }
+    });
+  for (uintptr_t pc = mh; pc < mh + 16 * kCount; pc += 16)
+    Cache::add(mh, pc, pc + 16, pc + 7);
+  stop = true;
+  for (std::thread &t : readers)
+    t.join();
+  if (wrong != 0)
+    abort();
+  for (uintptr_t pc = mh; pc < mh + 16 * kCount; pc += 16)
+    if (Cache::findFDE(mh, pc + 3) != pc + 7)
+      abort();
+  Cache::removeAllIn(mh);
+}
+#endif
+
+} // namespace
+
+int main() {
+  testRandom();
+#ifndef _LIBUNWIND_HAS_NO_THREADS
+  testConcurrent();
+#endif
+  return 0;
+}
+
+#else
+int main() { return 0; }
+#endif
@@ -74,7 +74,7 @@ int main() {
   if (FHC.find(&PInfo, 0, &CBData))
     abort();
   // Add enough things to the cache that the entry is evicted.
-  for (int i = 0; i < 9; i++) {
+  for (size_t i = 0; i <= FrameHeaderCache::kCacheEntryCount; i++) {
     UIS.dso_base = kBaseAddr + (kDwarfSectionLength * i);
     FHC.add(&UIS);
   }
@@ -82,6 +82,11 @@ int main() {
   // Should have been evicted.
   if (FHC.find(&PInfo, 0, &CBData))
     abort();
+  // Entries between the first and last ones should be found.
+  CBData.targetAddr = kBaseAddr + (kDwarfSectionLength * 5) + 1;
+  if (!FHC.find(&PInfo, 0, &CBData) ||
+      UIS.dso_base != kBaseAddr + (kDwarfSectionLength * 5))
+    abort();
   return 0;
 }
 #else
@@ -11,11 +11,13 @@
 
 #include "lld/Common/ErrorHandler.h"
 #include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/Optional.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/StringSet.h"
 #include "llvm/BinaryFormat/ELF.h"
 #include "llvm/Support/CachePruning.h"
 #include "llvm/Support/CodeGen.h"
+#include "llvm/Support/Compression.h"
 #include "llvm/Support/Endian.h"
 #include <atomic>
 #include <vector>
@@ -135,12 +137,13 @@ struct Configuration {
   bool armHasBlx = false;
   bool armHasMovtMovw = false;
   bool armJ1J2BranchEncoding = false;
+  // For --compress-debug-sections; None if sections are not compressed.
+  llvm::Optional<llvm::compression::Format> compressDebugSections;
   bool asNeeded = false;
   bool bsymbolic;
   bool bsymbolicFunctions;
   bool callGraphProfileSort;
   bool checkSections;
-  bool compressDebugSections;
   bool cref;
   bool defineCommon;
   bool demangle = true;
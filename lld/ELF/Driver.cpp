@@ -804,15 +804,23 @@ template <class ELFT> static void readCallGraphsFromObjectFiles() {
   }
 }
 
-static bool getCompressDebugSections(opt::InputArgList &args) {
+static Optional<compression::Format>
+getCompressDebugSections(opt::InputArgList &args) {
   StringRef s = args.getLastArgValue(OPT_compress_debug_sections, "none");
   if (s == "none")
-    return false;
-  if (s != "zlib")
+    return None;
+  compression::Format format;
+  if (s == "zlib") {
+    format = compression::Format::Zlib;
+  } else if (s == "zstd") {
+    format = compression::Format::Zstd;
+  } else {
     error("unknown --compress-debug-sections value: " + s);
-  if (!zlib::isAvailable())
-    error("--compress-debug-sections: zlib is not available");
-  return true;
+    return None;
+  }
+  if (!compression::isAvailable(format))
+    error("--compress-debug-sections: " + s + " is not available");
+  return format;
 }
 
 static StringRef getAliasSpelling(opt::Arg *arg) {
@@ -83,10 +83,11 @@ InputSectionBase::InputSectionBase(InputFile *file, uint64_t flags,
   // If that's the case, demangle section name so that we can handle a
   // section as if it weren't compressed.
   if ((flags & SHF_COMPRESSED) || name.startswith(".zdebug")) {
-    if (!zlib::isAvailable())
-      error(toString(file) + ": contains a compressed section, " +
-            "but zlib is not available");
     parseCompressedHeader();
+    if (!compression::isAvailable(getCompressionFormat()))
+      error(toString(file) + ": contains a compressed section, but " +
+            compression::getName(getCompressionFormat()) +
+            " is not available");
   }
 }
 
@@ -150,7 +151,9 @@ void InputSectionBase::uncompress() const {
     uncompressedBuf = bAlloc.Allocate<char>(size);
   }
 
-  if (Error e = zlib::uncompress(toStringRef(rawData), uncompressedBuf, size))
+  if (Error e = compression::uncompress(getCompressionFormat(),
+                                       toStringRef(rawData), uncompressedBuf,
+                                       size))
     fatal(toString(this) +
           ": uncompress failed: " + llvm::toString(std::move(e)));
   rawData = makeArrayRef((uint8_t *)uncompressedBuf, size);
@@ -245,10 +248,11 @@ void InputSectionBase::parseCompressedHeader() {
     }
 
     auto *hdr = reinterpret_cast<const Chdr64 *>(rawData.data());
-    if (hdr->ch_type != ELFCOMPRESS_ZLIB) {
+    if (hdr->ch_type != ELFCOMPRESS_ZLIB && hdr->ch_type != ELFCOMPRESS_ZSTD) {
       error(toString(this) + ": unsupported compression type");
       return;
     }
+    zstdCompressed = hdr->ch_type == ELFCOMPRESS_ZSTD;
 
     uncompressedSize = hdr->ch_size;
     alignment = std::max<uint32_t>(hdr->ch_addralign, 1);
@@ -263,10 +267,11 @@ void InputSectionBase::parseCompressedHeader() {
   }
 
   auto *hdr = reinterpret_cast<const Chdr32 *>(rawData.data());
-  if (hdr->ch_type != ELFCOMPRESS_ZLIB) {
+  if (hdr->ch_type != ELFCOMPRESS_ZLIB && hdr->ch_type != ELFCOMPRESS_ZSTD) {
     error(toString(this) + ": unsupported compression type");
     return;
   }
+  zstdCompressed = hdr->ch_type == ELFCOMPRESS_ZSTD;
 
   uncompressedSize = hdr->ch_size;
   alignment = std::max<uint32_t>(hdr->ch_addralign, 1);
@@ -1170,8 +1175,9 @@ template <class ELFT> void InputSection::writeTo(uint8_t *buf) {
   // to the buffer.
   if (uncompressedSize >= 0) {
     size_t size = uncompressedSize;
-    if (Error e = zlib::uncompress(toStringRef(rawData),
-                                   (char *)(buf + outSecOff), size))
+    if (Error e = compression::uncompress(getCompressionFormat(),
+                                          toStringRef(rawData),
+                                          (char *)(buf + outSecOff), size))
       fatal(toString(this) +
             ": uncompress failed: " + llvm::toString(std::move(e)));
     uint8_t *bufEnd = buf + outSecOff + size;
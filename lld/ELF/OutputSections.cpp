@@ -283,7 +283,8 @@ template <class ELFT> void OutputSection::maybeCompress() {
   // Create a section header.
   zDebugHeader.resize(sizeof(Elf_Chdr));
   auto *hdr = reinterpret_cast<Elf_Chdr *>(zDebugHeader.data());
-  hdr->ch_type = ELFCOMPRESS_ZLIB;
+  bool zstd = *config->compressDebugSections == compression::Format::Zstd;
+  hdr->ch_type = zstd ? ELFCOMPRESS_ZSTD : ELFCOMPRESS_ZLIB;
   hdr->ch_size = size;
   hdr->ch_addralign = alignment;
 
@@ -294,8 +295,11 @@ template <class ELFT> void OutputSection::maybeCompress() {
   // -O2 is given, we use level 6 to compress debug info more by ~15%. We found
   // that level 7 to 9 doesn't make much difference (~1% more compression) while
   // they take significant amount of time (~2x), so level 6 seems enough.
-  if (Error e = zlib::compress(toStringRef(buf), compressedData,
-                               config->optimize >= 2 ? 6 : 1))
+  // zstd at its default level compresses better than zlib at 6 and is still
+  // faster than zlib at 1, so it is used regardless of -O.
+  int level = zstd ? zstd::DefaultCompression : config->optimize >= 2 ? 6 : 1;
+  if (Error e = compression::compress(*config->compressDebugSections,
+                                      toStringRef(buf), compressedData, level))
     fatal("compress failed: " + llvm::toString(std::move(e)));
 
   // Update section headers.
@@ -0,0 +1,84 @@
+#include "benchmark/benchmark.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/Compression.h"
+#include "llvm/Support/Error.h"
+#include <string>
+
+using namespace llvm;
+
+// Debug-info-like input: repetitive records with slowly changing fields.
+static std::string makeInput(size_t Size) {
+  std::string S;
+  S.reserve(Size);
+  for (unsigned I = 0; S.size() < Size; ++I)
+    S += "DW_TAG_variable name=var" + std::to_string(I % 997) +
+         " type=0x" + std::to_string(I * 7 % 4096) + " line=" +
+         std::to_string(I) + "\n";
+  S.resize(Size);
+  return S;
+}
+
+static void BM_Compress(benchmark::State &State, compression::Format F,
+                        int Level) {
+  if (!compression::isAvailable(F)) {
+    State.SkipWithError(compression::getReasonIfUnavailable(F));
+    return;
+  }
+  std::string Input = makeInput(State.range(0));
+  SmallVector<char, 0> Compressed;
+  for (auto _ : State) {
+    Compressed.clear();
+    if (Error E = compression::compress(F, Input, Compressed, Level)) {
+      consumeError(std::move(E));
+      State.SkipWithError("compression failed");
+      return;
+    }
+    benchmark::DoNotOptimize(Compressed.data());
+  }
+  State.SetBytesProcessed(int64_t(State.iterations()) * Input.size());
+  State.counters["ratio"] = double(Input.size()) / Compressed.size();
+}
+
+static void BM_Uncompress(benchmark::State &State, compression::Format F,
+                          int Level) {
+  if (!compression::isAvailable(F)) {
+    State.SkipWithError(compression::getReasonIfUnavailable(F));
+    return;
+  }
+  std::string Input = makeInput(State.range(0));
+  SmallVector<char, 0> Compressed;
+  if (Error E = compression::compress(F, Input, Compressed, Level)) {
+    consumeError(std::move(E));
+    State.SkipWithError("compression failed");
+    return;
+  }
+  StringRef CompressedRef(Compressed.data(), Compressed.size());
+  SmallVector<char, 0> Uncompressed;
+  for (auto _ : State) {
+    Uncompressed.clear();
+    if (Error E = compression::uncompress(F, CompressedRef, Uncompressed,
+                                          Input.size())) {
+      consumeError(std::move(E));
+      State.SkipWithError("uncompression failed");
+      return;
+    }
+    benchmark::DoNotOptimize(Uncompressed.data());
+  }
+  State.SetBytesProcessed(int64_t(State.iterations()) * Input.size());
+}
+
+// The levels lld uses for --compress-debug-sections.
+BENCHMARK_CAPTURE(BM_Compress, zlib_1, compression::Format::Zlib, 1)
+    ->Range(1 << 16, 1 << 24);
+BENCHMARK_CAPTURE(BM_Compress, zlib_6, compression::Format::Zlib, 6)
+    ->Range(1 << 16, 1 << 24);
+BENCHMARK_CAPTURE(BM_Compress, zstd_default, compression::Format::Zstd,
+                  zstd::DefaultCompression)
+    ->Range(1 << 16, 1 << 24);
+BENCHMARK_CAPTURE(BM_Uncompress, zlib, compression::Format::Zlib, 6)
+    ->Range(1 << 16, 1 << 24);
+BENCHMARK_CAPTURE(BM_Uncompress, zstd, compression::Format::Zstd,
+                  zstd::DefaultCompression)
+    ->Range(1 << 16, 1 << 24);
+
+BENCHMARK_MAIN();
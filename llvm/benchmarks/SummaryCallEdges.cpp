@@ -0,0 +1,60 @@
+#include "benchmark/benchmark.h"
+#include "llvm/IR/ModuleSummaryIndex.h"
+#include <random>
+#include <vector>
+
+using namespace llvm;
+
+// Call edge storage of a combined summary index, built the way the bitcode
+// reader's makeCallList builds it. Each edge takes one record entry for the
+// callee, plus one for hotness or relative block frequency, or two in the old
+// profile format. The reader either reserves one edge per record entry or
+// exactly the number of edges.
+
+// Edges per function follow a geometric distribution, about 5.7 on average.
+static std::vector<unsigned> makeEdgeCounts(size_t NumFunctions) {
+  std::mt19937 Rng(1);
+  std::geometric_distribution<unsigned> Dist(0.15);
+  std::vector<unsigned> Counts(NumFunctions);
+  for (unsigned &C : Counts)
+    C = Dist(Rng);
+  return Counts;
+}
+
+static void BM_CallEdgeLists(benchmark::State &State, bool Exact) {
+  std::vector<unsigned> Counts = makeEdgeCounts(State.range(0));
+  unsigned EntriesPerEdge = State.range(1);
+  size_t Edges = 0, Bytes = 0;
+  for (auto _ : State) {
+    std::vector<std::vector<FunctionSummary::EdgeTy>> Lists;
+    Lists.reserve(Counts.size());
+    Edges = Bytes = 0;
+    for (unsigned C : Counts) {
+      size_t RecordSize = C * EntriesPerEdge;
+      std::vector<FunctionSummary::EdgeTy> Ret;
+      Ret.reserve(Exact ? RecordSize / EntriesPerEdge : RecordSize);
+      for (unsigned I = 0; I != C; ++I)
+        Ret.push_back({ValueInfo(), CalleeInfo()});
+      Edges += Ret.size();
+      Bytes += Ret.capacity() * sizeof(FunctionSummary::EdgeTy);
+      Lists.push_back(std::move(Ret));
+    }
+    benchmark::DoNotOptimize(Lists.data());
+  }
+  State.counters["edges"] = Edges;
+  State.counters["edge_bytes"] = Bytes;
+}
+
+static void Args(benchmark::internal::Benchmark *B) {
+  for (int EntriesPerEdge : {1, 2, 3})
+    B->Args({1 << 20, EntriesPerEdge});
+}
+
+BENCHMARK_CAPTURE(BM_CallEdgeLists, record_size, false)
+    ->Apply(Args)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_CallEdgeLists, exact, true)
+    ->Apply(Args)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -17,6 +17,7 @@
 
 #include <cstdint>
 #include <map>
+#include <mutex>
 #include <set>
 
 namespace llvm {
@@ -99,11 +100,16 @@ private:
   // Used to relax some checks that do not currently work portably
   bool IsObjectFile;
   bool IsMachOObject;
+  /// Held while dumping DIEs if units are verified in parallel. Dumping an
+  /// attribute may parse a line table through the shared DWARFContext.
+  std::mutex *DumpLock = nullptr;
 
   raw_ostream &error() const;
   raw_ostream &warn() const;
   raw_ostream &note() const;
   raw_ostream &dump(const DWARFDie &Die, unsigned indent = 0) const;
+  raw_ostream &dump(const DWARFDie &Die, unsigned indent,
+                    DIDumpOptions Opts) const;
 
   /// Verifies the abbreviations section.
   ///
@@ -161,6 +167,10 @@ private:
   /// Verifies the unit headers and contents in a .debug_info or .debug_types
   /// section.
   ///
+  /// The header chain is verified first. The contents of the units are then
+  /// verified on parallel::strategy threads, and the output of each unit is
+  /// printed in unit order, so it does not depend on the number of threads.
+  ///
   /// \param S           The DWARF Section to verify.
   /// \param SectionKind The object-file section kind that S comes from.
   ///
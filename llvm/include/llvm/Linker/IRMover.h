@@ -11,6 +11,8 @@
 
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/TinyPtrVector.h"
 #include <functional>
 
 namespace llvm {
@@ -32,12 +34,18 @@ class IRMover {
       bool operator==(const KeyTy &that) const;
       bool operator!=(const KeyTy &that) const;
     };
-    static StructType *getEmptyKey();
-    static StructType *getTombstoneKey();
+    /// A struct type in the set along with the hash of its body, computed
+    /// once when the type is added rather than every time the set grows.
+    struct EntryTy {
+      StructType *ST;
+      unsigned Hash;
+    };
+    static EntryTy getEmptyKey();
+    static EntryTy getTombstoneKey();
     static unsigned getHashValue(const KeyTy &Key);
-    static unsigned getHashValue(const StructType *ST);
-    static bool isEqual(const KeyTy &LHS, const StructType *RHS);
-    static bool isEqual(const StructType *LHS, const StructType *RHS);
+    static unsigned getHashValue(const EntryTy &Entry);
+    static bool isEqual(const KeyTy &LHS, const EntryTy &RHS);
+    static bool isEqual(const EntryTy &LHS, const EntryTy &RHS);
   };
 
   /// Type of the Metadata map in \a ValueToValueMapTy.
@@ -49,7 +57,20 @@ public:
     DenseSet<StructType *> OpaqueStructTypes;
 
     // The set of identified but non opaque structures in the composite module.
-    DenseSet<StructType *, StructTypeKeyInfo> NonOpaqueStructTypes;
+    DenseSet<StructTypeKeyInfo::EntryTy, StructTypeKeyInfo>
+        NonOpaqueStructTypes;
+
+    // The members of NonOpaqueStructTypes, looked up by identity.
+    DenseSet<StructType *> NonOpaqueStructTypeMembers;
+
+    // The structures in the composite module by the name they had before
+    // LLVMContext made it unique, e.g. "foo" for "foo.42".
+    StringMap<TinyPtrVector<StructType *>> TypesByNamePrefix;
+
+    // Memoized results of getShapeHash().
+    DenseMap<StructType *, unsigned> ShapeHashes;
+
+    void addNamePrefix(StructType *Ty);
 
   public:
     void addNonOpaque(StructType *Ty);
@@ -57,6 +78,14 @@ public:
     void addOpaque(StructType *Ty);
     StructType *findNonOpaque(ArrayRef<Type *> ETypes, bool IsPacked);
     bool hasType(StructType *Ty);
+
+    /// Return the structures in the composite module that were named \p Prefix
+    /// before LLVMContext made their names unique.
+    ArrayRef<StructType *> findByNamePrefix(StringRef Prefix) const;
+
+    /// Return a hash of the shape of the body of the non opaque structure \p Ty
+    /// that all structures isomorphic to it share.
+    unsigned getShapeHash(StructType *Ty);
   };
 
   IRMover(Module &M);
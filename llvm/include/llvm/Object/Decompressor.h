@@ -12,6 +12,7 @@
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Object/ObjectFile.h"
+#include "llvm/Support/Compression.h"
 
 namespace llvm {
 namespace object {
@@ -41,6 +42,9 @@ public:
   /// Return memory buffer size required for decompression.
   uint64_t getDecompressedSize() { return DecompressedSize; }
 
+  /// Return the format the section data is compressed with.
+  compression::Format getFormat() const { return CompressionFormat; }
+
   /// Return true if section is compressed, including gnu-styled case.
   static bool isCompressed(const object::SectionRef &Section);
 
@@ -54,10 +58,11 @@ private:
   Decompressor(StringRef Data);
 
   Error consumeCompressedGnuHeader();
-  Error consumeCompressedZLibHeader(bool Is64Bit, bool IsLittleEndian);
+  Error consumeCompressedSectionHeader(bool Is64Bit, bool IsLittleEndian);
 
   StringRef SectionData;
   uint64_t DecompressedSize;
+  compression::Format CompressionFormat = compression::Format::Zlib;
 };
 
 } // end namespace object
@@ -43,6 +43,62 @@ uint32_t crc32(StringRef Buffer);
 
 }  // End of namespace zlib
 
+namespace zstd {
+
+static constexpr int NoCompression = -5;
+static constexpr int BestSpeedCompression = 1;
+static constexpr int DefaultCompression = 5;
+static constexpr int BestSizeCompression = 12;
+
+bool isAvailable();
+
+Error compress(StringRef InputBuffer, SmallVectorImpl<char> &CompressedBuffer,
+               int Level = DefaultCompression);
+
+Error uncompress(StringRef InputBuffer, char *UncompressedBuffer,
+                 size_t &UncompressedSize);
+
+Error uncompress(StringRef InputBuffer,
+                 SmallVectorImpl<char> &UncompressedBuffer,
+                 size_t UncompressedSize);
+
+}  // End of namespace zstd
+
+/// Codec-agnostic entry points for callers that let the user choose the
+/// compression format.
+namespace compression {
+
+enum class Format {
+  Zlib,
+  Zstd,
+};
+
+/// Level that selects the default compression level of each format.
+static constexpr int DefaultLevel = -1000;
+
+/// Returns the user-facing name of \p F, e.g. "zlib".
+const char *getName(Format F);
+
+/// Returns whether LLVM was built with support for \p F.
+bool isAvailable(Format F);
+
+/// Returns a message suitable for diagnostics if \p F is unavailable, or
+/// nullptr.
+const char *getReasonIfUnavailable(Format F);
+
+Error compress(Format F, StringRef InputBuffer,
+               SmallVectorImpl<char> &CompressedBuffer,
+               int Level = DefaultLevel);
+
+Error uncompress(Format F, StringRef InputBuffer, char *UncompressedBuffer,
+                 size_t &UncompressedSize);
+
+Error uncompress(Format F, StringRef InputBuffer,
+                 SmallVectorImpl<char> &UncompressedBuffer,
+                 size_t UncompressedSize);
+
+}  // End of namespace compression
+
 } // End of namespace llvm
 
 #endif
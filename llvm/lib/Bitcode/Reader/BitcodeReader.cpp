@@ -5687,8 +5687,16 @@ std::vector<FunctionSummary::EdgeTy>
 ModuleSummaryIndexBitcodeReader::makeCallList(ArrayRef<uint64_t> Record,
                                               bool IsOldProfileFormat,
                                               bool HasProfile, bool HasRelBF) {
+  // Each edge occupies one record entry for the callee plus any per-edge
+  // profile fields. Reserve exactly the number of edges: these vectors are kept
+  // alive in the combined index for the whole thin link, so any slack adds up.
+  unsigned EntriesPerEdge = 1;
+  if (IsOldProfileFormat)
+    EntriesPerEdge += HasProfile ? 2 : 1;
+  else if (HasProfile || HasRelBF)
+    EntriesPerEdge += 1;
   std::vector<FunctionSummary::EdgeTy> Ret;
-  Ret.reserve(Record.size());
+  Ret.reserve(Record.size() / EntriesPerEdge);
   for (unsigned I = 0, E = Record.size(); I != E; ++I) {
     CalleeInfo::HotnessType Hotness = CalleeInfo::HotnessType::Unknown;
     uint64_t RelBF = 0;
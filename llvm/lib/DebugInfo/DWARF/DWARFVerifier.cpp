@@ -16,6 +16,7 @@
 #include "llvm/DebugInfo/DWARF/DWARFSection.h"
 #include "llvm/Support/DJB.h"
 #include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/WithColor.h"
 #include "llvm/Support/raw_ostream.h"
 #include <map>
@@ -26,6 +27,16 @@ using namespace llvm;
 using namespace dwarf;
 using namespace object;
 
+namespace {
+/// The results of verifying the contents of one unit of a .debug_info or
+/// .debug_types section on a parallel::strategy thread.
+struct UnitReport {
+  std::string Output;
+  unsigned NumErrors = 0;
+  std::map<uint64_t, std::set<uint64_t>> References;
+};
+} // namespace
+
 DWARFVerifier::DieRangeInfo::address_range_iterator
 DWARFVerifier::DieRangeInfo::insert(const DWARFAddressRange &R) {
   auto Begin = Ranges.begin();
@@ -216,14 +227,14 @@ unsigned DWARFVerifier::verifyDebugInfoCallSite(const DWARFDie &Die) {
   for (; Curr.isValid() && !Curr.isSubprogramDIE(); Curr = Die.getParent()) {
     if (Curr.getTag() == DW_TAG_inlined_subroutine) {
       error() << "Call site entry nested within inlined subroutine:";
-      Curr.dump(OS);
+      dump(Curr, 0, DIDumpOptions());
       return 1;
     }
   }
 
   if (!Curr.isValid()) {
     error() << "Call site entry not nested within a valid subprogram:";
-    Die.dump(OS);
+    dump(Die, 0, DIDumpOptions());
     return 1;
   }
 
@@ -234,8 +245,8 @@ unsigned DWARFVerifier::verifyDebugInfoCallSite(const DWARFDie &Die) {
                  DW_AT_GNU_all_tail_call_sites});
   if (!CallAttr) {
     error() << "Subprogram with call site entry has no DW_AT_call attribute:";
-    Curr.dump(OS);
-    Die.dump(OS, /*indent*/ 1);
+    dump(Curr, 0, DIDumpOptions());
+    dump(Die, /*indent*/ 1, DIDumpOptions());
     return 1;
   }
 
@@ -288,6 +299,10 @@ unsigned DWARFVerifier::verifyUnitSection(const DWARFSection &S,
   bool hasDIE = DebugInfoData.isValidOffset(Offset);
   DWARFUnitVector TypeUnitVector;
   DWARFUnitVector CompileUnitVector;
+  // Walk the header chain first. The contents are verified once all units
+  // are known, so references into later units resolve, and the output does
+  // not depend on whether the units are verified in parallel.
+  std::vector<DWARFUnit *> Units;
   while (hasDIE) {
     OffsetStart = Offset;
     if (!verifyUnitHeader(DebugInfoData, &Offset, UnitIdx, UnitType,
@@ -326,11 +341,43 @@ unsigned DWARFVerifier::verifyUnitSection(const DWARFSection &S,
       }
       default: { llvm_unreachable("Invalid UnitType."); }
       }
-      NumDebugInfoErrors += verifyUnitContents(*Unit);
+      Units.push_back(Unit);
     }
     hasDIE = DebugInfoData.isValidOffset(Offset);
     ++UnitIdx;
   }
+
+  if (parallel::strategy.compute_thread_count() <= 1) {
+    for (DWARFUnit *Unit : Units)
+      NumDebugInfoErrors += verifyUnitContents(*Unit);
+  } else {
+    // Each unit is verified into its own report, and the reports are printed
+    // in unit order. Everything the units share is set up beforehand: the
+    // abbreviation sets are cached in each unit, and all DIEs are extracted
+    // because references may lead into other units.
+    for (DWARFUnit *Unit : Units)
+      Unit->getAbbreviations();
+    parallel::for_each_n(parallel::par, size_t(0), Units.size(),
+                         [&](size_t I) { Units[I]->getNumDIEs(); });
+    std::vector<UnitReport> Reports(Units.size());
+    std::mutex Lock;
+    parallel::for_each_n(
+        parallel::par, size_t(0), Units.size(), [&](size_t I) {
+          UnitReport &Report = Reports[I];
+          raw_string_ostream ReportOS(Report.Output);
+          DWARFVerifier UnitVerifier(ReportOS, DCtx, DumpOpts);
+          UnitVerifier.DumpLock = &Lock;
+          Report.NumErrors = UnitVerifier.verifyUnitContents(*Units[I]);
+          Report.References = std::move(UnitVerifier.ReferenceToDIEOffsets);
+        });
+    for (UnitReport &Report : Reports) {
+      OS << Report.Output;
+      NumDebugInfoErrors += Report.NumErrors;
+      for (const auto &Ref : Report.References)
+        ReferenceToDIEOffsets[Ref.first].insert(Ref.second.begin(),
+                                                Ref.second.end());
+    }
+  }
   if (UnitIdx == 0 && !hasDIE) {
     warn() << "Section is empty.\n";
     isHeaderChainValid = true;
@@ -550,7 +597,7 @@ unsigned DWARFVerifier::verifyDebugInfoForm(const DWARFDie &Die,
                 << format("0x%08" PRIx64, CUOffset)
                 << " is invalid (must be less than CU size of "
                 << format("0x%08" PRIx64, CUSize) << "):\n";
-        Die.dump(OS, 0, DumpOpts);
+        dump(Die);
         dump(Die) << '\n';
       } else {
         // Valid reference, but we will verify it points to an actual
@@ -1475,6 +1522,14 @@ raw_ostream &DWARFVerifier::warn() const { return WithColor::warning(OS); }
 raw_ostream &DWARFVerifier::note() const { return WithColor::note(OS); }
 
 raw_ostream &DWARFVerifier::dump(const DWARFDie &Die, unsigned indent) const {
-  Die.dump(OS, indent, DumpOpts);
+  return dump(Die, indent, DumpOpts);
+}
+
+raw_ostream &DWARFVerifier::dump(const DWARFDie &Die, unsigned indent,
+                                 DIDumpOptions Opts) const {
+  std::unique_lock<std::mutex> Lock;
+  if (DumpLock)
+    Lock = std::unique_lock<std::mutex>(*DumpLock);
+  Die.dump(OS, indent, Opts);
   return OS;
 }
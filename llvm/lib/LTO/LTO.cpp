@@ -1291,6 +1291,11 @@ Error LTO::runThinLTO(AddStreamFn AddStream, NativeObjectCache Cache,
       !Conf.CombinedIndexHook(ThinLTO.CombinedIndex, GUIDPreservedSymbols))
     return Error::success();
 
+  // The thin link covers everything up to starting the backends. It is not a
+  // TimeTraceScope because the backends are started from this same frame.
+  if (timeTraceProfilerEnabled())
+    timeTraceProfilerBegin("Thin link", StringRef(""));
+
   // Collect for each module the list of function it defines (GUID ->
   // Summary).
   StringMap<GVSummaryMapTy>
@@ -1387,6 +1392,9 @@ Error LTO::runThinLTO(AddStreamFn AddStream, NativeObjectCache Cache,
   thinLTOResolvePrevailingInIndex(ThinLTO.CombinedIndex, isPrevailing,
                                   recordNewLinkage, GUIDPreservedSymbols);
 
+  if (timeTraceProfilerEnabled())
+    timeTraceProfilerEnd();
+
   std::unique_ptr<ThinBackendProc> BackendProc =
       ThinLTO.Backend(Conf, ThinLTO.CombinedIndex, ModuleToDefinedGVSummaries,
                       AddStream, Cache);
@@ -46,14 +46,21 @@ class TypeMapTy : public ValueMapTypeRemapper {
   /// getting a body from the source module.
   SmallPtrSet<StructType *, 16> DstResolvedOpaqueTypes;
 
+  /// Pairs of destination and source types that addTypeMapping found not to
+  /// be isomorphic. Mappings are only ever added while the type mapping is
+  /// computed, so the answer cannot change and the same pair, e.g. the types
+  /// of many globals, is not walked again.
+  DenseSet<std::pair<Type *, Type *>> NonIsomorphicTypes;
+
 public:
   TypeMapTy(IRMover::IdentifiedStructTypeSet &DstStructTypesSet)
       : DstStructTypesSet(DstStructTypesSet) {}
 
   IRMover::IdentifiedStructTypeSet &DstStructTypesSet;
   /// Indicate that the specified type in the destination module is conceptually
-  /// equivalent to the specified type in the source module.
-  void addTypeMapping(Type *DstTy, Type *SrcTy);
+  /// equivalent to the specified type in the source module. Returns false if
+  /// the types are not isomorphic, in which case no mapping is added.
+  bool addTypeMapping(Type *DstTy, Type *SrcTy);
 
   /// Produce a body for an opaque type in the dest module from a type
   /// definition in the source module.
@@ -77,13 +84,17 @@ private:
 };
 }
 
-void TypeMapTy::addTypeMapping(Type *DstTy, Type *SrcTy) {
+bool TypeMapTy::addTypeMapping(Type *DstTy, Type *SrcTy) {
   assert(SpeculativeTypes.empty());
   assert(SpeculativeDstOpaqueTypes.empty());
 
+  if (NonIsomorphicTypes.count({DstTy, SrcTy}))
+    return false;
+
   // Check to see if these types are recursively isomorphic and establish a
   // mapping between them if so.
-  if (!areTypesIsomorphic(DstTy, SrcTy)) {
+  bool Isomorphic = areTypesIsomorphic(DstTy, SrcTy);
+  if (!Isomorphic) {
     // Oops, they aren't isomorphic.  Just discard this request by rolling out
     // any speculative mappings we've established.
     for (Type *Ty : SpeculativeTypes)
@@ -93,6 +104,7 @@ void TypeMapTy::addTypeMapping(Type *DstTy, Type *SrcTy) {
                                    SpeculativeDstOpaqueTypes.size());
     for (StructType *Ty : SpeculativeDstOpaqueTypes)
       DstResolvedOpaqueTypes.erase(Ty);
+    NonIsomorphicTypes.insert({DstTy, SrcTy});
   } else {
     // SrcTy and DstTy are recursively ismorphic. We clear names of SrcTy
     // and all its descendants to lower amount of renaming in LLVM context
@@ -107,6 +119,7 @@ void TypeMapTy::addTypeMapping(Type *DstTy, Type *SrcTy) {
   }
   SpeculativeTypes.clear();
   SpeculativeDstOpaqueTypes.clear();
+  return Isomorphic;
 }
 
 /// Recursively walk this pair of types, returning true if they are isomorphic,
@@ -739,6 +752,39 @@ static StringRef getTypeNamePrefix(StringRef Name) {
              : Name.substr(0, DotPos);
 }
 
+/// Hash the parts of \p Ty that every type isomorphic to it shares. Structs
+/// are not looked into, since an opaque source struct maps onto any struct.
+static hash_code hashTypeShape(Type *Ty) {
+  if (isa<StructType>(Ty))
+    return hash_value(Ty->getTypeID());
+
+  hash_code Hash = hash_combine(Ty->getTypeID(), Ty->getNumContainedTypes());
+  if (auto *ITy = dyn_cast<IntegerType>(Ty))
+    Hash = hash_combine(Hash, ITy->getBitWidth());
+  else if (auto *PTy = dyn_cast<PointerType>(Ty))
+    Hash = hash_combine(Hash, PTy->getAddressSpace());
+  else if (auto *FTy = dyn_cast<FunctionType>(Ty))
+    Hash = hash_combine(Hash, FTy->isVarArg());
+  else if (auto *ATy = dyn_cast<ArrayType>(Ty))
+    Hash = hash_combine(Hash, ATy->getNumElements());
+  else if (auto *VTy = dyn_cast<VectorType>(Ty))
+    Hash = hash_combine(Hash, VTy->getNumElements(), VTy->isScalable());
+
+  for (Type *SubTy : Ty->subtypes())
+    Hash = hash_combine(Hash, hashTypeShape(SubTy));
+  return Hash;
+}
+
+/// Hash the body of the non opaque struct \p STy such that all structs that
+/// are isomorphic to it have the same hash.
+static unsigned hashStructShape(StructType *STy) {
+  assert(!STy->isOpaque());
+  hash_code Hash = hash_combine(STy->isPacked(), STy->getNumElements());
+  for (Type *ElTy : STy->elements())
+    Hash = hash_combine(Hash, hashTypeShape(ElTy));
+  return Hash;
+}
+
 /// Loop over all of the linked values to compute type mappings.  For example,
 /// if we link "extern Foo *x" and "Foo *x = NULL", then we have two struct
 /// types 'Foo' but one got renamed when the module was loaded into the same
@@ -796,13 +842,9 @@ void IRLinker::computeTypeMapping() {
     }
 
     auto STTypePrefix = getTypeNamePrefix(ST->getName());
-    if (STTypePrefix.size()== ST->getName().size())
-      continue;
 
     // Check to see if the destination module has a struct with the prefix name.
     StructType *DST = DstM.getTypeByName(STTypePrefix);
-    if (!DST)
-      continue;
 
     // Don't use it if this actually came from the source module. They're in
     // the same LLVMContext after all. Also don't use it unless the type is
@@ -821,8 +863,27 @@ void IRLinker::computeTypeMapping() {
     // we prefer to take the '%C' version. So we are then left with both
     // '%C.1' and '%C' being used for the same types. This leads to some
     // variables using one type and some using the other.
-    if (TypeMap.DstStructTypesSet.hasType(DST))
-      TypeMap.addTypeMapping(DST, ST);
+    if (DST && DST != ST && TypeMap.DstStructTypesSet.hasType(DST) &&
+        TypeMap.addTypeMapping(DST, ST))
+      continue;
+
+    // Otherwise try the structs in the destination module that were renamed
+    // from the same name, e.g. "%foo.3" for "%foo.42", or for "%foo" once the
+    // original "%foo" is gone. Without this, a recursive struct that could
+    // not be mapped by name gets yet another copy in the destination module.
+    // Only structs whose bodies have the same shape can be isomorphic.
+    ArrayRef<StructType *> Candidates =
+        TypeMap.DstStructTypesSet.findByNamePrefix(STTypePrefix);
+    if (ST->isOpaque() || Candidates.empty())
+      continue;
+    unsigned Shape = hashStructShape(ST);
+    for (StructType *Candidate : Candidates) {
+      if (!Candidate->isOpaque() &&
+          TypeMap.DstStructTypesSet.getShapeHash(Candidate) != Shape)
+        continue;
+      if (TypeMap.addTypeMapping(Candidate, ST))
+        break;
+    }
   }
 
   // Now that we have discovered all of the type equivalences, get a body for
@@ -1498,12 +1559,14 @@ bool IRMover::StructTypeKeyInfo::KeyTy::operator!=(const KeyTy &That) const {
   return !this->operator==(That);
 }
 
-StructType *IRMover::StructTypeKeyInfo::getEmptyKey() {
-  return DenseMapInfo<StructType *>::getEmptyKey();
+IRMover::StructTypeKeyInfo::EntryTy
+IRMover::StructTypeKeyInfo::getEmptyKey() {
+  return {DenseMapInfo<StructType *>::getEmptyKey(), 0};
 }
 
-StructType *IRMover::StructTypeKeyInfo::getTombstoneKey() {
-  return DenseMapInfo<StructType *>::getTombstoneKey();
+IRMover::StructTypeKeyInfo::EntryTy
+IRMover::StructTypeKeyInfo::getTombstoneKey() {
+  return {DenseMapInfo<StructType *>::getTombstoneKey(), 0};
 }
 
 unsigned IRMover::StructTypeKeyInfo::getHashValue(const KeyTy &Key) {
@@ -1511,32 +1574,51 @@ unsigned IRMover::StructTypeKeyInfo::getHashValue(const KeyTy &Key) {
                       Key.IsPacked);
 }
 
-unsigned IRMover::StructTypeKeyInfo::getHashValue(const StructType *ST) {
-  return getHashValue(KeyTy(ST));
+unsigned IRMover::StructTypeKeyInfo::getHashValue(const EntryTy &Entry) {
+  return Entry.Hash;
+}
+
+static bool isEmptyOrTombstone(const StructType *ST) {
+  return ST == DenseMapInfo<StructType *>::getEmptyKey() ||
+         ST == DenseMapInfo<StructType *>::getTombstoneKey();
 }
 
 bool IRMover::StructTypeKeyInfo::isEqual(const KeyTy &LHS,
-                                         const StructType *RHS) {
-  if (RHS == getEmptyKey() || RHS == getTombstoneKey())
+                                         const EntryTy &RHS) {
+  if (isEmptyOrTombstone(RHS.ST))
     return false;
-  return LHS == KeyTy(RHS);
+  return LHS == KeyTy(RHS.ST);
+}
+
+bool IRMover::StructTypeKeyInfo::isEqual(const EntryTy &LHS,
+                                         const EntryTy &RHS) {
+  if (isEmptyOrTombstone(RHS.ST))
+    return LHS.ST == RHS.ST;
+  return LHS.Hash == RHS.Hash && KeyTy(LHS.ST) == KeyTy(RHS.ST);
 }
 
-bool IRMover::StructTypeKeyInfo::isEqual(const StructType *LHS,
-                                         const StructType *RHS) {
-  if (RHS == getEmptyKey() || RHS == getTombstoneKey())
-    return LHS == RHS;
-  return KeyTy(LHS) == KeyTy(RHS);
+void IRMover::IdentifiedStructTypeSet::addNamePrefix(StructType *Ty) {
+  if (Ty->hasName())
+    TypesByNamePrefix[getTypeNamePrefix(Ty->getName())].push_back(Ty);
 }
 
 void IRMover::IdentifiedStructTypeSet::addNonOpaque(StructType *Ty) {
   assert(!Ty->isOpaque());
-  NonOpaqueStructTypes.insert(Ty);
+  StructTypeKeyInfo::EntryTy Entry = {
+      Ty, StructTypeKeyInfo::getHashValue(StructTypeKeyInfo::KeyTy(Ty))};
+  if (NonOpaqueStructTypes.insert(Entry).second) {
+    NonOpaqueStructTypeMembers.insert(Ty);
+    addNamePrefix(Ty);
+  }
 }
 
 void IRMover::IdentifiedStructTypeSet::switchToNonOpaque(StructType *Ty) {
   assert(!Ty->isOpaque());
-  NonOpaqueStructTypes.insert(Ty);
+  // The type is already indexed by its name prefix as an opaque type.
+  StructTypeKeyInfo::EntryTy Entry = {
+      Ty, StructTypeKeyInfo::getHashValue(StructTypeKeyInfo::KeyTy(Ty))};
+  if (NonOpaqueStructTypes.insert(Entry).second)
+    NonOpaqueStructTypeMembers.insert(Ty);
   bool Removed = OpaqueStructTypes.erase(Ty);
   (void)Removed;
   assert(Removed);
@@ -1544,7 +1626,8 @@ void IRMover::IdentifiedStructTypeSet::switchToNonOpaque(StructType *Ty) {
 
 void IRMover::IdentifiedStructTypeSet::addOpaque(StructType *Ty) {
   assert(Ty->isOpaque());
-  OpaqueStructTypes.insert(Ty);
+  if (OpaqueStructTypes.insert(Ty).second)
+    addNamePrefix(Ty);
 }
 
 StructType *
@@ -1558,8 +1641,23 @@ IRMover::IdentifiedStructTypeSet::findNonOpaque(ArrayRef<Type *> ETypes,
 bool IRMover::IdentifiedStructTypeSet::hasType(StructType *Ty) {
   if (Ty->isOpaque())
     return OpaqueStructTypes.count(Ty);
-  auto I = NonOpaqueStructTypes.find(Ty);
-  return I == NonOpaqueStructTypes.end() ? false : *I == Ty;
+  return NonOpaqueStructTypeMembers.count(Ty);
+}
+
+ArrayRef<StructType *>
+IRMover::IdentifiedStructTypeSet::findByNamePrefix(StringRef Prefix) const {
+  auto I = TypesByNamePrefix.find(Prefix);
+  if (I == TypesByNamePrefix.end())
+    return None;
+  return I->second;
+}
+
+unsigned IRMover::IdentifiedStructTypeSet::getShapeHash(StructType *Ty) {
+  assert(!Ty->isOpaque());
+  auto Insertion = ShapeHashes.insert({Ty, 0});
+  if (Insertion.second)
+    Insertion.first->second = hashStructShape(Ty);
+  return Insertion.first->second;
 }
 
 IRMover::IRMover(Module &M) : Composite(M) {
@@ -160,7 +160,8 @@ struct ELFWriter {
 
   bool maybeWriteCompression(uint64_t Size,
                              SmallVectorImpl<char> &CompressedContents,
-                             bool ZLibStyle, unsigned Alignment);
+                             DebugCompressionType CompressionType,
+                             unsigned Alignment);
 
 public:
   ELFWriter(ELFObjectWriter &OWriter, raw_pwrite_stream &OS,
@@ -807,9 +808,12 @@ MCSectionELF *ELFWriter::createRelocationSection(MCContext &Ctx,
 
 // Include the debug info compression header.
 bool ELFWriter::maybeWriteCompression(
-    uint64_t Size, SmallVectorImpl<char> &CompressedContents, bool ZLibStyle,
-    unsigned Alignment) {
-  if (ZLibStyle) {
+    uint64_t Size, SmallVectorImpl<char> &CompressedContents,
+    DebugCompressionType CompressionType, unsigned Alignment) {
+  if (CompressionType != DebugCompressionType::GNU) {
+    uint32_t ChType = CompressionType == DebugCompressionType::Zstd
+                          ? ELF::ELFCOMPRESS_ZSTD
+                          : ELF::ELFCOMPRESS_ZLIB;
     uint64_t HdrSize =
         is64Bit() ? sizeof(ELF::Elf32_Chdr) : sizeof(ELF::Elf64_Chdr);
     if (Size <= HdrSize + CompressedContents.size())
@@ -817,13 +821,13 @@ bool ELFWriter::maybeWriteCompression(
     // Platform specific header is followed by compressed data.
     if (is64Bit()) {
       // Write Elf64_Chdr header.
-      write(static_cast<ELF::Elf64_Word>(ELF::ELFCOMPRESS_ZLIB));
+      write(static_cast<ELF::Elf64_Word>(ChType));
       write(static_cast<ELF::Elf64_Word>(0)); // ch_reserved field.
       write(static_cast<ELF::Elf64_Xword>(Size));
       write(static_cast<ELF::Elf64_Xword>(Alignment));
     } else {
       // Write Elf32_Chdr header otherwise.
-      write(static_cast<ELF::Elf32_Word>(ELF::ELFCOMPRESS_ZLIB));
+      write(static_cast<ELF::Elf32_Word>(ChType));
       write(static_cast<ELF::Elf32_Word>(Size));
       write(static_cast<ELF::Elf32_Word>(Alignment));
     }
@@ -859,16 +863,21 @@ void ELFWriter::writeSectionData(const MCAssembler &Asm, MCSection &Sec,
     return;
   }
 
-  assert((MAI->compressDebugSections() == DebugCompressionType::Z ||
-          MAI->compressDebugSections() == DebugCompressionType::GNU) &&
-         "expected zlib or zlib-gnu style compression");
+  DebugCompressionType CompressionType = MAI->compressDebugSections();
+  assert((CompressionType == DebugCompressionType::Z ||
+          CompressionType == DebugCompressionType::GNU ||
+          CompressionType == DebugCompressionType::Zstd) &&
+         "expected zlib, zlib-gnu or zstd style compression");
 
   SmallVector<char, 128> UncompressedData;
   raw_svector_ostream VecOS(UncompressedData);
   Asm.writeSectionData(VecOS, &Section, Layout);
 
   SmallVector<char, 128> CompressedContents;
-  if (Error E = zlib::compress(
+  if (Error E = compression::compress(
+          CompressionType == DebugCompressionType::Zstd
+              ? compression::Format::Zstd
+              : compression::Format::Zlib,
           StringRef(UncompressedData.data(), UncompressedData.size()),
           CompressedContents)) {
     consumeError(std::move(E));
@@ -876,9 +885,9 @@ void ELFWriter::writeSectionData(const MCAssembler &Asm, MCSection &Sec,
     return;
   }
 
-  bool ZlibStyle = MAI->compressDebugSections() == DebugCompressionType::Z;
+  bool ZlibStyle = CompressionType != DebugCompressionType::GNU;
   if (!maybeWriteCompression(UncompressedData.size(), CompressedContents,
-                             ZlibStyle, Sec.getAlignment())) {
+                             CompressionType, Sec.getAlignment())) {
     W.OS << UncompressedData;
     return;
   }
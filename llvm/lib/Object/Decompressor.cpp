@@ -19,14 +19,15 @@ using namespace object;
 
 Expected<Decompressor> Decompressor::create(StringRef Name, StringRef Data,
                                             bool IsLE, bool Is64Bit) {
-  if (!zlib::isAvailable())
-    return createError("zlib is not available");
-
   Decompressor D(Data);
-  Error Err = isGnuStyle(Name) ? D.consumeCompressedGnuHeader()
-                               : D.consumeCompressedZLibHeader(Is64Bit, IsLE);
+  Error Err = isGnuStyle(Name)
+                  ? D.consumeCompressedGnuHeader()
+                  : D.consumeCompressedSectionHeader(Is64Bit, IsLE);
   if (Err)
     return std::move(Err);
+  if (!compression::isAvailable(D.CompressionFormat))
+    return createError(Twine(compression::getName(D.CompressionFormat)) +
+                       " is not available");
   return D;
 }
 
@@ -48,8 +49,8 @@ Error Decompressor::consumeCompressedGnuHeader() {
   return Error::success();
 }
 
-Error Decompressor::consumeCompressedZLibHeader(bool Is64Bit,
-                                                bool IsLittleEndian) {
+Error Decompressor::consumeCompressedSectionHeader(bool Is64Bit,
+                                                   bool IsLittleEndian) {
   using namespace ELF;
   uint64_t HdrSize = Is64Bit ? sizeof(Elf64_Chdr) : sizeof(Elf32_Chdr);
   if (SectionData.size() < HdrSize)
@@ -57,10 +58,17 @@ Error Decompressor::consumeCompressedZLibHeader(bool Is64Bit,
 
   DataExtractor Extractor(SectionData, IsLittleEndian, 0);
   uint64_t Offset = 0;
-  if (Extractor.getUnsigned(&Offset, Is64Bit ? sizeof(Elf64_Word)
-                                             : sizeof(Elf32_Word)) !=
-      ELFCOMPRESS_ZLIB)
+  switch (Extractor.getUnsigned(&Offset, Is64Bit ? sizeof(Elf64_Word)
+                                                 : sizeof(Elf32_Word))) {
+  case ELFCOMPRESS_ZLIB:
+    CompressionFormat = compression::Format::Zlib;
+    break;
+  case ELFCOMPRESS_ZSTD:
+    CompressionFormat = compression::Format::Zstd;
+    break;
+  default:
     return createError("unsupported compression type");
+  }
 
   // Skip Elf64_Chdr::ch_reserved field.
   if (Is64Bit)
@@ -94,5 +102,6 @@ bool Decompressor::isCompressedELFSection(uint64_t Flags, StringRef Name) {
 
 Error Decompressor::decompress(MutableArrayRef<char> Buffer) {
   size_t Size = Buffer.size();
-  return zlib::uncompress(SectionData, Buffer.data(), Size);
+  return compression::uncompress(CompressionFormat, SectionData, Buffer.data(),
+                                 Size);
 }
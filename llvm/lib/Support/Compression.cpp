@@ -20,14 +20,18 @@
 #if LLVM_ENABLE_ZLIB == 1 && HAVE_ZLIB_H
 #include <zlib.h>
 #endif
+#if LLVM_ENABLE_ZSTD == 1
+#include <zstd.h>
+#endif
 
 using namespace llvm;
 
-#if LLVM_ENABLE_ZLIB == 1 && HAVE_LIBZ
-static Error createError(StringRef Err) {
+LLVM_ATTRIBUTE_UNUSED static Error createError(StringRef Err) {
   return make_error<StringError>(Err, inconvertibleErrorCode());
 }
 
+#if LLVM_ENABLE_ZLIB == 1 && HAVE_LIBZ
+
 static StringRef convertZlibCodeToString(int Code) {
   switch (Code) {
   case Z_MEM_ERROR:
@@ -104,3 +108,137 @@ uint32_t zlib::crc32(StringRef Buffer) {
   llvm_unreachable("zlib::crc32 is unavailable");
 }
 #endif
+
+#if LLVM_ENABLE_ZSTD == 1
+bool zstd::isAvailable() { return true; }
+
+Error zstd::compress(StringRef InputBuffer,
+                     SmallVectorImpl<char> &CompressedBuffer, int Level) {
+  size_t CompressedBufferSize = ::ZSTD_compressBound(InputBuffer.size());
+  CompressedBuffer.reserve(CompressedBufferSize);
+  size_t CompressedSize =
+      ::ZSTD_compress(CompressedBuffer.data(), CompressedBufferSize,
+                      InputBuffer.data(), InputBuffer.size(), Level);
+  if (::ZSTD_isError(CompressedSize))
+    return createError(::ZSTD_getErrorName(CompressedSize));
+  // Tell MemorySanitizer that zstd output buffer is fully initialized.
+  // This avoids a false report when running LLVM with uninstrumented zstd.
+  __msan_unpoison(CompressedBuffer.data(), CompressedSize);
+  CompressedBuffer.set_size(CompressedSize);
+  return Error::success();
+}
+
+Error zstd::uncompress(StringRef InputBuffer, char *UncompressedBuffer,
+                       size_t &UncompressedSize) {
+  const size_t Res =
+      ::ZSTD_decompress(UncompressedBuffer, UncompressedSize,
+                        InputBuffer.data(), InputBuffer.size());
+  if (::ZSTD_isError(Res))
+    return createError(::ZSTD_getErrorName(Res));
+  UncompressedSize = Res;
+  // Tell MemorySanitizer that zstd output buffer is fully initialized.
+  // This avoids a false report when running LLVM with uninstrumented zstd.
+  __msan_unpoison(UncompressedBuffer, UncompressedSize);
+  return Error::success();
+}
+
+Error zstd::uncompress(StringRef InputBuffer,
+                       SmallVectorImpl<char> &UncompressedBuffer,
+                       size_t UncompressedSize) {
+  UncompressedBuffer.resize(UncompressedSize);
+  Error E =
+      uncompress(InputBuffer, UncompressedBuffer.data(), UncompressedSize);
+  UncompressedBuffer.resize(UncompressedSize);
+  return E;
+}
+
+#else
+bool zstd::isAvailable() { return false; }
+Error zstd::compress(StringRef InputBuffer,
+                     SmallVectorImpl<char> &CompressedBuffer, int Level) {
+  llvm_unreachable("zstd::compress is unavailable");
+}
+Error zstd::uncompress(StringRef InputBuffer, char *UncompressedBuffer,
+                       size_t &UncompressedSize) {
+  llvm_unreachable("zstd::uncompress is unavailable");
+}
+Error zstd::uncompress(StringRef InputBuffer,
+                       SmallVectorImpl<char> &UncompressedBuffer,
+                       size_t UncompressedSize) {
+  llvm_unreachable("zstd::uncompress is unavailable");
+}
+#endif
+
+const char *compression::getName(Format F) {
+  switch (F) {
+  case Format::Zlib:
+    return "zlib";
+  case Format::Zstd:
+    return "zstd";
+  }
+  llvm_unreachable("unknown compression format");
+}
+
+bool compression::isAvailable(Format F) {
+  switch (F) {
+  case Format::Zlib:
+    return zlib::isAvailable();
+  case Format::Zstd:
+    return zstd::isAvailable();
+  }
+  llvm_unreachable("unknown compression format");
+}
+
+const char *compression::getReasonIfUnavailable(Format F) {
+  if (isAvailable(F))
+    return nullptr;
+  switch (F) {
+  case Format::Zlib:
+    return "LLVM was not built with LLVM_ENABLE_ZLIB or did not find zlib at "
+           "build time";
+  case Format::Zstd:
+    return "LLVM was not built with LLVM_ENABLE_ZSTD or did not find zstd at "
+           "build time";
+  }
+  llvm_unreachable("unknown compression format");
+}
+
+Error compression::compress(Format F, StringRef InputBuffer,
+                            SmallVectorImpl<char> &CompressedBuffer,
+                            int Level) {
+  switch (F) {
+  case Format::Zlib:
+    return zlib::compress(InputBuffer, CompressedBuffer,
+                          Level == DefaultLevel ? zlib::DefaultCompression
+                                                : Level);
+  case Format::Zstd:
+    return zstd::compress(InputBuffer, CompressedBuffer,
+                          Level == DefaultLevel ? zstd::DefaultCompression
+                                                : Level);
+  }
+  llvm_unreachable("unknown compression format");
+}
+
+Error compression::uncompress(Format F, StringRef InputBuffer,
+                              char *UncompressedBuffer,
+                              size_t &UncompressedSize) {
+  switch (F) {
+  case Format::Zlib:
+    return zlib::uncompress(InputBuffer, UncompressedBuffer, UncompressedSize);
+  case Format::Zstd:
+    return zstd::uncompress(InputBuffer, UncompressedBuffer, UncompressedSize);
+  }
+  llvm_unreachable("unknown compression format");
+}
+
+Error compression::uncompress(Format F, StringRef InputBuffer,
+                              SmallVectorImpl<char> &UncompressedBuffer,
+                              size_t UncompressedSize) {
+  switch (F) {
+  case Format::Zlib:
+    return zlib::uncompress(InputBuffer, UncompressedBuffer, UncompressedSize);
+  case Format::Zstd:
+    return zstd::uncompress(InputBuffer, UncompressedBuffer, UncompressedSize);
+  }
+  llvm_unreachable("unknown compression format");
+}
@@ -42,12 +42,15 @@
 #include "llvm/Support/Error.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Transforms/IPO/Internalize.h"
 #include "llvm/Transforms/Utils/Cloning.h"
 #include "llvm/Transforms/Utils/FunctionImportUtils.h"
 #include "llvm/Transforms/Utils/ValueMapper.h"
+#include <atomic>
 #include <cassert>
 #include <memory>
 #include <set>
@@ -120,6 +123,11 @@ static cl::opt<bool> PrintImportFailures(
     "print-import-failures", cl::init(false), cl::Hidden,
     cl::desc("Print information for functions rejected for importing"));
 
+static cl::opt<bool> ParallelImportComputation(
+    "parallel-import-computation", cl::init(true), cl::Hidden,
+    cl::desc("Compute the per-module import lists of the thin link in "
+             "parallel"));
+
 static cl::opt<bool> ComputeDead("compute-dead", cl::init(true), cl::Hidden,
                                  cl::desc("Compute dead symbols"));
 
@@ -361,7 +369,7 @@ static void computeImportForFunction(
     FunctionImporter::ImportThresholdsTy &ImportThresholds) {
   computeImportForReferencedGlobals(Summary, Index, DefinedGVSummaries,
                                     ImportList, ExportLists);
-  static int ImportCount = 0;
+  static std::atomic<int> ImportCount(0);
   for (auto &Edge : Summary.calls()) {
     ValueInfo VI = Edge.first;
     LLVM_DEBUG(dbgs() << " edge -> " << VI << " Threshold:" << Threshold
@@ -648,15 +656,49 @@ void llvm::ComputeCrossModuleImport(
     const StringMap<GVSummaryMapTy> &ModuleToDefinedGVSummaries,
     StringMap<FunctionImporter::ImportMapTy> &ImportLists,
     StringMap<FunctionImporter::ExportSetTy> &ExportLists) {
+  TimeTraceScope TimeScope("Compute cross-module import");
+
+  // Per-module state for the import computation. The import list entries are
+  // created up front so that each module only ever touches its own entry, and
+  // each module gets a private export map which is merged afterwards.
+  struct ModuleImportState {
+    StringRef ModulePath;
+    const GVSummaryMapTy *DefinedGVSummaries;
+    FunctionImporter::ImportMapTy *ImportList;
+    StringMap<FunctionImporter::ExportSetTy> ExportLists;
+  };
+  std::vector<ModuleImportState> ModuleStates;
+  ModuleStates.reserve(ModuleToDefinedGVSummaries.size());
+  for (auto &DefinedGVSummaries : ModuleToDefinedGVSummaries)
+    ModuleStates.push_back({DefinedGVSummaries.first(),
+                            &DefinedGVSummaries.second,
+                            &ImportLists[DefinedGVSummaries.first()],
+                            {}});
+
   // For each module that has function defined, compute the import/export lists.
-  for (auto &DefinedGVSummaries : ModuleToDefinedGVSummaries) {
-    auto &ImportList = ImportLists[DefinedGVSummaries.first()];
-    LLVM_DEBUG(dbgs() << "Computing import for Module '"
-                      << DefinedGVSummaries.first() << "'\n");
-    ComputeImportForModule(DefinedGVSummaries.second, Index,
-                           DefinedGVSummaries.first(), ImportList,
-                           &ExportLists);
-  }
+  auto ComputeForModule = [&](size_t I) {
+    ModuleImportState &State = ModuleStates[I];
+    LLVM_DEBUG(dbgs() << "Computing import for Module '" << State.ModulePath
+                      << "'\n");
+    ComputeImportForModule(*State.DefinedGVSummaries, Index, State.ModulePath,
+                           *State.ImportList, &State.ExportLists);
+  };
+
+  // The combined index is only read while computing imports, so the modules
+  // are independent. -import-cutoff depends on the global visiting order and
+  // -print-import-failures prints per module, so both force the serial walk.
+  if (ParallelImportComputation && ImportCutoff < 0 && !PrintImportFailures)
+    parallel::for_each_n(parallel::par, size_t(0), ModuleStates.size(),
+                         ComputeForModule);
+  else
+    for (size_t I = 0, E = ModuleStates.size(); I != E; ++I)
+      ComputeForModule(I);
+
+  // Merge the exports in module order, so that the result does not depend on
+  // how the computation above was scheduled.
+  for (auto &State : ModuleStates)
+    for (auto &ELI : State.ExportLists)
+      ExportLists[ELI.first()].insert(ELI.second.begin(), ELI.second.end());
 
   // When computing imports we only added the variables and functions being
   // imported to the export list. We also need to mark any references and calls
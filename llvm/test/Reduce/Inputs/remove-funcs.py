@@ -0,0 +1,13 @@
+import sys
+
+InterestingFunction = False
+
+input = open(sys.argv[1], "r")
+for line in input:
+  if "define i32 @interesting(" in line:
+    InterestingFunction = True
+
+if InterestingFunction:
+  sys.exit(0) # interesting!
+
+sys.exit(1)
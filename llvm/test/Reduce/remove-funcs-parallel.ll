@@ -0,0 +1,45 @@
+; Test that llvm-reduce removes the same functions when it runs several
+; interesting-ness tests at once as when it runs them one at a time.
+;
+; RUN: llvm-reduce --test %python --test-arg %p/Inputs/remove-funcs.py %s -o %t.serial
+; RUN: llvm-reduce -j 4 --test %python --test-arg %p/Inputs/remove-funcs.py %s -o %t.parallel
+; RUN: diff %t.serial %t.parallel
+; RUN: cat %t.parallel | FileCheck -implicit-check-not=uninteresting %s
+
+define i32 @uninteresting1() {
+entry:
+  ret i32 0
+}
+
+; CHECK: define i32 @interesting()
+define i32 @interesting() {
+entry:
+  ret i32 5
+}
+
+define i32 @uninteresting2() {
+entry:
+  ret i32 2
+}
+
+define i32 @uninteresting3() {
+entry:
+  %call = call i32 @uninteresting2()
+  ret i32 %call
+}
+
+define i32 @uninteresting4() {
+entry:
+  ret i32 4
+}
+
+define i32 @uninteresting5() {
+entry:
+  %call = call i32 @uninteresting4()
+  ret i32 %call
+}
+
+define i32 @uninteresting6() {
+entry:
+  ret i32 6
+}
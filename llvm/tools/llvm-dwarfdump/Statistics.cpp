@@ -15,6 +15,7 @@
 #include "llvm/DebugInfo/DWARF/DWARFDebugLoc.h"
 #include "llvm/Object/ObjectFile.h"
 #include "llvm/Support/JSON.h"
+#include "llvm/Support/Parallel.h"
 
 #define DEBUG_TYPE "dwarfdump"
 using namespace llvm;
@@ -66,6 +67,28 @@ struct PerFunctionStats {
   unsigned NumVarTypes = 0;
   /// Number of variables with DW_AT_location.
   unsigned NumVarLocations = 0;
+
+  /// Adds the statistics of other instances of this function.
+  void accumulate(const PerFunctionStats &Other) {
+    NumFnInlined += Other.NumFnInlined;
+    NumFnOutOfLine += Other.NumFnOutOfLine;
+    NumAbstractOrigins += Other.NumAbstractOrigins;
+    TotalVarWithLoc += Other.TotalVarWithLoc;
+    ConstantMembers += Other.ConstantMembers;
+    NumArtificial += Other.NumArtificial;
+    for (const auto &Var : Other.VarsInFunction)
+      VarsInFunction.insert(Var.getKey());
+    IsFunction |= Other.IsFunction;
+    HasSourceLocation |= Other.HasSourceLocation;
+    NumParams += Other.NumParams;
+    NumParamSourceLocations += Other.NumParamSourceLocations;
+    NumParamTypes += Other.NumParamTypes;
+    NumParamLocations += Other.NumParamLocations;
+    NumVars += Other.NumVars;
+    NumVarSourceLocations += Other.NumVarSourceLocations;
+    NumVarTypes += Other.NumVarTypes;
+    NumVarLocations += Other.NumVarLocations;
+  }
 };
 
 /// Holds accumulated global statistics about DIEs.
@@ -108,6 +131,23 @@ struct GlobalStats {
   /// for the top inline functions within concrete functions. This can help
   /// tune the inline settings when compiling to match user expectations.
   unsigned InlineFunctionSize = 0;
+
+  void accumulate(const GlobalStats &Other) {
+    ScopeBytesCovered += Other.ScopeBytesCovered;
+    ScopeBytes += Other.ScopeBytes;
+    ScopeEntryValueBytesCovered += Other.ScopeEntryValueBytesCovered;
+    ParamScopeBytesCovered += Other.ParamScopeBytesCovered;
+    ParamScopeBytes += Other.ParamScopeBytes;
+    ParamScopeEntryValueBytesCovered += Other.ParamScopeEntryValueBytesCovered;
+    VarScopeBytesCovered += Other.VarScopeBytesCovered;
+    VarScopeBytes += Other.VarScopeBytes;
+    VarScopeEntryValueBytesCovered += Other.VarScopeEntryValueBytesCovered;
+    CallSiteEntries += Other.CallSiteEntries;
+    CallSiteDIEs += Other.CallSiteDIEs;
+    CallSiteParamDIEs += Other.CallSiteParamDIEs;
+    FunctionSize += Other.FunctionSize;
+    InlineFunctionSize += Other.InlineFunctionSize;
+  }
 };
 
 /// Holds accumulated debug location statistics about local variables and
@@ -141,6 +181,30 @@ struct LocationStats {
   unsigned NumParam = 0;
   /// Total number of local variables processed.
   unsigned NumVar = 0;
+
+  void accumulate(const LocationStats &Other) {
+    auto Add = [](std::vector<unsigned> &To,
+                  const std::vector<unsigned> &From) {
+      for (unsigned I = 0; I < NumOfCoverageCategories; ++I)
+        To[I] += From[I];
+    };
+    Add(VarParamLocStats, Other.VarParamLocStats);
+    Add(VarParamNonEntryValLocStats, Other.VarParamNonEntryValLocStats);
+    Add(ParamLocStats, Other.ParamLocStats);
+    Add(ParamNonEntryValLocStats, Other.ParamNonEntryValLocStats);
+    Add(VarLocStats, Other.VarLocStats);
+    Add(VarNonEntryValLocStats, Other.VarNonEntryValLocStats);
+    NumVarParam += Other.NumVarParam;
+    NumParam += Other.NumParam;
+    NumVar += Other.NumVar;
+  }
+};
+
+/// Statistics collected from one compile unit.
+struct UnitStats {
+  StringMap<PerFunctionStats> Functions;
+  GlobalStats Global;
+  LocationStats Locations;
 };
 } // namespace
 
@@ -516,13 +580,37 @@ bool dwarfdump::collectStatsForObjectFile(ObjectFile &Obj, DWARFContext &DICtx,
                                           const Twine &Filename,
                                           raw_ostream &OS) {
   StringRef FormatName = Obj.getFileFormatName();
+
+  // The compile units are walked in parallel, each into its own statistics,
+  // which are then added up in unit order. Everything the units share is set
+  // up beforehand: split DWARF units are loaded, the line tables are parsed,
+  // and all DIEs are extracted because abstract origins may lead into other
+  // units.
+  std::vector<DWARFUnit *> Units;
+  for (const auto &CU : static_cast<DWARFContext *>(&DICtx)->compile_units())
+    if (DWARFDie CUDie = CU->getNonSkeletonUnitDIE(true)) {
+      DWARFUnit *U = CUDie.getDwarfUnit();
+      U->getContext().getLineTableForUnit(U);
+      Units.push_back(U);
+    }
+  parallel::for_each_n(parallel::par, size_t(0), Units.size(),
+                       [&](size_t I) { Units[I]->getNumDIEs(); });
+  std::vector<UnitStats> PerUnit(Units.size());
+  parallel::for_each_n(parallel::par, size_t(0), Units.size(), [&](size_t I) {
+    UnitStats &S = PerUnit[I];
+    collectStatsRecursive(Units[I]->getUnitDIE(false), "/", "g", 0, 0,
+                          S.Functions, S.Global, S.Locations);
+  });
+
   GlobalStats GlobalStats;
   LocationStats LocStats;
   StringMap<PerFunctionStats> Statistics;
-  for (const auto &CU : static_cast<DWARFContext *>(&DICtx)->compile_units())
-    if (DWARFDie CUDie = CU->getNonSkeletonUnitDIE(false))
-      collectStatsRecursive(CUDie, "/", "g", 0, 0, Statistics, GlobalStats,
-                            LocStats);
+  for (const UnitStats &S : PerUnit) {
+    GlobalStats.accumulate(S.Global);
+    LocStats.accumulate(S.Locations);
+    for (const auto &Entry : S.Functions)
+      Statistics[Entry.getKey()].accumulate(Entry.getValue());
+  }
 
   /// Collect the sizes of debug sections.
   SectionSizes Sizes;
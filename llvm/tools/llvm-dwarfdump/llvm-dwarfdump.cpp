@@ -24,6 +24,7 @@
 #include "llvm/Support/Format.h"
 #include "llvm/Support/InitLLVM.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Regex.h"
 #include "llvm/Support/TargetSelect.h"
@@ -222,6 +223,11 @@ static opt<bool> Verify("verify", desc("Verify the DWARF debug info."),
                         cat(DwarfDumpCategory));
 static opt<bool> Quiet("quiet", desc("Use with -verify to not emit to STDOUT."),
                        cat(DwarfDumpCategory));
+static opt<unsigned>
+    NumThreads("num-threads", init(0),
+               desc("Number of threads used by -verify and -statistics "
+                    "(default: the number of hardware threads)"),
+               cat(DwarfDumpCategory));
 static opt<bool> DumpUUID("uuid", desc("Show the UUID for each architecture."),
                           cat(DwarfDumpCategory));
 static alias DumpUUIDAlias("u", desc("Alias for -uuid."), aliasopt(DumpUUID));
@@ -590,6 +596,7 @@ int main(int argc, char **argv) {
       argc, argv,
       "pretty-print DWARF debug information in object files"
       " and debug info archives.\n");
+  parallel::strategy = hardware_concurrency(NumThreads);
 
   // FIXME: Audit interactions between these two options and make them
   //        compatible.
@@ -54,6 +54,7 @@
 #include "llvm/Support/Host.h"
 #include "llvm/Support/InitLLVM.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
@@ -186,6 +187,12 @@ static cl::opt<unsigned> StoreQueueSize("squeue",
                                         cl::desc("Size of the store queue"),
                                         cl::cat(ToolOptions), cl::init(0));
 
+static cl::opt<unsigned>
+    NumThreads("num-threads", cl::init(0),
+               cl::desc("Number of threads used to simulate code regions "
+                        "(default: the number of hardware threads)"),
+               cl::cat(ToolOptions));
+
 static cl::opt<bool>
     PrintInstructionTables("instruction-tables",
                            cl::desc("Print instruction tables"),
@@ -276,16 +283,167 @@ static void processViewOptions() {
 }
 
 // Returns true on success.
-static bool runPipeline(mca::Pipeline &P) {
+static bool runPipeline(mca::Pipeline &P, raw_ostream &ErrOS) {
   // Handle pipeline errors here.
   Expected<unsigned> Cycles = P.run();
   if (!Cycles) {
-    WithColor::error() << toString(Cycles.takeError());
+    WithColor::error(ErrOS) << toString(Cycles.takeError());
     return false;
   }
   return true;
 }
 
+namespace {
+
+/// The target description shared by the simulations of all code regions.
+/// Every region builds its own mca::Context, InstrBuilder, instruction
+/// printer and code emitter from it, so that regions can be simulated
+/// concurrently. The code emitters all allocate in the shared MCContext,
+/// which is not thread-safe, so encodings may only be computed serially.
+struct RegionSimulator {
+  const Target &TheTarget;
+  const MCSubtargetInfo &STI;
+  const MCInstrInfo &MCII;
+  const MCRegisterInfo &MRI;
+  const MCAsmInfo &MAI;
+  const MCInstrAnalysis *MCIA;
+  const MCTargetOptions &MCOptions;
+  MCContext &Ctx;
+  unsigned AssemblerDialect;
+
+  /// Simulates \p Region and prints its report to \p OS. Diagnostics are
+  /// printed to \p ErrOS. Returns true on success.
+  bool run(const mca::CodeRegion &Region, raw_ostream &OS,
+           raw_ostream &ErrOS) const;
+};
+
+bool RegionSimulator::run(const mca::CodeRegion &Region, raw_ostream &OS,
+                          raw_ostream &ErrOS) const {
+  std::unique_ptr<MCInstPrinter> IP(TheTarget.createMCInstPrinter(
+      Triple(TripleName), AssemblerDialect, MAI, MCII, MRI));
+  // Set the display preference for hex vs. decimal immediates.
+  IP->setPrintImmHex(PrintImmHex);
+
+  std::unique_ptr<MCCodeEmitter> MCE(
+      TheTarget.createMCCodeEmitter(MCII, MRI, Ctx));
+
+  std::unique_ptr<MCAsmBackend> MAB(
+      TheTarget.createMCAsmBackend(STI, MRI, MCOptions));
+
+  const MCSchedModel &SM = STI.getSchedModel();
+
+  // Create an instruction builder.
+  mca::InstrBuilder IB(STI, MCII, MRI, MCIA);
+
+  // Create a context to control ownership of the pipeline hardware.
+  mca::Context MCA(MRI, STI);
+
+  mca::PipelineOptions PO(MicroOpQueue, DecoderThroughput, DispatchWidth,
+                          RegisterFileSize, LoadQueueSize, StoreQueueSize,
+                          AssumeNoAlias, EnableBottleneckAnalysis);
+
+  // Lower the MCInst sequence into an mca::Instruction sequence.
+  ArrayRef<MCInst> Insts = Region.getInstructions();
+  mca::CodeEmitter CE(STI, *MAB, *MCE, Insts);
+  std::vector<std::unique_ptr<mca::Instruction>> LoweredSequence;
+  for (const MCInst &MCI : Insts) {
+    Expected<std::unique_ptr<mca::Instruction>> Inst =
+        IB.createInstruction(MCI);
+    if (!Inst) {
+      if (auto NewE = handleErrors(
+              Inst.takeError(),
+              [&](const mca::InstructionError<MCInst> &IE) {
+                std::string InstructionStr;
+                raw_string_ostream SS(InstructionStr);
+                WithColor::error(ErrOS) << IE.Message << '\n';
+                IP->printInst(&IE.Inst, 0, "", STI, SS);
+                SS.flush();
+                WithColor::note(ErrOS)
+                    << "instruction: " << InstructionStr << '\n';
+              })) {
+        // Default case.
+        WithColor::error(ErrOS) << toString(std::move(NewE));
+      }
+      return false;
+    }
+
+    LoweredSequence.emplace_back(std::move(Inst.get()));
+  }
+
+  mca::SourceMgr S(LoweredSequence, PrintInstructionTables ? 1 : Iterations);
+
+  if (PrintInstructionTables) {
+    //  Create a pipeline, stages, and a printer.
+    auto P = std::make_unique<mca::Pipeline>();
+    P->appendStage(std::make_unique<mca::EntryStage>(S));
+    P->appendStage(std::make_unique<mca::InstructionTables>(SM));
+    mca::PipelinePrinter Printer(*P);
+
+    // Create the views for this pipeline, execute, and emit a report.
+    if (PrintInstructionInfoView) {
+      Printer.addView(std::make_unique<mca::InstructionInfoView>(
+          STI, MCII, CE, ShowEncoding, Insts, *IP));
+    }
+    Printer.addView(
+        std::make_unique<mca::ResourcePressureView>(STI, *IP, Insts));
+
+    if (!runPipeline(*P, ErrOS))
+      return false;
+
+    Printer.printReport(OS);
+    return true;
+  }
+
+  // Create a basic pipeline simulating an out-of-order backend.
+  auto P = MCA.createDefaultPipeline(PO, S);
+  mca::PipelinePrinter Printer(*P);
+
+  if (PrintSummaryView)
+    Printer.addView(
+        std::make_unique<mca::SummaryView>(SM, Insts, DispatchWidth));
+
+  if (EnableBottleneckAnalysis) {
+    Printer.addView(std::make_unique<mca::BottleneckAnalysis>(
+        STI, *IP, Insts, S.getNumIterations()));
+  }
+
+  if (PrintInstructionInfoView)
+    Printer.addView(std::make_unique<mca::InstructionInfoView>(
+        STI, MCII, CE, ShowEncoding, Insts, *IP));
+
+  if (PrintDispatchStats)
+    Printer.addView(std::make_unique<mca::DispatchStatistics>());
+
+  if (PrintSchedulerStats)
+    Printer.addView(std::make_unique<mca::SchedulerStatistics>(STI));
+
+  if (PrintRetireStats)
+    Printer.addView(std::make_unique<mca::RetireControlUnitStatistics>(SM));
+
+  if (PrintRegisterFileStats)
+    Printer.addView(std::make_unique<mca::RegisterFileStatistics>(STI));
+
+  if (PrintResourcePressureView)
+    Printer.addView(
+        std::make_unique<mca::ResourcePressureView>(STI, *IP, Insts));
+
+  if (PrintTimelineView) {
+    unsigned TimelineIterations =
+        TimelineMaxIterations ? TimelineMaxIterations : 10;
+    Printer.addView(std::make_unique<mca::TimelineView>(
+        STI, *IP, Insts, std::min(TimelineIterations, S.getNumIterations()),
+        TimelineMaxCycles));
+  }
+
+  if (!runPipeline(*P, ErrOS))
+    return false;
+
+  Printer.printReport(OS);
+  return true;
+}
+
+} // end of anonymous namespace
+
 int main(int argc, char **argv) {
   InitLLVM X(argc, argv);
 
@@ -302,6 +460,7 @@ int main(int argc, char **argv) {
   // Parse flags and initialize target options.
   cl::ParseCommandLineOptions(argc, argv,
                               "llvm machine code performance analyzer.\n");
+  parallel::strategy = hardware_concurrency(NumThreads);
 
   // Get the target from the triple. If a triple is not specified, then select
   // the default triple for the host. If the triple doesn't correspond to any
@@ -411,6 +570,8 @@ int main(int argc, char **argv) {
   unsigned AssemblerDialect = CRG.getAssemblerDialect();
   if (OutputAsmVariant >= 0)
     AssemblerDialect = static_cast<unsigned>(OutputAsmVariant);
+  // Every region creates its own printer. Check here that the target has one
+  // for this assembly variant.
   std::unique_ptr<MCInstPrinter> IP(TheTarget->createMCInstPrinter(
       Triple(TripleName), AssemblerDialect, *MAI, *MCII, *MRI));
   if (!IP) {
@@ -421,147 +582,69 @@ int main(int argc, char **argv) {
     return 1;
   }
 
-  // Set the display preference for hex vs. decimal immediates.
-  IP->setPrintImmHex(PrintImmHex);
-
   std::unique_ptr<ToolOutputFile> TOF = std::move(*OF);
 
-  const MCSchedModel &SM = STI->getSchedModel();
-
-  // Create an instruction builder.
-  mca::InstrBuilder IB(*STI, *MCII, *MRI, MCIA.get());
-
-  // Create a context to control ownership of the pipeline hardware.
-  mca::Context MCA(*MRI, *STI);
+  RegionSimulator Simulator{*TheTarget, *STI, *MCII, *MRI, *MAI, MCIA.get(),
+                            MCOptions, Ctx, AssemblerDialect};
 
-  mca::PipelineOptions PO(MicroOpQueue, DecoderThroughput, DispatchWidth,
-                          RegisterFileSize, LoadQueueSize, StoreQueueSize,
-                          AssumeNoAlias, EnableBottleneckAnalysis);
+  // Skip empty code regions.
+  std::vector<const mca::CodeRegion *> NonEmptyRegions;
+  for (const std::unique_ptr<mca::CodeRegion> &Region : Regions)
+    if (!Region->empty())
+      NonEmptyRegions.push_back(Region.get());
 
   // Number each region in the sequence.
   unsigned RegionIdx = 0;
-
-  std::unique_ptr<MCCodeEmitter> MCE(
-      TheTarget->createMCCodeEmitter(*MCII, *MRI, Ctx));
-
-  std::unique_ptr<MCAsmBackend> MAB(TheTarget->createMCAsmBackend(
-      *STI, *MRI, mc::InitMCTargetOptionsFromFlags()));
-
-  for (const std::unique_ptr<mca::CodeRegion> &Region : Regions) {
-    // Skip empty code regions.
-    if (Region->empty())
-      continue;
-
+  auto PrintRegionHeader = [&](const mca::CodeRegion &Region,
+                               raw_ostream &OS) {
     // Don't print the header of this region if it is the default region, and
     // it doesn't have an end location.
-    if (Region->startLoc().isValid() || Region->endLoc().isValid()) {
-      TOF->os() << "\n[" << RegionIdx++ << "] Code Region";
-      StringRef Desc = Region->getDescription();
+    if (Region.startLoc().isValid() || Region.endLoc().isValid()) {
+      OS << "\n[" << RegionIdx++ << "] Code Region";
+      StringRef Desc = Region.getDescription();
       if (!Desc.empty())
-        TOF->os() << " - " << Desc;
-      TOF->os() << "\n\n";
-    }
-
-    // Lower the MCInst sequence into an mca::Instruction sequence.
-    ArrayRef<MCInst> Insts = Region->getInstructions();
-    mca::CodeEmitter CE(*STI, *MAB, *MCE, Insts);
-    std::vector<std::unique_ptr<mca::Instruction>> LoweredSequence;
-    for (const MCInst &MCI : Insts) {
-      Expected<std::unique_ptr<mca::Instruction>> Inst =
-          IB.createInstruction(MCI);
-      if (!Inst) {
-        if (auto NewE = handleErrors(
-                Inst.takeError(),
-                [&IP, &STI](const mca::InstructionError<MCInst> &IE) {
-                  std::string InstructionStr;
-                  raw_string_ostream SS(InstructionStr);
-                  WithColor::error() << IE.Message << '\n';
-                  IP->printInst(&IE.Inst, 0, "", *STI, SS);
-                  SS.flush();
-                  WithColor::note()
-                      << "instruction: " << InstructionStr << '\n';
-                })) {
-          // Default case.
-          WithColor::error() << toString(std::move(NewE));
-        }
-        return 1;
-      }
-
-      LoweredSequence.emplace_back(std::move(Inst.get()));
+        OS << " - " << Desc;
+      OS << "\n\n";
     }
-
-    mca::SourceMgr S(LoweredSequence, PrintInstructionTables ? 1 : Iterations);
-
-    if (PrintInstructionTables) {
-      //  Create a pipeline, stages, and a printer.
-      auto P = std::make_unique<mca::Pipeline>();
-      P->appendStage(std::make_unique<mca::EntryStage>(S));
-      P->appendStage(std::make_unique<mca::InstructionTables>(SM));
-      mca::PipelinePrinter Printer(*P);
-
-      // Create the views for this pipeline, execute, and emit a report.
-      if (PrintInstructionInfoView) {
-        Printer.addView(std::make_unique<mca::InstructionInfoView>(
-            *STI, *MCII, CE, ShowEncoding, Insts, *IP));
-      }
-      Printer.addView(
-          std::make_unique<mca::ResourcePressureView>(*STI, *IP, Insts));
-
-      if (!runPipeline(*P))
+  };
+
+  // Regions are simulated in parallel, each into its own buffer, and the
+  // reports are printed in source order. Views color their output on a
+  // terminal, which a buffer cannot carry, so that case stays serial. So does
+  // -show-encoding, as encoding creates expressions in the shared MCContext.
+  if (NonEmptyRegions.size() <= 1 ||
+      parallel::strategy.compute_thread_count() <= 1 ||
+      TOF->os().has_colors() || ShowEncoding) {
+    for (const mca::CodeRegion *Region : NonEmptyRegions) {
+      PrintRegionHeader(*Region, TOF->os());
+      if (!Simulator.run(*Region, TOF->os(), errs()))
         return 1;
-
-      Printer.printReport(TOF->os());
-      continue;
     }
-
-    // Create a basic pipeline simulating an out-of-order backend.
-    auto P = MCA.createDefaultPipeline(PO, S);
-    mca::PipelinePrinter Printer(*P);
-
-    if (PrintSummaryView)
-      Printer.addView(
-          std::make_unique<mca::SummaryView>(SM, Insts, DispatchWidth));
-
-    if (EnableBottleneckAnalysis) {
-      Printer.addView(std::make_unique<mca::BottleneckAnalysis>(
-          *STI, *IP, Insts, S.getNumIterations()));
+  } else {
+    struct RegionReport {
+      std::string Output;
+      std::string Errors;
+      bool Success = false;
+    };
+    std::vector<RegionReport> Reports(NonEmptyRegions.size());
+    for (unsigned I = 0, E = NonEmptyRegions.size(); I != E; ++I) {
+      raw_string_ostream OS(Reports[I].Output);
+      PrintRegionHeader(*NonEmptyRegions[I], OS);
     }
-
-    if (PrintInstructionInfoView)
-      Printer.addView(std::make_unique<mca::InstructionInfoView>(
-          *STI, *MCII, CE, ShowEncoding, Insts, *IP));
-
-    if (PrintDispatchStats)
-      Printer.addView(std::make_unique<mca::DispatchStatistics>());
-
-    if (PrintSchedulerStats)
-      Printer.addView(std::make_unique<mca::SchedulerStatistics>(*STI));
-
-    if (PrintRetireStats)
-      Printer.addView(std::make_unique<mca::RetireControlUnitStatistics>(SM));
-
-    if (PrintRegisterFileStats)
-      Printer.addView(std::make_unique<mca::RegisterFileStatistics>(*STI));
-
-    if (PrintResourcePressureView)
-      Printer.addView(
-          std::make_unique<mca::ResourcePressureView>(*STI, *IP, Insts));
-
-    if (PrintTimelineView) {
-      unsigned TimelineIterations =
-          TimelineMaxIterations ? TimelineMaxIterations : 10;
-      Printer.addView(std::make_unique<mca::TimelineView>(
-          *STI, *IP, Insts, std::min(TimelineIterations, S.getNumIterations()),
-          TimelineMaxCycles));
+    parallel::for_each_n(
+        parallel::par, size_t(0), NonEmptyRegions.size(), [&](size_t I) {
+          raw_string_ostream OS(Reports[I].Output);
+          raw_string_ostream ErrOS(Reports[I].Errors);
+          Reports[I].Success = Simulator.run(*NonEmptyRegions[I], OS, ErrOS);
+        });
+    // Stop at the first region that failed, like the serial loop does.
+    for (const RegionReport &Report : Reports) {
+      TOF->os() << Report.Output;
+      if (!Report.Success) {
+        errs() << Report.Errors;
+        return 1;
+      }
     }
-
-    if (!runPipeline(*P))
-      return 1;
-
-    Printer.printReport(TOF->os());
-
-    // Clear the InstrBuilder internal state in preparation for another round.
-    IB.clear();
   }
 
   TOF->keep();
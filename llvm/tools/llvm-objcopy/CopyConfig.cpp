@@ -517,6 +517,7 @@ parseObjcopyOptions(ArrayRef<const char *> ArgsArr,
               InputArgs.getLastArgValue(OBJCOPY_compress_debug_sections_eq))
               .Case("zlib-gnu", DebugCompressionType::GNU)
               .Case("zlib", DebugCompressionType::Z)
+              .Case("zstd", DebugCompressionType::Zstd)
               .Default(DebugCompressionType::None);
       if (Config.CompressionType == DebugCompressionType::None)
         return createStringError(
@@ -526,10 +527,16 @@ parseObjcopyOptions(ArrayRef<const char *> ArgsArr,
                 .str()
                 .c_str());
     }
-    if (!zlib::isAvailable())
+    if (Config.CompressionType == DebugCompressionType::Zstd) {
+      if (!zstd::isAvailable())
+        return createStringError(
+            errc::invalid_argument,
+            "LLVM was not compiled with LLVM_ENABLE_ZSTD: can not compress");
+    } else if (!zlib::isAvailable()) {
       return createStringError(
           errc::invalid_argument,
           "LLVM was not compiled with LLVM_ENABLE_ZLIB: can not compress");
+    }
   }
 
   Config.AddGnuDebugLink = InputArgs.getLastArgValue(OBJCOPY_add_gnu_debuglink);
@@ -778,10 +785,11 @@ parseObjcopyOptions(ArrayRef<const char *> ArgsArr,
         "--decompress-debug-sections");
   }
 
-  if (Config.DecompressDebugSections && !zlib::isAvailable())
-    return createStringError(
-        errc::invalid_argument,
-        "LLVM was not compiled with LLVM_ENABLE_ZLIB: cannot decompress");
+  if (Config.DecompressDebugSections && !zlib::isAvailable() &&
+      !zstd::isAvailable())
+    return createStringError(errc::invalid_argument,
+                             "LLVM was not compiled with LLVM_ENABLE_ZLIB or "
+                             "LLVM_ENABLE_ZSTD: cannot decompress");
 
   if (Config.ExtractPartition && Config.ExtractMainPartition)
     return createStringError(errc::invalid_argument,
@@ -422,17 +422,38 @@ getDecompressedSizeAndAlignment(ArrayRef<uint8_t> Data) {
 
 template <class ELFT>
 void ELFSectionWriter<ELFT>::visit(const DecompressedSection &Sec) {
-  const size_t DataOffset = isDataGnuCompressed(Sec.OriginalData)
+  const bool IsGnuCompressed = isDataGnuCompressed(Sec.OriginalData);
+  const size_t DataOffset = IsGnuCompressed
                                 ? (ZlibGnuMagic.size() + sizeof(Sec.Size))
                                 : sizeof(Elf_Chdr_Impl<ELFT>);
+  compression::Format Format = compression::Format::Zlib;
+  if (!IsGnuCompressed) {
+    uint32_t ChType = reinterpret_cast<const Elf_Chdr_Impl<ELFT> *>(
+                          Sec.OriginalData.data())
+                          ->ch_type;
+    if (ChType == ELF::ELFCOMPRESS_ZSTD)
+      Format = compression::Format::Zstd;
+    else if (ChType != ELF::ELFCOMPRESS_ZLIB)
+      reportError(Sec.Name,
+                  createStringError(errc::invalid_argument,
+                                    "unsupported compression type %u",
+                                    ChType));
+  }
+  if (!compression::isAvailable(Format))
+    reportError(Sec.Name,
+                createStringError(errc::invalid_argument,
+                                  "LLVM was not compiled with %s: cannot "
+                                  "decompress",
+                                  compression::getName(Format)));
 
   StringRef CompressedContent(
       reinterpret_cast<const char *>(Sec.OriginalData.data()) + DataOffset,
       Sec.OriginalData.size() - DataOffset);
 
   SmallVector<char, 128> DecompressedContent;
-  if (Error E = zlib::uncompress(CompressedContent, DecompressedContent,
-                                 static_cast<size_t>(Sec.Size)))
+  if (Error E = compression::uncompress(Format, CompressedContent,
+                                        DecompressedContent,
+                                        static_cast<size_t>(Sec.Size)))
     reportError(Sec.Name, std::move(E));
 
   uint8_t *Buf = Out.getBufferStart() + Sec.Offset;
@@ -490,7 +511,9 @@ void ELFSectionWriter<ELFT>::visit(const CompressedSection &Sec) {
     Buf += sizeof(DecompressedSize);
   } else {
     Elf_Chdr_Impl<ELFT> Chdr;
-    Chdr.ch_type = ELF::ELFCOMPRESS_ZLIB;
+    Chdr.ch_type = Sec.CompressionType == DebugCompressionType::Zstd
+                       ? ELF::ELFCOMPRESS_ZSTD
+                       : ELF::ELFCOMPRESS_ZLIB;
     Chdr.ch_size = Sec.DecompressedSize;
     Chdr.ch_addralign = Sec.DecompressedAlign;
     memcpy(Buf, &Chdr, sizeof(Chdr));
@@ -504,7 +527,10 @@ CompressedSection::CompressedSection(const SectionBase &Sec,
                                      DebugCompressionType CompressionType)
     : SectionBase(Sec), CompressionType(CompressionType),
       DecompressedSize(Sec.OriginalData.size()), DecompressedAlign(Sec.Align) {
-  if (Error E = zlib::compress(
+  if (Error E = compression::compress(
+          CompressionType == DebugCompressionType::Zstd
+              ? compression::Format::Zstd
+              : compression::Format::Zlib,
           StringRef(reinterpret_cast<const char *>(OriginalData.data()),
                     OriginalData.size()),
           CompressedData))
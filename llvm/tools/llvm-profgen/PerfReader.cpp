@@ -0,0 +1,155 @@
+//===-- PerfReader.cpp - perfscript reader ----------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "PerfReader.h"
+#include "ErrorHandling.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/LineIterator.h"
+#include "llvm/Support/Parallel.h"
+#include "llvm/Support/Path.h"
+
+using namespace llvm;
+using namespace sampleprof;
+
+// Number of sample lines aggregated by one parallel task.
+static const size_t SamplesPerTask = 4096;
+
+static bool parseHexAddress(StringRef Str, uint64_t &Address) {
+  Str.consume_front("0x");
+  return !Str.empty() && !Str.getAsInteger(16, Address);
+}
+
+// Parse one "FROM/TO/PREDICTED/IN_TX/ABORT/CYCLES" branch stack entry.
+static bool parseLBREntry(StringRef Token, uint64_t &Source,
+                          uint64_t &Target) {
+  StringRef SourceStr, TargetStr;
+  std::tie(SourceStr, Token) = Token.split('/');
+  std::tie(TargetStr, Token) = Token.split('/');
+  return parseHexAddress(SourceStr, Source) &&
+         parseHexAddress(TargetStr, Target);
+}
+
+void PerfReader::parseMMap2Event(StringRef Line, int64_t &Bias) {
+  // The event is printed as
+  //   PERF_RECORD_MMAP2 PID/TID: [START(SIZE) @ PGOFF DEV INO GEN]: PROT PATH
+  StringRef Event = Line.substr(Line.find("PERF_RECORD_MMAP2"));
+  StringRef Desc = Event.substr(Event.find('[') + 1);
+  StringRef Tail;
+  std::tie(Desc, Tail) = Desc.split("]:");
+
+  StringRef Prot, Path;
+  std::tie(Prot, Path) = Tail.trim().split(' ');
+  if (sys::path::filename(Path.trim()) != Binary.getName())
+    return;
+  // Only the executable mapping of the binary matters for code addresses.
+  if (Prot.size() < 3 || Prot[2] != 'x')
+    return;
+
+  StringRef StartStr = Desc.substr(0, Desc.find('('));
+  StringRef PageOffsetStr =
+      Desc.substr(Desc.find('@') + 1).trim().split(' ').first;
+  uint64_t Start, PageOffset;
+  if (StartStr.getAsInteger(0, Start) ||
+      PageOffsetStr.getAsInteger(0, PageOffset)) {
+    emitWarning("malformed mmap event: " + Line.trim());
+    return;
+  }
+
+  uint64_t LinkAddress;
+  if (!Binary.getLinkAddressForOffset(PageOffset, LinkAddress)) {
+    emitWarning("mmap event does not match any executable segment: " +
+                Line.trim());
+    return;
+  }
+  Bias = LinkAddress - Start;
+}
+
+void PerfReader::collectSampleLines(StringRef TraceFile) {
+  auto BufferOrErr = MemoryBuffer::getFileOrSTDIN(TraceFile);
+  if (std::error_code EC = BufferOrErr.getError())
+    exitWithError(EC, TraceFile);
+  TraceBuffers.push_back(std::move(*BufferOrErr));
+
+  // Without mmap events the addresses are taken to be link time addresses,
+  // which is the case for non-PIE executables.
+  int64_t Bias = 0;
+  for (line_iterator LineIt(*TraceBuffers.back(), /*SkipBlanks=*/true);
+       !LineIt.is_at_eof(); ++LineIt) {
+    StringRef Line = *LineIt;
+    if (Line.contains("PERF_RECORD_MMAP2"))
+      parseMMap2Event(Line, Bias);
+    else if (Line.contains('/'))
+      SampleLines.push_back({Line, Bias});
+  }
+}
+
+void PerfReader::aggregateSamples() {
+  struct TaskCounters {
+    RangeSample Ranges;
+    BranchSample Branches;
+    uint64_t NumSamples = 0;
+  };
+
+  size_t NumTasks = (SampleLines.size() + SamplesPerTask - 1) / SamplesPerTask;
+  std::vector<TaskCounters> Tasks(NumTasks);
+
+  // Samples are independent of each other, so chunks of them are aggregated
+  // in parallel into private counters. Since the counters are only ever
+  // summed, merging them afterwards gives the same result as a serial run.
+  parallel::for_each_n(parallel::par, size_t(0), NumTasks, [&](size_t TaskNo) {
+    TaskCounters &Counters = Tasks[TaskNo];
+    size_t Begin = TaskNo * SamplesPerTask;
+    size_t End = std::min(Begin + SamplesPerTask, SampleLines.size());
+    SmallVector<StringRef, 32> Tokens;
+    SmallVector<std::pair<uint64_t, uint64_t>, 32> LBRStack;
+    for (size_t I = Begin; I != End; ++I) {
+      const SampleLine &Sample = SampleLines[I];
+      Tokens.clear();
+      LBRStack.clear();
+      Sample.Line.split(Tokens, ' ', /*MaxSplit=*/-1, /*KeepEmpty=*/false);
+      for (StringRef Token : Tokens) {
+        uint64_t Source, Target;
+        if (parseLBREntry(Token.trim(), Source, Target))
+          LBRStack.emplace_back(Source + Sample.Bias, Target + Sample.Bias);
+      }
+      if (LBRStack.empty())
+        continue;
+      ++Counters.NumSamples;
+
+      for (size_t J = 0, E = LBRStack.size(); J != E; ++J) {
+        uint64_t Source = LBRStack[J].first;
+        if (Binary.addressIsCode(Source))
+          ++Counters.Branches[LBRStack[J]];
+        // The entries are most recent first, so the range executed before
+        // this branch starts at the target of the next older one.
+        if (J + 1 == E)
+          continue;
+        uint64_t RangeStart = LBRStack[J + 1].second;
+        if (RangeStart <= Source && Binary.addressIsCode(RangeStart) &&
+            Binary.addressIsCode(Source))
+          ++Counters.Ranges[{RangeStart, Source}];
+      }
+    }
+  });
+
+  for (TaskCounters &Counters : Tasks) {
+    for (const auto &Range : Counters.Ranges)
+      RangeCounter[Range.first] += Range.second;
+    for (const auto &Branch : Counters.Branches)
+      BranchCounter[Branch.first] += Branch.second;
+    NumSamples += Counters.NumSamples;
+  }
+}
+
+void PerfReader::parsePerfTraces(ArrayRef<std::string> PerfTraceFilenames) {
+  for (const std::string &Filename : PerfTraceFilenames)
+    collectSampleLines(Filename);
+  aggregateSamples();
+  SampleLines.clear();
+  TraceBuffers.clear();
+}
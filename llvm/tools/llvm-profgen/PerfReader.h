@@ -0,0 +1,74 @@
+//===-- PerfReader.h - perfscript reader ------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_TOOLS_LLVM_PROFGEN_PERFREADER_H
+#define LLVM_TOOLS_LLVM_PROFGEN_PERFREADER_H
+
+#include "ProfiledBinary.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace llvm {
+namespace sampleprof {
+
+/// Execution counts of address ranges, keyed by the link time addresses of
+/// the first and last instruction of the range (both inclusive).
+using RangeSample = std::map<std::pair<uint64_t, uint64_t>, uint64_t>;
+/// Taken counts of branches, keyed by link time (source, target) addresses.
+using BranchSample = std::map<std::pair<uint64_t, uint64_t>, uint64_t>;
+
+/// Reads the text output of `perf script -F ip,brstack` (optionally with
+/// `--show-mmap-events`) and aggregates the last branch records of all samples
+/// into range and branch counters for one profiled binary.
+///
+/// Every LBR sample lists the taken branches most recent first. Between the
+/// target of one branch and the source of the next one execution fell through
+/// sequentially, which is where the range counts come from.
+class PerfReader {
+  ProfiledBinary &Binary;
+
+  RangeSample RangeCounter;
+  BranchSample BranchCounter;
+
+  std::vector<std::unique_ptr<MemoryBuffer>> TraceBuffers;
+
+  /// One LBR sample line together with the address bias that was in effect
+  /// for the binary when it was recorded.
+  struct SampleLine {
+    StringRef Line;
+    int64_t Bias;
+  };
+  std::vector<SampleLine> SampleLines;
+
+  uint64_t NumSamples = 0;
+
+  void parseMMap2Event(StringRef Line, int64_t &Bias);
+  void collectSampleLines(StringRef TraceFile);
+  void aggregateSamples();
+
+public:
+  explicit PerfReader(ProfiledBinary &Binary) : Binary(Binary) {}
+
+  /// Read and aggregate all the given perf script files.
+  void parsePerfTraces(ArrayRef<std::string> PerfTraceFilenames);
+
+  const RangeSample &getRangeCounter() const { return RangeCounter; }
+  const BranchSample &getBranchCounter() const { return BranchCounter; }
+  uint64_t getNumSamples() const { return NumSamples; }
+};
+
+} // end namespace sampleprof
+} // end namespace llvm
+
+#endif
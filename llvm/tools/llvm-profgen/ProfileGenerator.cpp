@@ -0,0 +1,150 @@
+//===-- ProfileGenerator.cpp - Profile Generator ----------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "ProfileGenerator.h"
+#include "ErrorHandling.h"
+#include "llvm/ProfileData/SampleProfWriter.h"
+#include "llvm/Support/Parallel.h"
+
+using namespace llvm;
+using namespace sampleprof;
+
+FunctionSamples &ProfileGenerator::getTopLevelProfile(StringRef FuncName) {
+  auto Ret = ProfileMap.try_emplace(FuncName);
+  if (Ret.second)
+    Ret.first->second.setName(Ret.first->getKey());
+  return Ret.first->second;
+}
+
+FunctionSamples &
+ProfileGenerator::getLeafProfile(const FrameLocationStack &Stack) {
+  assert(!Stack.empty() && "Expected at least one frame");
+  FunctionSamples *FProfile = &getTopLevelProfile(Stack.front().FuncName);
+  for (size_t I = 1, E = Stack.size(); I != E; ++I) {
+    FunctionSamplesMap &Callees =
+        FProfile->functionSamplesAt(Stack[I - 1].Location);
+    auto Ret = Callees.emplace(Stack[I].FuncName, FunctionSamples());
+    FProfile = &Ret.first->second;
+    if (Ret.second)
+      FProfile->setName(Ret.first->first);
+  }
+  return *FProfile;
+}
+
+void ProfileGenerator::populateBodySamples(const RangeSample &RangeCounter) {
+  // Group the ranges by the function containing them, dropping the few that
+  // cross a function boundary. The functions are then independent regions
+  // whose instruction counts can be computed in parallel.
+  using RangeList = std::vector<const RangeSample::value_type *>;
+  std::map<uint64_t, RangeList> RangesByFunc;
+  for (const auto &Range : RangeCounter) {
+    uint64_t FuncStart = Binary.getFuncStartForAddr(Range.first.first);
+    if (!FuncStart ||
+        FuncStart != Binary.getFuncStartForAddr(Range.first.second))
+      continue;
+    RangesByFunc[FuncStart].push_back(&Range);
+  }
+
+  using InstCounts = std::map<uint64_t, uint64_t>;
+  std::vector<const RangeList *> Regions;
+  for (const auto &Func : RangesByFunc)
+    Regions.push_back(&Func.second);
+  std::vector<InstCounts> RegionCounts(Regions.size());
+
+  ArrayRef<uint64_t> CodeAddrs = Binary.getCodeAddrs();
+  parallel::for_each_n(
+      parallel::par, size_t(0), Regions.size(), [&](size_t RegionNo) {
+        InstCounts &Counts = RegionCounts[RegionNo];
+        for (const RangeSample::value_type *Range : *Regions[RegionNo]) {
+          uint64_t Start = Range->first.first;
+          uint64_t End = Range->first.second;
+          for (auto It = llvm::lower_bound(CodeAddrs, Start);
+               It != CodeAddrs.end() && *It <= End; ++It)
+            Counts[*It] += Range->second;
+        }
+      });
+
+  // Several instructions usually share a source location. The location was
+  // executed as often as its most frequently executed instruction, so take the
+  // maximum rather than the sum. The symbolizer is not thread safe, so this
+  // part runs serially.
+  std::map<std::pair<FunctionSamples *, LineLocation>, uint64_t> LocationCounts;
+  for (const InstCounts &Counts : RegionCounts) {
+    for (const auto &InstCount : Counts) {
+      const FrameLocationStack &Stack =
+          Binary.getFrameLocationStack(InstCount.first);
+      if (Stack.empty())
+        continue;
+      FunctionSamples &FProfile = getLeafProfile(Stack);
+      uint64_t &Count = LocationCounts[{&FProfile, Stack.back().Location}];
+      Count = std::max(Count, InstCount.second);
+    }
+  }
+
+  for (const auto &LocationCount : LocationCounts) {
+    const LineLocation &Loc = LocationCount.first.second;
+    LocationCount.first.first->addBodySamples(Loc.LineOffset,
+                                              Loc.Discriminator,
+                                              LocationCount.second);
+  }
+}
+
+void ProfileGenerator::populateCallSamples(const BranchSample &BranchCounter) {
+  for (const auto &Branch : BranchCounter) {
+    uint64_t Source = Branch.first.first;
+    uint64_t Target = Branch.first.second;
+    uint64_t Count = Branch.second;
+    if (!Binary.addressIsCall(Source))
+      continue;
+    StringRef CalleeName = Binary.getFuncNameForStartAddr(Target);
+    if (CalleeName.empty())
+      continue;
+    const FrameLocationStack &Stack = Binary.getFrameLocationStack(Source);
+    if (Stack.empty())
+      continue;
+
+    const LineLocation &Loc = Stack.back().Location;
+    getLeafProfile(Stack).addCalledTargetSamples(
+        Loc.LineOffset, Loc.Discriminator, CalleeName, Count);
+    // Every taken call enters the outlined copy of the callee.
+    getTopLevelProfile(CalleeName).addHeadSamples(Count);
+  }
+}
+
+// The total of a profile covers its own body samples and all of its inlinees.
+static uint64_t updateTotalSamples(FunctionSamples &FProfile) {
+  uint64_t Total = 0;
+  for (const auto &BodySample : FProfile.getBodySamples())
+    Total += BodySample.second.getSamples();
+  for (const auto &CallsiteSamples : FProfile.getCallsiteSamples())
+    for (auto &Callee : FProfile.functionSamplesAt(CallsiteSamples.first))
+      Total += updateTotalSamples(Callee.second);
+  FProfile.addTotalSamples(Total);
+  return Total;
+}
+
+void ProfileGenerator::populateTotalSamples() {
+  for (auto &FProfile : ProfileMap)
+    updateTotalSamples(FProfile.second);
+}
+
+void ProfileGenerator::generateProfile(const PerfReader &Reader) {
+  populateBodySamples(Reader.getRangeCounter());
+  populateCallSamples(Reader.getBranchCounter());
+  populateTotalSamples();
+}
+
+void ProfileGenerator::write(StringRef OutputFilename,
+                             SampleProfileFormat Format) {
+  auto WriterOrErr = SampleProfileWriter::create(OutputFilename, Format);
+  if (std::error_code EC = WriterOrErr.getError())
+    exitWithError(EC, OutputFilename);
+  std::unique_ptr<SampleProfileWriter> Writer = std::move(WriterOrErr.get());
+  if (std::error_code EC = Writer->write(ProfileMap))
+    exitWithError(EC, OutputFilename);
+}
@@ -0,0 +1,46 @@
+//===-- ProfileGenerator.h - Profile Generator ------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_TOOLS_LLVM_PROFGEN_PROFILEGENERATOR_H
+#define LLVM_TOOLS_LLVM_PROFGEN_PROFILEGENERATOR_H
+
+#include "PerfReader.h"
+#include "ProfiledBinary.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ProfileData/SampleProf.h"
+
+namespace llvm {
+namespace sampleprof {
+
+/// Turns the aggregated range and branch counters of a PerfReader into line
+/// based sample profiles. Inlined code is attributed to nested callsite
+/// profiles following the inline context recorded in the debug info.
+class ProfileGenerator {
+  const ProfiledBinary &Binary;
+  StringMap<FunctionSamples> ProfileMap;
+
+  FunctionSamples &getTopLevelProfile(StringRef FuncName);
+  FunctionSamples &getLeafProfile(const FrameLocationStack &Stack);
+
+  void populateBodySamples(const RangeSample &RangeCounter);
+  void populateCallSamples(const BranchSample &BranchCounter);
+  void populateTotalSamples();
+
+public:
+  explicit ProfileGenerator(const ProfiledBinary &Binary) : Binary(Binary) {}
+
+  void generateProfile(const PerfReader &Reader);
+  void write(StringRef OutputFilename, SampleProfileFormat Format);
+
+  const StringMap<FunctionSamples> &getProfiles() const { return ProfileMap; }
+};
+
+} // end namespace sampleprof
+} // end namespace llvm
+
+#endif
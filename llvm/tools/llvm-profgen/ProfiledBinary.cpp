@@ -0,0 +1,239 @@
+//===-- ProfiledBinary.cpp - Binary decoder ---------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "ProfiledBinary.h"
+#include "ErrorHandling.h"
+#include "llvm/MC/MCInst.h"
+#include "llvm/MC/MCTargetOptions.h"
+#include "llvm/MC/SubtargetFeature.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/TargetRegistry.h"
+
+using namespace llvm;
+using namespace sampleprof;
+
+static cl::opt<std::string> MCPU("mcpu", cl::init(""),
+                                 cl::desc("Target CPU of the profiled binary, "
+                                          "used for disassembly"));
+
+static const Target *getTarget(const object::ObjectFile *Obj) {
+  Triple TheTriple = Obj->makeTriple();
+  std::string Error;
+  std::string ArchName;
+  const Target *TheTarget =
+      TargetRegistry::lookupTarget(ArchName, TheTriple, Error);
+  if (!TheTarget)
+    exitWithError(Error, Obj->getFileName());
+  return TheTarget;
+}
+
+template <class ELFT>
+static void
+collectExecSegments(const object::ELFFile<ELFT> *Obj, StringRef FileName,
+                    std::vector<std::pair<uint64_t, uint64_t>> &Segments) {
+  auto PhdrRangeOrErr = Obj->program_headers();
+  if (!PhdrRangeOrErr)
+    exitWithError(PhdrRangeOrErr.takeError(), FileName);
+  for (const typename ELFT::Phdr &Phdr : *PhdrRangeOrErr)
+    if (Phdr.p_type == ELF::PT_LOAD && (Phdr.p_flags & ELF::PF_X))
+      Segments.emplace_back(Phdr.p_offset, Phdr.p_vaddr);
+}
+
+ProfiledBinary::ProfiledBinary(StringRef Path) : Path(Path.str()) {
+  Binary = unwrapOrError(object::createBinary(Path), Path);
+  Obj = dyn_cast<object::ELFObjectFileBase>(Binary.getBinary());
+  if (!Obj)
+    exitWithError("not a valid ELF image", Path);
+  TripleName = Obj->makeTriple().getTriple();
+
+  // Profiles are keyed by linkage names, so keep the symbolizer from
+  // demangling them.
+  symbolize::LLVMSymbolizer::Options SymbolizerOpts;
+  SymbolizerOpts.PrintFunctions = symbolize::FunctionNameKind::LinkageName;
+  SymbolizerOpts.Demangle = false;
+  Symbolizer = std::make_unique<symbolize::LLVMSymbolizer>(SymbolizerOpts);
+
+  setPreferredBaseAddress();
+  setUpDisassembler();
+  loadFunctionSymbols();
+  disassemble();
+}
+
+StringRef ProfiledBinary::getName() const {
+  return sys::path::filename(Path);
+}
+
+void ProfiledBinary::setPreferredBaseAddress() {
+  if (const auto *ELFObj = dyn_cast<object::ELF32LEObjectFile>(Obj))
+    collectExecSegments(ELFObj->getELFFile(), Path, ExecSegments);
+  else if (const auto *ELFObj = dyn_cast<object::ELF32BEObjectFile>(Obj))
+    collectExecSegments(ELFObj->getELFFile(), Path, ExecSegments);
+  else if (const auto *ELFObj = dyn_cast<object::ELF64LEObjectFile>(Obj))
+    collectExecSegments(ELFObj->getELFFile(), Path, ExecSegments);
+  else if (const auto *ELFObj = cast<object::ELF64BEObjectFile>(Obj))
+    collectExecSegments(ELFObj->getELFFile(), Path, ExecSegments);
+
+  if (ExecSegments.empty())
+    exitWithError("no executable segment found", Path);
+  PreferredBaseAddress = ExecSegments.front().second;
+}
+
+bool ProfiledBinary::getLinkAddressForOffset(uint64_t PageOffset,
+                                             uint64_t &Address) const {
+  // The kernel maps whole pages, so the mmap offset of a segment is its file
+  // offset rounded down to the page size. Pick the last segment starting at
+  // or before the page offset.
+  const std::pair<uint64_t, uint64_t> *Found = nullptr;
+  for (const auto &Segment : ExecSegments) {
+    uint64_t PageAlignedOffset = Segment.first & ~uint64_t(0xfff);
+    if (PageAlignedOffset <= PageOffset)
+      Found = &Segment;
+  }
+  if (!Found)
+    return false;
+  Address = Found->second - (Found->first - PageOffset);
+  return true;
+}
+
+void ProfiledBinary::setUpDisassembler() {
+  const Target *TheTarget = getTarget(Obj);
+  SubtargetFeatures Features = Obj->getFeatures();
+
+  MRI.reset(TheTarget->createMCRegInfo(TripleName));
+  if (!MRI)
+    exitWithError("no register info for target " + TripleName, Path);
+
+  MCTargetOptions MCOptions;
+  AsmInfo.reset(TheTarget->createMCAsmInfo(*MRI, TripleName, MCOptions));
+  if (!AsmInfo)
+    exitWithError("no assembly info for target " + TripleName, Path);
+
+  STI.reset(
+      TheTarget->createMCSubtargetInfo(TripleName, MCPU, Features.getString()));
+  if (!STI)
+    exitWithError("no subtarget info for target " + TripleName, Path);
+
+  MII.reset(TheTarget->createMCInstrInfo());
+  if (!MII)
+    exitWithError("no instruction info for target " + TripleName, Path);
+
+  MOFI = std::make_unique<MCObjectFileInfo>();
+  Ctx = std::make_unique<MCContext>(AsmInfo.get(), MRI.get(), MOFI.get());
+  MOFI->InitMCObjectFileInfo(Triple(TripleName), false, *Ctx);
+
+  DisAsm.reset(TheTarget->createMCDisassembler(*STI, *Ctx));
+  if (!DisAsm)
+    exitWithError("no disassembler for target " + TripleName, Path);
+}
+
+void ProfiledBinary::loadFunctionSymbols() {
+  for (const object::ELFSymbolRef &Symbol : Obj->symbols()) {
+    object::SymbolRef::Type Type = unwrapOrError(Symbol.getType(), Path);
+    if (Type != object::SymbolRef::ST_Function)
+      continue;
+    uint64_t Start = unwrapOrError(Symbol.getAddress(), Path);
+    uint64_t Size = Symbol.getSize();
+    StringRef Name = unwrapOrError(Symbol.getName(), Path);
+    if (!Start || Name.empty())
+      continue;
+    // Keep the first name seen for aliased functions, and the largest extent.
+    auto Ret =
+        FuncRanges.emplace(Start, std::make_pair(Start + Size, Name.str()));
+    if (!Ret.second && Ret.first->second.first < Start + Size)
+      Ret.first->second.first = Start + Size;
+  }
+}
+
+void ProfiledBinary::disassemble() {
+  for (const object::SectionRef &Section : Obj->sections()) {
+    if (!Section.isText() || Section.isVirtual() || !Section.getSize())
+      continue;
+
+    uint64_t SectionAddress = Section.getAddress();
+    StringRef Contents = unwrapOrError(Section.getContents(), Path);
+    ArrayRef<uint8_t> Bytes(
+        reinterpret_cast<const uint8_t *>(Contents.data()), Contents.size());
+
+    uint64_t Offset = 0;
+    while (Offset < Bytes.size()) {
+      MCInst Inst;
+      uint64_t Size;
+      bool Disassembled =
+          DisAsm->getInstruction(Inst, Size, Bytes.slice(Offset),
+                                 SectionAddress + Offset,
+                                 nulls()) == MCDisassembler::Success;
+      if (!Disassembled || !Size) {
+        // Skip over padding and data the disassembler does not understand,
+        // one unit of the minimal instruction size at a time.
+        Offset += std::max(AsmInfo->getMinInstAlignment(), 1u);
+        continue;
+      }
+
+      uint64_t Address = SectionAddress + Offset;
+      CodeAddrs.push_back(Address);
+      if (MII->get(Inst.getOpcode()).isCall())
+        CallAddrs.insert(Address);
+      Offset += Size;
+    }
+  }
+  llvm::sort(CodeAddrs);
+}
+
+bool ProfiledBinary::addressIsCode(uint64_t Address) const {
+  return std::binary_search(CodeAddrs.begin(), CodeAddrs.end(), Address);
+}
+
+uint64_t ProfiledBinary::getFuncStartForAddr(uint64_t Address) const {
+  auto It = FuncRanges.upper_bound(Address);
+  if (It == FuncRanges.begin())
+    return 0;
+  --It;
+  if (Address >= It->second.first)
+    return 0;
+  return It->first;
+}
+
+StringRef ProfiledBinary::getFuncNameForStartAddr(uint64_t Address) const {
+  auto It = FuncRanges.find(Address);
+  if (It == FuncRanges.end())
+    return StringRef();
+  return It->second.second;
+}
+
+const FrameLocationStack &
+ProfiledBinary::getFrameLocationStack(uint64_t Address) const {
+  auto Ret = FrameStackCache.try_emplace(Address);
+  FrameLocationStack &Stack = Ret.first->second;
+  if (!Ret.second)
+    return Stack;
+
+  Expected<DIInliningInfo> InlineStackOrErr = Symbolizer->symbolizeInlinedCode(
+      Path, {Address, object::SectionedAddress::UndefSection});
+  if (!InlineStackOrErr) {
+    consumeError(InlineStackOrErr.takeError());
+    return Stack;
+  }
+
+  // The symbolizer reports the innermost frame first; profiles nest the other
+  // way around.
+  const DIInliningInfo &InlineStack = *InlineStackOrErr;
+  for (int I = InlineStack.getNumberOfFrames() - 1; I >= 0; --I) {
+    const DILineInfo &Frame = InlineStack.getFrame(I);
+    if (Frame.FunctionName == DILineInfo::BadString) {
+      Stack.clear();
+      break;
+    }
+    // Line offsets are relative to the start of the function and truncated to
+    // 16 bits, as in FunctionSamples::getOffset.
+    LineLocation Location((Frame.Line - Frame.StartLine) & 0xffff,
+                          Frame.Discriminator);
+    Stack.emplace_back(Frame.FunctionName, Location);
+  }
+  return Stack;
+}
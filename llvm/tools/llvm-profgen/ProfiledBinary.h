@@ -0,0 +1,120 @@
+//===-- ProfiledBinary.h - Binary decoder -----------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_TOOLS_LLVM_PROFGEN_PROFILEDBINARY_H
+#define LLVM_TOOLS_LLVM_PROFGEN_PROFILEDBINARY_H
+
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/DebugInfo/Symbolize/Symbolize.h"
+#include "llvm/MC/MCAsmInfo.h"
+#include "llvm/MC/MCContext.h"
+#include "llvm/MC/MCDisassembler/MCDisassembler.h"
+#include "llvm/MC/MCInstrInfo.h"
+#include "llvm/MC/MCObjectFileInfo.h"
+#include "llvm/MC/MCRegisterInfo.h"
+#include "llvm/MC/MCSubtargetInfo.h"
+#include "llvm/Object/ELFObjectFile.h"
+#include "llvm/ProfileData/SampleProf.h"
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace llvm {
+namespace sampleprof {
+
+/// A source location inside one frame of an (inlined) call stack. For all but
+/// the innermost frame this is the location of the call site of the next
+/// frame.
+struct FrameLocation {
+  std::string FuncName;
+  LineLocation Location;
+
+  FrameLocation(std::string FuncName, LineLocation Location)
+      : FuncName(std::move(FuncName)), Location(Location) {}
+};
+
+/// The inline context of an instruction, outermost frame first.
+using FrameLocationStack = std::vector<FrameLocation>;
+
+/// A binary loaded for profile generation. It knows the address of every
+/// instruction in the executable sections, which of them are calls, the
+/// extent of every function symbol and how to map an address to its inline
+/// context through the debug info.
+class ProfiledBinary {
+  std::string Path;
+  object::OwningBinary<object::Binary> Binary;
+  const object::ELFObjectFileBase *Obj = nullptr;
+  std::string TripleName;
+
+  // The virtual address the first executable segment is linked at. Runtime
+  // addresses are rebased against it using the mmap events of the trace.
+  uint64_t PreferredBaseAddress = 0;
+  // Executable PT_LOAD segments as (file offset, virtual address) pairs, used
+  // to translate mmap page offsets into link time addresses.
+  std::vector<std::pair<uint64_t, uint64_t>> ExecSegments;
+
+  // Sorted addresses of all decoded instructions.
+  std::vector<uint64_t> CodeAddrs;
+  // Addresses of the decoded call instructions.
+  DenseSet<uint64_t> CallAddrs;
+  // Function symbols keyed by start address, mapped to (end address, name).
+  std::map<uint64_t, std::pair<uint64_t, std::string>> FuncRanges;
+
+  // The symbolizer is not thread safe, so inline contexts are computed and
+  // cached serially before any parallel consumer looks at them.
+  std::unique_ptr<symbolize::LLVMSymbolizer> Symbolizer;
+  mutable std::unordered_map<uint64_t, FrameLocationStack> FrameStackCache;
+
+  std::unique_ptr<const MCRegisterInfo> MRI;
+  std::unique_ptr<const MCAsmInfo> AsmInfo;
+  std::unique_ptr<const MCSubtargetInfo> STI;
+  std::unique_ptr<const MCInstrInfo> MII;
+  std::unique_ptr<MCObjectFileInfo> MOFI;
+  std::unique_ptr<MCContext> Ctx;
+  std::unique_ptr<MCDisassembler> DisAsm;
+
+  void setPreferredBaseAddress();
+  void setUpDisassembler();
+  void loadFunctionSymbols();
+  void disassemble();
+
+public:
+  explicit ProfiledBinary(StringRef Path);
+
+  StringRef getPath() const { return Path; }
+  StringRef getName() const;
+  uint64_t getPreferredBaseAddress() const { return PreferredBaseAddress; }
+
+  /// Translate the file page offset of an executable mapping into the virtual
+  /// address it is linked at, or return false if no segment covers it.
+  bool getLinkAddressForOffset(uint64_t PageOffset, uint64_t &Address) const;
+
+  /// Return the sorted addresses of all decoded instructions.
+  ArrayRef<uint64_t> getCodeAddrs() const { return CodeAddrs; }
+  bool addressIsCode(uint64_t Address) const;
+  bool addressIsCall(uint64_t Address) const {
+    return CallAddrs.count(Address);
+  }
+
+  /// Return the start address of the function containing \p Address, or 0.
+  uint64_t getFuncStartForAddr(uint64_t Address) const;
+  /// Return the name of the function starting exactly at \p Address, if any.
+  StringRef getFuncNameForStartAddr(uint64_t Address) const;
+
+  /// Return the inline context of the instruction at \p Address, outermost
+  /// frame first. The result is empty if there is no debug info for it.
+  const FrameLocationStack &getFrameLocationStack(uint64_t Address) const;
+};
+
+} // end namespace sampleprof
+} // end namespace llvm
+
+#endif
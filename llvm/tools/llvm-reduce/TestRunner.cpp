@@ -16,7 +16,9 @@ TestRunner::TestRunner(StringRef TestName, const std::vector<std::string> &TestA
 
 /// Runs the interestingness test, passes file to be tested as first argument
 /// and other specified test arguments after that.
-int TestRunner::run(StringRef Filename) {
+int TestRunner::run(StringRef Filename) { return wait(start(Filename)); }
+
+sys::ProcessInfo TestRunner::start(StringRef Filename) {
   std::vector<StringRef> ProgramArgs;
   ProgramArgs.push_back(TestName);
 
@@ -26,11 +28,28 @@ int TestRunner::run(StringRef Filename) {
   ProgramArgs.push_back(Filename);
 
   std::string ErrMsg;
-  int Result = sys::ExecuteAndWait(
-      TestName, ProgramArgs, /*Env=*/None, /*Redirects=*/None,
-      /*SecondsToWait=*/0, /*MemoryLimit=*/0, &ErrMsg);
+  bool ExecutionFailed;
+  sys::ProcessInfo PI =
+      sys::ExecuteNoWait(TestName, ProgramArgs, /*Env=*/None, /*Redirects=*/{},
+                         /*MemoryLimit=*/0, &ErrMsg, &ExecutionFailed);
+
+  if (ExecutionFailed) {
+    Error E = make_error<StringError>("Error running interesting-ness test: " +
+                                          ErrMsg,
+                                      inconvertibleErrorCode());
+    errs() << toString(std::move(E));
+    exit(1);
+  }
+
+  return PI;
+}
+
+int TestRunner::wait(const sys::ProcessInfo &PI) {
+  std::string ErrMsg;
+  sys::ProcessInfo Result = sys::Wait(PI, /*SecondsToWait=*/0,
+                                      /*WaitUntilTerminates=*/true, &ErrMsg);
 
-  if (Result < 0) {
+  if (Result.ReturnCode < 0) {
     Error E = make_error<StringError>("Error running interesting-ness test: " +
                                           ErrMsg,
                                       inconvertibleErrorCode());
@@ -38,5 +57,5 @@ int TestRunner::run(StringRef Filename) {
     exit(1);
   }
 
-  return !Result;
+  return !Result.ReturnCode;
 }
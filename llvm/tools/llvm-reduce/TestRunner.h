@@ -30,6 +30,14 @@ public:
   /// @returns 0 if test was successful, 1 if otherwise
   int run(StringRef Filename);
 
+  /// Starts the interesting-ness test for the specified file in a subprocess
+  /// without waiting for it to finish, so that several tests can run at once.
+  sys::ProcessInfo start(StringRef Filename);
+
+  /// Waits for a test started with start() to finish
+  /// @returns 1 if the file was interesting, 0 if otherwise
+  int wait(const sys::ProcessInfo &PI);
+
   /// Returns the most reduced version of the original testcase
   Module *getProgram() const { return Program.get(); }
 
@@ -14,6 +14,7 @@
 
 #include "Delta.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Transforms/Utils/Cloning.h"
 #include <fstream>
@@ -21,8 +22,13 @@
 
 using namespace llvm;
 
-bool IsReduced(Module &M, TestRunner &Test, SmallString<128> &CurrentFilepath) {
-  // Write Module to tmp file
+static cl::opt<unsigned> NumJobs(
+    "j", cl::init(1),
+    cl::desc("Number of interesting-ness tests to run at the same time"));
+
+/// Writes the Module to a new temporary file, whose name is returned in
+/// CurrentFilepath.
+static void writeTemporaryFile(Module &M, SmallString<128> &CurrentFilepath) {
   int FD;
   std::error_code EC =
       sys::fs::createTemporaryFile("llvm-reduce", "ll", FD, CurrentFilepath);
@@ -38,6 +44,11 @@ bool IsReduced(Module &M, TestRunner &Test, SmallString<128> &CurrentFilepath) {
     errs() << "Error emitting bitcode to file '" << CurrentFilepath << "'!\n";
     exit(1);
   }
+}
+
+bool IsReduced(Module &M, TestRunner &Test, SmallString<128> &CurrentFilepath) {
+  // Write Module to tmp file
+  writeTemporaryFile(M, CurrentFilepath);
 
   // Current Chunks aren't interesting
   return Test.run(CurrentFilepath);
@@ -116,37 +127,65 @@ void llvm::runDeltaPass(
 
   do {
     UninterestingChunks = {};
-    for (int I = Chunks.size() - 1; I >= 0; --I) {
-      std::vector<Chunk> CurrentChunks;
-
-      for (auto C : Chunks)
-        if (!UninterestingChunks.count(C) && C != Chunks[I])
-          CurrentChunks.push_back(C);
-
-      if (CurrentChunks.empty())
-        continue;
-
-      // Clone module before hacking it up..
-      std::unique_ptr<Module> Clone = CloneModule(*Test.getProgram());
-      // Generate Module with only Targets inside Current Chunks
-      ExtractChunksFromModule(CurrentChunks, Clone.get());
-
-      errs() << "Ignoring: ";
-      Chunks[I].print();
-      for (auto C : UninterestingChunks)
-        C.print();
-
-
-
-      SmallString<128> CurrentFilepath;
-      if (!IsReduced(*Clone, Test, CurrentFilepath)) {
-        errs() << "\n";
-        continue;
+    for (int I = Chunks.size() - 1; I >= 0;) {
+      // Test up to NumJobs chunks at once, each on the assumption that none
+      // of the chunks before it in this batch can be removed. Only the first
+      // chunk that turns out to be removable is removed, and the batch ends
+      // there, so the result is the same as testing the chunks one by one.
+      struct Candidate {
+        int Index;
+        std::unique_ptr<Module> Clone;
+        SmallString<128> Filepath;
+        sys::ProcessInfo Process;
+      };
+      std::vector<Candidate> Batch;
+      for (; I >= 0 && Batch.size() < std::max(NumJobs.getValue(), 1u); --I) {
+        std::vector<Chunk> CurrentChunks;
+
+        for (auto C : Chunks)
+          if (!UninterestingChunks.count(C) && C != Chunks[I])
+            CurrentChunks.push_back(C);
+
+        if (CurrentChunks.empty())
+          continue;
+
+        // Clone module before hacking it up..
+        Batch.push_back(Candidate());
+        Candidate &Cand = Batch.back();
+        Cand.Index = I;
+        Cand.Clone = CloneModule(*Test.getProgram());
+        // Generate Module with only Targets inside Current Chunks
+        ExtractChunksFromModule(CurrentChunks, Cand.Clone.get());
+
+        writeTemporaryFile(*Cand.Clone, Cand.Filepath);
+        Cand.Process = Test.start(Cand.Filepath);
       }
 
-      UninterestingChunks.insert(Chunks[I]);
-      ReducedProgram = std::move(Clone);
-      errs() << " **** SUCCESS | lines: " << getLines(CurrentFilepath) << "\n";
+      bool Removed = false;
+      for (Candidate &Cand : Batch) {
+        // Tests started after the removed chunk are stale; reap them.
+        if (Removed) {
+          Test.wait(Cand.Process);
+          continue;
+        }
+
+        errs() << "Ignoring: ";
+        Chunks[Cand.Index].print();
+        for (auto C : UninterestingChunks)
+          C.print();
+
+        if (!Test.wait(Cand.Process)) {
+          errs() << "\n";
+          continue;
+        }
+
+        UninterestingChunks.insert(Chunks[Cand.Index]);
+        ReducedProgram = std::move(Cand.Clone);
+        errs() << " **** SUCCESS | lines: " << getLines(Cand.Filepath) << "\n";
+        // Carry on with the next chunk after the removed one.
+        I = Cand.Index - 1;
+        Removed = true;
+      }
     }
     // Delete uninteresting chunks
     erase_if(Chunks, [&UninterestingChunks](const Chunk &C) {
@@ -27,8 +27,10 @@
 #include "llvm/ObjectYAML/DWARFEmitter.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Testing/Support/Error.h"
 #include "gtest/gtest.h"
 #include <string>
@@ -1975,6 +1977,164 @@ TEST(DWARFDebugInfo, TestDwarfVerifyInvalidRefAddr) {
               "error: DW_FORM_ref_addr offset beyond .debug_info bounds:");
 }
 
+TEST(DWARFDebugInfo, TestDwarfVerifyParallel) {
+  // Verify three compile units and an invalid unit header between the last
+  // two. The first two refer to each other with DW_FORM_ref_addr: the first
+  // to a variable of the second as its type, the second to a base type of the
+  // first. The first also has an invalid DW_FORM_ref4, and the second refers
+  // into the middle of its own unit DIE. The last has a DW_FORM_ref_addr
+  // beyond .debug_info. The output must be the same with one and with several
+  // threads: the header chain, then the units in order.
+  const char *yamldata = R"(
+    debug_str:
+      - ''
+      - /tmp/main.c
+      - int
+      - float
+      - x
+    debug_abbrev:
+      - Code:            0x00000001
+        Tag:             DW_TAG_compile_unit
+        Children:        DW_CHILDREN_yes
+        Attributes:
+          - Attribute:       DW_AT_name
+            Form:            DW_FORM_strp
+      - Code:            0x00000002
+        Tag:             DW_TAG_base_type
+        Children:        DW_CHILDREN_no
+        Attributes:
+          - Attribute:       DW_AT_name
+            Form:            DW_FORM_strp
+      - Code:            0x00000003
+        Tag:             DW_TAG_variable
+        Children:        DW_CHILDREN_no
+        Attributes:
+          - Attribute:       DW_AT_name
+            Form:            DW_FORM_strp
+          - Attribute:       DW_AT_type
+            Form:            DW_FORM_ref_addr
+      - Code:            0x00000004
+        Tag:             DW_TAG_variable
+        Children:        DW_CHILDREN_no
+        Attributes:
+          - Attribute:       DW_AT_name
+            Form:            DW_FORM_strp
+          - Attribute:       DW_AT_type
+            Form:            DW_FORM_ref4
+    debug_info:
+      - Length:
+          TotalLength:     36
+        Version:         4
+        AbbrOffset:      0
+        AddrSize:        8
+        Entries:
+          - AbbrCode:        0x00000001
+            Values:
+              - Value:           0x0000000000000001
+          - AbbrCode:        0x00000002
+            Values:
+              - Value:           0x000000000000000D
+          - AbbrCode:        0x00000003
+            Values:
+              - Value:           0x0000000000000017
+              - Value:           0x000000000000003D
+          - AbbrCode:        0x00000004
+            Values:
+              - Value:           0x0000000000000017
+              - Value:           0x0000000000001234
+          - AbbrCode:        0x00000000
+            Values:
+      - Length:
+          TotalLength:     36
+        Version:         4
+        AbbrOffset:      0
+        AddrSize:        8
+        Entries:
+          - AbbrCode:        0x00000001
+            Values:
+              - Value:           0x0000000000000001
+          - AbbrCode:        0x00000002
+            Values:
+              - Value:           0x0000000000000011
+          - AbbrCode:        0x00000003
+            Values:
+              - Value:           0x0000000000000017
+              - Value:           0x0000000000000010
+          - AbbrCode:        0x00000003
+            Values:
+              - Value:           0x0000000000000017
+              - Value:           0x0000000000000034
+          - AbbrCode:        0x00000000
+            Values:
+      - Length:
+          TotalLength:     13
+        Version:         1
+        AbbrOffset:      0
+        AddrSize:        8
+        Entries:
+          - AbbrCode:        0x00000001
+            Values:
+              - Value:           0x0000000000000001
+          - AbbrCode:        0x00000000
+            Values:
+      - Length:
+          TotalLength:     22
+        Version:         4
+        AbbrOffset:      0
+        AddrSize:        8
+        Entries:
+          - AbbrCode:        0x00000001
+            Values:
+              - Value:           0x0000000000000001
+          - AbbrCode:        0x00000003
+            Values:
+              - Value:           0x0000000000000017
+              - Value:           0x0000000000005000
+          - AbbrCode:        0x00000000
+            Values:
+  )";
+  auto ErrOrSections = DWARFYAML::EmitDebugSections(StringRef(yamldata));
+  ASSERT_TRUE((bool)ErrOrSections);
+  auto Verify = [&](unsigned ThreadCount) {
+    parallel::strategy = hardware_concurrency(ThreadCount);
+    std::unique_ptr<DWARFContext> DwarfContext =
+        DWARFContext::create(*ErrOrSections, 8);
+    std::string Str;
+    raw_string_ostream Strm(Str);
+    EXPECT_FALSE(DwarfContext->verify(Strm));
+    return Strm.str();
+  };
+  ThreadPoolStrategy SavedStrategy = parallel::strategy;
+  std::string Serial = Verify(1);
+  std::string Parallel = Verify(4);
+  parallel::strategy = SavedStrategy;
+  EXPECT_EQ(Serial, Parallel);
+
+  size_t InvalidHeader = Serial.find("error: Units[2] - start offset: "
+                                     "0x00000050");
+  size_t InvalidTag = Serial.find(
+      "error: DIE has DW_AT_type with incompatible tag DW_TAG_variable");
+  size_t InvalidRef4 = Serial.find(
+      "error: DW_FORM_ref4 CU offset 0x00001234 is invalid (must be less "
+      "than CU size of 0x00000028):");
+  size_t InvalidRefAddr =
+      Serial.find("error: DW_FORM_ref_addr offset beyond .debug_info bounds:");
+  size_t InvalidDIERef = Serial.find("error: invalid DIE reference "
+                                     "0x00000034. Offset is in between DIEs:");
+  ASSERT_NE(InvalidHeader, std::string::npos);
+  ASSERT_NE(InvalidTag, std::string::npos);
+  ASSERT_NE(InvalidRef4, std::string::npos);
+  ASSERT_NE(InvalidRefAddr, std::string::npos);
+  ASSERT_NE(InvalidDIERef, std::string::npos);
+  EXPECT_LT(InvalidHeader, InvalidTag);
+  EXPECT_LT(InvalidTag, InvalidRef4);
+  EXPECT_LT(InvalidRef4, InvalidRefAddr);
+  EXPECT_LT(InvalidRefAddr, InvalidDIERef);
+  // Both references between the first two units point to DIEs.
+  EXPECT_FALSE(StringRef(Serial).contains("invalid DIE reference 0x00000010"));
+  EXPECT_FALSE(StringRef(Serial).contains("invalid DIE reference 0x0000003d"));
+}
+
 TEST(DWARFDebugInfo, TestDwarfVerifyInvalidRanges) {
   // Create a single compile unit with a DW_AT_ranges whose section offset
   // isn't valid.
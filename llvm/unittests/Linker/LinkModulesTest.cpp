@@ -201,6 +201,37 @@ TEST_F(LinkModuleTest, TypeMerge) {
             M1->getNamedGlobal("t2")->getType());
 }
 
+TEST_F(LinkModuleTest, TypeMergeRenamedRecursive) {
+  LLVMContext C;
+  SMDiagnostic Err;
+
+  // An unrelated type holds the name "node", so the recursive types of the
+  // two modules linked below are renamed to "node.0" and "node.1" when they
+  // are loaded, and the destination module has no "node" to map them to.
+  const char *OtherStr = "%node = type {i8}\n"
+                         "@o = global %node zeroinitializer\n";
+  std::unique_ptr<Module> Other = parseAssemblyString(OtherStr, Err, C);
+  ASSERT_TRUE(Other.get());
+
+  const char *M1Str = "%node = type {%node*, i32}\n"
+                      "@n1 = global %node zeroinitializer\n";
+  std::unique_ptr<Module> M1 = parseAssemblyString(M1Str, Err, C);
+  ASSERT_TRUE(M1.get());
+
+  const char *M2Str = "%node = type {%node*, i32}\n"
+                      "@n2 = global %node zeroinitializer\n";
+  std::unique_ptr<Module> M2 = parseAssemblyString(M2Str, Err, C);
+  ASSERT_TRUE(M2.get());
+
+  auto Dst = std::make_unique<Module>("Linked", C);
+  C.setDiagnosticHandlerCallBack(expectNoDiags);
+  ASSERT_FALSE(Linker::linkModules(*Dst, std::move(M1)));
+  ASSERT_FALSE(Linker::linkModules(*Dst, std::move(M2)));
+
+  EXPECT_EQ(Dst->getNamedGlobal("n1")->getValueType(),
+            Dst->getNamedGlobal("n2")->getValueType());
+}
+
 TEST_F(LinkModuleTest, NewCAPISuccess) {
   std::unique_ptr<Module> DestM(getExternal(Ctx, "foo"));
   std::unique_ptr<Module> SourceM(getExternal(Ctx, "bar"));
@@ -73,4 +73,70 @@ TEST(CompressionTest, ZlibCRC32) {
 
 #endif
 
+void TestZstdCompression(StringRef Input, int Level) {
+  SmallString<32> Compressed;
+  SmallString<32> Uncompressed;
+
+  Error E = zstd::compress(Input, Compressed, Level);
+  EXPECT_FALSE(E);
+  consumeError(std::move(E));
+
+  // Check that uncompressed buffer is the same as original.
+  E = zstd::uncompress(Compressed, Uncompressed, Input.size());
+  EXPECT_FALSE(E);
+  consumeError(std::move(E));
+
+  EXPECT_EQ(Input, Uncompressed);
+  if (Input.size() > 0) {
+    // Uncompression fails if expected length is too short.
+    E = zstd::uncompress(Compressed, Uncompressed, Input.size() - 1);
+    EXPECT_TRUE(bool(E));
+    consumeError(std::move(E));
+  }
+}
+
+TEST(CompressionTest, Zstd) {
+  if (!zstd::isAvailable())
+    return;
+
+  TestZstdCompression("", zstd::DefaultCompression);
+
+  TestZstdCompression("hello, world!", zstd::NoCompression);
+  TestZstdCompression("hello, world!", zstd::BestSizeCompression);
+  TestZstdCompression("hello, world!", zstd::BestSpeedCompression);
+  TestZstdCompression("hello, world!", zstd::DefaultCompression);
+
+  const size_t kSize = 1024;
+  char BinaryData[kSize];
+  for (size_t i = 0; i < kSize; ++i) {
+    BinaryData[i] = i & 255;
+  }
+  StringRef BinaryDataStr(BinaryData, kSize);
+
+  TestZstdCompression(BinaryDataStr, zstd::NoCompression);
+  TestZstdCompression(BinaryDataStr, zstd::BestSizeCompression);
+  TestZstdCompression(BinaryDataStr, zstd::BestSpeedCompression);
+  TestZstdCompression(BinaryDataStr, zstd::DefaultCompression);
+}
+
+TEST(CompressionTest, Formats) {
+  for (auto F : {compression::Format::Zlib, compression::Format::Zstd}) {
+    if (!compression::isAvailable(F)) {
+      EXPECT_NE(nullptr, compression::getReasonIfUnavailable(F));
+      continue;
+    }
+    EXPECT_EQ(nullptr, compression::getReasonIfUnavailable(F));
+
+    StringRef Input = "The quick brown fox jumps over the lazy dog";
+    SmallString<32> Compressed;
+    SmallString<32> Uncompressed;
+    EXPECT_FALSE(errorToBool(compression::compress(F, Input, Compressed)));
+    EXPECT_FALSE(errorToBool(
+        compression::uncompress(F, Compressed, Uncompressed, Input.size())));
+    EXPECT_EQ(Input, Uncompressed);
+  }
+  EXPECT_STREQ("zlib", compression::getName(compression::Format::Zlib));
+  EXPECT_STREQ("zstd", compression::getName(compression::Format::Zstd));
+}
+
 }
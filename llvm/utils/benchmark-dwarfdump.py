@@ -0,0 +1,120 @@
+#!/usr/bin/env python3
+"""Times llvm-dwarfdump --verify and --statistics on synthetic DWARF.
+
+A large input is built by compiling a number of generated translation units
+with -g -O1 and linking them into one relocatable object. Every unit defines
+structs and functions with loops, locals and inlined calls, so that the
+verifier checks ranges, locations and inlined subroutines.
+
+Both modes are then run with one thread and with each of the given thread
+counts. The minimum wall time over the repetitions is reported, and the run
+fails if any multi-threaded output differs from the single-threaded one.
+"""
+
+import argparse
+import os
+import subprocess
+import sys
+import time
+
+
+def write_unit(path, index, num_units, functions):
+    other = (index + 1) % num_units
+    lines = ['struct S%d { int a; long b; double c; };\n' % index,
+             'struct S%d { int a; long b; double c; };\n' % other if
+             other != index else '',
+             'static inline __attribute__((always_inline)) int '
+             'mix%d(int x, int y) {\n'
+             '  int t = x * 31 + y;\n'
+             '  return t ^ (t >> 3);\n'
+             '}\n' % index]
+    for f in range(functions):
+        lines.append('''
+int unit%(i)d_fn%(f)d(struct S%(i)d *s, struct S%(o)d *o, int n) {
+  int acc = 0;
+  for (int k = 0; k < n; ++k) {
+    int v = mix%(i)d(s->a + k, o->a);
+    acc += v;
+    s->b += acc;
+  }
+  double d = s->c * o->c;
+  return acc + (int)d;
+}
+''' % {'i': index, 'o': other, 'f': f})
+    with open(path, 'w') as f:
+        f.write(''.join(lines))
+
+
+def build_input(args):
+    sources = os.path.join(args.work_dir, 'src')
+    os.makedirs(sources, exist_ok=True)
+    objects = []
+    for i in range(args.units):
+        source = os.path.join(sources, 'unit%d.c' % i)
+        obj = source[:-2] + '.o'
+        write_unit(source, i, args.units, args.functions)
+        subprocess.check_call([args.clang, '-c', '-g', '-O1', source, '-o',
+                               obj])
+        objects.append(obj)
+    output = os.path.join(args.work_dir, 'input.o')
+    subprocess.check_call([args.lld, '-r', '-o', output] + objects)
+    return output
+
+
+def run(args, mode, threads, obj):
+    cmd = [args.dwarfdump, mode, '--num-threads=%d' % threads, obj]
+    best = None
+    output = None
+    for _ in range(args.repeat):
+        start = time.perf_counter()
+        proc = subprocess.run(cmd, stdout=subprocess.PIPE,
+                              stderr=subprocess.STDOUT)
+        wall = time.perf_counter() - start
+        best = wall if best is None else min(best, wall)
+        output = proc.stdout
+    return best, output
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description=__doc__.splitlines()[0])
+    parser.add_argument('--dwarfdump', required=True,
+                        help='llvm-dwarfdump executable')
+    parser.add_argument('--clang', required=True, help='clang executable')
+    parser.add_argument('--lld', required=True, help='ld.lld executable')
+    parser.add_argument('--work-dir', required=True,
+                        help='directory for the generated input')
+    parser.add_argument('--units', type=int, default=2000,
+                        help='number of compile units')
+    parser.add_argument('--functions', type=int, default=50,
+                        help='functions per compile unit')
+    parser.add_argument('--threads', type=int, nargs='+',
+                        default=[os.cpu_count() or 1],
+                        help='thread counts to compare to one thread')
+    parser.add_argument('--repeat', type=int, default=3,
+                        help='runs per configuration; the fastest is kept')
+    args = parser.parse_args()
+
+    obj = build_input(args)
+    print('input: %s (%d bytes)' % (obj, os.path.getsize(obj)))
+    print('%-14s %8s %10s %8s' % ('mode', 'threads', 'wall (s)', 'speedup'))
+    failed = False
+    for mode in ['--verify', '--statistics']:
+        serial, expected = run(args, mode, 1, obj)
+        print('%-14s %8d %10.3f %8s' % (mode, 1, serial, '-'))
+        for threads in args.threads:
+            if threads == 1:
+                continue
+            wall, output = run(args, mode, threads, obj)
+            print('%-14s %8d %10.3f %7.2fx' % (mode, threads, wall,
+                                              serial / wall))
+            if output != expected:
+                sys.stderr.write('error: %s output with %d threads differs '
+                                 'from the serial output\n' % (mode, threads))
+                failed = True
+        sys.stdout.flush()
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,118 @@
+#!/usr/bin/env python3
+"""Times llvm-link on many generated modules that share struct types.
+
+Every module defines the same set of named struct types, among them
+recursive lists and trees, plus an anonymous struct whose body varies
+between modules, and a struct of its own. Each function calls the function
+of the next module, so that declarations and definitions with the same
+struct types are linked together.
+
+llvm-link is run on all modules with each of the given executables, e.g. a
+build before and after a change. The minimum wall time over the repetitions
+is reported, along with the number of identified struct types in the linked
+module and how many of those are renamed copies such as %struct.list.12.
+"""
+
+import argparse
+import os
+import re
+import subprocess
+import sys
+import time
+
+SHARED_TYPES = '''%struct.list = type { %struct.list*, i32 }
+%struct.tree = type { %struct.tree*, %struct.tree*, %struct.payload* }
+%struct.payload = type { i64, [4 x i8], %struct.list* }
+'''
+
+ANON_BODIES = ['{ i32, float }', '{ i64 }', '{ i8*, i32 }',
+               '{ double, double }']
+
+TYPE_DEF = re.compile(r'^%("?[^ ]+"?) = type ', re.MULTILINE)
+RENAMED = re.compile(r'\.\d+"?$')
+
+
+def write_module(path, index, num_modules):
+    callee = (index + 1) % num_modules
+    subst = {'i': index, 'c': callee,
+             'anon': ANON_BODIES[index % len(ANON_BODIES)],
+             'types': '%struct.tree*, %struct.list*, %struct.anon*',
+             'args': '%struct.tree* %t, %struct.list* %l, %struct.anon* %a'}
+    lines = [SHARED_TYPES,
+             '%%struct.anon = type %(anon)s\n' % subst,
+             '%%struct.local%(i)d = type { i32, %%struct.payload }\n' % subst,
+             '@g%(i)d = global %%struct.local%(i)d zeroinitializer\n' % subst]
+    if callee != index:
+        lines.append('declare i32 @f%(c)d(%(types)s)\n' % subst)
+    lines.append('''
+define i32 @f%(i)d(%(args)s) {
+  %%p = getelementptr %%struct.list, %%struct.list* %%l, i32 0, i32 1
+  %%v = load i32, i32* %%p
+  %%r = call i32 @f%(c)d(%(args)s)
+  %%s = add i32 %%v, %%r
+  ret i32 %%s
+}
+''' % subst)
+    with open(path, 'w') as f:
+        f.write(''.join(lines))
+
+
+def build_inputs(args):
+    os.makedirs(args.work_dir, exist_ok=True)
+    paths = []
+    for i in range(args.modules):
+        path = os.path.join(args.work_dir, 'module%d.ll' % i)
+        write_module(path, i, args.modules)
+        paths.append(path)
+    return paths
+
+
+def run(args, link, inputs):
+    output = os.path.join(args.work_dir, 'linked.ll')
+    cmd = [link, '-S', '-o', output] + inputs
+    best = None
+    for _ in range(args.repeat):
+        start = time.perf_counter()
+        proc = subprocess.run(cmd, stderr=subprocess.PIPE)
+        wall = time.perf_counter() - start
+        if proc.returncode != 0:
+            sys.stderr.write('error: %s failed:\n' % link)
+            sys.stderr.write(proc.stderr.decode(errors='replace'))
+            return None
+        best = wall if best is None else min(best, wall)
+    with open(output) as f:
+        names = TYPE_DEF.findall(f.read())
+    renamed = sum(1 for name in names if RENAMED.search(name))
+    return best, len(names), renamed
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description=__doc__.splitlines()[0])
+    parser.add_argument('links', nargs='+', metavar='llvm-link',
+                        help='llvm-link executables to compare')
+    parser.add_argument('--work-dir', required=True,
+                        help='directory for the generated modules')
+    parser.add_argument('--modules', type=int, default=2000,
+                        help='number of modules to link')
+    parser.add_argument('--repeat', type=int, default=3,
+                        help='runs per executable; the fastest is kept')
+    args = parser.parse_args()
+
+    inputs = build_inputs(args)
+    print('input: %d modules in %s' % (len(inputs), args.work_dir))
+    print('%-40s %10s %8s %8s' % ('llvm-link', 'wall (s)', 'types',
+                                  'renamed'))
+    failed = False
+    for link in args.links:
+        result = run(args, link, inputs)
+        if result is None:
+            failed = True
+            continue
+        print('%-40s %10.3f %8d %8d' % ((link,) + result))
+        sys.stdout.flush()
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,102 @@
+#!/usr/bin/env python3
+"""Times llvm-mca on a generated input with many code regions.
+
+The input is an x86-64 assembly file made of a number of code regions, each
+delimited by LLVM-MCA-BEGIN and LLVM-MCA-END comments. Every region holds a
+short dependency chain of integer, memory and vector instructions, so that
+each one runs a full pipeline simulation with the timeline and resource
+pressure views.
+
+llvm-mca is then run with one thread and with each of the given thread
+counts. The minimum wall time over the repetitions is reported, and the run
+fails if any multi-threaded output differs from the single-threaded one.
+"""
+
+import argparse
+import os
+import subprocess
+import sys
+import time
+
+# Instruction forms that regions are built from. Each reads the register that
+# the previous one wrote, so that the simulation sees real dependencies.
+FORMS = [
+    'addq %rax, %rbx',
+    'imulq %rbx, %rcx',
+    'movq (%rdi), %rax',
+    'addq %rcx, %rax',
+    'vaddps %xmm0, %xmm1, %xmm2',
+    'vmulps %xmm2, %xmm3, %xmm0',
+    'movq %rax, 8(%rsi)',
+    'shlq $3, %rbx',
+]
+
+
+def write_input(path, regions, instructions):
+    lines = []
+    for r in range(regions):
+        lines.append('# LLVM-MCA-BEGIN region%d\n' % r)
+        for k in range(instructions):
+            lines.append(FORMS[(r + k) % len(FORMS)] + '\n')
+        lines.append('# LLVM-MCA-END\n')
+    with open(path, 'w') as f:
+        f.write(''.join(lines))
+
+
+def run(args, threads, source):
+    cmd = [args.mca, '-mtriple=x86_64-unknown-unknown', '-mcpu=' + args.mcpu,
+           '-timeline', '--num-threads=%d' % threads, source]
+    best = None
+    output = None
+    for _ in range(args.repeat):
+        start = time.perf_counter()
+        proc = subprocess.run(cmd, stdout=subprocess.PIPE,
+                              stderr=subprocess.STDOUT)
+        wall = time.perf_counter() - start
+        best = wall if best is None else min(best, wall)
+        output = proc.stdout
+    return best, output
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description=__doc__.splitlines()[0])
+    parser.add_argument('--mca', required=True, help='llvm-mca executable')
+    parser.add_argument('--work-dir', required=True,
+                        help='directory for the generated input')
+    parser.add_argument('--mcpu', default='skylake',
+                        help='cpu to simulate')
+    parser.add_argument('--regions', type=int, default=2000,
+                        help='number of code regions')
+    parser.add_argument('--instructions', type=int, default=16,
+                        help='instructions per code region')
+    parser.add_argument('--threads', type=int, nargs='+',
+                        default=[os.cpu_count() or 1],
+                        help='thread counts to compare to one thread')
+    parser.add_argument('--repeat', type=int, default=3,
+                        help='runs per configuration; the fastest is kept')
+    args = parser.parse_args()
+
+    os.makedirs(args.work_dir, exist_ok=True)
+    source = os.path.join(args.work_dir, 'input.s')
+    write_input(source, args.regions, args.instructions)
+    print('input: %s (%d regions)' % (source, args.regions))
+    print('%8s %10s %8s' % ('threads', 'wall (s)', 'speedup'))
+    serial, expected = run(args, 1, source)
+    print('%8d %10.3f %8s' % (1, serial, '-'))
+    failed = False
+    for threads in args.threads:
+        if threads == 1:
+            continue
+        wall, output = run(args, threads, source)
+        print('%8d %10.3f %7.2fx' % (threads, wall, serial / wall))
+        if output != expected:
+            sys.stderr.write('error: output with %d threads differs from the '
+                             'serial output\n' % threads)
+            failed = True
+        sys.stdout.flush()
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -1791,6 +1791,8 @@ typedef enum kmp_bar_pat { /* Barrier communication patterns */
                                2, /* Hypercube-embedded tree with min branching
                                      factor 2^n */
                            bp_hierarchical_bar = 3, /* Machine hierarchy tree */
+                           bp_dist_bar = 4, /* Two-level tree over groups of
+                                               neighbouring threads */
                            bp_last_bar /* Placeholder to mark the end */
 } kmp_bar_pat_e;
 
@@ -3340,6 +3342,7 @@ extern int __kmp_aux_set_affinity_mask_proc(int proc, void **mask);
 extern int __kmp_aux_unset_affinity_mask_proc(int proc, void **mask);
 extern int __kmp_aux_get_affinity_mask_proc(int proc, void **mask);
 extern void __kmp_balanced_affinity(kmp_info_t *th, int team_size);
+extern int __kmp_affinity_threads_per_package(void);
 #if KMP_OS_LINUX || KMP_OS_FREEBSD
 extern int kmp_set_thread_affinity_mask_initial(void);
 #endif
@@ -3435,6 +3438,7 @@ extern kmp_team_t *__kmp_reap_team(kmp_team_t *);
 
 extern void __kmp_initialize_bget(kmp_info_t *th);
 extern void __kmp_finalize_bget(kmp_info_t *th);
+extern void __kmp_bget_flush_remote(kmp_info_t *th);
 
 KMP_EXPORT void *kmpc_malloc(size_t size);
 KMP_EXPORT void *kmpc_aligned_malloc(size_t size, size_t alignment);
@@ -314,6 +314,12 @@ inline static bool __kmp_affinity_uniform_topology() {
   return __kmp_avail_proc == (__kmp_nThreadsPerCore * nCoresPerPkg * nPackages);
 }
 
+// Number of hardware threads in one package of the machine topology, or 0 if
+// the topology has not been detected.
+int __kmp_affinity_threads_per_package() {
+  return __kmp_nThreadsPerCore * nCoresPerPkg;
+}
+
 // Print out the detailed machine topology map, i.e. the physical locations
 // of each OS proc.
 static void __kmp_affinity_print_topology(AddrUnsPair *address2os, int len,
@@ -48,6 +48,8 @@ static void *bget(kmp_info_t *th, bufsize size);
 static void *bgetz(kmp_info_t *th, bufsize size);
 static void *bgetr(kmp_info_t *th, void *buffer, bufsize newsize);
 static void brel(kmp_info_t *th, void *buf);
+static int bcache_put(kmp_info_t *th, void *buf);
+static int bcache_drain(kmp_info_t *th);
 static void bectl(kmp_info_t *th, bget_compact_t compact,
                   bget_acquire_t acquire, bget_release_t release,
                   bufsize pool_incr);
@@ -123,6 +125,20 @@ static bufsize bget_bin_size[] = {
 
 #define MAX_BGET_BINS (int)(sizeof(bget_bin_size) / sizeof(bufsize))
 
+/* Usable sizes of the small buffers kept in the per-thread caches.  Requests
+   up to the largest class are rounded up to a class size, and freed buffers
+   of these sizes are kept by the owning thread for reuse instead of going
+   back through the free lists. */
+static bufsize bget_cache_size[] = {32, 64, 128, 256, 512, 1024, 2048, 4096};
+
+#define MAX_BGET_CACHE_CLASSES                                                 \
+  (int)(sizeof(bget_cache_size) / sizeof(bufsize))
+// Maximum number of buffers kept in each per-thread cache
+#define BGET_CACHE_DEPTH 16
+// Buffers freed by a thread other than their owner are collected into a chain
+// and handed back to the owner in one operation once this many are pending.
+#define BGET_REMOTE_BATCH 32
+
 struct bfhead;
 
 //  Declare the interface, including the requested buffer size type, bufsize.
@@ -187,6 +203,17 @@ typedef struct thr_data {
                        >0: (common) block size for all bpool calls made so far
                     */
   bfhead_t *last_pool; /* Last pool owned by this thread (delay deallocation) */
+
+  /* Small allocated buffers owned by this thread, ready for reuse */
+  void *cache[MAX_BGET_CACHE_CLASSES];
+  int cache_count[MAX_BGET_CACHE_CLASSES];
+
+  /* Chain of buffers freed by this thread but owned by remote_owner, not yet
+     handed back to it */
+  kmp_info_t *remote_owner;
+  void *remote_head;
+  void *remote_tail;
+  int remote_count;
 } thr_data_t;
 
 /*  Minimum allocation quantum: */
@@ -224,6 +251,15 @@ static int bget_get_bin(bufsize size) {
   return lo;
 }
 
+// Smallest cache class that holds a request of the given size, or -1
+static int bget_get_cache_class(bufsize size) {
+  int c;
+  for (c = 0; c < MAX_BGET_CACHE_CLASSES; ++c)
+    if (size <= bget_cache_size[c])
+      return c;
+  return -1;
+}
+
 static void set_thr_data(kmp_info_t *th) {
   int i;
   thr_data_t *data;
@@ -304,27 +340,28 @@ static void __kmp_bget_dequeue(kmp_info_t *th) {
 
       p = (void *)b->ql.flink;
 
-      brel(th, buf);
+      if (!bcache_put(th, buf))
+        brel(th, buf);
     }
   }
 }
 
-/* Chain together the free buffers by using the thread owner field */
-static void __kmp_bget_enqueue(kmp_info_t *th, void *buf
+/* Chain together the free buffers by using the thread owner field.  buf is
+   the first buffer of a chain linked through ql.flink that ends with last. */
+static void __kmp_bget_enqueue(kmp_info_t *th, void *buf, void *last
 #ifdef USE_QUEUING_LOCK_FOR_BGET
                                ,
                                kmp_int32 rel_gtid
 #endif
                                ) {
-  bfhead_t *b = BFH(((char *)buf) - sizeof(bhead_t));
+  bfhead_t *b = BFH(((char *)last) - sizeof(bhead_t));
 
   KMP_DEBUG_ASSERT(b->bh.bb.bsize != 0);
   KMP_DEBUG_ASSERT(((kmp_uintptr_t)TCR_PTR(b->bh.bb.bthr) & ~1) ==
                    (kmp_uintptr_t)th); // clear possible mark
+  KMP_DEBUG_ASSERT(b->ql.blink == 0);
 
-  b->ql.blink = 0;
-
-  KC_TRACE(10, ("__kmp_bget_enqueue: moving buffer to T#%d list\n",
+  KC_TRACE(10, ("__kmp_bget_enqueue: moving buffers to T#%d list\n",
                 __kmp_gtid_from_thread(th)));
 
 #if USE_CMP_XCHG_FOR_BGET
@@ -361,6 +398,63 @@ static void __kmp_bget_enqueue(kmp_info_t *th, void *buf
 #endif /* USE_CMP_XCHG_FOR_BGET */
 }
 
+/* Hand the buffers this thread freed for another thread back to their owner.
+   Besides the allocation path, this is called whenever the thread becomes idle
+   so that no buffers are held back while their owner might be reaped. */
+void __kmp_bget_flush_remote(kmp_info_t *th) {
+  thr_data_t *thr = get_thr_data(th);
+
+  if (thr->remote_count == 0)
+    return;
+
+  __kmp_bget_enqueue(thr->remote_owner, thr->remote_head, thr->remote_tail
+#ifdef USE_QUEUING_LOCK_FOR_BGET
+                     ,
+                     __kmp_gtid_from_thread(th)
+#endif
+                     );
+  thr->remote_owner = NULL;
+  thr->remote_head = NULL;
+  thr->remote_tail = NULL;
+  thr->remote_count = 0;
+}
+
+/* Queue a buffer owned by thread bth to be handed back to it.  Buffers for the
+   same owner are chained together so that they are passed on in one step. */
+static void __kmp_bget_free_remote(kmp_info_t *th, kmp_info_t *bth, void *buf) {
+  thr_data_t *thr = get_thr_data(th);
+  bfhead_t *b = BFH(((char *)buf) - sizeof(bhead_t));
+  int bgtid = __kmp_gtid_from_thread(bth);
+
+  b->ql.blink = 0;
+
+  // Roots other than the initial thread may go away while the program runs,
+  // so their buffers are handed back right away.
+  if (KMP_UBER_GTID(bgtid) && !KMP_INITIAL_GTID(bgtid)) {
+    b->ql.flink = NULL;
+    __kmp_bget_enqueue(bth, buf, buf
+#ifdef USE_QUEUING_LOCK_FOR_BGET
+                       ,
+                       __kmp_gtid_from_thread(th)
+#endif
+                       );
+    return;
+  }
+
+  if (thr->remote_owner != bth) {
+    __kmp_bget_flush_remote(th);
+    thr->remote_owner = bth;
+  }
+
+  b->ql.flink = BFH(thr->remote_head);
+  if (thr->remote_head == NULL)
+    thr->remote_tail = buf;
+  thr->remote_head = buf;
+
+  if (++thr->remote_count >= BGET_REMOTE_BATCH)
+    __kmp_bget_flush_remote(th);
+}
+
 /* insert buffer back onto a new freelist */
 static void __kmp_bget_insert_into_freelist(thr_data_t *thr, bfhead_t *b) {
   int bin;
@@ -431,12 +525,28 @@ static void *bget(kmp_info_t *th, bufsize requested_size) {
   int use_blink = 0;
   /* For BestFit */
   bfhead_t *best;
+  int cache_class;
 
   if (size < 0 || size + sizeof(bhead_t) > MaxSize) {
     return NULL;
   }
 
   __kmp_bget_dequeue(th); /* Release any queued buffers */
+  __kmp_bget_flush_remote(th); /* Hand back buffers freed for other threads */
+
+  /* Small requests are served from the cache of their size class if possible,
+     otherwise they are rounded up so that the buffer can be cached later. */
+  cache_class = bget_get_cache_class(size);
+  if (cache_class >= 0) {
+    buf = thr->cache[cache_class];
+    if (buf != NULL) {
+      thr->cache[cache_class] = *(void **)buf;
+      thr->cache_count[cache_class]--;
+      KMP_DEBUG_ASSERT(((size_t)buf) % SizeQuant == 0);
+      return buf;
+    }
+    size = bget_cache_size[cache_class];
+  }
 
   if (size < (bufsize)SizeQ) { // Need at least room for the queue links.
     size = SizeQ;
@@ -573,6 +683,11 @@ static void *bget(kmp_info_t *th, bufsize requested_size) {
 
   /* No buffer available with requested size free. */
 
+  /* Put the cached buffers back into the free lists and try again before
+     growing the pool. */
+  if (bcache_drain(th))
+    return bget(th, requested_size);
+
   /* Don't give up yet -- look in the reserve supply. */
   if (thr->acqfcn != 0) {
     if (size > (bufsize)(thr->exp_incr - sizeof(bhead_t))) {
@@ -733,12 +848,7 @@ static void brel(kmp_info_t *th, void *buf) {
                        ~1); // clear possible mark before comparison
   if (bth != th) {
     /* Add this buffer to be released by the owning thread later */
-    __kmp_bget_enqueue(bth, buf
-#ifdef USE_QUEUING_LOCK_FOR_BGET
-                       ,
-                       __kmp_gtid_from_thread(th)
-#endif
-                           );
+    __kmp_bget_free_remote(th, bth, buf);
     return;
   }
 
@@ -861,6 +971,53 @@ static void brel(kmp_info_t *th, void *buf) {
   }
 }
 
+/*  BCACHE_PUT  --  Keep a small buffer owned by this thread in the cache of
+                    its size class instead of releasing it.  Returns nonzero
+                    if the buffer was cached. */
+static int bcache_put(kmp_info_t *th, void *buf) {
+  thr_data_t *thr = get_thr_data(th);
+  bfhead_t *b = BFH(((char *)buf) - sizeof(bhead_t));
+  bufsize size;
+  int c;
+
+  if (b->bh.bb.bsize >= 0) /* Directly-acquired buffer? */
+    return 0;
+  if (((kmp_uintptr_t)TCR_PTR(b->bh.bb.bthr) & ~1) != (kmp_uintptr_t)th)
+    return 0;
+
+  size = -b->bh.bb.bsize - (bufsize)sizeof(bhead_t);
+  for (c = MAX_BGET_CACHE_CLASSES - 1; c >= 0; --c)
+    if (bget_cache_size[c] <= size)
+      break;
+  // Leave buffers much larger than their class to the free lists
+  if (c < 0 || size >= 2 * bget_cache_size[c] ||
+      thr->cache_count[c] >= BGET_CACHE_DEPTH)
+    return 0;
+
+  *(void **)buf = thr->cache[c];
+  thr->cache[c] = buf;
+  thr->cache_count[c]++;
+  return 1;
+}
+
+/*  BCACHE_DRAIN  --  Release all cached buffers of this thread.  Returns the
+                      number of buffers released. */
+static int bcache_drain(kmp_info_t *th) {
+  thr_data_t *thr = get_thr_data(th);
+  int c, count = 0;
+
+  for (c = 0; c < MAX_BGET_CACHE_CLASSES; ++c) {
+    while (thr->cache[c] != NULL) {
+      void *buf = thr->cache[c];
+      thr->cache[c] = *(void **)buf;
+      brel(th, buf);
+      ++count;
+    }
+    thr->cache_count[c] = 0;
+  }
+  return count;
+}
+
 /*  BECTL  --  Establish automatic pool expansion control  */
 static void bectl(kmp_info_t *th, bget_compact_t compact,
                   bget_acquire_t acquire, bget_release_t release,
@@ -1004,6 +1161,15 @@ void __kmp_finalize_bget(kmp_info_t *th) {
 
   KMP_DEBUG_ASSERT(th != 0);
 
+  /* Put the cached buffers back into the pool, and hand back buffers freed
+     for other threads unless the library is shutting down and their owners
+     may already be gone. */
+  if (th->th.th_local.bget_data != NULL) {
+    bcache_drain(th);
+    if (!TCR_4(__kmp_global.g.g_done))
+      __kmp_bget_flush_remote(th);
+  }
+
 #if BufStats
   thr = (thr_data_t *)th->th.th_local.bget_data;
   KMP_DEBUG_ASSERT(thr != NULL);
@@ -1076,6 +1242,7 @@ void kmpc_get_poolstat(size_t *maxmem, size_t *allmem) {
   bufsize a, b;
 
   __kmp_bget_dequeue(th); /* Release any queued buffers */
+  bcache_drain(th);
 
   bcheck(th, &a, &b);
 
@@ -1087,6 +1254,7 @@ void kmpc_poolprint(void) {
   kmp_info_t *th = __kmp_get_thread();
 
   __kmp_bget_dequeue(th); /* Release any queued buffers */
+  bcache_drain(th);
 
   bfreed(th);
 }
@@ -1178,7 +1346,8 @@ void kmpc_free(void *ptr) {
     __kmp_bget_dequeue(th); /* Release any queued buffers */
     // extract allocated pointer and free it
     KMP_ASSERT(*((void **)ptr - 1));
-    brel(th, *((void **)ptr - 1));
+    if (!bcache_put(th, *((void **)ptr - 1)))
+      brel(th, *((void **)ptr - 1));
   }
 }
 
@@ -1215,7 +1384,8 @@ void ___kmp_thread_free(kmp_info_t *th, void *ptr KMP_SRC_LOC_DECL) {
                 ptr KMP_SRC_LOC_PARM));
   if (ptr != NULL) {
     __kmp_bget_dequeue(th); /* Release any queued buffers */
-    brel(th, ptr);
+    if (!bcache_put(th, ptr))
+      brel(th, ptr);
   }
   KE_TRACE(30, ("<- __kmp_thread_free()\n"));
 }
@@ -1460,7 +1630,9 @@ void *__kmpc_alloc(int gtid, size_t size, omp_allocator_handle_t allocator) {
   if (allocator > kmp_max_mem_alloc && al->alignment > 0) {
     align = al->alignment; // alignment requested by user
   }
-  desc.size_a = size + sz_desc + align;
+  // Blocks from the allocators are at least pointer aligned, and so is the
+  // descriptor size, so extra room is needed only for larger alignments.
+  desc.size_a = size + sz_desc + (align > alignment ? align : 0);
 
   if (__kmp_memkind_available) {
     if (allocator < kmp_max_mem_alloc) {
@@ -2031,6 +2203,7 @@ void __kmp_free_fast_memory(kmp_info_t *th) {
       5, ("__kmp_free_fast_memory: Called T#%d\n", __kmp_gtid_from_thread(th)));
 
   __kmp_bget_dequeue(th); // Release any queued buffers
+  bcache_drain(th);
 
   // Dig through free lists and extract all allocated blocks
   for (bin = 0; bin < MAX_BGET_BINS; ++bin) {
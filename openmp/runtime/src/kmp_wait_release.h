@@ -347,6 +347,8 @@ final_spin=FALSE)
             __ompt_implicit_task_end(this_thr, ompt_entry_state, tId);
 #endif
           this_thr->th.th_task_team = NULL;
+          // Tasks run by this thread may have freed buffers of other threads
+          __kmp_bget_flush_remote(this_thr);
           this_thr->th.th_reap_state = KMP_SAFE_TO_REAP;
         }
       } else {
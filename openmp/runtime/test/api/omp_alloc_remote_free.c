@@ -0,0 +1,84 @@
+// RUN: %libomp-compile-and-run
+
+// Allocates small blocks in tasks and frees them from other tasks, so that
+// blocks are often freed by a thread other than the one that allocated them.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <omp.h>
+
+#define NBLOCKS 4096
+#define NROUNDS 8
+
+static void *blocks[NBLOCKS];
+
+static int check_block(void *p, size_t size, int align) {
+  size_t i;
+  if (p == NULL || ((uintptr_t)p & (align - 1)) != 0)
+    return 0;
+  for (i = 0; i < size; ++i)
+    if (((unsigned char *)p)[i] != (unsigned char)size)
+      return 0;
+  return 1;
+}
+
+static int run(omp_allocator_handle_t a, int align) {
+  int errors = 0;
+  int r;
+  for (r = 0; r < NROUNDS; ++r) {
+    #pragma omp parallel num_threads(4) reduction(+:errors)
+    #pragma omp single
+    {
+      int i;
+      for (i = 0; i < NBLOCKS; ++i) {
+        #pragma omp task firstprivate(i)
+        {
+          size_t size = 8 + (i * 37) % 600;
+          void *p = omp_alloc(size, a);
+          if (p != NULL)
+            memset(p, (unsigned char)size, size);
+          blocks[i] = p;
+        }
+      }
+      #pragma omp taskwait
+      for (i = 0; i < NBLOCKS; ++i) {
+        #pragma omp task firstprivate(i) shared(errors)
+        {
+          size_t size = 8 + (i * 37) % 600;
+          if (!check_block(blocks[i], size, align)) {
+            #pragma omp atomic
+            errors++;
+          }
+          omp_free(blocks[i], a);
+        }
+      }
+    }
+  }
+  return errors;
+}
+
+int main() {
+  omp_alloctrait_t at[3];
+  omp_allocator_handle_t a;
+  int errors;
+
+  errors = run(omp_default_mem_alloc, sizeof(void *));
+
+  at[0].key = omp_atk_alignment;
+  at[0].value = 64;
+  at[1].key = omp_atk_pool_size;
+  at[1].value = 16 * 1024 * 1024;
+  at[2].key = omp_atk_fallback;
+  at[2].value = omp_atv_default_mem_fb;
+  a = omp_init_allocator(omp_default_mem_space, 3, at);
+  errors += run(a, 64);
+  omp_destroy_allocator(a);
+
+  if (errors) {
+    printf("failed: %d errors\n", errors);
+    return 1;
+  }
+  printf("passed\n");
+  return 0;
+}
@@ -0,0 +1,53 @@
+// RUN: %libomp-compile
+// RUN: env KMP_PLAIN_BARRIER_PATTERN=dist,dist KMP_FORKJOIN_BARRIER_PATTERN=dist,dist KMP_REDUCTION_BARRIER_PATTERN=dist,dist %libomp-run
+// RUN: env KMP_PLAIN_BARRIER_PATTERN=dist,dist KMP_FORKJOIN_BARRIER_PATTERN=dist,dist KMP_REDUCTION_BARRIER_PATTERN=dist,dist KMP_AFFINITY=compact %libomp-run
+#include <stdio.h>
+#include "omp_testsuite.h"
+
+// Runs barriers and reductions over team sizes that give full and partial
+// groups in the distributed barrier.
+int test_omp_barrier_dist(int nthreads)
+{
+  int i;
+  int failed = 0;
+  int counts[64] = {0};
+
+  #pragma omp parallel num_threads(nthreads) shared(counts, failed) private(i)
+  {
+    int rank = omp_get_thread_num();
+    int nth = omp_get_num_threads();
+    for (i = 0; i < 100; i++) {
+      counts[rank] = i;
+      #pragma omp barrier
+      if (counts[(rank + 1) % nth] < i) {
+        #pragma omp atomic
+        failed++;
+      }
+      #pragma omp barrier
+    }
+  }
+
+  int sum = 0;
+  #pragma omp parallel num_threads(nthreads) reduction(+:sum)
+  {
+    sum += omp_get_thread_num();
+  }
+  if (sum != nthreads * (nthreads - 1) / 2) {
+    fprintf(stderr, "reduction with %d threads gave %d\n", nthreads, sum);
+    failed++;
+  }
+  return failed == 0;
+}
+
+int main()
+{
+  int n;
+  int num_failed = 0;
+
+  omp_set_dynamic(0);
+  for (n = 1; n <= 17; n++) {
+    if (!test_omp_barrier_dist(n))
+      num_failed++;
+  }
+  return num_failed;
+}